@@ -2,7 +2,8 @@
 #include "extraction/ExtractionPipeline.h"
 #include <android/log.h>
 #include <algorithm>
-#include <future>
+#include <chrono>
+#include <cmath>
 #include <utility>
 
 #define LOG_TAG "AudioEngine"
@@ -12,7 +13,84 @@
 
 namespace sezo {
 
-AudioEngine::AudioEngine() = default;
+namespace {
+
+// Background extraction jobs allowed to run at once by default. Each mixdown
+// already renders on one thread per core, so more jobs mostly help short
+// exports get past long ones.
+constexpr int32_t kDefaultExtractionConcurrency = 2;
+
+// How long Release() waits for cancelled extraction jobs to finish
+constexpr auto kExtractionStopTimeout = std::chrono::seconds(5);
+
+// Helper threads that seek tracks alongside the caller. Decoder seeks are
+// mostly I/O, so a few threads cover large sessions.
+constexpr size_t kSeekPoolWorkers = 3;
+
+struct SeekBatch {
+  const std::vector<std::shared_ptr<playback::Track>>* tracks;
+  int64_t frame;
+  std::atomic<bool> ok{true};
+};
+
+void SeekTrackTask(void* context, size_t index) {
+  auto* batch = static_cast<SeekBatch*>(context);
+  const auto& track = (*batch->tracks)[index];
+  const int64_t track_frame = batch->frame - track->GetStartTimeSamples();
+  if (!track->Seek(std::max<int64_t>(0, track_frame))) {
+    batch->ok.store(false, std::memory_order_relaxed);
+  }
+}
+
+// Quality level 0 is full quality; each level above is one cheaper tier
+playback::TimeStretch::Quality StretchQualityForLevel(int32_t level) {
+  return static_cast<playback::TimeStretch::Quality>(
+      std::clamp(level, 0, playback::TimeStretch::kQualityCount - 1));
+}
+
+bool ToExtractionConfig(const AudioEngine::ExtractionOptions& options,
+                        int32_t sample_rate,
+                        extraction::ExtractionConfig* config) {
+  config->sample_rate = sample_rate;
+  config->bitrate = options.bitrate;
+  config->bits_per_sample = options.bits_per_sample;
+  config->include_effects = options.include_effects;
+  config->render_threads = options.render_threads;
+  config->memory_budget_bytes = options.memory_budget_bytes;
+  config->range_start_frames =
+      std::llround(options.start_ms * static_cast<double>(sample_rate) / 1000.0);
+  config->range_end_frames =
+      std::llround(options.end_ms * static_cast<double>(sample_rate) / 1000.0);
+
+  // Map format string to enum
+  if (options.format == "wav") {
+    config->format = audio::EncoderFormat::kWAV;
+  } else if (options.format == "aac") {
+    config->format = audio::EncoderFormat::kAAC;
+  } else if (options.format == "m4a") {
+    config->format = audio::EncoderFormat::kM4A;
+  } else if (options.format == "mp3") {
+    config->format = audio::EncoderFormat::kMP3;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void CopyExtractionResult(const extraction::ExtractionResult& source,
+                          AudioEngine::ExtractionResult* result) {
+  result->success = source.success;
+  result->duration_samples = source.duration_samples;
+  result->file_size = source.file_size;
+  result->realtime_factor = source.realtime_factor;
+  result->error_message = source.error_message;
+}
+
+}  // namespace
+
+AudioEngine::AudioEngine()
+    : extraction_scheduler_(
+          std::make_unique<extraction::ExtractionScheduler>(kDefaultExtractionConcurrency)) {}
 
 AudioEngine::~AudioEngine() {
   Release();
@@ -63,7 +141,6 @@ bool AudioEngine::Initialize(int32_t sample_rate, int32_t max_tracks) {
 
   // Create core components
   clock_ = std::make_shared<core::MasterClock>();
-  timing_ = std::make_shared<core::TimingManager>(sample_rate);
   transport_ = std::make_shared<core::TransportController>();
 
   // Create playback components
@@ -78,15 +155,26 @@ bool AudioEngine::Initialize(int32_t sample_rate, int32_t max_tracks) {
     return false;
   }
 
+  // The device may not honor the requested rate; the timeline runs at the
+  // stream rate and tracks are resampled to it.
+  sample_rate_ = player_->GetSampleRate();
+  if (sample_rate_ != sample_rate) {
+    LOGW("Requested sample rate %d, stream opened at %d", sample_rate, sample_rate_);
+  }
+  timing_ = std::make_shared<core::TimingManager>(sample_rate_);
+  mixer_->ConfigureMasterStretch(sample_rate_);
+
   // Set up stream error callback for unrecoverable errors
   player_->SetStreamErrorCallback([this](const std::string& message) {
     ReportError(core::ErrorCode::kStreamDisconnected, message);
   });
 
-  StartExtractionWorker();
-
   initialized_.store(true, std::memory_order_release);
-  LOGD("AudioEngine initialized: sample_rate=%d, max_tracks=%d", sample_rate, max_tracks);
+  if (IsQualityGovernorEnabled()) {
+    std::lock_guard<std::mutex> thread_lock(governor_thread_mutex_);
+    StartQualityGovernor();
+  }
+  LOGD("AudioEngine initialized: sample_rate=%d, max_tracks=%d", sample_rate_, max_tracks);
   return true;
 }
 
@@ -95,8 +183,11 @@ void AudioEngine::Release() {
     return;
   }
 
-  CancelAllExtractions();
-  StopExtractionWorker();
+  StopExtractionJobs();
+  {
+    std::lock_guard<std::mutex> thread_lock(governor_thread_mutex_);
+    StopQualityGovernor();
+  }
 
   Stop();
   UnloadAllTracks();
@@ -178,6 +269,18 @@ bool AudioEngine::LoadTrack(const std::string& track_id,
 
   // Create and load track (file I/O done outside lock)
   auto track = std::make_shared<playback::Track>(track_id, file_path);
+  track->SetOutputSampleRate(sample_rate_);
+  track->SetPlanar(planar_signal_path_.load(std::memory_order_relaxed));
+  {
+    std::lock_guard<std::mutex> lock(tracks_mutex_);
+    track->SetPcmCache(pcm_cache_);
+    track->SetStretchAhead(stretch_ahead_, static_cast<size_t>(std::max<int64_t>(
+        0, timing_->MsToSamples(stretch_ahead_ms_))));
+    track->SetVarispeed(varispeed_);
+    track->SetVarispeedQuality(varispeed_quality_);
+    track->SetStretchQuality(StretchQualityForLevel(quality_level_.load(std::memory_order_relaxed)),
+                             stretch_crossfade_frames_);
+  }
   if (!track->Load()) {
     LOGE("Failed to load track: %s", file_path.c_str());
     ReportError(core::ErrorCode::kDecoderOpenFailed, "Failed to load track: " + file_path);
@@ -197,8 +300,12 @@ bool AudioEngine::LoadTrack(const std::string& track_id,
       LOGD("Track %s already loaded (concurrent)", track_id.c_str());
       return true;
     }
+    // The quality level may have changed while the track was loading
+    track->SetStretchQuality(StretchQualityForLevel(quality_level_.load(std::memory_order_relaxed)),
+                             stretch_crossfade_frames_);
     mixer_->AddTrack(track);
     tracks_[track_id] = track;
+    UpdateStretchRouting();
   }
 
   RecalculateDuration();
@@ -235,6 +342,39 @@ void AudioEngine::UnloadAllTracks() {
   LOGD("All tracks unloaded");
 }
 
+bool AudioEngine::EnablePcmCache(const std::string& directory, int64_t max_bytes, bool use_float) {
+  if (directory.empty() || max_bytes <= 0) {
+    ReportError(core::ErrorCode::kInvalidArgument, "Invalid PCM cache configuration");
+    return false;
+  }
+
+  audio::PcmCache::Config config;
+  config.directory = directory;
+  config.max_bytes = max_bytes;
+  config.sample_format =
+      use_float ? audio::PcmCache::SampleFormat::kFloat32 : audio::PcmCache::SampleFormat::kInt16;
+  auto cache = std::make_shared<audio::PcmCache>(config);
+
+  std::lock_guard<std::mutex> lock(tracks_mutex_);
+  pcm_cache_ = std::move(cache);
+  LOGD("PCM cache enabled: dir=%s, budget=%lld bytes", directory.c_str(),
+       static_cast<long long>(max_bytes));
+  return true;
+}
+
+void AudioEngine::DisablePcmCache() {
+  std::lock_guard<std::mutex> lock(tracks_mutex_);
+  pcm_cache_.reset();
+}
+
+void AudioEngine::SetPlanarSignalPath(bool enabled) {
+  planar_signal_path_.store(enabled, std::memory_order_relaxed);
+}
+
+bool AudioEngine::IsPlanarSignalPath() const {
+  return planar_signal_path_.load(std::memory_order_relaxed);
+}
+
 std::vector<std::string> AudioEngine::GetLoadedTrackIds() const {
   std::lock_guard<std::mutex> lock(tracks_mutex_);
   std::vector<std::string> ids;
@@ -329,19 +469,47 @@ void AudioEngine::Seek(double position_ms) {
   }
 
   const int64_t frame = timing_->MsToSamples(clamped_ms);
+
+  // One seek at a time, so overlapping seeks (scrubbing) cannot leave tracks
+  // on different positions or open the priming gate early.
+  std::lock_guard<std::mutex> seek_lock(seek_mutex_);
+
+  // Hold output while the tracks reposition, then until each has pre-filled
+  // the priming window.
+  const double prime_ms = seek_prime_ms_.load(std::memory_order_relaxed);
+  if (prime_ms > 0.0) {
+    mixer_->ArmPrimingGate(static_cast<size_t>(std::max<int64_t>(0, timing_->MsToSamples(prime_ms))));
+  }
   clock_->SetPosition(frame);
+  mixer_->ResetMasterStretch();
 
-  // Seek all tracks
-  bool seek_ok = true;
+  std::vector<std::shared_ptr<playback::Track>> tracks;
   {
     std::lock_guard<std::mutex> lock(tracks_mutex_);
+    tracks.reserve(tracks_.size());
     for (auto& pair : tracks_) {
-      const int64_t track_start = pair.second->GetStartTimeSamples();
-      const int64_t track_frame = frame - track_start;
-      if (!pair.second->Seek(std::max<int64_t>(0, track_frame))) {
-        seek_ok = false;
-      }
+      tracks.push_back(pair.second);
+    }
+  }
+
+  // Decoder seeks (especially MP3/M4A) are slow; issue them concurrently and
+  // outside the engine lock.
+  SeekBatch batch;
+  batch.tracks = &tracks;
+  batch.frame = frame;
+  if (tracks.size() > 1) {
+    if (!seek_pool_) {
+      seek_pool_ = std::make_unique<playback::RenderPool>(
+          kSeekPoolWorkers, playback::RenderPool::Priority::kBackground);
     }
+    seek_pool_->Run(SeekTrackTask, &batch, tracks.size(), 0);
+  } else if (!tracks.empty()) {
+    SeekTrackTask(&batch, 0);
+  }
+  const bool seek_ok = batch.ok.load(std::memory_order_relaxed);
+
+  if (prime_ms > 0.0) {
+    mixer_->ReleasePrimingHold();
   }
   if (!seek_ok) {
     ReportError(core::ErrorCode::kSeekFailed, "One or more tracks failed to seek");
@@ -350,6 +518,59 @@ void AudioEngine::Seek(double position_ms) {
   LOGD("Seeked to %.2f ms (%lld frames)", clamped_ms, static_cast<long long>(frame));
 }
 
+void AudioEngine::SetSeekPrimeMs(double prime_ms) {
+  seek_prime_ms_.store(std::max(0.0, prime_ms), std::memory_order_relaxed);
+}
+
+double AudioEngine::GetSeekPrimeMs() const {
+  return seek_prime_ms_.load(std::memory_order_relaxed);
+}
+
+bool AudioEngine::IsSeekReady() {
+  if (!initialized_.load(std::memory_order_acquire)) {
+    return false;
+  }
+  return mixer_->PollPrimingGate(clock_->GetPosition());
+}
+
+double AudioEngine::GetSeekReadyLatencyMs() {
+  if (!IsSeekReady()) {
+    return -1.0;
+  }
+  const int64_t latency_ns = mixer_->GetLastPrimingLatencyNs();
+  return latency_ns < 0 ? -1.0 : static_cast<double>(latency_ns) / 1e6;
+}
+
+AudioEngine::RealtimeStats AudioEngine::GetRealtimeStats() const {
+  RealtimeStats stats;
+  if (!initialized_.load(std::memory_order_acquire)) {
+    return stats;
+  }
+  stats.callback = player_->GetCallbackStats();
+  stats.xrun_count = player_->GetXRunCount();
+
+  std::lock_guard<std::mutex> lock(tracks_mutex_);
+  for (const auto& pair : tracks_) {
+    const uint64_t underruns = pair.second->GetStarvationCount();
+    stats.track_underrun_counts[pair.first] = underruns;
+    stats.track_underruns += underruns;
+  }
+  stats.parallel_render = mixer_->GetParallelRenderStats();
+  return stats;
+}
+
+void AudioEngine::ResetRealtimeStats() {
+  if (!initialized_.load(std::memory_order_acquire)) {
+    return;
+  }
+  player_->ResetCallbackStats();
+
+  std::lock_guard<std::mutex> lock(tracks_mutex_);
+  for (auto& pair : tracks_) {
+    pair.second->ResetStarvationCount();
+  }
+}
+
 bool AudioEngine::IsPlaying() const {
   return initialized_.load(std::memory_order_acquire) && transport_->IsPlaying();
 }
@@ -420,6 +641,7 @@ void AudioEngine::SetTrackPitch(const std::string& track_id, float semitones) {
   auto it = tracks_.find(track_id);
   if (it != tracks_.end()) {
     it->second->SetPitchSemitones(semitones);
+    UpdateStretchRouting();
   } else {
     ReportError(core::ErrorCode::kTrackNotFound, "Track not found: " + track_id);
   }
@@ -439,6 +661,7 @@ void AudioEngine::SetTrackSpeed(const std::string& track_id, float rate) {
   auto it = tracks_.find(track_id);
   if (it != tracks_.end()) {
     it->second->SetStretchFactor(rate);
+    UpdateStretchRouting();
   } else {
     ReportError(core::ErrorCode::kTrackNotFound, "Track not found: " + track_id);
   }
@@ -453,31 +676,311 @@ float AudioEngine::GetTrackSpeed(const std::string& track_id) const {
   return 1.0f;
 }
 
+void AudioEngine::SetTrackVarispeed(const std::string& track_id, bool enabled) {
+  std::lock_guard<std::mutex> lock(tracks_mutex_);
+  auto it = tracks_.find(track_id);
+  if (it != tracks_.end()) {
+    it->second->SetVarispeed(enabled);
+    UpdateStretchRouting();
+  } else {
+    ReportError(core::ErrorCode::kTrackNotFound, "Track not found: " + track_id);
+  }
+}
+
+bool AudioEngine::IsTrackVarispeed(const std::string& track_id) const {
+  std::lock_guard<std::mutex> lock(tracks_mutex_);
+  auto it = tracks_.find(track_id);
+  if (it != tracks_.end()) {
+    return it->second->IsVarispeed();
+  }
+  return false;
+}
+
 // Phase 2: Master effects (apply to all tracks)
 void AudioEngine::SetPitch(float semitones) {
-  pitch_ = semitones;
   std::lock_guard<std::mutex> lock(tracks_mutex_);
+  // Same range the stretchers clamp to, so routing can compare values
+  pitch_ = std::clamp(semitones, -12.0f, 12.0f);
   for (auto& pair : tracks_) {
-    pair.second->SetPitchSemitones(semitones);
+    pair.second->SetPitchSemitones(pitch_);
   }
+  UpdateStretchRouting();
 }
 
 float AudioEngine::GetPitch() const {
+  std::lock_guard<std::mutex> lock(tracks_mutex_);
   return pitch_;
 }
 
 void AudioEngine::SetSpeed(float rate) {
-  speed_ = rate;
   std::lock_guard<std::mutex> lock(tracks_mutex_);
+  speed_ = std::clamp(rate, 0.5f, 2.0f);
   for (auto& pair : tracks_) {
-    pair.second->SetStretchFactor(rate);
+    pair.second->SetStretchFactor(speed_);
   }
+  UpdateStretchRouting();
 }
 
 float AudioEngine::GetSpeed() const {
+  std::lock_guard<std::mutex> lock(tracks_mutex_);
   return speed_;
 }
 
+void AudioEngine::SetMasterBusStretch(bool enabled) {
+  std::lock_guard<std::mutex> lock(tracks_mutex_);
+  master_bus_stretch_ = enabled;
+  UpdateStretchRouting();
+}
+
+bool AudioEngine::IsMasterBusStretch() const {
+  std::lock_guard<std::mutex> lock(tracks_mutex_);
+  return master_bus_stretch_;
+}
+
+void AudioEngine::SetVarispeed(bool enabled) {
+  std::lock_guard<std::mutex> lock(tracks_mutex_);
+  varispeed_ = enabled;
+  for (auto& pair : tracks_) {
+    pair.second->SetVarispeed(varispeed_);
+  }
+  UpdateStretchRouting();
+}
+
+bool AudioEngine::IsVarispeed() const {
+  std::lock_guard<std::mutex> lock(tracks_mutex_);
+  return varispeed_;
+}
+
+void AudioEngine::SetVarispeedQuality(dsp::Varispeed::Quality quality) {
+  std::lock_guard<std::mutex> lock(tracks_mutex_);
+  varispeed_quality_ = quality;
+  for (auto& pair : tracks_) {
+    pair.second->SetVarispeedQuality(varispeed_quality_);
+  }
+  UpdateStretchRouting();
+}
+
+dsp::Varispeed::Quality AudioEngine::GetVarispeedQuality() const {
+  std::lock_guard<std::mutex> lock(tracks_mutex_);
+  return varispeed_quality_;
+}
+
+void AudioEngine::SetStretchAhead(bool enabled, double max_latency_ms) {
+  std::lock_guard<std::mutex> lock(tracks_mutex_);
+  stretch_ahead_ = enabled;
+  stretch_ahead_ms_ = std::max(0.0, max_latency_ms);
+  UpdateStretchRouting();
+}
+
+bool AudioEngine::IsStretchAhead() const {
+  std::lock_guard<std::mutex> lock(tracks_mutex_);
+  return stretch_ahead_;
+}
+
+double AudioEngine::GetEffectLatencyMs() const {
+  if (!initialized_.load(std::memory_order_acquire)) {
+    return 0.0;
+  }
+  int64_t latency_frames = 0;
+  std::lock_guard<std::mutex> lock(tracks_mutex_);
+  for (const auto& pair : tracks_) {
+    latency_frames = std::max(latency_frames, pair.second->GetEffectLatencyFrames());
+  }
+  return timing_->SamplesToMs(latency_frames);
+}
+
+double AudioEngine::GetProcessingLatencyMs() const {
+  if (!initialized_.load(std::memory_order_acquire)) {
+    return 0.0;
+  }
+  int64_t latency_frames = mixer_->GetMasterLatencyFrames();
+  std::lock_guard<std::mutex> lock(tracks_mutex_);
+  for (const auto& pair : tracks_) {
+    latency_frames = std::max(latency_frames, pair.second->GetProcessingLatencyFrames());
+  }
+  return timing_->SamplesToMs(latency_frames);
+}
+
+void AudioEngine::SetParallelRender(bool enabled, int32_t worker_count) {
+  if (!initialized_.load(std::memory_order_acquire)) {
+    ReportError(core::ErrorCode::kNotInitialized, "AudioEngine not initialized");
+    return;
+  }
+  mixer_->SetParallelRender(enabled, sample_rate_, static_cast<size_t>(std::max(0, worker_count)));
+}
+
+bool AudioEngine::IsParallelRender() const {
+  return initialized_.load(std::memory_order_acquire) && mixer_->IsParallelRender();
+}
+
+void AudioEngine::SetQualityGovernor(bool enabled, const core::QualityGovernor::Config& config) {
+  core::QualityGovernor::Config clamped = config;
+  clamped.window_ms = std::max(10, clamped.window_ms);
+  clamped.max_level = std::clamp(clamped.max_level, 0, playback::TimeStretch::kQualityCount - 1);
+  clamped.crossfade_ms = std::max(0, clamped.crossfade_ms);
+
+  std::lock_guard<std::mutex> thread_lock(governor_thread_mutex_);
+  StopQualityGovernor();
+  core::QualityGovernor::Step step;
+  step.reason = core::QualityGovernor::Reason::kManual;
+  {
+    std::lock_guard<std::mutex> lock(governor_mutex_);
+    step.previous_level = governor_.GetLevel();
+    governor_.SetConfig(clamped);
+    if (!enabled) {
+      governor_.Reset();
+    }
+    governor_enabled_ = enabled;
+    step.level = governor_.GetLevel();
+    // Re-apply even when unchanged so the crossfade length follows the config
+    ApplyQualityLevel(step.level);
+  }
+  if (step.level != step.previous_level) {
+    NotifyQualityChange(step);
+  }
+  if (enabled && initialized_.load(std::memory_order_acquire)) {
+    StartQualityGovernor();
+  }
+}
+
+bool AudioEngine::IsQualityGovernorEnabled() const {
+  std::lock_guard<std::mutex> lock(governor_mutex_);
+  return governor_enabled_;
+}
+
+void AudioEngine::SetQualityLevel(int32_t level) {
+  core::QualityGovernor::Step step;
+  {
+    std::lock_guard<std::mutex> lock(governor_mutex_);
+    step.previous_level = governor_.GetLevel();
+    governor_.SetLevel(level);
+    step.level = governor_.GetLevel();
+    step.reason = core::QualityGovernor::Reason::kManual;
+    if (step.level == step.previous_level) {
+      return;
+    }
+    ApplyQualityLevel(step.level);
+  }
+  NotifyQualityChange(step);
+}
+
+int32_t AudioEngine::GetQualityLevel() const {
+  return quality_level_.load(std::memory_order_relaxed);
+}
+
+void AudioEngine::SetQualityChangeCallback(QualityChangeCallback callback) {
+  std::lock_guard<std::mutex> lock(quality_callback_mutex_);
+  quality_change_callback_ = std::move(callback);
+}
+
+void AudioEngine::ApplyQualityLevel(int32_t level) {
+  // Called with governor_mutex_ held
+  const playback::TimeStretch::Quality quality = StretchQualityForLevel(level);
+  std::lock_guard<std::mutex> lock(tracks_mutex_);
+  stretch_crossfade_frames_ = timing_ ? static_cast<size_t>(std::max<int64_t>(
+      0, timing_->MsToSamples(governor_.GetConfig().crossfade_ms))) : 0;
+  quality_level_.store(level, std::memory_order_relaxed);
+  if (mixer_) {
+    mixer_->SetMasterStretchQuality(quality, stretch_crossfade_frames_);
+  }
+  for (auto& pair : tracks_) {
+    pair.second->SetStretchQuality(quality, stretch_crossfade_frames_);
+  }
+}
+
+void AudioEngine::NotifyQualityChange(const core::QualityGovernor::Step& step) {
+  LOGD("Quality level %d -> %d (reason %d, p90 load %.1f%%, %llu deadline misses, %lld xruns)",
+       step.previous_level, step.level, static_cast<int>(step.reason),
+       step.window.p90_load_percent,
+       static_cast<unsigned long long>(step.window.deadline_misses),
+       static_cast<long long>(step.window.xruns));
+  QualityChangeCallback callback;
+  {
+    std::lock_guard<std::mutex> lock(quality_callback_mutex_);
+    callback = quality_change_callback_;
+  }
+  if (callback) {
+    callback(step);
+  }
+}
+
+void AudioEngine::StartQualityGovernor() {
+  // Called with governor_thread_mutex_ held
+  if (governor_thread_.joinable() || !player_) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(governor_mutex_);
+    governor_shutdown_ = false;
+  }
+  governor_thread_ = std::thread(&AudioEngine::QualityGovernorLoop, this);
+}
+
+void AudioEngine::StopQualityGovernor() {
+  // Called with governor_thread_mutex_ held; the loop needs governor_mutex_
+  if (!governor_thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(governor_mutex_);
+    governor_shutdown_ = true;
+  }
+  governor_cv_.notify_all();
+  governor_thread_.join();
+}
+
+void AudioEngine::QualityGovernorLoop() {
+  std::unique_lock<std::mutex> lock(governor_mutex_);
+  core::CallbackStats::Snapshot previous = player_->GetCallbackStats();
+  int32_t previous_xruns = player_->GetXRunCount();
+  while (!governor_shutdown_) {
+    const auto window = std::chrono::milliseconds(governor_.GetConfig().window_ms);
+    if (governor_cv_.wait_for(lock, window, [this] { return governor_shutdown_; })) {
+      break;
+    }
+
+    const core::CallbackStats::Snapshot current = player_->GetCallbackStats();
+    const int32_t xruns = player_->GetXRunCount();
+    const core::QualityGovernor::Window measured =
+        core::QualityGovernor::MakeWindow(previous, current, previous_xruns, xruns);
+    previous = current;
+    previous_xruns = xruns;
+
+    core::QualityGovernor::Step step;
+    if (!governor_.Evaluate(measured, &step)) {
+      continue;
+    }
+    ApplyQualityLevel(step.level);
+
+    // The callback may call back into the engine
+    lock.unlock();
+    NotifyQualityChange(step);
+    lock.lock();
+  }
+}
+
+void AudioEngine::UpdateStretchRouting() {
+  // Called with tracks_mutex_ held. Tracks still on the global pitch/speed
+  // share the master-bus stretcher; tracks with an override run their own.
+  // Tracks that stretch ahead always render their own on the decode threads.
+  // The bus follows the global varispeed mode; tracks in the other mode keep
+  // their own processor.
+  if (!mixer_) {
+    return;
+  }
+  const bool use_bus = master_bus_stretch_ && !stretch_ahead_;
+  mixer_->SetMasterStretch(use_bus ? pitch_ : 0.0f, use_bus ? speed_ : 1.0f);
+  mixer_->SetMasterVarispeed(varispeed_);
+  mixer_->SetMasterVarispeedQuality(varispeed_quality_);
+  for (const auto& pair : tracks_) {
+    const auto& track = pair.second;
+    const bool shares_global = std::abs(track->GetPitchSemitones() - pitch_) < 0.001f &&
+                               std::abs(track->GetStretchFactor() - speed_) < 0.001f &&
+                               track->IsVarispeed() == varispeed_;
+    track->SetStretchOnMasterBus(use_bus && shares_global && !track->IsStretchAhead());
+  }
+}
+
 // Phase 3: Recording
 bool AudioEngine::StartRecording(
     const std::string& output_path,
@@ -604,21 +1107,7 @@ AudioEngine::ExtractionResult AudioEngine::ExtractTrack(
 
   // Convert options to extraction config
   extraction::ExtractionConfig config;
-  config.sample_rate = sample_rate_;
-  config.bitrate = options.bitrate;
-  config.bits_per_sample = options.bits_per_sample;
-  config.include_effects = options.include_effects;
-
-  // Map format string to enum
-  if (options.format == "wav") {
-    config.format = audio::EncoderFormat::kWAV;
-  } else if (options.format == "aac") {
-    config.format = audio::EncoderFormat::kAAC;
-  } else if (options.format == "m4a") {
-    config.format = audio::EncoderFormat::kM4A;
-  } else if (options.format == "mp3") {
-    config.format = audio::EncoderFormat::kMP3;
-  } else {
+  if (!ToExtractionConfig(options, sample_rate_, &config)) {
     result.error_message = "Unsupported format: " + options.format;
     ReportError(core::ErrorCode::kInvalidArgument, result.error_message);
     return result;
@@ -629,10 +1118,7 @@ AudioEngine::ExtractionResult AudioEngine::ExtractTrack(
       track, output_path, config, progress_callback, cancel_flag);
 
   // Convert extraction result
-  result.success = extraction_result.success;
-  result.duration_samples = extraction_result.duration_samples;
-  result.file_size = extraction_result.file_size;
-  result.error_message = extraction_result.error_message;
+  CopyExtractionResult(extraction_result, &result);
 
   if (!result.success) {
     ReportError(core::ErrorCode::kExtractionFailed, result.error_message);
@@ -684,21 +1170,7 @@ AudioEngine::ExtractionResult AudioEngine::ExtractAllTracks(
 
   // Convert options to extraction config
   extraction::ExtractionConfig config;
-  config.sample_rate = sample_rate_;
-  config.bitrate = options.bitrate;
-  config.bits_per_sample = options.bits_per_sample;
-  config.include_effects = options.include_effects;
-
-  // Map format string to enum
-  if (options.format == "wav") {
-    config.format = audio::EncoderFormat::kWAV;
-  } else if (options.format == "aac") {
-    config.format = audio::EncoderFormat::kAAC;
-  } else if (options.format == "m4a") {
-    config.format = audio::EncoderFormat::kM4A;
-  } else if (options.format == "mp3") {
-    config.format = audio::EncoderFormat::kMP3;
-  } else {
+  if (!ToExtractionConfig(options, sample_rate_, &config)) {
     result.error_message = "Unsupported format: " + options.format;
     ReportError(core::ErrorCode::kInvalidArgument, result.error_message);
     return result;
@@ -709,10 +1181,90 @@ AudioEngine::ExtractionResult AudioEngine::ExtractAllTracks(
       track_list, output_path, config, progress_callback, cancel_flag);
 
   // Convert extraction result
-  result.success = extraction_result.success;
-  result.duration_samples = extraction_result.duration_samples;
-  result.file_size = extraction_result.file_size;
-  result.error_message = extraction_result.error_message;
+  CopyExtractionResult(extraction_result, &result);
+
+  if (!result.success) {
+    ReportError(core::ErrorCode::kExtractionFailed, result.error_message);
+  }
+
+  return result;
+}
+
+AudioEngine::StemExportResult AudioEngine::ExtractStems(
+    const std::vector<std::string>& track_ids,
+    const std::string& output_dir,
+    const std::string& mix_output_path,
+    const ExtractionOptions& options,
+    ExtractionProgressCallback progress_callback,
+    std::atomic<bool>* cancel_flag) {
+
+  StemExportResult result;
+  result.mix.output_path = mix_output_path;
+
+  if (!initialized_.load(std::memory_order_acquire)) {
+    result.error_message = "AudioEngine not initialized";
+    ReportError(core::ErrorCode::kNotInitialized, result.error_message);
+    return result;
+  }
+
+  // Collect the requested tracks (all loaded ones by default) under lock
+  std::vector<std::shared_ptr<playback::Track>> track_list;
+  {
+    std::lock_guard<std::mutex> lock(tracks_mutex_);
+    if (track_ids.empty()) {
+      for (const auto& pair : tracks_) {
+        if (pair.second->IsLoaded()) {
+          track_list.push_back(pair.second);
+        }
+      }
+    } else {
+      for (const auto& track_id : track_ids) {
+        auto it = tracks_.find(track_id);
+        if (it == tracks_.end() || !it->second->IsLoaded()) {
+          result.error_message = "Track not found: " + track_id;
+          ReportError(core::ErrorCode::kTrackNotFound, result.error_message);
+          return result;
+        }
+        track_list.push_back(it->second);
+      }
+    }
+  }
+
+  if (track_list.empty()) {
+    result.error_message = "No loaded tracks to extract";
+    ReportError(core::ErrorCode::kTrackNotFound, result.error_message);
+    return result;
+  }
+
+  extraction::ExtractionConfig config;
+  if (!ToExtractionConfig(options, sample_rate_, &config)) {
+    result.error_message = "Unsupported format: " + options.format;
+    ReportError(core::ErrorCode::kInvalidArgument, result.error_message);
+    return result;
+  }
+
+  std::vector<std::string> stem_paths;
+  stem_paths.reserve(track_list.size());
+  for (const auto& track : track_list) {
+    stem_paths.push_back(output_dir + "/" + track->GetId() + "." + options.format);
+  }
+
+  extraction::ExtractionPipeline pipeline;
+  auto export_result = pipeline.ExtractStems(
+      track_list, stem_paths, mix_output_path, config, progress_callback, cancel_flag);
+
+  result.success = export_result.success;
+  result.realtime_factor = export_result.realtime_factor;
+  result.error_message = export_result.error_message;
+  result.stems.resize(export_result.stems.size());
+  for (size_t i = 0; i < export_result.stems.size(); ++i) {
+    result.stems[i].track_id = export_result.stems[i].track_id;
+    result.stems[i].output_path = export_result.stems[i].output_path;
+    CopyExtractionResult(export_result.stems[i], &result.stems[i]);
+  }
+  if (!mix_output_path.empty()) {
+    CopyExtractionResult(export_result.mix, &result.mix);
+  }
 
   if (!result.success) {
     ReportError(core::ErrorCode::kExtractionFailed, result.error_message);
@@ -738,25 +1290,14 @@ int64_t AudioEngine::StartExtractTrack(
     return 0;
   }
 
-  StartExtractionWorker();
-
   ExtractionTask task;
-  task.job_id = NextExtractionJobId();
   task.is_mix = false;
   task.track_id = track_id;
   task.output_path = output_path;
   task.options = options;
   task.progress_callback = std::move(progress_callback);
   task.completion_callback = std::move(completion_callback);
-  task.cancel_flag = std::make_shared<std::atomic<bool>>(false);
-
-  {
-    std::lock_guard<std::mutex> lock(extraction_mutex_);
-    extraction_queue_.push_back(task);
-    extraction_cancel_flags_[task.job_id] = task.cancel_flag;
-  }
-  extraction_cv_.notify_one();
-  return task.job_id;
+  return EnqueueExtraction(std::move(task));
 }
 
 int64_t AudioEngine::StartExtractAllTracks(
@@ -775,156 +1316,182 @@ int64_t AudioEngine::StartExtractAllTracks(
     return 0;
   }
 
-  StartExtractionWorker();
-
   ExtractionTask task;
-  task.job_id = NextExtractionJobId();
   task.is_mix = true;
   task.output_path = output_path;
   task.options = options;
   task.progress_callback = std::move(progress_callback);
   task.completion_callback = std::move(completion_callback);
-  task.cancel_flag = std::make_shared<std::atomic<bool>>(false);
+  return EnqueueExtraction(std::move(task));
+}
 
-  {
-    std::lock_guard<std::mutex> lock(extraction_mutex_);
-    extraction_queue_.push_back(task);
-    extraction_cancel_flags_[task.job_id] = task.cancel_flag;
+int64_t AudioEngine::StartExtractStems(
+    const std::vector<std::string>& track_ids,
+    const std::string& output_dir,
+    const std::string& mix_output_path,
+    const ExtractionOptions& options,
+    ExtractionProgressCallback progress_callback,
+    StemExportCompletionCallback completion_callback) {
+
+  if (!initialized_.load(std::memory_order_acquire)) {
+    ReportError(core::ErrorCode::kNotInitialized, "AudioEngine not initialized");
+    return 0;
   }
-  extraction_cv_.notify_one();
-  return task.job_id;
+
+  if (output_dir.empty()) {
+    ReportError(core::ErrorCode::kInvalidArgument, "Output directory is empty");
+    return 0;
+  }
+
+  ExtractionTask task;
+  task.is_stems = true;
+  task.track_ids = track_ids;
+  task.output_path = output_dir;
+  task.mix_output_path = mix_output_path;
+  task.options = options;
+  task.progress_callback = std::move(progress_callback);
+  task.stems_completion_callback = std::move(completion_callback);
+  return EnqueueExtraction(std::move(task));
 }
 
 bool AudioEngine::CancelExtraction(int64_t job_id) {
-  std::lock_guard<std::mutex> lock(extraction_mutex_);
-  auto it = extraction_cancel_flags_.find(job_id);
-  if (it == extraction_cancel_flags_.end()) {
-    return false;
+  {
+    std::lock_guard<std::mutex> lock(extraction_mutex_);
+    auto it = extraction_cancel_flags_.find(job_id);
+    if (it == extraction_cancel_flags_.end()) {
+      return false;
+    }
+    it->second->store(true, std::memory_order_release);
   }
-  it->second->store(true, std::memory_order_release);
-  extraction_cv_.notify_one();
+  // A queued job starts right away (even while paused) to report the cancel
+  extraction_scheduler_->Reschedule();
   return true;
 }
 
 void AudioEngine::CancelAllExtractions() {
-  std::lock_guard<std::mutex> lock(extraction_mutex_);
-  for (auto& entry : extraction_cancel_flags_) {
-    entry.second->store(true, std::memory_order_release);
+  {
+    std::lock_guard<std::mutex> lock(extraction_mutex_);
+    for (auto& entry : extraction_cancel_flags_) {
+      entry.second->store(true, std::memory_order_release);
+    }
   }
-  extraction_cv_.notify_one();
+  extraction_scheduler_->Reschedule();
 }
 
 bool AudioEngine::IsExtractionRunning() const {
-  std::lock_guard<std::mutex> lock(extraction_mutex_);
-  return current_extraction_job_id_ != 0;
+  return extraction_scheduler_->GetMetrics().running > 0;
 }
 
-void AudioEngine::StartExtractionWorker() {
-  if (extraction_worker_running_.load(std::memory_order_acquire)) {
-    return;
-  }
+void AudioEngine::SetExtractionConcurrency(int32_t jobs) {
+  extraction_scheduler_->SetConcurrency(jobs);
+}
 
-  extraction_shutdown_.store(false, std::memory_order_release);
-  extraction_worker_running_.store(true, std::memory_order_release);
-  extraction_thread_ = std::thread(&AudioEngine::ExtractionWorkerLoop, this);
+int32_t AudioEngine::GetExtractionConcurrency() const {
+  return extraction_scheduler_->GetConcurrency();
 }
 
-void AudioEngine::StopExtractionWorker() {
-  if (!extraction_worker_running_.load(std::memory_order_acquire)) {
-    return;
-  }
+void AudioEngine::PauseExtractions() {
+  extraction_scheduler_->Pause();
+}
 
-  extraction_shutdown_.store(true, std::memory_order_release);
-  CancelAllExtractions();
-  extraction_cv_.notify_one();
+void AudioEngine::ResumeExtractions() {
+  extraction_scheduler_->Resume();
+}
 
-  if (extraction_thread_.joinable()) {
-    // Use a timed approach: try to join within 5 seconds, then detach if stuck
-    auto future = std::async(std::launch::async, [this] {
-      extraction_thread_.join();
-    });
+bool AudioEngine::AreExtractionsPaused() const {
+  return extraction_scheduler_->IsPaused();
+}
 
-    if (future.wait_for(std::chrono::seconds(5)) == std::future_status::timeout) {
-      LOGW("Extraction worker did not stop within timeout, detaching thread");
-      extraction_thread_.detach();
-    }
+AudioEngine::ExtractionMetrics AudioEngine::GetExtractionMetrics() const {
+  return extraction_scheduler_->GetMetrics();
+}
+
+void AudioEngine::StopExtractionJobs() {
+  CancelAllExtractions();
+  if (!extraction_scheduler_->WaitUntilIdle(
+          std::chrono::duration_cast<std::chrono::milliseconds>(kExtractionStopTimeout))) {
+    LOGW("Extraction jobs did not stop within timeout");
   }
-  extraction_worker_running_.store(false, std::memory_order_release);
 }
 
-void AudioEngine::ExtractionWorkerLoop() {
-  while (true) {
-    ExtractionTask task;
-    {
-      std::unique_lock<std::mutex> lock(extraction_mutex_);
-      extraction_cv_.wait(lock, [this] {
-        return extraction_shutdown_.load(std::memory_order_acquire) ||
-               !extraction_queue_.empty();
-      });
+int64_t AudioEngine::EnqueueExtraction(ExtractionTask task) {
+  task.cancel_flag = std::make_shared<std::atomic<bool>>(false);
 
-      if (extraction_queue_.empty()) {
-        if (extraction_shutdown_.load(std::memory_order_acquire)) {
-          break;
-        }
-        continue;
-      }
+  extraction::ExtractionScheduler::JobOptions job_options;
+  job_options.priority = static_cast<extraction::ExtractionScheduler::Priority>(
+      std::clamp(task.options.priority, 0, 2));
+  job_options.deadline_ms = task.options.deadline_ms;
 
-      task = std::move(extraction_queue_.front());
-      extraction_queue_.pop_front();
-      current_extraction_job_id_ = task.job_id;
-    }
+  // Registered under the lock so the job cannot finish (and unregister)
+  // before it is registered
+  std::lock_guard<std::mutex> lock(extraction_mutex_);
+  task.job_id = next_extraction_job_id_++;
+  extraction_cancel_flags_[task.job_id] = task.cancel_flag;
+  const int64_t job_id = task.job_id;
+  auto cancel_flag = task.cancel_flag;
+  extraction_scheduler_->Submit(
+      [this, task = std::move(task)] {
+        RunExtractionTask(task);
+        std::lock_guard<std::mutex> lock(extraction_mutex_);
+        extraction_cancel_flags_.erase(task.job_id);
+      },
+      job_options, std::move(cancel_flag));
+  return job_id;
+}
+
+void AudioEngine::RunExtractionTask(const ExtractionTask& task) {
+  ExtractionResult result;
+  result.track_id = task.track_id;
+  result.output_path = task.output_path;
 
-    ExtractionResult result;
-    result.track_id = task.track_id;
-    result.output_path = task.output_path;
+  const auto cancel_flag = task.cancel_flag;
+  // Progress steps double as pause checkpoints
+  auto progress_wrapper = [this, cancel_flag, &task](float progress) {
+    if (!extraction_scheduler_->WaitWhilePaused(cancel_flag.get())) {
+      return;
+    }
+    if (task.progress_callback) {
+      task.progress_callback(progress);
+    }
+  };
 
-    const auto cancel_flag = task.cancel_flag;
+  if (task.is_stems) {
+    StemExportResult stems_result;
     if (cancel_flag && cancel_flag->load(std::memory_order_acquire)) {
-      result.success = false;
-      result.error_message = "Extraction cancelled";
+      stems_result.error_message = "Extraction cancelled";
     } else {
-      auto progress_wrapper = [cancel_flag, &task](float progress) {
-        if (cancel_flag && cancel_flag->load(std::memory_order_acquire)) {
-          return;
-        }
-        if (task.progress_callback) {
-          task.progress_callback(progress);
-        }
-      };
-
-      if (task.is_mix) {
-        result = ExtractAllTracks(
-            task.output_path, task.options, progress_wrapper,
-            cancel_flag ? cancel_flag.get() : nullptr);
-      } else {
-        result = ExtractTrack(
-            task.track_id, task.output_path, task.options, progress_wrapper,
-            cancel_flag ? cancel_flag.get() : nullptr);
-      }
-
-      if (cancel_flag && cancel_flag->load(std::memory_order_acquire)) {
-        result.success = false;
-        if (result.error_message.empty()) {
-          result.error_message = "Extraction cancelled";
-        }
-      }
+      stems_result = ExtractStems(
+          task.track_ids, task.output_path, task.mix_output_path, task.options,
+          progress_wrapper, cancel_flag ? cancel_flag.get() : nullptr);
     }
-
-    if (task.completion_callback) {
-      task.completion_callback(task.job_id, result);
+    if (task.stems_completion_callback) {
+      task.stems_completion_callback(task.job_id, stems_result);
+    }
+  } else if (cancel_flag && cancel_flag->load(std::memory_order_acquire)) {
+    result.success = false;
+    result.error_message = "Extraction cancelled";
+  } else {
+    if (task.is_mix) {
+      result = ExtractAllTracks(
+          task.output_path, task.options, progress_wrapper,
+          cancel_flag ? cancel_flag.get() : nullptr);
+    } else {
+      result = ExtractTrack(
+          task.track_id, task.output_path, task.options, progress_wrapper,
+          cancel_flag ? cancel_flag.get() : nullptr);
     }
 
-    {
-      std::lock_guard<std::mutex> lock(extraction_mutex_);
-      extraction_cancel_flags_.erase(task.job_id);
-      current_extraction_job_id_ = 0;
+    if (cancel_flag && cancel_flag->load(std::memory_order_acquire)) {
+      result.success = false;
+      if (result.error_message.empty()) {
+        result.error_message = "Extraction cancelled";
+      }
     }
   }
-}
 
-int64_t AudioEngine::NextExtractionJobId() {
-  std::lock_guard<std::mutex> lock(extraction_mutex_);
-  return next_extraction_job_id_++;
+  if (!task.is_stems && task.completion_callback) {
+    task.completion_callback(task.job_id, result);
+  }
 }
 
 void AudioEngine::ReportError(core::ErrorCode code, const std::string& message) {
@@ -1,17 +1,20 @@
 #pragma once
 
+#include "audio/PcmCache.h"
 #include "core/ErrorCodes.h"
 #include "core/MasterClock.h"
+#include "core/QualityGovernor.h"
 #include "core/TimingManager.h"
 #include "core/TransportController.h"
+#include "extraction/ExtractionScheduler.h"
 #include "playback/MultiTrackMixer.h"
 #include "playback/OboePlayer.h"
+#include "playback/RenderPool.h"
 #include "playback/Track.h"
 #include "recording/RecordingPipeline.h"
 
 #include <atomic>
 #include <condition_variable>
-#include <deque>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -76,6 +79,31 @@ class AudioEngine {
   void UnloadAllTracks();
   std::vector<std::string> GetLoadedTrackIds() const;
 
+  /**
+   * Enable the pre-decoded PCM cache for MP3/M4A tracks loaded afterwards.
+   * Sources are decoded once in the background into the cache directory and
+   * later loads and seeks read the memory-mapped PCM.
+   * @param directory Cache directory (created if missing)
+   * @param max_bytes LRU size budget for the directory
+   * @param use_float Store float32 instead of int16 samples
+   * @return true if successful
+   */
+  bool EnablePcmCache(const std::string& directory, int64_t max_bytes, bool use_float = false);
+
+  /**
+   * Stop using the PCM cache for new loads. Existing cache files are kept.
+   */
+  void DisablePcmCache();
+
+  /**
+   * Carry stereo tracks loaded afterwards as separate left/right planes from
+   * the ring buffer through time-stretch to the mix, interleaving only once
+   * for the output stream. Off by default.
+   * @param enabled true for the planar signal path
+   */
+  void SetPlanarSignalPath(bool enabled);
+  bool IsPlanarSignalPath() const;
+
   // Playback control
   void Play();
   void Pause();
@@ -85,6 +113,50 @@ class AudioEngine {
   double GetCurrentPosition() const;  // in milliseconds
   double GetDuration() const;         // in milliseconds
 
+  /**
+   * Amount of audio every track must buffer after a seek before output
+   * resumes (default: 100 ms). 0 disables the priming gate.
+   * @param prime_ms Milliseconds to pre-fill
+   */
+  void SetSeekPrimeMs(double prime_ms);
+  double GetSeekPrimeMs() const;
+
+  /**
+   * Check whether all tracks are primed after the last seek.
+   * @return true once output can resume
+   */
+  bool IsSeekReady();
+
+  /**
+   * Time from the last Seek() call until all tracks were primed.
+   * @return Latency in milliseconds, or -1 while still priming
+   */
+  double GetSeekReadyLatencyMs();
+
+  /**
+   * Audio callback health since the last reset.
+   */
+  struct RealtimeStats {
+    core::CallbackStats::Snapshot callback;
+    int32_t xrun_count = -1;  // device-reported, -1 if unsupported
+    uint64_t track_underruns = 0;
+    std::map<std::string, uint64_t> track_underrun_counts;
+    // Parallel track rendering, since the render pool started
+    playback::MultiTrackMixer::ParallelRenderStats parallel_render;
+  };
+
+  /**
+   * Snapshot the callback timing histogram, xruns and per-track underruns.
+   * Safe to poll from the UI thread while playing.
+   * @return Realtime statistics
+   */
+  RealtimeStats GetRealtimeStats() const;
+
+  /**
+   * Clear callback timing and track underrun counters.
+   */
+  void ResetRealtimeStats();
+
   // Track controls
   void SetTrackVolume(const std::string& track_id, float volume);
   void SetTrackMuted(const std::string& track_id, bool muted);
@@ -101,12 +173,116 @@ class AudioEngine {
   void SetTrackSpeed(const std::string& track_id, float rate);
   float GetTrackSpeed(const std::string& track_id) const;
 
+  /**
+   * Change one track's speed by resampling instead of time-stretching, so
+   * pitch follows speed and its pitch setting is ignored. Overrides the
+   * global mode (see SetVarispeed()) for that track.
+   * @param track_id Track ID
+   * @param enabled true for varispeed
+   */
+  void SetTrackVarispeed(const std::string& track_id, bool enabled);
+  bool IsTrackVarispeed(const std::string& track_id) const;
+
   // Master effects (apply to all tracks)
   void SetPitch(float semitones);
   float GetPitch() const;
   void SetSpeed(float rate);
   float GetSpeed() const;
 
+  /**
+   * Render the global pitch/speed with one stretcher on the summed master
+   * bus instead of one per track (default: on). Tracks with their own
+   * pitch/speed override keep a per-track stretcher.
+   * @param enabled true to use the master-bus stretcher
+   */
+  void SetMasterBusStretch(bool enabled);
+  bool IsMasterBusStretch() const;
+
+  /**
+   * Apply the global speed by resampling (pitch follows speed, like a tape
+   * machine) instead of time-stretching, on every track and the master bus.
+   * Much cheaper than the stretcher; the global pitch is ignored while
+   * enabled. Off by default.
+   * @param enabled true for varispeed
+   */
+  void SetVarispeed(bool enabled);
+  bool IsVarispeed() const;
+
+  /**
+   * Interpolation used in varispeed mode, for playback and extraction.
+   * @param quality kCubic (cheapest) or kSinc (band-limited, default)
+   */
+  void SetVarispeedQuality(dsp::Varispeed::Quality quality);
+  dsp::Varispeed::Quality GetVarispeedQuality() const;
+
+  /**
+   * Time-stretch tracks loaded afterwards on the decode threads, ahead of
+   * playback, so the audio callback only copies and mixes. Pitch/speed
+   * changes then take effect after up to max_latency_ms (see
+   * GetEffectLatencyMs()); large changes re-render immediately. Replaces the
+   * master-bus stretcher while enabled. Off by default.
+   * @param enabled true to stretch ahead
+   * @param max_latency_ms Audio rendered ahead at most, in milliseconds
+   */
+  void SetStretchAhead(bool enabled, double max_latency_ms = 150.0);
+  bool IsStretchAhead() const;
+
+  /**
+   * Current delay before a pitch/speed change is heard: the most audio any
+   * track has already rendered ahead. 0 unless stretching ahead.
+   * @return Latency in milliseconds
+   */
+  double GetEffectLatencyMs() const;
+
+  /**
+   * Pitch/speed processing latency the mix currently compensates for: the
+   * largest stretcher latency among stretched tracks and the master bus.
+   * Stretched audio is pre-rolled by this much so every track stays
+   * sample-aligned with the timeline.
+   * @return Latency in milliseconds (0 when no effect is active)
+   */
+  double GetProcessingLatencyMs() const;
+
+  /**
+   * Render tracks on a pool of helper threads alongside the audio callback
+   * (see MultiTrackMixer::SetParallelRender()). Pays off with many
+   * time-stretched tracks on multi-core devices. Off by default.
+   * @param enabled true to render in parallel
+   * @param worker_count Helper threads (0 = one less than the cores); only
+   *                     used the first time it is enabled
+   */
+  void SetParallelRender(bool enabled, int32_t worker_count = 0);
+  bool IsParallelRender() const;
+
+  /**
+   * Let a governor trade time-stretch quality for CPU: every
+   * config.window_ms it compares callback load, deadline misses and xruns
+   * against the thresholds and steps every stretcher (per-track and master
+   * bus) to a cheaper or better tier, crossfading between the two. Off by
+   * default; disabling returns to full quality.
+   * @param enabled true to run the governor
+   * @param config Thresholds and timing
+   */
+  void SetQualityGovernor(bool enabled,
+                          const core::QualityGovernor::Config& config = core::QualityGovernor::Config());
+  bool IsQualityGovernorEnabled() const;
+
+  /**
+   * Force a quality level (0 = full quality, up to config.max_level). With
+   * the governor running it holds there for config.hold_windows windows
+   * before judging again.
+   * @param level Quality level
+   */
+  void SetQualityLevel(int32_t level);
+  int32_t GetQualityLevel() const;
+
+  using QualityChangeCallback = std::function<void(const core::QualityGovernor::Step&)>;
+
+  /**
+   * Called on the governor thread for every quality level change.
+   */
+  void SetQualityChangeCallback(QualityChangeCallback callback);
+
   // Phase 3: Recording
   using RecordingCompletionCallback = std::function<void(const recording::RecordingResult&)>;
 
@@ -152,6 +328,16 @@ class AudioEngine {
     int32_t bitrate = 128000;
     int32_t bits_per_sample = 16;
     bool include_effects = true;
+    int32_t render_threads = 0;  // Mixdown render threads (0 = one per core)
+    // Stem export: estimated memory of the stems open at once (0 = unlimited)
+    int64_t memory_budget_bytes = 0;
+    int32_t priority = 1;  // Background jobs: 0 = low, 1 = normal, 2 = high
+    int64_t deadline_ms = 0;  // Background jobs: finish-by hint after submission (0 = none)
+    // Export only [start_ms, end_ms) (end_ms 0 = to the end). Track exports
+    // count from the track's start, mixdowns from the timeline start; stem
+    // exports do not take a range. With a high priority this suits previews.
+    double start_ms = 0.0;
+    double end_ms = 0.0;
   };
 
   struct ExtractionResult {
@@ -160,12 +346,24 @@ class AudioEngine {
     std::string output_path;
     int64_t duration_samples = 0;
     int64_t file_size = 0;
+    double realtime_factor = 0.0;
+    std::string error_message;
+  };
+
+  struct StemExportResult {
+    bool success = false;
+    std::vector<ExtractionResult> stems;
+    ExtractionResult mix;  // output_path is empty when no mixdown was requested
+    double realtime_factor = 0.0;
     std::string error_message;
   };
 
   using ExtractionProgressCallback = std::function<void(float progress)>;
   using ExtractionCompletionCallback =
       std::function<void(int64_t job_id, const ExtractionResult& result)>;
+  using StemExportCompletionCallback =
+      std::function<void(int64_t job_id, const StemExportResult& result)>;
+  using ExtractionMetrics = extraction::ExtractionScheduler::Metrics;
 
   /**
    * Extract a single track to an audio file with effects applied.
@@ -195,6 +393,26 @@ class AudioEngine {
       ExtractionProgressCallback progress_callback = nullptr,
       std::atomic<bool>* cancel_flag = nullptr);
 
+  /**
+   * Export tracks as stems, one file per track, in a single render pass.
+   * Tracks render in parallel (options.render_threads) within
+   * options.memory_budget_bytes; the mixdown, if requested, is summed from
+   * the same rendered blocks.
+   * @param track_ids Tracks to export (empty = every loaded track)
+   * @param output_dir Directory for the stems, named <track_id>.<format>
+   * @param mix_output_path Mixdown output path (empty = no mixdown)
+   * @param options Extraction options
+   * @param progress_callback Optional progress over the whole export
+   * @return Result per file
+   */
+  StemExportResult ExtractStems(
+      const std::vector<std::string>& track_ids,
+      const std::string& output_dir,
+      const std::string& mix_output_path,
+      const ExtractionOptions& options,
+      ExtractionProgressCallback progress_callback = nullptr,
+      std::atomic<bool>* cancel_flag = nullptr);
+
   int64_t StartExtractTrack(
       const std::string& track_id,
       const std::string& output_path,
@@ -208,30 +426,70 @@ class AudioEngine {
       ExtractionProgressCallback progress_callback,
       ExtractionCompletionCallback completion_callback);
 
+  int64_t StartExtractStems(
+      const std::vector<std::string>& track_ids,
+      const std::string& output_dir,
+      const std::string& mix_output_path,
+      const ExtractionOptions& options,
+      ExtractionProgressCallback progress_callback,
+      StemExportCompletionCallback completion_callback);
+
  bool CancelExtraction(int64_t job_id);
   void CancelAllExtractions();
   bool IsExtractionRunning() const;
 
+  /**
+   * Set how many background extraction jobs run at once (default: 2).
+   * Queued jobs start by options.priority, then options.deadline_ms.
+   * @param jobs Concurrent jobs (at least 1)
+   */
+  void SetExtractionConcurrency(int32_t jobs);
+  int32_t GetExtractionConcurrency() const;
+
+  /**
+   * Hold background extraction: queued jobs do not start and running jobs
+   * stop at their next progress step until ResumeExtractions(). Cancelling
+   * a held job still completes it.
+   */
+  void PauseExtractions();
+  void ResumeExtractions();
+  bool AreExtractionsPaused() const;
+
+  /**
+   * Queue depth and wait times of background extraction jobs.
+   */
+  ExtractionMetrics GetExtractionMetrics() const;
+
  private:
   void RecalculateDuration();
+  void UpdateStretchRouting();
   void ReportError(core::ErrorCode code, const std::string& message);
   void NotifyPlaybackState(core::PlaybackState state);
-  void StartExtractionWorker();
-  void StopExtractionWorker();
-  void ExtractionWorkerLoop();
-  int64_t NextExtractionJobId();
+  void ApplyQualityLevel(int32_t level);
+  void NotifyQualityChange(const core::QualityGovernor::Step& step);
+  void StartQualityGovernor();
+  void StopQualityGovernor();
+  void QualityGovernorLoop();
+  void StopExtractionJobs();
 
   struct ExtractionTask {
     int64_t job_id = 0;
     bool is_mix = false;
+    bool is_stems = false;
     std::string track_id;
-    std::string output_path;
+    std::vector<std::string> track_ids;  // Stem export
+    std::string output_path;  // Output directory for stem exports
+    std::string mix_output_path;  // Stem export mixdown
     ExtractionOptions options;
     ExtractionProgressCallback progress_callback;
     ExtractionCompletionCallback completion_callback;
+    StemExportCompletionCallback stems_completion_callback;
     std::shared_ptr<std::atomic<bool>> cancel_flag;
   };
 
+  int64_t EnqueueExtraction(ExtractionTask task);
+  void RunExtractionTask(const ExtractionTask& task);
+
   std::atomic<bool> initialized_{false};
   int32_t sample_rate_ = 44100;
   int32_t max_tracks_ = 8;
@@ -252,10 +510,37 @@ class AudioEngine {
   // Track management
   mutable std::mutex tracks_mutex_;
   std::map<std::string, std::shared_ptr<playback::Track>> tracks_;
+  std::shared_ptr<audio::PcmCache> pcm_cache_;
+  std::atomic<bool> planar_signal_path_{false};
+
+  std::atomic<double> seek_prime_ms_{100.0};
+  // Serializes Seek(); seek_pool_ (created on first use) is guarded by it
+  std::mutex seek_mutex_;
+  std::unique_ptr<playback::RenderPool> seek_pool_;
 
-  // Effects state (for Phase 2)
+  // Effects state (for Phase 2), guarded by tracks_mutex_
   float pitch_ = 0.0f;
   float speed_ = 1.0f;
+  bool master_bus_stretch_ = true;
+  bool varispeed_ = false;
+  dsp::Varispeed::Quality varispeed_quality_ = dsp::Varispeed::Quality::kSinc;
+  bool stretch_ahead_ = false;
+  double stretch_ahead_ms_ = 150.0;
+
+  // Quality governor. governor_thread_mutex_ serializes starting and stopping
+  // the thread; governor_ and the level are guarded by governor_mutex_, and
+  // the level is applied to tracks under tracks_mutex_ (taken in that order).
+  std::mutex governor_thread_mutex_;
+  mutable std::mutex governor_mutex_;
+  std::condition_variable governor_cv_;
+  std::thread governor_thread_;
+  bool governor_enabled_ = false;
+  bool governor_shutdown_ = false;
+  core::QualityGovernor governor_;
+  std::atomic<int32_t> quality_level_{0};
+  size_t stretch_crossfade_frames_ = 0;  // guarded by tracks_mutex_
+  std::mutex quality_callback_mutex_;
+  QualityChangeCallback quality_change_callback_;
 
   mutable std::mutex error_mutex_;
   ErrorCallback error_callback_;
@@ -266,15 +551,12 @@ class AudioEngine {
   core::ErrorCode last_error_ = core::ErrorCode::kOk;
   std::string last_error_message_;
 
-  std::thread extraction_thread_;
-  std::atomic<bool> extraction_worker_running_{false};
-  std::atomic<bool> extraction_shutdown_{false};
+  // Background extraction. extraction_cancel_flags_ holds every queued or
+  // running job. The scheduler is declared last so its threads stop first.
   mutable std::mutex extraction_mutex_;
-  std::condition_variable extraction_cv_;
-  std::deque<ExtractionTask> extraction_queue_;
   std::unordered_map<int64_t, std::shared_ptr<std::atomic<bool>>> extraction_cancel_flags_;
   int64_t next_extraction_job_id_ = 1;
-  int64_t current_extraction_job_id_ = 0;
+  std::unique_ptr<extraction::ExtractionScheduler> extraction_scheduler_;
 };
 
 }  // namespace sezo
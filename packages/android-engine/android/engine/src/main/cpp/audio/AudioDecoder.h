@@ -44,6 +44,27 @@ class AudioDecoder {
    */
   virtual size_t Read(float* buffer, size_t frames) = 0;
 
+  /**
+   * Borrow the next decoded frames without copying them.
+   * Only decoders that hold float PCM in memory (e.g. a memory-mapped WAV)
+   * support this; check SupportsMappedReads() first. The pointer stays
+   * valid until the decoder is closed.
+   * @param data Receives a pointer to interleaved float samples
+   * @param frames Maximum number of frames to borrow
+   * @return Number of frames borrowed (0 at end of stream)
+   */
+  virtual size_t ReadMapped(const float** data, size_t frames) {
+    (void)data;
+    (void)frames;
+    return 0;
+  }
+
+  /**
+   * Check whether ReadMapped() can be used.
+   * @return true if zero-copy reads are supported
+   */
+  virtual bool SupportsMappedReads() const { return false; }
+
   /**
    * Seek to a specific frame position.
    * @param frame Frame position to seek to
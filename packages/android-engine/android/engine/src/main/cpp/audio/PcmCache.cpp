@@ -0,0 +1,381 @@
+#include "audio/PcmCache.h"
+#include "audio/M4ADecoder.h"
+#include "audio/MP3Decoder.h"
+#include "audio/WAVDecoder.h"
+
+#include "dr_wav.h"
+
+#include <android/log.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#define LOG_TAG "PcmCache"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace sezo {
+namespace audio {
+
+namespace {
+
+constexpr const char* kEntrySuffix = ".pcm.wav";
+constexpr const char* kTempSuffix = ".tmp";
+constexpr size_t kDecodeChunkFrames = 4096;
+
+bool EndsWith(const std::string& value, const char* suffix) {
+  const size_t suffix_len = std::strlen(suffix);
+  if (value.size() < suffix_len) {
+    return false;
+  }
+  for (size_t i = 0; i < suffix_len; ++i) {
+    const char c = static_cast<char>(
+        std::tolower(static_cast<unsigned char>(value[value.size() - suffix_len + i])));
+    if (c != suffix[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// FNV-1a; stable across runs, unlike std::hash.
+uint64_t Fnv1a(const void* data, size_t size, uint64_t hash) {
+  const auto* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+std::unique_ptr<AudioDecoder> CreateSourceDecoder(const std::string& path) {
+  if (EndsWith(path, ".mp3")) {
+    return std::make_unique<MP3Decoder>();
+  }
+  if (EndsWith(path, ".m4a") || EndsWith(path, ".mp4")) {
+    return std::make_unique<M4ADecoder>();
+  }
+  return nullptr;
+}
+
+int16_t FloatToPcm16(float sample) {
+  const float clamped = std::max(-1.0f, std::min(1.0f, sample));
+  return static_cast<int16_t>(std::lrint(clamped * 32767.0f));
+}
+
+}  // namespace
+
+PcmCache::PcmCache(const Config& config) : config_(config) {
+  if (!config_.directory.empty() && config_.directory.back() == '/') {
+    config_.directory.pop_back();
+  }
+  if (mkdir(config_.directory.c_str(), 0755) != 0 && errno != EEXIST) {
+    LOGE("Failed to create cache directory: %s", config_.directory.c_str());
+  }
+  ScanDirectory();
+  worker_ = std::thread(&PcmCache::WorkerLoop, this);
+}
+
+PcmCache::~PcmCache() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_.store(true, std::memory_order_release);
+  }
+  queue_cv_.notify_all();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+}
+
+bool PcmCache::IsCacheable(const std::string& source_path) {
+  return EndsWith(source_path, ".mp3") || EndsWith(source_path, ".m4a") ||
+         EndsWith(source_path, ".mp4");
+}
+
+std::string PcmCache::MakeKey(const std::string& source_path) const {
+  struct stat info;
+  if (stat(source_path.c_str(), &info) != 0) {
+    return {};
+  }
+
+  const int64_t size = static_cast<int64_t>(info.st_size);
+  const int64_t mtime_ns = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000LL +
+                           static_cast<int64_t>(info.st_mtim.tv_nsec);
+  uint64_t hash = 14695981039346656037ULL;
+  hash = Fnv1a(source_path.data(), source_path.size(), hash);
+  hash = Fnv1a(&size, sizeof(size), hash);
+  hash = Fnv1a(&mtime_ns, sizeof(mtime_ns), hash);
+
+  char key[32];
+  std::snprintf(key, sizeof(key), "%016llx-%s", static_cast<unsigned long long>(hash),
+                config_.sample_format == SampleFormat::kFloat32 ? "f32" : "s16");
+  return key;
+}
+
+std::string PcmCache::EntryPath(const std::string& key) const {
+  return config_.directory + "/" + key + kEntrySuffix;
+}
+
+void PcmCache::ScanDirectory() {
+  DIR* dir = opendir(config_.directory.c_str());
+  if (!dir) {
+    return;
+  }
+
+  struct Found {
+    Entry entry;
+    int64_t mtime = 0;
+  };
+  std::vector<Found> found;
+  while (dirent* item = readdir(dir)) {
+    const std::string name = item->d_name;
+    const std::string path = config_.directory + "/" + name;
+    if (EndsWith(name, kTempSuffix)) {
+      // Left behind by an interrupted decode
+      unlink(path.c_str());
+      continue;
+    }
+    if (!EndsWith(name, kEntrySuffix)) {
+      continue;
+    }
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+      continue;
+    }
+    Found f;
+    f.entry.key = name.substr(0, name.size() - std::strlen(kEntrySuffix));
+    f.entry.path = path;
+    f.entry.bytes = static_cast<int64_t>(info.st_size);
+    f.mtime = static_cast<int64_t>(info.st_mtime);
+    found.push_back(std::move(f));
+  }
+  closedir(dir);
+
+  // Entry mtimes are bumped on use, so they carry the LRU order across runs.
+  std::sort(found.begin(), found.end(),
+            [](const Found& a, const Found& b) { return a.mtime > b.mtime; });
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& f : found) {
+    total_bytes_ += f.entry.bytes;
+    lru_.push_back(std::move(f.entry));
+    index_[lru_.back().key] = std::prev(lru_.end());
+  }
+  EvictLocked();
+  LOGD("Cache opened: %zu entries, %lld bytes", lru_.size(), static_cast<long long>(total_bytes_));
+}
+
+bool PcmCache::Contains(const std::string& source_path) {
+  const std::string key = MakeKey(source_path);
+  if (key.empty()) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  return index_.count(key) != 0;
+}
+
+std::unique_ptr<AudioDecoder> PcmCache::OpenCached(const std::string& source_path) {
+  const std::string key = MakeKey(source_path);
+  if (key.empty()) {
+    return nullptr;
+  }
+
+  std::string path;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+      return nullptr;
+    }
+    path = it->second->path;
+    lru_.splice(lru_.begin(), lru_, it->second);
+  }
+  utimensat(AT_FDCWD, path.c_str(), nullptr, 0);
+
+  auto decoder = std::make_unique<WAVDecoder>();
+  if (!decoder->Open(path)) {
+    // Removed behind our back; forget it
+    LOGW("Cache entry unreadable, dropping: %s", path.c_str());
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      total_bytes_ -= it->second->bytes;
+      lru_.erase(it->second);
+      index_.erase(it);
+    }
+    return nullptr;
+  }
+  return decoder;
+}
+
+void PcmCache::Prefetch(const std::string& source_path) {
+  if (!IsCacheable(source_path) || Contains(source_path)) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!pending_.insert(source_path).second) {
+      return;
+    }
+    queue_.push_back(source_path);
+  }
+  queue_cv_.notify_one();
+}
+
+bool PcmCache::DecodeNow(const std::string& source_path) {
+  const std::string key = MakeKey(source_path);
+  if (key.empty()) {
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (index_.count(key) != 0) {
+      return true;
+    }
+  }
+
+  auto decoder = CreateSourceDecoder(source_path);
+  if (!decoder || !decoder->Open(source_path)) {
+    LOGE("Failed to open source for caching: %s", source_path.c_str());
+    return false;
+  }
+  const AudioFormat format = decoder->GetFormat();
+  if (format.channels <= 0 || format.sample_rate <= 0) {
+    return false;
+  }
+
+  const bool use_float = config_.sample_format == SampleFormat::kFloat32;
+  drwav_data_format wav_format;
+  wav_format.container = drwav_container_riff;
+  wav_format.format = use_float ? DR_WAVE_FORMAT_IEEE_FLOAT : DR_WAVE_FORMAT_PCM;
+  wav_format.channels = static_cast<drwav_uint32>(format.channels);
+  wav_format.sampleRate = static_cast<drwav_uint32>(format.sample_rate);
+  wav_format.bitsPerSample = use_float ? 32 : 16;
+
+  // Unique temp name so concurrent DecodeNow() calls cannot collide
+  static std::atomic<uint32_t> temp_counter{0};
+  const std::string final_path = EntryPath(key);
+  const std::string temp_path = final_path + "." +
+      std::to_string(temp_counter.fetch_add(1, std::memory_order_relaxed)) + kTempSuffix;
+
+  drwav wav;
+  if (!drwav_init_file_write(&wav, temp_path.c_str(), &wav_format, nullptr)) {
+    LOGE("Failed to create cache file: %s", temp_path.c_str());
+    return false;
+  }
+
+  const size_t channels = static_cast<size_t>(format.channels);
+  std::vector<float> buffer(kDecodeChunkFrames * channels);
+  std::vector<int16_t> pcm16(use_float ? 0 : buffer.size());
+  int64_t frames_written = 0;
+  bool ok = true;
+  while (!stop_.load(std::memory_order_acquire)) {
+    const size_t frames_read = decoder->Read(buffer.data(), kDecodeChunkFrames);
+    if (frames_read == 0) {
+      break;
+    }
+    const void* data = buffer.data();
+    if (!use_float) {
+      for (size_t i = 0; i < frames_read * channels; ++i) {
+        pcm16[i] = FloatToPcm16(buffer[i]);
+      }
+      data = pcm16.data();
+    }
+    if (drwav_write_pcm_frames(&wav, frames_read, data) != frames_read) {
+      LOGE("Failed to write cache file: %s", temp_path.c_str());
+      ok = false;
+      break;
+    }
+    frames_written += static_cast<int64_t>(frames_read);
+  }
+  drwav_uninit(&wav);
+  decoder->Close();
+
+  if (!ok || frames_written == 0 || stop_.load(std::memory_order_acquire) ||
+      std::rename(temp_path.c_str(), final_path.c_str()) != 0) {
+    unlink(temp_path.c_str());
+    return false;
+  }
+
+  struct stat info;
+  if (stat(final_path.c_str(), &info) != 0) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (index_.count(key) != 0) {
+    // Another caller finished first; the rename replaced its identical file
+    return true;
+  }
+  const int64_t bytes = static_cast<int64_t>(info.st_size);
+  if (bytes > config_.max_bytes) {
+    LOGW("Decoded %s exceeds cache budget (%lld bytes), not caching",
+         source_path.c_str(), static_cast<long long>(bytes));
+    unlink(final_path.c_str());
+    return false;
+  }
+  lru_.push_front(Entry{key, final_path, bytes});
+  index_[key] = lru_.begin();
+  total_bytes_ += bytes;
+  EvictLocked();
+  LOGD("Cached %s: %lld frames, %lld bytes", source_path.c_str(),
+       static_cast<long long>(frames_written), static_cast<long long>(bytes));
+  return true;
+}
+
+void PcmCache::EvictLocked() {
+  // Keep the most recent entry even if it alone is over budget
+  while (total_bytes_ > config_.max_bytes && lru_.size() > 1) {
+    const Entry& victim = lru_.back();
+    // Unlinking is safe for readers that still have the file mapped
+    unlink(victim.path.c_str());
+    total_bytes_ -= victim.bytes;
+    index_.erase(victim.key);
+    lru_.pop_back();
+  }
+}
+
+int64_t PcmCache::GetTotalBytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return total_bytes_;
+}
+
+size_t PcmCache::GetEntryCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return lru_.size();
+}
+
+void PcmCache::WorkerLoop() {
+  while (true) {
+    std::string source_path;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      queue_cv_.wait(lock, [this] {
+        return stop_.load(std::memory_order_acquire) || !queue_.empty();
+      });
+      if (stop_.load(std::memory_order_acquire)) {
+        return;
+      }
+      source_path = std::move(queue_.front());
+      queue_.pop_front();
+    }
+
+    DecodeNow(source_path);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.erase(source_path);
+  }
+}
+
+}  // namespace audio
+}  // namespace sezo
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "audio/AudioDecoder.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace sezo {
+namespace audio {
+
+/**
+ * On-disk cache of fully decoded compressed audio (MP3/M4A).
+ *
+ * Sources are decoded once on a background thread into WAV files inside the
+ * cache directory (PCM16 or float32), so later loads open them with the
+ * memory-mapped WAVDecoder and seeks become plain pointer arithmetic.
+ * Entries are keyed by source path, size and modification time, and the
+ * directory is kept under a byte budget by evicting the least recently used
+ * entries. Eviction only unlinks files, so tracks that still have an entry
+ * mapped keep reading it.
+ */
+class PcmCache {
+ public:
+  enum class SampleFormat {
+    kInt16,    // Half the footprint; converted on read by the mix kernels
+    kFloat32,  // Zero-copy reads
+  };
+
+  struct Config {
+    std::string directory;
+    int64_t max_bytes = 512LL * 1024 * 1024;
+    SampleFormat sample_format = SampleFormat::kInt16;
+  };
+
+  /**
+   * Constructor. Scans the directory for existing entries and starts the
+   * background decode thread.
+   * @param config Cache configuration
+   */
+  explicit PcmCache(const Config& config);
+  ~PcmCache();
+
+  PcmCache(const PcmCache&) = delete;
+  PcmCache& operator=(const PcmCache&) = delete;
+
+  /**
+   * Whether a source benefits from caching (compressed formats only).
+   * @param source_path Source file path
+   * @return true for MP3/M4A/MP4 files
+   */
+  static bool IsCacheable(const std::string& source_path);
+
+  /**
+   * Open a decoder over the cached PCM for a source, if present.
+   * Marks the entry as most recently used.
+   * @param source_path Source file path
+   * @return Memory-mapped decoder, or nullptr on a miss
+   */
+  std::unique_ptr<AudioDecoder> OpenCached(const std::string& source_path);
+
+  /**
+   * Queue a source for background decoding. No-op if it is already cached
+   * or queued.
+   * @param source_path Source file path
+   */
+  void Prefetch(const std::string& source_path);
+
+  /**
+   * Decode a source into the cache on the calling thread.
+   * @param source_path Source file path
+   * @return true if the source is cached on return
+   */
+  bool DecodeNow(const std::string& source_path);
+
+  /**
+   * Check whether a source has a cache entry.
+   * @param source_path Source file path
+   * @return true if cached
+   */
+  bool Contains(const std::string& source_path);
+
+  const Config& GetConfig() const { return config_; }
+  int64_t GetTotalBytes() const;
+  size_t GetEntryCount() const;
+
+ private:
+  struct Entry {
+    std::string key;
+    std::string path;
+    int64_t bytes = 0;
+  };
+
+  std::string MakeKey(const std::string& source_path) const;
+  std::string EntryPath(const std::string& key) const;
+  void ScanDirectory();
+  void EvictLocked();
+  void WorkerLoop();
+
+  Config config_;
+
+  mutable std::mutex mutex_;
+  // Most recently used at the front
+  std::list<Entry> lru_;
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+  int64_t total_bytes_ = 0;
+
+  std::condition_variable queue_cv_;
+  std::deque<std::string> queue_;
+  std::unordered_set<std::string> pending_;
+  std::thread worker_;
+  std::atomic<bool> stop_{false};
+};
+
+}  // namespace audio
+}  // namespace sezo
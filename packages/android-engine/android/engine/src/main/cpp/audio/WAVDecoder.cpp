@@ -1,11 +1,26 @@
 #define DR_WAV_IMPLEMENTATION
 #include "WAVDecoder.h"
+#include "dsp/MixKernels.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
 #include <cstring>
 
 namespace sezo {
 namespace audio {
 
-WAVDecoder::WAVDecoder() {
+namespace {
+
+// Readahead window requested from the kernel ahead of the read position.
+constexpr int64_t kReadaheadSeconds = 2;
+
+}  // namespace
+
+WAVDecoder::WAVDecoder(bool allow_memory_map) : allow_memory_map_(allow_memory_map) {
   std::memset(&decoder_, 0, sizeof(decoder_));
 }
 
@@ -21,36 +36,197 @@ bool WAVDecoder::Open(const std::string& file_path) {
   if (!drwav_init_file(&decoder_, file_path.c_str(), nullptr)) {
     return false;
   }
+  drwav_open_ = true;
 
   format_.sample_rate = decoder_.sampleRate;
   format_.channels = decoder_.channels;
   format_.total_frames = static_cast<int64_t>(decoder_.totalPCMFrameCount);
 
+  // dr_wav has parsed the header; if the data chunk can be served from a
+  // mapping there is no need to keep the stdio stream around.
+  if (allow_memory_map_ && OpenMapped(file_path)) {
+    drwav_uninit(&decoder_);
+    drwav_open_ = false;
+  }
+
   is_open_ = true;
   return true;
 }
 
+bool WAVDecoder::OpenMapped(const std::string& file_path) {
+  if (decoder_.container != drwav_container_riff && decoder_.container != drwav_container_rf64) {
+    return false;
+  }
+
+  MappedSampleFormat sample_format = MappedSampleFormat::kNone;
+  if (decoder_.translatedFormatTag == DR_WAVE_FORMAT_PCM && decoder_.bitsPerSample == 16) {
+    sample_format = MappedSampleFormat::kInt16;
+  } else if (decoder_.translatedFormatTag == DR_WAVE_FORMAT_IEEE_FLOAT &&
+             decoder_.bitsPerSample == 32) {
+    sample_format = MappedSampleFormat::kFloat32;
+  } else {
+    return false;
+  }
+
+  const size_t sample_bytes = decoder_.bitsPerSample / 8;
+  const size_t frame_bytes = sample_bytes * decoder_.channels;
+  if (frame_bytes == 0 || decoder_.fmt.blockAlign != frame_bytes ||
+      decoder_.dataChunkDataPos % sample_bytes != 0) {
+    return false;
+  }
+
+  const int fd = open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    close(fd);
+    return false;
+  }
+
+  const uint64_t file_size = static_cast<uint64_t>(file_stat.st_size);
+  const uint64_t data_end = decoder_.dataChunkDataPos + decoder_.totalPCMFrameCount * frame_bytes;
+  if (file_size == 0 || data_end > file_size) {
+    close(fd);
+    return false;
+  }
+
+  void* mapping = mmap(nullptr, static_cast<size_t>(file_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);  // The mapping keeps its own reference to the file.
+  if (mapping == MAP_FAILED) {
+    return false;
+  }
+
+  madvise(mapping, static_cast<size_t>(file_size), MADV_SEQUENTIAL);
+
+  mapping_ = mapping;
+  mapping_size_ = static_cast<size_t>(file_size);
+  mapped_data_ = static_cast<const uint8_t*>(mapping) + decoder_.dataChunkDataPos;
+  mapped_format_ = sample_format;
+  mapped_frame_bytes_ = frame_bytes;
+  mapped_position_ = 0;
+  advised_until_ = 0;
+  AdviseReadahead();
+  return true;
+}
+
 void WAVDecoder::Close() {
   if (is_open_) {
-    drwav_uninit(&decoder_);
+    CloseMapped();
+    if (drwav_open_) {
+      drwav_uninit(&decoder_);
+      drwav_open_ = false;
+    }
     is_open_ = false;
   }
 }
 
+void WAVDecoder::CloseMapped() {
+  if (mapping_) {
+    munmap(mapping_, mapping_size_);
+    mapping_ = nullptr;
+    mapping_size_ = 0;
+  }
+  mapped_data_ = nullptr;
+  mapped_format_ = MappedSampleFormat::kNone;
+  mapped_frame_bytes_ = 0;
+  mapped_position_ = 0;
+  advised_until_ = 0;
+}
+
+void WAVDecoder::AdviseReadahead() {
+  // Keep the kernel a window ahead of the read position; only re-issue the
+  // hint once half of the previous window has been consumed.
+  const int64_t window = static_cast<int64_t>(format_.sample_rate) * kReadaheadSeconds;
+  if (window <= 0 || mapped_position_ + window / 2 < advised_until_) {
+    return;
+  }
+
+  static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  const int64_t end_frame = std::min(mapped_position_ + window, format_.total_frames);
+  const uint8_t* base = static_cast<const uint8_t*>(mapping_);
+  const size_t start = static_cast<size_t>(mapped_data_ - base) +
+                       static_cast<size_t>(mapped_position_) * mapped_frame_bytes_;
+  const size_t end = static_cast<size_t>(mapped_data_ - base) +
+                     static_cast<size_t>(end_frame) * mapped_frame_bytes_;
+  const size_t aligned_start = start - (start % page_size);
+  if (end > aligned_start) {
+    madvise(const_cast<uint8_t*>(base) + aligned_start, end - aligned_start, MADV_WILLNEED);
+  }
+  advised_until_ = end_frame;
+}
+
 size_t WAVDecoder::Read(float* buffer, size_t frames) {
   if (!is_open_) {
     return 0;
   }
 
+  if (mapping_) {
+    const int64_t remaining = format_.total_frames - mapped_position_;
+    const size_t frames_read = static_cast<size_t>(
+        std::min<int64_t>(static_cast<int64_t>(frames), std::max<int64_t>(remaining, 0)));
+    if (frames_read == 0) {
+      return 0;
+    }
+
+    const uint8_t* source =
+        mapped_data_ + static_cast<size_t>(mapped_position_) * mapped_frame_bytes_;
+    const size_t samples = frames_read * static_cast<size_t>(format_.channels);
+    if (mapped_format_ == MappedSampleFormat::kFloat32) {
+      std::memcpy(buffer, source, samples * sizeof(float));
+    } else {
+      dsp::GetMixKernels().convert_s16_to_f32(
+          buffer, reinterpret_cast<const int16_t*>(source), samples);
+    }
+    mapped_position_ += static_cast<int64_t>(frames_read);
+    AdviseReadahead();
+    return frames_read;
+  }
+
   drwav_uint64 frames_read = drwav_read_pcm_frames_f32(&decoder_, frames, buffer);
   return static_cast<size_t>(frames_read);
 }
 
+size_t WAVDecoder::ReadMapped(const float** data, size_t frames) {
+  if (!is_open_ || !SupportsMappedReads()) {
+    return 0;
+  }
+
+  const int64_t remaining = format_.total_frames - mapped_position_;
+  const size_t frames_read = static_cast<size_t>(
+      std::min<int64_t>(static_cast<int64_t>(frames), std::max<int64_t>(remaining, 0)));
+  if (frames_read == 0) {
+    return 0;
+  }
+
+  *data = reinterpret_cast<const float*>(
+      mapped_data_ + static_cast<size_t>(mapped_position_) * mapped_frame_bytes_);
+  mapped_position_ += static_cast<int64_t>(frames_read);
+  AdviseReadahead();
+  return frames_read;
+}
+
+bool WAVDecoder::SupportsMappedReads() const {
+  return mapping_ != nullptr && mapped_format_ == MappedSampleFormat::kFloat32;
+}
+
 bool WAVDecoder::Seek(int64_t frame) {
   if (!is_open_) {
     return false;
   }
 
+  if (mapping_) {
+    if (frame < 0 || frame > format_.total_frames) {
+      return false;
+    }
+    mapped_position_ = frame;
+    advised_until_ = frame;
+    AdviseReadahead();
+    return true;
+  }
+
   return drwav_seek_to_pcm_frame(&decoder_, static_cast<drwav_uint64>(frame));
 }
 
@@ -3,6 +3,7 @@
 #include "AudioDecoder.h"
 #include "dr_wav.h"
 
+#include <cstdint>
 #include <memory>
 
 namespace sezo {
@@ -10,22 +11,56 @@ namespace audio {
 
 /**
  * WAV decoder using dr_wav.
+ *
+ * Little-endian 16-bit PCM and 32-bit float files are memory-mapped and read
+ * straight from the mapping: float data can be borrowed without a copy via
+ * ReadMapped(), 16-bit data is converted in a single vectorized pass, and
+ * seeks only move the read position. Other layouts stream through dr_wav.
  */
 class WAVDecoder : public AudioDecoder {
  public:
-  WAVDecoder();
+  /**
+   * Constructor.
+   * @param allow_memory_map Use the memory-mapped fast path when possible
+   */
+  explicit WAVDecoder(bool allow_memory_map = true);
   ~WAVDecoder() override;
 
   bool Open(const std::string& file_path) override;
   void Close() override;
   size_t Read(float* buffer, size_t frames) override;
+  size_t ReadMapped(const float** data, size_t frames) override;
+  bool SupportsMappedReads() const override;
   bool Seek(int64_t frame) override;
   const AudioFormat& GetFormat() const override { return format_; }
   bool IsOpen() const override { return is_open_; }
 
+  /**
+   * Check whether the open file is served from a memory mapping.
+   * @return true if memory-mapped
+   */
+  bool IsMemoryMapped() const { return mapping_ != nullptr; }
+
  private:
+  enum class MappedSampleFormat { kNone, kInt16, kFloat32 };
+
+  bool OpenMapped(const std::string& file_path);
+  void CloseMapped();
+  void AdviseReadahead();
+
   drwav decoder_;
+  bool drwav_open_ = false;
   bool is_open_ = false;
+  bool allow_memory_map_ = true;
+
+  // Memory-mapped fast path
+  void* mapping_ = nullptr;
+  size_t mapping_size_ = 0;
+  const uint8_t* mapped_data_ = nullptr;
+  MappedSampleFormat mapped_format_ = MappedSampleFormat::kNone;
+  size_t mapped_frame_bytes_ = 0;
+  int64_t mapped_position_ = 0;
+  int64_t advised_until_ = 0;
 };
 
 }  // namespace audio
@@ -0,0 +1,201 @@
+#include "CallbackStats.h"
+
+#include <cmath>
+#include <limits>
+
+namespace sezo {
+namespace core {
+
+namespace {
+
+constexpr double kFirstBucketUs = 16.0;
+constexpr double kBucketsPerOctave = 4.0;
+
+}  // namespace
+
+CallbackStats::CallbackStats() {
+  Reset();
+}
+
+double CallbackStats::DurationBucketUpperUs(size_t bucket) {
+  if (bucket + 1 >= kDurationBuckets) {
+    return std::numeric_limits<double>::infinity();
+  }
+  return kFirstBucketUs * std::exp2(static_cast<double>(bucket) / kBucketsPerOctave);
+}
+
+double CallbackStats::LoadBucketUpperPercent(size_t bucket) {
+  if (bucket + 1 >= kLoadBuckets) {
+    return std::numeric_limits<double>::infinity();
+  }
+  return kLoadBucketPercent * static_cast<double>(bucket + 1);
+}
+
+size_t CallbackStats::DurationBucketFor(int64_t duration_ns) {
+  const double us = static_cast<double>(duration_ns) / 1000.0;
+  if (us <= kFirstBucketUs) {
+    return 0;
+  }
+  const double index = std::ceil(std::log2(us / kFirstBucketUs) * kBucketsPerOctave);
+  if (index >= static_cast<double>(kDurationBuckets - 1)) {
+    return kDurationBuckets - 1;
+  }
+  return static_cast<size_t>(index);
+}
+
+void CallbackStats::UpdateMax(std::atomic<int64_t>& target, int64_t value) {
+  int64_t current = target.load(std::memory_order_relaxed);
+  while (value > current &&
+         !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+  }
+}
+
+void CallbackStats::Record(int64_t start_ns,
+                           int64_t end_ns,
+                           int32_t frames,
+                           int32_t sample_rate) {
+  const int64_t duration_ns = end_ns > start_ns ? end_ns - start_ns : 0;
+
+  duration_counts_[DurationBucketFor(duration_ns)].fetch_add(1, std::memory_order_relaxed);
+  callbacks_.fetch_add(1, std::memory_order_relaxed);
+  frames_.fetch_add(static_cast<uint64_t>(frames > 0 ? frames : 0), std::memory_order_relaxed);
+  total_duration_ns_.fetch_add(duration_ns, std::memory_order_relaxed);
+  UpdateMax(max_duration_ns_, duration_ns);
+  last_frames_.store(frames, std::memory_order_relaxed);
+  last_sample_rate_.store(sample_rate, std::memory_order_relaxed);
+
+  if (frames > 0 && sample_rate > 0) {
+    const int64_t period_ns = static_cast<int64_t>(frames) * 1000000000LL / sample_rate;
+    if (period_ns > 0) {
+      const int64_t load_permille = duration_ns * 1000 / period_ns;
+      size_t load_bucket = static_cast<size_t>(
+          static_cast<double>(load_permille) / (kLoadBucketPercent * 10.0));
+      if (load_bucket >= kLoadBuckets) {
+        load_bucket = kLoadBuckets - 1;
+      }
+      load_counts_[load_bucket].fetch_add(1, std::memory_order_relaxed);
+      UpdateMax(max_load_permille_, load_permille);
+      if (duration_ns > period_ns) {
+        deadline_misses_.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  const int64_t last_start = last_start_ns_.exchange(start_ns, std::memory_order_relaxed);
+  if (last_start > 0 && start_ns > last_start) {
+    UpdateMax(max_interval_ns_, start_ns - last_start);
+  }
+}
+
+void CallbackStats::MarkIdle() {
+  last_start_ns_.store(0, std::memory_order_relaxed);
+}
+
+double CallbackStats::Percentile(const uint64_t* counts,
+                                 size_t bucket_count,
+                                 uint64_t total,
+                                 double fraction,
+                                 double (*upper_bound)(size_t),
+                                 double max_value) {
+  if (total == 0) {
+    return 0.0;
+  }
+  const double rank = fraction * static_cast<double>(total);
+  uint64_t cumulative = 0;
+  for (size_t i = 0; i < bucket_count; ++i) {
+    if (counts[i] == 0) {
+      continue;
+    }
+    const uint64_t before = cumulative;
+    cumulative += counts[i];
+    if (static_cast<double>(cumulative) < rank) {
+      continue;
+    }
+    // Interpolate linearly inside the bucket; the overflow bucket and any
+    // bound above the observed maximum are capped at the maximum.
+    const double lower = i == 0 ? 0.0 : upper_bound(i - 1);
+    double upper = upper_bound(i);
+    if (upper > max_value) {
+      upper = max_value;
+    }
+    if (upper <= lower) {
+      return upper;
+    }
+    const double position =
+        (rank - static_cast<double>(before)) / static_cast<double>(counts[i]);
+    return lower + (upper - lower) * position;
+  }
+  return max_value;
+}
+
+CallbackStats::Snapshot CallbackStats::GetSnapshot() const {
+  Snapshot snapshot;
+  snapshot.callbacks = callbacks_.load(std::memory_order_relaxed);
+  snapshot.frames = frames_.load(std::memory_order_relaxed);
+  snapshot.frames_per_callback = last_frames_.load(std::memory_order_relaxed);
+  snapshot.sample_rate = last_sample_rate_.load(std::memory_order_relaxed);
+  if (snapshot.sample_rate > 0) {
+    snapshot.period_us = static_cast<double>(snapshot.frames_per_callback) * 1e6 /
+                         static_cast<double>(snapshot.sample_rate);
+  }
+  snapshot.max_duration_us =
+      static_cast<double>(max_duration_ns_.load(std::memory_order_relaxed)) / 1000.0;
+  snapshot.max_load_percent =
+      static_cast<double>(max_load_permille_.load(std::memory_order_relaxed)) / 10.0;
+  snapshot.max_interval_us =
+      static_cast<double>(max_interval_ns_.load(std::memory_order_relaxed)) / 1000.0;
+  snapshot.deadline_misses = deadline_misses_.load(std::memory_order_relaxed);
+
+  uint64_t duration_total = 0;
+  for (size_t i = 0; i < kDurationBuckets; ++i) {
+    snapshot.duration_histogram[i] = duration_counts_[i].load(std::memory_order_relaxed);
+    duration_total += snapshot.duration_histogram[i];
+  }
+  std::array<uint64_t, kLoadBuckets> load_histogram{};
+  uint64_t load_total = 0;
+  for (size_t i = 0; i < kLoadBuckets; ++i) {
+    load_histogram[i] = load_counts_[i].load(std::memory_order_relaxed);
+    load_total += load_histogram[i];
+  }
+
+  if (duration_total > 0) {
+    snapshot.mean_duration_us =
+        static_cast<double>(total_duration_ns_.load(std::memory_order_relaxed)) / 1000.0 /
+        static_cast<double>(duration_total);
+  }
+
+  const uint64_t* durations = snapshot.duration_histogram.data();
+  snapshot.p50_duration_us = Percentile(durations, kDurationBuckets, duration_total, 0.50,
+                                        &DurationBucketUpperUs, snapshot.max_duration_us);
+  snapshot.p90_duration_us = Percentile(durations, kDurationBuckets, duration_total, 0.90,
+                                        &DurationBucketUpperUs, snapshot.max_duration_us);
+  snapshot.p99_duration_us = Percentile(durations, kDurationBuckets, duration_total, 0.99,
+                                        &DurationBucketUpperUs, snapshot.max_duration_us);
+  snapshot.p999_duration_us = Percentile(durations, kDurationBuckets, duration_total, 0.999,
+                                         &DurationBucketUpperUs, snapshot.max_duration_us);
+  snapshot.p50_load_percent = Percentile(load_histogram.data(), kLoadBuckets, load_total, 0.50,
+                                         &LoadBucketUpperPercent, snapshot.max_load_percent);
+  snapshot.p99_load_percent = Percentile(load_histogram.data(), kLoadBuckets, load_total, 0.99,
+                                         &LoadBucketUpperPercent, snapshot.max_load_percent);
+  return snapshot;
+}
+
+void CallbackStats::Reset() {
+  for (auto& count : duration_counts_) {
+    count.store(0, std::memory_order_relaxed);
+  }
+  for (auto& count : load_counts_) {
+    count.store(0, std::memory_order_relaxed);
+  }
+  callbacks_.store(0, std::memory_order_relaxed);
+  frames_.store(0, std::memory_order_relaxed);
+  total_duration_ns_.store(0, std::memory_order_relaxed);
+  max_duration_ns_.store(0, std::memory_order_relaxed);
+  max_load_permille_.store(0, std::memory_order_relaxed);
+  max_interval_ns_.store(0, std::memory_order_relaxed);
+  deadline_misses_.store(0, std::memory_order_relaxed);
+  last_start_ns_.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace core
+}  // namespace sezo
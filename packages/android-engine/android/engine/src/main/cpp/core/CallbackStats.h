@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace sezo {
+namespace core {
+
+/**
+ * Lock-free timing statistics for the audio callback.
+ * Record() is called once per callback from the audio thread; snapshots and
+ * resets come from any other thread and never block it.
+ */
+class CallbackStats {
+ public:
+  // Callback duration buckets: four per octave from 16 us (last = overflow).
+  static constexpr size_t kDurationBuckets = 48;
+  // Load buckets (duration / period) in 2.5% steps up to 160% (last = overflow).
+  static constexpr size_t kLoadBuckets = 65;
+  static constexpr double kLoadBucketPercent = 2.5;
+
+  struct Snapshot {
+    uint64_t callbacks = 0;
+    uint64_t frames = 0;
+    int32_t frames_per_callback = 0;  // most recent callback
+    int32_t sample_rate = 0;
+    double period_us = 0.0;           // buffer period of the most recent callback
+    double mean_duration_us = 0.0;
+    double max_duration_us = 0.0;
+    double p50_duration_us = 0.0;
+    double p90_duration_us = 0.0;
+    double p99_duration_us = 0.0;
+    double p999_duration_us = 0.0;
+    double p50_load_percent = 0.0;
+    double p99_load_percent = 0.0;
+    double max_load_percent = 0.0;
+    uint64_t deadline_misses = 0;     // callbacks that took longer than their period
+    double max_interval_us = 0.0;     // longest gap between consecutive callbacks
+    std::array<uint64_t, kDurationBuckets> duration_histogram{};
+  };
+
+  CallbackStats();
+
+  /**
+   * Record one callback. Audio thread only.
+   * @param start_ns Callback start (steady clock)
+   * @param end_ns Callback end (steady clock)
+   * @param frames Frames rendered
+   * @param sample_rate Stream sample rate
+   */
+  void Record(int64_t start_ns, int64_t end_ns, int32_t frames, int32_t sample_rate);
+
+  /**
+   * Note a callback that did not render (e.g. transport stopped), so the next
+   * recorded interval does not span the idle time. Audio thread only.
+   */
+  void MarkIdle();
+
+  /**
+   * Copy the counters and derive percentiles.
+   * Counters are read individually, so a snapshot taken during a callback may
+   * be off by that one callback.
+   */
+  Snapshot GetSnapshot() const;
+
+  /**
+   * Clear all counters.
+   */
+  void Reset();
+
+  /**
+   * Upper bound of a duration bucket.
+   * @param bucket Bucket index
+   * @return Upper bound in microseconds (infinity for the overflow bucket)
+   */
+  static double DurationBucketUpperUs(size_t bucket);
+
+ private:
+  static size_t DurationBucketFor(int64_t duration_ns);
+  static double Percentile(const uint64_t* counts,
+                           size_t bucket_count,
+                           uint64_t total,
+                           double fraction,
+                           double (*upper_bound)(size_t),
+                           double max_value);
+  static double LoadBucketUpperPercent(size_t bucket);
+  static void UpdateMax(std::atomic<int64_t>& target, int64_t value);
+
+  std::array<std::atomic<uint64_t>, kDurationBuckets> duration_counts_;
+  std::array<std::atomic<uint64_t>, kLoadBuckets> load_counts_;
+  std::atomic<uint64_t> callbacks_{0};
+  std::atomic<uint64_t> frames_{0};
+  std::atomic<int64_t> total_duration_ns_{0};
+  std::atomic<int64_t> max_duration_ns_{0};
+  std::atomic<int64_t> max_load_permille_{0};
+  std::atomic<int64_t> max_interval_ns_{0};
+  std::atomic<uint64_t> deadline_misses_{0};
+  std::atomic<int32_t> last_frames_{0};
+  std::atomic<int32_t> last_sample_rate_{0};
+  std::atomic<int64_t> last_start_ns_{0};
+};
+
+}  // namespace core
+}  // namespace sezo
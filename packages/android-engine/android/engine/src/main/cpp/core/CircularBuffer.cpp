@@ -5,75 +5,142 @@
 namespace sezo {
 namespace core {
 
-CircularBuffer::CircularBuffer(size_t capacity)
-    : buffer_(std::make_unique<float[]>(capacity)), capacity_(capacity) {
-  std::memset(buffer_.get(), 0, capacity_ * sizeof(float));
+namespace {
+
+size_t NextPowerOfTwo(size_t value) {
+  size_t result = 1;
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+
+}  // namespace
+
+CircularBuffer::CircularBuffer(size_t capacity, size_t frame_size)
+    : frame_size_(frame_size > 0 ? frame_size : 1) {
+  capacity_ = capacity - capacity % frame_size_;
+  const size_t storage = NextPowerOfTwo(std::max<size_t>(capacity_, 1));
+  mask_ = storage - 1;
+  buffer_ = std::make_unique<float[]>(storage);
+  std::memset(buffer_.get(), 0, storage * sizeof(float));
 }
 
 CircularBuffer::~CircularBuffer() = default;
 
-size_t CircularBuffer::Write(const float* data, size_t count) {
-  const size_t free = FreeSpace();
-  const size_t to_write = std::min(count, free);
+CircularBuffer::WriteSpan CircularBuffer::AcquireWrite(size_t count) {
+  const size_t write_pos = write_pos_.load(std::memory_order_relaxed);
+  size_t free = capacity_ - (write_pos - cached_read_pos_);
+  if (free < count) {
+    cached_read_pos_ = read_pos_.load(std::memory_order_acquire);
+    free = capacity_ - (write_pos - cached_read_pos_);
+  }
 
+  WriteSpan span;
+  const size_t to_write = std::min(count, free);
   if (to_write == 0) {
-    return 0;
+    return span;
   }
-
-  const size_t write_idx = write_pos_.load(std::memory_order_acquire);
-  const size_t first_chunk = std::min(to_write, capacity_ - write_idx);
-
-  std::memcpy(buffer_.get() + write_idx, data, first_chunk * sizeof(float));
-
-  if (to_write > first_chunk) {
-    const size_t second_chunk = to_write - first_chunk;
-    std::memcpy(buffer_.get(), data + first_chunk, second_chunk * sizeof(float));
+  const size_t index = write_pos & mask_;
+  span.first = buffer_.get() + index;
+  span.first_count = std::min(to_write, mask_ + 1 - index);
+  if (to_write > span.first_count) {
+    span.second = buffer_.get();
+    span.second_count = to_write - span.first_count;
   }
+  return span;
+}
 
-  write_pos_.store((write_idx + to_write) % capacity_, std::memory_order_release);
-  return to_write;
+void CircularBuffer::CommitWrite(size_t count) {
+  if (count == 0) {
+    return;
+  }
+  const size_t write_pos = write_pos_.load(std::memory_order_relaxed);
+  write_pos_.store(write_pos + count, std::memory_order_release);
 }
 
-size_t CircularBuffer::Read(float* data, size_t count) {
-  const size_t available = Available();
-  const size_t to_read = std::min(count, available);
+CircularBuffer::ReadSpan CircularBuffer::AcquireRead(size_t count) {
+  const size_t read_pos = read_pos_.load(std::memory_order_acquire);
+  acquired_read_pos_ = read_pos;
+  size_t available = cached_write_pos_ - read_pos;
+  // A Reset() can move read_pos_ past the cached write position
+  if (available < count || available > capacity_) {
+    cached_write_pos_ = write_pos_.load(std::memory_order_acquire);
+    available = cached_write_pos_ - read_pos;
+  }
 
+  ReadSpan span;
+  const size_t to_read = std::min(count, available);
   if (to_read == 0) {
-    return 0;
+    return span;
   }
+  const size_t index = read_pos & mask_;
+  span.first = buffer_.get() + index;
+  span.first_count = std::min(to_read, mask_ + 1 - index);
+  if (to_read > span.first_count) {
+    span.second = buffer_.get();
+    span.second_count = to_read - span.first_count;
+  }
+  return span;
+}
 
-  const size_t read_idx = read_pos_.load(std::memory_order_acquire);
-  const size_t first_chunk = std::min(to_read, capacity_ - read_idx);
-
-  std::memcpy(data, buffer_.get() + read_idx, first_chunk * sizeof(float));
+void CircularBuffer::CommitRead(size_t count) {
+  if (count == 0) {
+    return;
+  }
+  // Compare-exchange against the position the span was taken from, so a
+  // concurrent Reset() wins: the consumed samples were discarded anyway.
+  size_t expected = acquired_read_pos_;
+  read_pos_.compare_exchange_strong(expected, acquired_read_pos_ + count,
+                                    std::memory_order_release,
+                                    std::memory_order_relaxed);
+  acquired_read_pos_ += count;
+}
 
-  if (to_read > first_chunk) {
-    const size_t second_chunk = to_read - first_chunk;
-    std::memcpy(data + first_chunk, buffer_.get(), second_chunk * sizeof(float));
+size_t CircularBuffer::Write(const float* data, size_t count) {
+  const WriteSpan span = AcquireWrite(count);
+  if (span.size() == 0) {
+    return 0;
   }
+  std::memcpy(span.first, data, span.first_count * sizeof(float));
+  if (span.second_count > 0) {
+    std::memcpy(span.second, data + span.first_count, span.second_count * sizeof(float));
+  }
+  CommitWrite(span.size());
+  return span.size();
+}
 
-  read_pos_.store((read_idx + to_read) % capacity_, std::memory_order_release);
-  return to_read;
+size_t CircularBuffer::Read(float* data, size_t count) {
+  const ReadSpan span = AcquireRead(count);
+  if (span.size() == 0) {
+    return 0;
+  }
+  std::memcpy(data, span.first, span.first_count * sizeof(float));
+  if (span.second_count > 0) {
+    std::memcpy(data + span.first_count, span.second, span.second_count * sizeof(float));
+  }
+  CommitRead(span.size());
+  return span.size();
 }
 
 size_t CircularBuffer::Available() const {
-  const size_t write_idx = write_pos_.load(std::memory_order_acquire);
-  const size_t read_idx = read_pos_.load(std::memory_order_acquire);
-
-  if (write_idx >= read_idx) {
-    return write_idx - read_idx;
-  }
-  return capacity_ - (read_idx - write_idx);
+  const size_t read_pos = read_pos_.load(std::memory_order_acquire);
+  const size_t write_pos = write_pos_.load(std::memory_order_acquire);
+  const size_t available = write_pos - read_pos;
+  // Loaded separately, so a Reset() in between can make read_pos look ahead
+  return available > capacity_ ? 0 : available;
 }
 
 size_t CircularBuffer::FreeSpace() const {
-  return capacity_ - Available() - 1;  // Leave one slot empty to distinguish full from empty
+  return capacity_ - Available();
 }
 
 void CircularBuffer::Reset() {
-  std::memset(buffer_.get(), 0, capacity_ * sizeof(float));
-  write_pos_.store(0, std::memory_order_release);
-  read_pos_.store(0, std::memory_order_release);
+  // Discard by moving the consumer up to the producer. The producer is
+  // quiescent, so write_pos_ is stable.
+  const size_t write_pos = write_pos_.load(std::memory_order_acquire);
+  read_pos_.store(write_pos, std::memory_order_release);
+  cached_read_pos_ = write_pos;
 }
 
 }  // namespace core
@@ -10,16 +10,55 @@ namespace core {
 /**
  * Lock-free circular buffer for real-time audio streaming.
  * Single producer, single consumer (SPSC) design.
+ *
+ * Storage is rounded up to a power of two so positions wrap with a mask, and
+ * the producer and consumer indices live on separate cache lines. Each side
+ * also keeps a cached copy of the other side's index and only reloads it when
+ * the cached value says the buffer is full (producer) or empty (consumer).
+ *
+ * Besides Write()/Read(), the span API lets a producer decode straight into
+ * the ring and a consumer mix straight out of it:
+ *
+ *   auto span = buffer.AcquireWrite(n);
+ *   ... fill span.first / span.second ...
+ *   buffer.CommitWrite(written);
  */
 class CircularBuffer {
  public:
+  /**
+   * Writable region, split in two where it wraps around the end of storage.
+   */
+  struct WriteSpan {
+    float* first = nullptr;
+    size_t first_count = 0;
+    float* second = nullptr;
+    size_t second_count = 0;
+    size_t size() const { return first_count + second_count; }
+  };
+
+  /**
+   * Readable region, split in two where it wraps around the end of storage.
+   */
+  struct ReadSpan {
+    const float* first = nullptr;
+    size_t first_count = 0;
+    const float* second = nullptr;
+    size_t second_count = 0;
+    size_t size() const { return first_count + second_count; }
+  };
+
   /**
    * Constructor.
    * @param capacity Buffer capacity in samples
+   * @param frame_size Samples per frame; capacity is rounded down to whole
+   *        frames so a full buffer never holds a partial frame
    */
-  explicit CircularBuffer(size_t capacity);
+  explicit CircularBuffer(size_t capacity, size_t frame_size = 1);
   ~CircularBuffer();
 
+  CircularBuffer(const CircularBuffer&) = delete;
+  CircularBuffer& operator=(const CircularBuffer&) = delete;
+
   /**
    * Write data to the buffer.
    * @param data Source data pointer
@@ -36,6 +75,32 @@ class CircularBuffer {
    */
   size_t Read(float* data, size_t count);
 
+  /**
+   * Borrow up to count samples of free space. Producer only.
+   * @param count Samples wanted
+   * @return Writable span (may be shorter than count, or empty)
+   */
+  WriteSpan AcquireWrite(size_t count);
+
+  /**
+   * Publish samples written into the last AcquireWrite() span. Producer only.
+   * @param count Samples written (at most the span size)
+   */
+  void CommitWrite(size_t count);
+
+  /**
+   * Borrow up to count buffered samples in place. Consumer only.
+   * @param count Samples wanted
+   * @return Readable span (may be shorter than count, or empty)
+   */
+  ReadSpan AcquireRead(size_t count);
+
+  /**
+   * Release samples consumed from the last AcquireRead() span. Consumer only.
+   * @param count Samples consumed (at most the span size)
+   */
+  void CommitRead(size_t count);
+
   /**
    * Get available samples for reading.
    * @return Number of samples available
@@ -49,15 +114,45 @@ class CircularBuffer {
   size_t FreeSpace() const;
 
   /**
-   * Reset the buffer (clear all data).
+   * Get the buffer capacity.
+   * @return Capacity in samples
+   */
+  size_t Capacity() const { return capacity_; }
+
+  /**
+   * Samples per frame the capacity is aligned to.
+   */
+  size_t FrameSize() const { return frame_size_; }
+
+  /**
+   * Reset the buffer (discard all buffered data).
+   * The producer must not be writing. The consumer may be reading, and the
+   * discard still takes effect when it commits, but a span it has already
+   * acquired is not protected: the whole ring is free to the producer again,
+   * so a refill started right after Reset() can overwrite samples the
+   * consumer has yet to copy, and the read may return new data.
+   * Storage is not cleared.
    */
   void Reset();
 
  private:
+  // Not std::hardware_destructive_interference_size: the NDK's libc++ does
+  // not define it, and 64 bytes matches current ARM and x86 cores.
+  static constexpr size_t kCacheLineSize = 64;
+
   std::unique_ptr<float[]> buffer_;
   size_t capacity_;
-  std::atomic<size_t> write_pos_{0};
-  std::atomic<size_t> read_pos_{0};
+  size_t frame_size_;
+  size_t mask_;
+
+  // Positions count samples since construction and wrap through the mask;
+  // write_pos_ - read_pos_ is the fill level.
+  alignas(kCacheLineSize) std::atomic<size_t> write_pos_{0};
+  size_t cached_read_pos_ = 0;  // producer's view of read_pos_
+
+  alignas(kCacheLineSize) std::atomic<size_t> read_pos_{0};
+  size_t cached_write_pos_ = 0;  // consumer's view of write_pos_
+  size_t acquired_read_pos_ = 0;  // read_pos_ seen by the last AcquireRead()
 };
 
 }  // namespace core
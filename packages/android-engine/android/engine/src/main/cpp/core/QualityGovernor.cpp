@@ -0,0 +1,138 @@
+#include "QualityGovernor.h"
+
+#include <algorithm>
+
+namespace sezo {
+namespace core {
+
+namespace {
+
+constexpr double kLoadPercentile = 0.9;
+
+}  // namespace
+
+QualityGovernor::QualityGovernor() : QualityGovernor(Config()) {}
+
+QualityGovernor::QualityGovernor(const Config& config) {
+  SetConfig(config);
+}
+
+void QualityGovernor::SetConfig(const Config& config) {
+  config_ = config;
+  config_.max_level = std::max(0, config_.max_level);
+  config_.calm_windows_to_step_up = std::max(1, config_.calm_windows_to_step_up);
+  config_.hold_windows = std::max(0, config_.hold_windows);
+  level_ = std::min(level_, config_.max_level);
+}
+
+bool QualityGovernor::Evaluate(const Window& window, Step* step) {
+  if (window.callbacks == 0) {
+    return false;
+  }
+  if (hold_remaining_ > 0) {
+    --hold_remaining_;
+    return false;
+  }
+
+  Reason reason = Reason::kLoad;
+  bool overloaded = true;
+  if (window.xruns > 0) {
+    reason = Reason::kXRun;
+  } else if (window.deadline_misses > 0) {
+    reason = Reason::kDeadlineMiss;
+  } else if (window.p90_load_percent < config_.step_down_load_percent) {
+    overloaded = false;
+  }
+
+  if (overloaded) {
+    calm_windows_ = 0;
+    return level_ < config_.max_level && ChangeLevel(level_ + 1, reason, window, step);
+  }
+
+  if (window.p90_load_percent >= config_.step_up_load_percent) {
+    calm_windows_ = 0;
+    return false;
+  }
+  if (++calm_windows_ < config_.calm_windows_to_step_up || level_ == 0) {
+    return false;
+  }
+  return ChangeLevel(level_ - 1, Reason::kRecovered, window, step);
+}
+
+bool QualityGovernor::ChangeLevel(int32_t level, Reason reason, const Window& window,
+                                  Step* step) {
+  if (step) {
+    step->level = level;
+    step->previous_level = level_;
+    step->reason = reason;
+    step->window = window;
+  }
+  level_ = level;
+  calm_windows_ = 0;
+  hold_remaining_ = config_.hold_windows;
+  return true;
+}
+
+void QualityGovernor::SetLevel(int32_t level) {
+  level_ = std::clamp(level, 0, config_.max_level);
+  calm_windows_ = 0;
+  hold_remaining_ = config_.hold_windows;
+}
+
+void QualityGovernor::Reset() {
+  level_ = 0;
+  calm_windows_ = 0;
+  hold_remaining_ = 0;
+}
+
+QualityGovernor::Window QualityGovernor::MakeWindow(const CallbackStats::Snapshot& previous,
+                                                    const CallbackStats::Snapshot& current,
+                                                    int32_t previous_xruns,
+                                                    int32_t current_xruns) {
+  Window window;
+  if (current_xruns > 0) {
+    window.xruns = current_xruns >= previous_xruns && previous_xruns >= 0
+                       ? current_xruns - previous_xruns
+                       : current_xruns;
+  }
+
+  // Counters restart after CallbackStats::Reset()
+  const bool restarted = current.callbacks < previous.callbacks;
+  const CallbackStats::Snapshot empty;
+  const CallbackStats::Snapshot& base = restarted ? empty : previous;
+
+  window.callbacks = current.callbacks - base.callbacks;
+  window.deadline_misses = current.deadline_misses >= base.deadline_misses
+                               ? current.deadline_misses - base.deadline_misses
+                               : current.deadline_misses;
+  if (window.callbacks == 0 || current.period_us <= 0.0) {
+    return window;
+  }
+
+  const double total_us =
+      current.mean_duration_us * static_cast<double>(current.callbacks) -
+      base.mean_duration_us * static_cast<double>(base.callbacks);
+  window.mean_load_percent =
+      std::max(0.0, total_us / static_cast<double>(window.callbacks)) / current.period_us * 100.0;
+
+  // p90 of this window's durations from the histogram difference
+  const uint64_t target = static_cast<uint64_t>(
+      static_cast<double>(window.callbacks) * kLoadPercentile + 0.5);
+  uint64_t seen = 0;
+  for (size_t bucket = 0; bucket < CallbackStats::kDurationBuckets; ++bucket) {
+    const uint64_t now = current.duration_histogram[bucket];
+    const uint64_t before = base.duration_histogram[bucket];
+    seen += now >= before ? now - before : now;
+    if (seen >= target) {
+      const double upper_us = bucket + 1 < CallbackStats::kDurationBuckets
+                                  ? CallbackStats::DurationBucketUpperUs(bucket)
+                                  : current.max_duration_us;
+      window.p90_load_percent = upper_us / current.period_us * 100.0;
+      break;
+    }
+  }
+  return window;
+}
+
+}  // namespace core
+}  // namespace sezo
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "core/CallbackStats.h"
+
+#include <cstdint>
+
+namespace sezo {
+namespace core {
+
+/**
+ * Decides when to trade DSP quality for CPU from audio callback health.
+ *
+ * The owner feeds it one measurement window at a time (see MakeWindow());
+ * the governor answers with the quality level to run at. Level 0 is full
+ * quality and each level above it is a cheaper processing tier. Any xrun or
+ * deadline miss, or a high callback load, steps one level down in quality;
+ * a run of calm windows steps one level back up. After every step the
+ * governor holds for a few windows so the change (and the crossfade into it)
+ * shows up in the measurements before it judges again.
+ *
+ * Not thread-safe: call from one thread.
+ */
+class QualityGovernor {
+ public:
+  struct Config {
+    // Length of a measurement window
+    int32_t window_ms = 500;
+    // Callback load (p90 duration / buffer period) that steps quality down
+    double step_down_load_percent = 80.0;
+    // Windows with a p90 load below this, and no xruns or deadline misses,
+    // count as calm
+    double step_up_load_percent = 45.0;
+    // Consecutive calm windows before stepping quality back up
+    int32_t calm_windows_to_step_up = 8;
+    // Windows to ignore after a step
+    int32_t hold_windows = 2;
+    // Cheapest level allowed
+    int32_t max_level = 2;
+    // Crossfade between processing tiers
+    int32_t crossfade_ms = 50;
+  };
+
+  enum class Reason : int32_t {
+    kLoad = 0,          // p90 load reached step_down_load_percent
+    kDeadlineMiss = 1,  // a callback overran its buffer period
+    kXRun = 2,          // the device reported an underrun
+    kRecovered = 3,     // calm for calm_windows_to_step_up windows
+    kManual = 4,        // level set explicitly
+  };
+
+  /**
+   * Callback health over one measurement window.
+   */
+  struct Window {
+    uint64_t callbacks = 0;
+    double mean_load_percent = 0.0;
+    double p90_load_percent = 0.0;
+    uint64_t deadline_misses = 0;
+    int64_t xruns = 0;
+  };
+
+  /**
+   * A level change and the window that caused it.
+   */
+  struct Step {
+    int32_t level = 0;
+    int32_t previous_level = 0;
+    Reason reason = Reason::kLoad;
+    Window window;
+  };
+
+  QualityGovernor();
+  explicit QualityGovernor(const Config& config);
+
+  /**
+   * Replace the thresholds. The current level is kept (clamped to the new
+   * max_level).
+   */
+  void SetConfig(const Config& config);
+  const Config& GetConfig() const { return config_; }
+
+  /**
+   * Judge one window. Windows without callbacks (transport stopped) are
+   * skipped.
+   * @param window Measurements
+   * @param step Receives the change, if any
+   * @return true if the level changed
+   */
+  bool Evaluate(const Window& window, Step* step);
+
+  /**
+   * Force a level, e.g. to start at a cheaper tier. Restarts the hold.
+   * @param level Level (clamped to 0..max_level)
+   */
+  void SetLevel(int32_t level);
+  int32_t GetLevel() const { return level_; }
+
+  /**
+   * Return to level 0 and forget the calm/hold counts.
+   */
+  void Reset();
+
+  /**
+   * Difference between two callback statistics snapshots as a window.
+   * A reset in between (fewer callbacks than before) counts from zero, as
+   * does an xrun counter that went backwards (stream reopened).
+   * @param previous Snapshot at the start of the window
+   * @param current Snapshot at the end of the window
+   * @param previous_xruns Device xrun count at the start (-1 = unsupported)
+   * @param current_xruns Device xrun count at the end (-1 = unsupported)
+   * @return The window
+   */
+  static Window MakeWindow(const CallbackStats::Snapshot& previous,
+                           const CallbackStats::Snapshot& current,
+                           int32_t previous_xruns,
+                           int32_t current_xruns);
+
+ private:
+  bool ChangeLevel(int32_t level, Reason reason, const Window& window, Step* step);
+
+  Config config_;
+  int32_t level_ = 0;
+  int32_t calm_windows_ = 0;
+  int32_t hold_remaining_ = 0;
+};
+
+}  // namespace core
+}  // namespace sezo
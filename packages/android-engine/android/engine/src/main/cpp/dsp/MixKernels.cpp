@@ -0,0 +1,174 @@
+#include "dsp/MixKernels.h"
+
+#include <algorithm>
+
+namespace sezo {
+namespace dsp {
+
+namespace {
+
+void AccumulateMonoToStereoScalar(float* out, const float* in, size_t frames,
+                                  float gain_left, float gain_right) {
+  for (size_t i = 0; i < frames; ++i) {
+    const float sample = in[i];
+    out[i * 2] += sample * gain_left;
+    out[i * 2 + 1] += sample * gain_right;
+  }
+}
+
+void AccumulateStereoScalar(float* out, const float* in, size_t frames,
+                            float gain_left, float gain_right) {
+  for (size_t i = 0; i < frames; ++i) {
+    out[i * 2] += in[i * 2] * gain_left;
+    out[i * 2 + 1] += in[i * 2 + 1] * gain_right;
+  }
+}
+
+void AccumulateMonoToStereoRampScalar(float* out, const float* in, size_t frames,
+                                      float start_left, float start_right,
+                                      float end_left, float end_right) {
+  if (frames == 0) {
+    return;
+  }
+  const float step_left = (end_left - start_left) / static_cast<float>(frames);
+  const float step_right = (end_right - start_right) / static_cast<float>(frames);
+  for (size_t i = 0; i < frames; ++i) {
+    const float index = static_cast<float>(i);
+    const float sample = in[i];
+    out[i * 2] += sample * (start_left + step_left * index);
+    out[i * 2 + 1] += sample * (start_right + step_right * index);
+  }
+}
+
+void AccumulateStereoRampScalar(float* out, const float* in, size_t frames,
+                                float start_left, float start_right,
+                                float end_left, float end_right) {
+  if (frames == 0) {
+    return;
+  }
+  const float step_left = (end_left - start_left) / static_cast<float>(frames);
+  const float step_right = (end_right - start_right) / static_cast<float>(frames);
+  for (size_t i = 0; i < frames; ++i) {
+    const float index = static_cast<float>(i);
+    out[i * 2] += in[i * 2] * (start_left + step_left * index);
+    out[i * 2 + 1] += in[i * 2 + 1] * (start_right + step_right * index);
+  }
+}
+
+void AccumulatePlanarStereoScalar(float* out, const float* left, const float* right,
+                                  size_t frames, float gain_left, float gain_right) {
+  for (size_t i = 0; i < frames; ++i) {
+    out[i * 2] += left[i] * gain_left;
+    out[i * 2 + 1] += right[i] * gain_right;
+  }
+}
+
+void AccumulatePlanarStereoRampScalar(float* out, const float* left, const float* right,
+                                      size_t frames, float start_left, float start_right,
+                                      float end_left, float end_right) {
+  if (frames == 0) {
+    return;
+  }
+  const float step_left = (end_left - start_left) / static_cast<float>(frames);
+  const float step_right = (end_right - start_right) / static_cast<float>(frames);
+  for (size_t i = 0; i < frames; ++i) {
+    const float index = static_cast<float>(i);
+    out[i * 2] += left[i] * (start_left + step_left * index);
+    out[i * 2 + 1] += right[i] * (start_right + step_right * index);
+  }
+}
+
+void ScaleStereoScalar(float* buffer, size_t frames, float gain_left, float gain_right) {
+  for (size_t i = 0; i < frames; ++i) {
+    buffer[i * 2] *= gain_left;
+    buffer[i * 2 + 1] *= gain_right;
+  }
+}
+
+void ApplyGainAndClipScalar(float* buffer, size_t samples, float gain) {
+  for (size_t i = 0; i < samples; ++i) {
+    buffer[i] = std::clamp(buffer[i] * gain, -1.0f, 1.0f);
+  }
+}
+
+void ConvertS16ToF32Scalar(float* out, const int16_t* in, size_t samples) {
+  for (size_t i = 0; i < samples; ++i) {
+    out[i] = static_cast<float>(in[i]) * kS16ToFloat;
+  }
+}
+
+void DeinterleaveStereoScalar(float* left, float* right, const float* in, size_t frames) {
+  for (size_t i = 0; i < frames; ++i) {
+    left[i] = in[i * 2];
+    right[i] = in[i * 2 + 1];
+  }
+}
+
+void InterleaveStereoScalar(float* out, const float* left, const float* right, size_t frames) {
+  for (size_t i = 0; i < frames; ++i) {
+    out[i * 2] = left[i];
+    out[i * 2 + 1] = right[i];
+  }
+}
+
+float DotProductScalar(const float* a, const float* b, size_t count) {
+  float sum = 0.0f;
+  for (size_t i = 0; i < count; ++i) {
+    sum += a[i] * b[i];
+  }
+  return sum;
+}
+
+const MixKernels kScalarKernels = {
+    "scalar",
+    AccumulateMonoToStereoScalar,
+    AccumulateStereoScalar,
+    AccumulateMonoToStereoRampScalar,
+    AccumulateStereoRampScalar,
+    AccumulatePlanarStereoScalar,
+    AccumulatePlanarStereoRampScalar,
+    ScaleStereoScalar,
+    ApplyGainAndClipScalar,
+    ConvertS16ToF32Scalar,
+    DeinterleaveStereoScalar,
+    InterleaveStereoScalar,
+    DotProductScalar,
+};
+
+const MixKernels& ResolveMixKernels() {
+  if (const MixKernels* kernels = GetNeonMixKernels()) {
+    return *kernels;
+  }
+  if (const MixKernels* kernels = GetAvx2MixKernels()) {
+    return *kernels;
+  }
+  if (const MixKernels* kernels = GetSse2MixKernels()) {
+    return *kernels;
+  }
+  return kScalarKernels;
+}
+
+}  // namespace
+
+const MixKernels& GetMixKernels() {
+  static const MixKernels& kernels = ResolveMixKernels();
+  return kernels;
+}
+
+const MixKernels& GetScalarMixKernels() {
+  return kScalarKernels;
+}
+
+std::vector<const MixKernels*> GetAvailableMixKernels() {
+  std::vector<const MixKernels*> available = {&kScalarKernels};
+  for (const MixKernels* kernels :
+       {GetSse2MixKernels(), GetAvx2MixKernels(), GetNeonMixKernels()}) {
+    if (kernels) {
+      available.push_back(kernels);
+    }
+  }
+  return available;
+}
+
+}  // namespace dsp
+}  // namespace sezo
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sezo {
+namespace dsp {
+
+// Scale used for 16-bit PCM to float conversion (matches dr_wav).
+constexpr float kS16ToFloat = 1.0f / 32768.0f;
+
+/**
+ * Table of fused mixing, conversion and filter kernels for one instruction set.
+ * Buffers are interleaved float samples unless a kernel names separate left
+ * and right planes; no alignment is required.
+ */
+struct MixKernels {
+  const char* name;
+
+  /**
+   * Upmix a mono buffer into an interleaved stereo accumulator.
+   * out[2i] += in[i] * gain_left, out[2i + 1] += in[i] * gain_right
+   */
+  void (*accumulate_mono_to_stereo)(float* out, const float* in, size_t frames,
+                                    float gain_left, float gain_right);
+
+  /**
+   * Add an interleaved stereo buffer into a stereo accumulator.
+   * out[2i] += in[2i] * gain_left, out[2i + 1] += in[2i + 1] * gain_right
+   */
+  void (*accumulate_stereo)(float* out, const float* in, size_t frames,
+                            float gain_left, float gain_right);
+
+  /**
+   * Ramped variant of accumulate_mono_to_stereo. The gain for frame i is
+   * start + (end - start) * i / frames, so the next block starts at end.
+   */
+  void (*accumulate_mono_to_stereo_ramp)(float* out, const float* in, size_t frames,
+                                         float start_left, float start_right,
+                                         float end_left, float end_right);
+
+  /**
+   * Ramped variant of accumulate_stereo (same interpolation as above).
+   */
+  void (*accumulate_stereo_ramp)(float* out, const float* in, size_t frames,
+                                 float start_left, float start_right,
+                                 float end_left, float end_right);
+
+  /**
+   * Add planar stereo into an interleaved stereo accumulator.
+   * out[2i] += left[i] * gain_left, out[2i + 1] += right[i] * gain_right
+   */
+  void (*accumulate_planar_stereo)(float* out, const float* left, const float* right,
+                                   size_t frames, float gain_left, float gain_right);
+
+  /**
+   * Ramped variant of accumulate_planar_stereo (same interpolation as above).
+   */
+  void (*accumulate_planar_stereo_ramp)(float* out, const float* left, const float* right,
+                                        size_t frames, float start_left, float start_right,
+                                        float end_left, float end_right);
+
+  /**
+   * Scale an interleaved stereo buffer in place.
+   * buffer[2i] *= gain_left, buffer[2i + 1] *= gain_right
+   */
+  void (*scale_stereo)(float* buffer, size_t frames, float gain_left, float gain_right);
+
+  /**
+   * Apply master gain and hard-clip to [-1, 1] in a single pass.
+   * @param samples Total sample count (frames * channels)
+   */
+  void (*apply_gain_and_clip)(float* buffer, size_t samples, float gain);
+
+  /**
+   * Convert signed 16-bit PCM to float in [-1, 1).
+   * out[i] = in[i] / 32768. The input must be 2-byte aligned.
+   */
+  void (*convert_s16_to_f32)(float* out, const int16_t* in, size_t samples);
+
+  /**
+   * Split interleaved stereo into left and right planes.
+   * left[i] = in[2i], right[i] = in[2i + 1]
+   */
+  void (*deinterleave_stereo)(float* left, float* right, const float* in, size_t frames);
+
+  /**
+   * Merge left and right planes into interleaved stereo.
+   * out[2i] = left[i], out[2i + 1] = right[i]
+   */
+  void (*interleave_stereo)(float* out, const float* left, const float* right, size_t frames);
+
+  /**
+   * Inner product of two float vectors (FIR filter tap sum).
+   * @return sum(a[i] * b[i])
+   */
+  float (*dot_product)(const float* a, const float* b, size_t count);
+};
+
+/**
+ * Get the fastest kernels supported by the running CPU.
+ * Resolved once on first use; safe to call from the audio thread afterwards.
+ */
+const MixKernels& GetMixKernels();
+
+/**
+ * Get the portable scalar reference kernels.
+ */
+const MixKernels& GetScalarMixKernels();
+
+/**
+ * Get every kernel table usable on the running CPU (scalar first).
+ * Intended for tests and benchmarks.
+ */
+std::vector<const MixKernels*> GetAvailableMixKernels();
+
+// Per-ISA tables. Each returns nullptr when not compiled in for this target.
+const MixKernels* GetNeonMixKernels();
+const MixKernels* GetSse2MixKernels();
+const MixKernels* GetAvx2MixKernels();
+
+}  // namespace dsp
+}  // namespace sezo
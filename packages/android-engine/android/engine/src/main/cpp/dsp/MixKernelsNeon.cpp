@@ -0,0 +1,285 @@
+#include "dsp/MixKernels.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#include <algorithm>
+#endif
+
+namespace sezo {
+namespace dsp {
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+namespace {
+
+inline float32x4_t StereoGains(float gain_left, float gain_right) {
+  const float gains[4] = {gain_left, gain_right, gain_left, gain_right};
+  return vld1q_f32(gains);
+}
+
+void AccumulateMonoToStereoNeon(float* out, const float* in, size_t frames,
+                                float gain_left, float gain_right) {
+  const float32x4_t gains = StereoGains(gain_left, gain_right);
+  size_t i = 0;
+  for (; i + 4 <= frames; i += 4) {
+    const float32x4_t mono = vld1q_f32(in + i);
+    const float32x4x2_t pairs = vzipq_f32(mono, mono);
+    float* dst = out + i * 2;
+    vst1q_f32(dst, vmlaq_f32(vld1q_f32(dst), pairs.val[0], gains));
+    vst1q_f32(dst + 4, vmlaq_f32(vld1q_f32(dst + 4), pairs.val[1], gains));
+  }
+  for (; i < frames; ++i) {
+    out[i * 2] += in[i] * gain_left;
+    out[i * 2 + 1] += in[i] * gain_right;
+  }
+}
+
+void AccumulateStereoNeon(float* out, const float* in, size_t frames,
+                          float gain_left, float gain_right) {
+  const float32x4_t gains = StereoGains(gain_left, gain_right);
+  const size_t samples = frames * 2;
+  size_t i = 0;
+  for (; i + 8 <= samples; i += 8) {
+    vst1q_f32(out + i, vmlaq_f32(vld1q_f32(out + i), vld1q_f32(in + i), gains));
+    vst1q_f32(out + i + 4, vmlaq_f32(vld1q_f32(out + i + 4), vld1q_f32(in + i + 4), gains));
+  }
+  for (; i + 4 <= samples; i += 4) {
+    vst1q_f32(out + i, vmlaq_f32(vld1q_f32(out + i), vld1q_f32(in + i), gains));
+  }
+  for (; i < samples; i += 2) {
+    out[i] += in[i] * gain_left;
+    out[i + 1] += in[i + 1] * gain_right;
+  }
+}
+
+void AccumulateMonoToStereoRampNeon(float* out, const float* in, size_t frames,
+                                    float start_left, float start_right,
+                                    float end_left, float end_right) {
+  if (frames == 0) {
+    return;
+  }
+  const float step_left = (end_left - start_left) / static_cast<float>(frames);
+  const float step_right = (end_right - start_right) / static_cast<float>(frames);
+  const float32x4_t start = StereoGains(start_left, start_right);
+  const float32x4_t step = StereoGains(step_left, step_right);
+  const float first_index[4] = {0.0f, 0.0f, 1.0f, 1.0f};
+  float32x4_t index = vld1q_f32(first_index);
+  const float32x4_t two = vdupq_n_f32(2.0f);
+  size_t i = 0;
+  for (; i + 4 <= frames; i += 4) {
+    const float32x4_t mono = vld1q_f32(in + i);
+    const float32x4x2_t pairs = vzipq_f32(mono, mono);
+    const float32x4_t gains_lo = vmlaq_f32(start, step, index);
+    index = vaddq_f32(index, two);
+    const float32x4_t gains_hi = vmlaq_f32(start, step, index);
+    index = vaddq_f32(index, two);
+    float* dst = out + i * 2;
+    vst1q_f32(dst, vmlaq_f32(vld1q_f32(dst), pairs.val[0], gains_lo));
+    vst1q_f32(dst + 4, vmlaq_f32(vld1q_f32(dst + 4), pairs.val[1], gains_hi));
+  }
+  for (; i < frames; ++i) {
+    const float frame_index = static_cast<float>(i);
+    out[i * 2] += in[i] * (start_left + step_left * frame_index);
+    out[i * 2 + 1] += in[i] * (start_right + step_right * frame_index);
+  }
+}
+
+void AccumulateStereoRampNeon(float* out, const float* in, size_t frames,
+                              float start_left, float start_right,
+                              float end_left, float end_right) {
+  if (frames == 0) {
+    return;
+  }
+  const float step_left = (end_left - start_left) / static_cast<float>(frames);
+  const float step_right = (end_right - start_right) / static_cast<float>(frames);
+  const float32x4_t start = StereoGains(start_left, start_right);
+  const float32x4_t step = StereoGains(step_left, step_right);
+  const float first_index[4] = {0.0f, 0.0f, 1.0f, 1.0f};
+  float32x4_t index = vld1q_f32(first_index);
+  const float32x4_t two = vdupq_n_f32(2.0f);
+  const size_t samples = frames * 2;
+  size_t i = 0;
+  for (; i + 4 <= samples; i += 4) {
+    const float32x4_t gains = vmlaq_f32(start, step, index);
+    index = vaddq_f32(index, two);
+    vst1q_f32(out + i, vmlaq_f32(vld1q_f32(out + i), vld1q_f32(in + i), gains));
+  }
+  for (; i < samples; i += 2) {
+    const float frame_index = static_cast<float>(i / 2);
+    out[i] += in[i] * (start_left + step_left * frame_index);
+    out[i + 1] += in[i + 1] * (start_right + step_right * frame_index);
+  }
+}
+
+void AccumulatePlanarStereoNeon(float* out, const float* left, const float* right,
+                                size_t frames, float gain_left, float gain_right) {
+  const float32x4_t gains = StereoGains(gain_left, gain_right);
+  size_t i = 0;
+  for (; i + 4 <= frames; i += 4) {
+    const float32x4x2_t pairs = vzipq_f32(vld1q_f32(left + i), vld1q_f32(right + i));
+    float* dst = out + i * 2;
+    vst1q_f32(dst, vmlaq_f32(vld1q_f32(dst), pairs.val[0], gains));
+    vst1q_f32(dst + 4, vmlaq_f32(vld1q_f32(dst + 4), pairs.val[1], gains));
+  }
+  for (; i < frames; ++i) {
+    out[i * 2] += left[i] * gain_left;
+    out[i * 2 + 1] += right[i] * gain_right;
+  }
+}
+
+void AccumulatePlanarStereoRampNeon(float* out, const float* left, const float* right,
+                                    size_t frames, float start_left, float start_right,
+                                    float end_left, float end_right) {
+  if (frames == 0) {
+    return;
+  }
+  const float step_left = (end_left - start_left) / static_cast<float>(frames);
+  const float step_right = (end_right - start_right) / static_cast<float>(frames);
+  const float32x4_t start = StereoGains(start_left, start_right);
+  const float32x4_t step = StereoGains(step_left, step_right);
+  const float first_index[4] = {0.0f, 0.0f, 1.0f, 1.0f};
+  float32x4_t index = vld1q_f32(first_index);
+  const float32x4_t two = vdupq_n_f32(2.0f);
+  size_t i = 0;
+  for (; i + 4 <= frames; i += 4) {
+    const float32x4x2_t pairs = vzipq_f32(vld1q_f32(left + i), vld1q_f32(right + i));
+    const float32x4_t gains_lo = vmlaq_f32(start, step, index);
+    index = vaddq_f32(index, two);
+    const float32x4_t gains_hi = vmlaq_f32(start, step, index);
+    index = vaddq_f32(index, two);
+    float* dst = out + i * 2;
+    vst1q_f32(dst, vmlaq_f32(vld1q_f32(dst), pairs.val[0], gains_lo));
+    vst1q_f32(dst + 4, vmlaq_f32(vld1q_f32(dst + 4), pairs.val[1], gains_hi));
+  }
+  for (; i < frames; ++i) {
+    const float frame_index = static_cast<float>(i);
+    out[i * 2] += left[i] * (start_left + step_left * frame_index);
+    out[i * 2 + 1] += right[i] * (start_right + step_right * frame_index);
+  }
+}
+
+void ScaleStereoNeon(float* buffer, size_t frames, float gain_left, float gain_right) {
+  const float32x4_t gains = StereoGains(gain_left, gain_right);
+  const size_t samples = frames * 2;
+  size_t i = 0;
+  for (; i + 4 <= samples; i += 4) {
+    vst1q_f32(buffer + i, vmulq_f32(vld1q_f32(buffer + i), gains));
+  }
+  for (; i < samples; i += 2) {
+    buffer[i] *= gain_left;
+    buffer[i + 1] *= gain_right;
+  }
+}
+
+void ApplyGainAndClipNeon(float* buffer, size_t samples, float gain) {
+  const float32x4_t gain_v = vdupq_n_f32(gain);
+  const float32x4_t lo = vdupq_n_f32(-1.0f);
+  const float32x4_t hi = vdupq_n_f32(1.0f);
+  size_t i = 0;
+  for (; i + 4 <= samples; i += 4) {
+    const float32x4_t scaled = vmulq_f32(vld1q_f32(buffer + i), gain_v);
+    vst1q_f32(buffer + i, vminq_f32(vmaxq_f32(scaled, lo), hi));
+  }
+  for (; i < samples; ++i) {
+    buffer[i] = std::clamp(buffer[i] * gain, -1.0f, 1.0f);
+  }
+}
+
+void ConvertS16ToF32Neon(float* out, const int16_t* in, size_t samples) {
+  const float32x4_t scale = vdupq_n_f32(kS16ToFloat);
+  size_t i = 0;
+  for (; i + 8 <= samples; i += 8) {
+    const int16x8_t pcm = vld1q_s16(in + i);
+    const float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(pcm)));
+    const float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(pcm)));
+    vst1q_f32(out + i, vmulq_f32(lo, scale));
+    vst1q_f32(out + i + 4, vmulq_f32(hi, scale));
+  }
+  for (; i < samples; ++i) {
+    out[i] = static_cast<float>(in[i]) * kS16ToFloat;
+  }
+}
+
+void DeinterleaveStereoNeon(float* left, float* right, const float* in, size_t frames) {
+  size_t i = 0;
+  for (; i + 4 <= frames; i += 4) {
+    const float32x4x2_t planes = vld2q_f32(in + i * 2);
+    vst1q_f32(left + i, planes.val[0]);
+    vst1q_f32(right + i, planes.val[1]);
+  }
+  for (; i < frames; ++i) {
+    left[i] = in[i * 2];
+    right[i] = in[i * 2 + 1];
+  }
+}
+
+void InterleaveStereoNeon(float* out, const float* left, const float* right, size_t frames) {
+  size_t i = 0;
+  for (; i + 4 <= frames; i += 4) {
+    float32x4x2_t planes;
+    planes.val[0] = vld1q_f32(left + i);
+    planes.val[1] = vld1q_f32(right + i);
+    vst2q_f32(out + i * 2, planes);
+  }
+  for (; i < frames; ++i) {
+    out[i * 2] = left[i];
+    out[i * 2 + 1] = right[i];
+  }
+}
+
+float DotProductNeon(const float* a, const float* b, size_t count) {
+  float32x4_t acc0 = vdupq_n_f32(0.0f);
+  float32x4_t acc1 = vdupq_n_f32(0.0f);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+    acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+  }
+  for (; i + 4 <= count; i += 4) {
+    acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+  }
+  const float32x4_t acc = vaddq_f32(acc0, acc1);
+#if defined(__aarch64__)
+  float sum = vaddvq_f32(acc);
+#else
+  const float32x2_t pair = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+  float sum = vget_lane_f32(vpadd_f32(pair, pair), 0);
+#endif
+  for (; i < count; ++i) {
+    sum += a[i] * b[i];
+  }
+  return sum;
+}
+
+const MixKernels kNeonKernels = {
+    "neon",
+    AccumulateMonoToStereoNeon,
+    AccumulateStereoNeon,
+    AccumulateMonoToStereoRampNeon,
+    AccumulateStereoRampNeon,
+    AccumulatePlanarStereoNeon,
+    AccumulatePlanarStereoRampNeon,
+    ScaleStereoNeon,
+    ApplyGainAndClipNeon,
+    ConvertS16ToF32Neon,
+    DeinterleaveStereoNeon,
+    InterleaveStereoNeon,
+    DotProductNeon,
+};
+
+}  // namespace
+
+const MixKernels* GetNeonMixKernels() {
+  return &kNeonKernels;
+}
+
+#else
+
+const MixKernels* GetNeonMixKernels() {
+  return nullptr;
+}
+
+#endif
+
+}  // namespace dsp
+}  // namespace sezo
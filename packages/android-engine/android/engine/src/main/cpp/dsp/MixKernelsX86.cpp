@@ -0,0 +1,539 @@
+#include "dsp/MixKernels.h"
+
+#if defined(__SSE2__) && (defined(__x86_64__) || defined(__i386__))
+#define SEZO_DSP_HAS_X86 1
+#include <immintrin.h>
+#include <algorithm>
+#endif
+
+namespace sezo {
+namespace dsp {
+
+#if defined(SEZO_DSP_HAS_X86)
+
+namespace {
+
+// SSE2 ---------------------------------------------------------------------
+
+void AccumulateMonoToStereoSse2(float* out, const float* in, size_t frames,
+                                float gain_left, float gain_right) {
+  const __m128 gains = _mm_setr_ps(gain_left, gain_right, gain_left, gain_right);
+  size_t i = 0;
+  for (; i + 4 <= frames; i += 4) {
+    const __m128 mono = _mm_loadu_ps(in + i);
+    float* dst = out + i * 2;
+    const __m128 lo = _mm_mul_ps(_mm_unpacklo_ps(mono, mono), gains);
+    const __m128 hi = _mm_mul_ps(_mm_unpackhi_ps(mono, mono), gains);
+    _mm_storeu_ps(dst, _mm_add_ps(_mm_loadu_ps(dst), lo));
+    _mm_storeu_ps(dst + 4, _mm_add_ps(_mm_loadu_ps(dst + 4), hi));
+  }
+  for (; i < frames; ++i) {
+    out[i * 2] += in[i] * gain_left;
+    out[i * 2 + 1] += in[i] * gain_right;
+  }
+}
+
+void AccumulateStereoSse2(float* out, const float* in, size_t frames,
+                          float gain_left, float gain_right) {
+  const __m128 gains = _mm_setr_ps(gain_left, gain_right, gain_left, gain_right);
+  const size_t samples = frames * 2;
+  size_t i = 0;
+  for (; i + 4 <= samples; i += 4) {
+    const __m128 scaled = _mm_mul_ps(_mm_loadu_ps(in + i), gains);
+    _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), scaled));
+  }
+  for (; i < samples; i += 2) {
+    out[i] += in[i] * gain_left;
+    out[i + 1] += in[i + 1] * gain_right;
+  }
+}
+
+void AccumulateMonoToStereoRampSse2(float* out, const float* in, size_t frames,
+                                    float start_left, float start_right,
+                                    float end_left, float end_right) {
+  if (frames == 0) {
+    return;
+  }
+  const float step_left = (end_left - start_left) / static_cast<float>(frames);
+  const float step_right = (end_right - start_right) / static_cast<float>(frames);
+  const __m128 start = _mm_setr_ps(start_left, start_right, start_left, start_right);
+  const __m128 step = _mm_setr_ps(step_left, step_right, step_left, step_right);
+  const __m128 two = _mm_set1_ps(2.0f);
+  __m128 index = _mm_setr_ps(0.0f, 0.0f, 1.0f, 1.0f);
+  size_t i = 0;
+  for (; i + 4 <= frames; i += 4) {
+    const __m128 mono = _mm_loadu_ps(in + i);
+    const __m128 gains_lo = _mm_add_ps(start, _mm_mul_ps(step, index));
+    index = _mm_add_ps(index, two);
+    const __m128 gains_hi = _mm_add_ps(start, _mm_mul_ps(step, index));
+    index = _mm_add_ps(index, two);
+    float* dst = out + i * 2;
+    const __m128 lo = _mm_mul_ps(_mm_unpacklo_ps(mono, mono), gains_lo);
+    const __m128 hi = _mm_mul_ps(_mm_unpackhi_ps(mono, mono), gains_hi);
+    _mm_storeu_ps(dst, _mm_add_ps(_mm_loadu_ps(dst), lo));
+    _mm_storeu_ps(dst + 4, _mm_add_ps(_mm_loadu_ps(dst + 4), hi));
+  }
+  for (; i < frames; ++i) {
+    const float frame_index = static_cast<float>(i);
+    out[i * 2] += in[i] * (start_left + step_left * frame_index);
+    out[i * 2 + 1] += in[i] * (start_right + step_right * frame_index);
+  }
+}
+
+void AccumulateStereoRampSse2(float* out, const float* in, size_t frames,
+                              float start_left, float start_right,
+                              float end_left, float end_right) {
+  if (frames == 0) {
+    return;
+  }
+  const float step_left = (end_left - start_left) / static_cast<float>(frames);
+  const float step_right = (end_right - start_right) / static_cast<float>(frames);
+  const __m128 start = _mm_setr_ps(start_left, start_right, start_left, start_right);
+  const __m128 step = _mm_setr_ps(step_left, step_right, step_left, step_right);
+  const __m128 two = _mm_set1_ps(2.0f);
+  __m128 index = _mm_setr_ps(0.0f, 0.0f, 1.0f, 1.0f);
+  const size_t samples = frames * 2;
+  size_t i = 0;
+  for (; i + 4 <= samples; i += 4) {
+    const __m128 gains = _mm_add_ps(start, _mm_mul_ps(step, index));
+    index = _mm_add_ps(index, two);
+    const __m128 scaled = _mm_mul_ps(_mm_loadu_ps(in + i), gains);
+    _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), scaled));
+  }
+  for (; i < samples; i += 2) {
+    const float frame_index = static_cast<float>(i / 2);
+    out[i] += in[i] * (start_left + step_left * frame_index);
+    out[i + 1] += in[i + 1] * (start_right + step_right * frame_index);
+  }
+}
+
+void AccumulatePlanarStereoSse2(float* out, const float* left, const float* right,
+                                size_t frames, float gain_left, float gain_right) {
+  const __m128 gains = _mm_setr_ps(gain_left, gain_right, gain_left, gain_right);
+  size_t i = 0;
+  for (; i + 4 <= frames; i += 4) {
+    const __m128 l = _mm_loadu_ps(left + i);
+    const __m128 r = _mm_loadu_ps(right + i);
+    float* dst = out + i * 2;
+    const __m128 lo = _mm_mul_ps(_mm_unpacklo_ps(l, r), gains);
+    const __m128 hi = _mm_mul_ps(_mm_unpackhi_ps(l, r), gains);
+    _mm_storeu_ps(dst, _mm_add_ps(_mm_loadu_ps(dst), lo));
+    _mm_storeu_ps(dst + 4, _mm_add_ps(_mm_loadu_ps(dst + 4), hi));
+  }
+  for (; i < frames; ++i) {
+    out[i * 2] += left[i] * gain_left;
+    out[i * 2 + 1] += right[i] * gain_right;
+  }
+}
+
+void AccumulatePlanarStereoRampSse2(float* out, const float* left, const float* right,
+                                    size_t frames, float start_left, float start_right,
+                                    float end_left, float end_right) {
+  if (frames == 0) {
+    return;
+  }
+  const float step_left = (end_left - start_left) / static_cast<float>(frames);
+  const float step_right = (end_right - start_right) / static_cast<float>(frames);
+  const __m128 start = _mm_setr_ps(start_left, start_right, start_left, start_right);
+  const __m128 step = _mm_setr_ps(step_left, step_right, step_left, step_right);
+  const __m128 two = _mm_set1_ps(2.0f);
+  __m128 index = _mm_setr_ps(0.0f, 0.0f, 1.0f, 1.0f);
+  size_t i = 0;
+  for (; i + 4 <= frames; i += 4) {
+    const __m128 l = _mm_loadu_ps(left + i);
+    const __m128 r = _mm_loadu_ps(right + i);
+    const __m128 gains_lo = _mm_add_ps(start, _mm_mul_ps(step, index));
+    index = _mm_add_ps(index, two);
+    const __m128 gains_hi = _mm_add_ps(start, _mm_mul_ps(step, index));
+    index = _mm_add_ps(index, two);
+    float* dst = out + i * 2;
+    const __m128 lo = _mm_mul_ps(_mm_unpacklo_ps(l, r), gains_lo);
+    const __m128 hi = _mm_mul_ps(_mm_unpackhi_ps(l, r), gains_hi);
+    _mm_storeu_ps(dst, _mm_add_ps(_mm_loadu_ps(dst), lo));
+    _mm_storeu_ps(dst + 4, _mm_add_ps(_mm_loadu_ps(dst + 4), hi));
+  }
+  for (; i < frames; ++i) {
+    const float frame_index = static_cast<float>(i);
+    out[i * 2] += left[i] * (start_left + step_left * frame_index);
+    out[i * 2 + 1] += right[i] * (start_right + step_right * frame_index);
+  }
+}
+
+void ScaleStereoSse2(float* buffer, size_t frames, float gain_left, float gain_right) {
+  const __m128 gains = _mm_setr_ps(gain_left, gain_right, gain_left, gain_right);
+  const size_t samples = frames * 2;
+  size_t i = 0;
+  for (; i + 4 <= samples; i += 4) {
+    _mm_storeu_ps(buffer + i, _mm_mul_ps(_mm_loadu_ps(buffer + i), gains));
+  }
+  for (; i < samples; i += 2) {
+    buffer[i] *= gain_left;
+    buffer[i + 1] *= gain_right;
+  }
+}
+
+void ApplyGainAndClipSse2(float* buffer, size_t samples, float gain) {
+  const __m128 gain_v = _mm_set1_ps(gain);
+  const __m128 lo = _mm_set1_ps(-1.0f);
+  const __m128 hi = _mm_set1_ps(1.0f);
+  size_t i = 0;
+  for (; i + 4 <= samples; i += 4) {
+    const __m128 scaled = _mm_mul_ps(_mm_loadu_ps(buffer + i), gain_v);
+    _mm_storeu_ps(buffer + i, _mm_min_ps(_mm_max_ps(scaled, lo), hi));
+  }
+  for (; i < samples; ++i) {
+    buffer[i] = std::clamp(buffer[i] * gain, -1.0f, 1.0f);
+  }
+}
+
+void ConvertS16ToF32Sse2(float* out, const int16_t* in, size_t samples) {
+  const __m128 scale = _mm_set1_ps(kS16ToFloat);
+  size_t i = 0;
+  for (; i + 8 <= samples; i += 8) {
+    const __m128i pcm = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    // Interleave with itself and arithmetic-shift to sign-extend to 32 bits.
+    const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(pcm, pcm), 16);
+    const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(pcm, pcm), 16);
+    _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+    _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+  }
+  for (; i < samples; ++i) {
+    out[i] = static_cast<float>(in[i]) * kS16ToFloat;
+  }
+}
+
+void DeinterleaveStereoSse2(float* left, float* right, const float* in, size_t frames) {
+  size_t i = 0;
+  for (; i + 4 <= frames; i += 4) {
+    const __m128 a = _mm_loadu_ps(in + i * 2);      // l0 r0 l1 r1
+    const __m128 b = _mm_loadu_ps(in + i * 2 + 4);  // l2 r2 l3 r3
+    _mm_storeu_ps(left + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+  }
+  for (; i < frames; ++i) {
+    left[i] = in[i * 2];
+    right[i] = in[i * 2 + 1];
+  }
+}
+
+void InterleaveStereoSse2(float* out, const float* left, const float* right, size_t frames) {
+  size_t i = 0;
+  for (; i + 4 <= frames; i += 4) {
+    const __m128 l = _mm_loadu_ps(left + i);
+    const __m128 r = _mm_loadu_ps(right + i);
+    _mm_storeu_ps(out + i * 2, _mm_unpacklo_ps(l, r));
+    _mm_storeu_ps(out + i * 2 + 4, _mm_unpackhi_ps(l, r));
+  }
+  for (; i < frames; ++i) {
+    out[i * 2] = left[i];
+    out[i * 2 + 1] = right[i];
+  }
+}
+
+inline float HorizontalSum(__m128 v) {
+  const __m128 shuffled = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+  const __m128 sums = _mm_add_ps(v, shuffled);
+  return _mm_cvtss_f32(_mm_add_ss(sums, _mm_movehl_ps(shuffled, sums)));
+}
+
+float DotProductSse2(const float* a, const float* b, size_t count) {
+  __m128 acc0 = _mm_setzero_ps();
+  __m128 acc1 = _mm_setzero_ps();
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+  }
+  for (; i + 4 <= count; i += 4) {
+    acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+  }
+  float sum = HorizontalSum(_mm_add_ps(acc0, acc1));
+  for (; i < count; ++i) {
+    sum += a[i] * b[i];
+  }
+  return sum;
+}
+
+// AVX2 ---------------------------------------------------------------------
+// Compiled with a function-level target so the rest of the library keeps the
+// baseline ABI; only selected when the CPU reports AVX2 support at runtime.
+// The compiler does not insert vzeroupper before calls out of a target
+// function, so each kernel clears the upper lanes itself before handing its
+// tail to the SSE2 version; otherwise every call pays the AVX/SSE transition.
+
+#define SEZO_AVX2 __attribute__((target("avx2")))
+
+SEZO_AVX2 void AccumulateMonoToStereoAvx2(float* out, const float* in, size_t frames,
+                                          float gain_left, float gain_right) {
+  const __m256 gains = _mm256_setr_ps(gain_left, gain_right, gain_left, gain_right,
+                                      gain_left, gain_right, gain_left, gain_right);
+  size_t i = 0;
+  for (; i + 8 <= frames; i += 8) {
+    const __m256 mono = _mm256_loadu_ps(in + i);
+    const __m256 dup_lo = _mm256_unpacklo_ps(mono, mono);  // m0 m0 m1 m1 | m4 m4 m5 m5
+    const __m256 dup_hi = _mm256_unpackhi_ps(mono, mono);  // m2 m2 m3 m3 | m6 m6 m7 m7
+    const __m256 first = _mm256_permute2f128_ps(dup_lo, dup_hi, 0x20);
+    const __m256 second = _mm256_permute2f128_ps(dup_lo, dup_hi, 0x31);
+    float* dst = out + i * 2;
+    _mm256_storeu_ps(dst, _mm256_add_ps(_mm256_loadu_ps(dst), _mm256_mul_ps(first, gains)));
+    _mm256_storeu_ps(dst + 8,
+                     _mm256_add_ps(_mm256_loadu_ps(dst + 8), _mm256_mul_ps(second, gains)));
+  }
+  _mm256_zeroupper();
+  AccumulateMonoToStereoSse2(out + i * 2, in + i, frames - i, gain_left, gain_right);
+}
+
+SEZO_AVX2 void AccumulateStereoAvx2(float* out, const float* in, size_t frames,
+                                    float gain_left, float gain_right) {
+  const __m256 gains = _mm256_setr_ps(gain_left, gain_right, gain_left, gain_right,
+                                      gain_left, gain_right, gain_left, gain_right);
+  const size_t samples = frames * 2;
+  size_t i = 0;
+  for (; i + 8 <= samples; i += 8) {
+    const __m256 scaled = _mm256_mul_ps(_mm256_loadu_ps(in + i), gains);
+    _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(out + i), scaled));
+  }
+  _mm256_zeroupper();
+  AccumulateStereoSse2(out + i, in + i, (samples - i) / 2, gain_left, gain_right);
+}
+
+SEZO_AVX2 void AccumulateMonoToStereoRampAvx2(float* out, const float* in, size_t frames,
+                                              float start_left, float start_right,
+                                              float end_left, float end_right) {
+  if (frames == 0) {
+    return;
+  }
+  const float step_left = (end_left - start_left) / static_cast<float>(frames);
+  const float step_right = (end_right - start_right) / static_cast<float>(frames);
+  const __m256 start = _mm256_setr_ps(start_left, start_right, start_left, start_right,
+                                      start_left, start_right, start_left, start_right);
+  const __m256 step = _mm256_setr_ps(step_left, step_right, step_left, step_right,
+                                     step_left, step_right, step_left, step_right);
+  const __m256 four = _mm256_set1_ps(4.0f);
+  __m256 index = _mm256_setr_ps(0.0f, 0.0f, 1.0f, 1.0f, 2.0f, 2.0f, 3.0f, 3.0f);
+  size_t i = 0;
+  for (; i + 8 <= frames; i += 8) {
+    const __m256 mono = _mm256_loadu_ps(in + i);
+    const __m256 dup_lo = _mm256_unpacklo_ps(mono, mono);
+    const __m256 dup_hi = _mm256_unpackhi_ps(mono, mono);
+    const __m256 first = _mm256_permute2f128_ps(dup_lo, dup_hi, 0x20);
+    const __m256 second = _mm256_permute2f128_ps(dup_lo, dup_hi, 0x31);
+    const __m256 gains_first = _mm256_add_ps(start, _mm256_mul_ps(step, index));
+    index = _mm256_add_ps(index, four);
+    const __m256 gains_second = _mm256_add_ps(start, _mm256_mul_ps(step, index));
+    index = _mm256_add_ps(index, four);
+    float* dst = out + i * 2;
+    _mm256_storeu_ps(dst, _mm256_add_ps(_mm256_loadu_ps(dst),
+                                        _mm256_mul_ps(first, gains_first)));
+    _mm256_storeu_ps(dst + 8, _mm256_add_ps(_mm256_loadu_ps(dst + 8),
+                                            _mm256_mul_ps(second, gains_second)));
+  }
+  for (; i < frames; ++i) {
+    const float frame_index = static_cast<float>(i);
+    out[i * 2] += in[i] * (start_left + step_left * frame_index);
+    out[i * 2 + 1] += in[i] * (start_right + step_right * frame_index);
+  }
+}
+
+SEZO_AVX2 void AccumulateStereoRampAvx2(float* out, const float* in, size_t frames,
+                                        float start_left, float start_right,
+                                        float end_left, float end_right) {
+  if (frames == 0) {
+    return;
+  }
+  const float step_left = (end_left - start_left) / static_cast<float>(frames);
+  const float step_right = (end_right - start_right) / static_cast<float>(frames);
+  const __m256 start = _mm256_setr_ps(start_left, start_right, start_left, start_right,
+                                      start_left, start_right, start_left, start_right);
+  const __m256 step = _mm256_setr_ps(step_left, step_right, step_left, step_right,
+                                     step_left, step_right, step_left, step_right);
+  const __m256 four = _mm256_set1_ps(4.0f);
+  __m256 index = _mm256_setr_ps(0.0f, 0.0f, 1.0f, 1.0f, 2.0f, 2.0f, 3.0f, 3.0f);
+  const size_t samples = frames * 2;
+  size_t i = 0;
+  for (; i + 8 <= samples; i += 8) {
+    const __m256 gains = _mm256_add_ps(start, _mm256_mul_ps(step, index));
+    index = _mm256_add_ps(index, four);
+    const __m256 scaled = _mm256_mul_ps(_mm256_loadu_ps(in + i), gains);
+    _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(out + i), scaled));
+  }
+  for (; i < samples; i += 2) {
+    const float frame_index = static_cast<float>(i / 2);
+    out[i] += in[i] * (start_left + step_left * frame_index);
+    out[i + 1] += in[i + 1] * (start_right + step_right * frame_index);
+  }
+}
+
+SEZO_AVX2 void AccumulatePlanarStereoAvx2(float* out, const float* left, const float* right,
+                                          size_t frames, float gain_left, float gain_right) {
+  const __m256 gains = _mm256_setr_ps(gain_left, gain_right, gain_left, gain_right,
+                                      gain_left, gain_right, gain_left, gain_right);
+  size_t i = 0;
+  for (; i + 8 <= frames; i += 8) {
+    const __m256 l = _mm256_loadu_ps(left + i);
+    const __m256 r = _mm256_loadu_ps(right + i);
+    const __m256 pairs_lo = _mm256_unpacklo_ps(l, r);  // l0 r0 l1 r1 | l4 r4 l5 r5
+    const __m256 pairs_hi = _mm256_unpackhi_ps(l, r);  // l2 r2 l3 r3 | l6 r6 l7 r7
+    const __m256 first = _mm256_permute2f128_ps(pairs_lo, pairs_hi, 0x20);
+    const __m256 second = _mm256_permute2f128_ps(pairs_lo, pairs_hi, 0x31);
+    float* dst = out + i * 2;
+    _mm256_storeu_ps(dst, _mm256_add_ps(_mm256_loadu_ps(dst), _mm256_mul_ps(first, gains)));
+    _mm256_storeu_ps(dst + 8,
+                     _mm256_add_ps(_mm256_loadu_ps(dst + 8), _mm256_mul_ps(second, gains)));
+  }
+  _mm256_zeroupper();
+  AccumulatePlanarStereoSse2(out + i * 2, left + i, right + i, frames - i,
+                             gain_left, gain_right);
+}
+
+SEZO_AVX2 void AccumulatePlanarStereoRampAvx2(float* out, const float* left, const float* right,
+                                              size_t frames, float start_left, float start_right,
+                                              float end_left, float end_right) {
+  if (frames == 0) {
+    return;
+  }
+  const float step_left = (end_left - start_left) / static_cast<float>(frames);
+  const float step_right = (end_right - start_right) / static_cast<float>(frames);
+  const __m256 start = _mm256_setr_ps(start_left, start_right, start_left, start_right,
+                                      start_left, start_right, start_left, start_right);
+  const __m256 step = _mm256_setr_ps(step_left, step_right, step_left, step_right,
+                                     step_left, step_right, step_left, step_right);
+  const __m256 four = _mm256_set1_ps(4.0f);
+  __m256 index = _mm256_setr_ps(0.0f, 0.0f, 1.0f, 1.0f, 2.0f, 2.0f, 3.0f, 3.0f);
+  size_t i = 0;
+  for (; i + 8 <= frames; i += 8) {
+    const __m256 l = _mm256_loadu_ps(left + i);
+    const __m256 r = _mm256_loadu_ps(right + i);
+    const __m256 pairs_lo = _mm256_unpacklo_ps(l, r);
+    const __m256 pairs_hi = _mm256_unpackhi_ps(l, r);
+    const __m256 first = _mm256_permute2f128_ps(pairs_lo, pairs_hi, 0x20);
+    const __m256 second = _mm256_permute2f128_ps(pairs_lo, pairs_hi, 0x31);
+    const __m256 gains_first = _mm256_add_ps(start, _mm256_mul_ps(step, index));
+    index = _mm256_add_ps(index, four);
+    const __m256 gains_second = _mm256_add_ps(start, _mm256_mul_ps(step, index));
+    index = _mm256_add_ps(index, four);
+    float* dst = out + i * 2;
+    _mm256_storeu_ps(dst, _mm256_add_ps(_mm256_loadu_ps(dst),
+                                        _mm256_mul_ps(first, gains_first)));
+    _mm256_storeu_ps(dst + 8, _mm256_add_ps(_mm256_loadu_ps(dst + 8),
+                                            _mm256_mul_ps(second, gains_second)));
+  }
+  for (; i < frames; ++i) {
+    const float frame_index = static_cast<float>(i);
+    out[i * 2] += left[i] * (start_left + step_left * frame_index);
+    out[i * 2 + 1] += right[i] * (start_right + step_right * frame_index);
+  }
+}
+
+SEZO_AVX2 void ScaleStereoAvx2(float* buffer, size_t frames, float gain_left, float gain_right) {
+  const __m256 gains = _mm256_setr_ps(gain_left, gain_right, gain_left, gain_right,
+                                      gain_left, gain_right, gain_left, gain_right);
+  const size_t samples = frames * 2;
+  size_t i = 0;
+  for (; i + 8 <= samples; i += 8) {
+    _mm256_storeu_ps(buffer + i, _mm256_mul_ps(_mm256_loadu_ps(buffer + i), gains));
+  }
+  _mm256_zeroupper();
+  ScaleStereoSse2(buffer + i, (samples - i) / 2, gain_left, gain_right);
+}
+
+SEZO_AVX2 void ApplyGainAndClipAvx2(float* buffer, size_t samples, float gain) {
+  const __m256 gain_v = _mm256_set1_ps(gain);
+  const __m256 lo = _mm256_set1_ps(-1.0f);
+  const __m256 hi = _mm256_set1_ps(1.0f);
+  size_t i = 0;
+  for (; i + 8 <= samples; i += 8) {
+    const __m256 scaled = _mm256_mul_ps(_mm256_loadu_ps(buffer + i), gain_v);
+    _mm256_storeu_ps(buffer + i, _mm256_min_ps(_mm256_max_ps(scaled, lo), hi));
+  }
+  _mm256_zeroupper();
+  ApplyGainAndClipSse2(buffer + i, samples - i, gain);
+}
+
+SEZO_AVX2 void ConvertS16ToF32Avx2(float* out, const int16_t* in, size_t samples) {
+  const __m256 scale = _mm256_set1_ps(kS16ToFloat);
+  size_t i = 0;
+  for (; i + 8 <= samples; i += 8) {
+    const __m128i pcm = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    const __m256 widened = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(pcm));
+    _mm256_storeu_ps(out + i, _mm256_mul_ps(widened, scale));
+  }
+  _mm256_zeroupper();
+  ConvertS16ToF32Sse2(out + i, in + i, samples - i);
+}
+
+SEZO_AVX2 float DotProductAvx2(const float* a, const float* b, size_t count) {
+  __m256 acc0 = _mm256_setzero_ps();
+  __m256 acc1 = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    acc1 = _mm256_add_ps(acc1,
+                         _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+  }
+  const __m256 acc = _mm256_add_ps(acc0, acc1);
+  const __m128 folded = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+  const float sum = HorizontalSum(folded);
+  _mm256_zeroupper();
+  return sum + DotProductSse2(a + i, b + i, count - i);
+}
+
+#undef SEZO_AVX2
+
+const MixKernels kSse2Kernels = {
+    "sse2",
+    AccumulateMonoToStereoSse2,
+    AccumulateStereoSse2,
+    AccumulateMonoToStereoRampSse2,
+    AccumulateStereoRampSse2,
+    AccumulatePlanarStereoSse2,
+    AccumulatePlanarStereoRampSse2,
+    ScaleStereoSse2,
+    ApplyGainAndClipSse2,
+    ConvertS16ToF32Sse2,
+    DeinterleaveStereoSse2,
+    InterleaveStereoSse2,
+    DotProductSse2,
+};
+
+const MixKernels kAvx2Kernels = {
+    "avx2",
+    AccumulateMonoToStereoAvx2,
+    AccumulateStereoAvx2,
+    AccumulateMonoToStereoRampAvx2,
+    AccumulateStereoRampAvx2,
+    AccumulatePlanarStereoAvx2,
+    AccumulatePlanarStereoRampAvx2,
+    ScaleStereoAvx2,
+    ApplyGainAndClipAvx2,
+    ConvertS16ToF32Avx2,
+    DeinterleaveStereoSse2,  // shuffle-bound; 256-bit lanes do not help
+    InterleaveStereoSse2,
+    DotProductAvx2,
+};
+
+}  // namespace
+
+const MixKernels* GetSse2MixKernels() {
+  return &kSse2Kernels;
+}
+
+const MixKernels* GetAvx2MixKernels() {
+  static const bool supported = __builtin_cpu_supports("avx2");
+  return supported ? &kAvx2Kernels : nullptr;
+}
+
+#else
+
+const MixKernels* GetSse2MixKernels() {
+  return nullptr;
+}
+
+const MixKernels* GetAvx2MixKernels() {
+  return nullptr;
+}
+
+#endif
+
+}  // namespace dsp
+}  // namespace sezo
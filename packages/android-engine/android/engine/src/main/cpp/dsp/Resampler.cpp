@@ -0,0 +1,145 @@
+#include "dsp/Resampler.h"
+
+#include "dsp/MixKernels.h"
+#include "dsp/SincFilter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace sezo {
+namespace dsp {
+
+namespace {
+
+// Cutoff relative to the lower of the two Nyquist frequencies; leaves room
+// for the transition band of a 32-tap filter.
+constexpr double kCutoffScale = 0.9;
+
+constexpr uint64_t kFixedPointOne = uint64_t{1} << 32;
+
+size_t PhaseCount(int32_t input_rate, int32_t output_rate) {
+  const uint64_t divisor = std::gcd(static_cast<uint64_t>(input_rate),
+                                    static_cast<uint64_t>(output_rate));
+  const uint64_t up = static_cast<uint64_t>(output_rate) / divisor;
+  return up <= Resampler::kMaxExactPhases ? static_cast<size_t>(up) : Resampler::kMaxExactPhases;
+}
+
+size_t MaxInputFrames(double ratio, size_t max_block_frames) {
+  return static_cast<size_t>(std::ceil(static_cast<double>(max_block_frames) / ratio)) + 2;
+}
+
+}  // namespace
+
+Resampler::Resampler(int32_t input_rate, int32_t output_rate, int32_t channels,
+                     size_t max_block_frames)
+    : input_rate_(std::max(1, input_rate)),
+      output_rate_(std::max(1, output_rate)),
+      channels_(std::max(1, channels)) {
+  const uint64_t divisor = std::gcd(static_cast<uint64_t>(input_rate_),
+                                    static_cast<uint64_t>(output_rate_));
+  const uint64_t up = static_cast<uint64_t>(output_rate_) / divisor;
+  const uint64_t down = static_cast<uint64_t>(input_rate_) / divisor;
+
+  if (up <= kMaxExactPhases) {
+    num_phases_ = static_cast<size_t>(up);
+    denominator_ = up;
+    step_int_ = down / up;
+    step_frac_ = down % up;
+  } else {
+    num_phases_ = kMaxExactPhases;
+    denominator_ = kFixedPointOne;
+    const uint64_t step = (down << 32) / up;
+    step_int_ = step >> 32;
+    step_frac_ = step & (kFixedPointOne - 1);
+  }
+
+  const double cutoff = 0.5 * std::min(1.0, GetRatio()) * kCutoffScale;
+  filter_bank_ = AcquireSincFilterBank(kTapsPerPhase, num_phases_, cutoff);
+
+  const size_t max_input = MaxInputFrames(GetRatio(), max_block_frames);
+  work_.resize(static_cast<size_t>(channels_));
+  for (auto& channel : work_) {
+    channel.reserve(kTapsPerPhase + max_input);
+  }
+  Reset();
+}
+
+Resampler::~Resampler() = default;
+
+size_t Resampler::EstimateMemoryBytes(int32_t input_rate, int32_t output_rate, int32_t channels,
+                                      size_t max_block_frames) {
+  input_rate = std::max(1, input_rate);
+  output_rate = std::max(1, output_rate);
+  const double ratio = static_cast<double>(output_rate) / static_cast<double>(input_rate);
+  const size_t work_floats = static_cast<size_t>(std::max(1, channels)) *
+                             (kTapsPerPhase + MaxInputFrames(ratio, max_block_frames));
+  const size_t bank_floats = PhaseCount(input_rate, output_rate) * kTapsPerPhase;
+  return (work_floats + bank_floats) * sizeof(float);
+}
+
+void Resampler::Reset() {
+  for (auto& channel : work_) {
+    channel.assign(kTapsPerPhase, 0.0f);
+  }
+  frac_ = 0;
+  // Start with the filter centred on the first input frame so the output is
+  // not delayed by the filter length.
+  pending_advance_ = kTapsPerPhase / 2 + 1;
+}
+
+size_t Resampler::GetInputFramesNeeded(size_t output_frames) const {
+  const uint64_t frames = static_cast<uint64_t>(output_frames);
+  const uint64_t frac_total = frac_ + frames * step_frac_;
+  return pending_advance_ + static_cast<size_t>(frames * step_int_ + frac_total / denominator_);
+}
+
+void Resampler::Process(const float* input, size_t input_frames, float* output,
+                        size_t output_frames) {
+  const size_t needed = GetInputFramesNeeded(output_frames);
+  const size_t copy_frames = std::min(input_frames, needed);
+  const size_t channels = static_cast<size_t>(channels_);
+
+  // Deinterleave after the history so each channel's taps are contiguous.
+  for (size_t c = 0; c < channels; ++c) {
+    std::vector<float>& channel = work_[c];
+    channel.resize(kTapsPerPhase + needed);
+    float* dst = channel.data() + kTapsPerPhase;
+    for (size_t i = 0; i < copy_frames; ++i) {
+      dst[i] = input[i * channels + c];
+    }
+    std::fill(dst + copy_frames, dst + needed, 0.0f);
+  }
+
+  const MixKernels& kernels = GetMixKernels();
+  const float* bank = filter_bank_->data();
+  size_t position = pending_advance_;
+  uint64_t frac = frac_;
+  for (size_t n = 0; n < output_frames; ++n) {
+    const size_t phase = static_cast<size_t>((frac * num_phases_) / denominator_);
+    const float* taps = bank + phase * kTapsPerPhase;
+    for (size_t c = 0; c < channels; ++c) {
+      output[n * channels + c] =
+          kernels.dot_product(taps, work_[c].data() + position, kTapsPerPhase);
+    }
+    position += static_cast<size_t>(step_int_);
+    frac += step_frac_;
+    if (frac >= denominator_) {
+      frac -= denominator_;
+      ++position;
+    }
+  }
+
+  // position == needed here; keep the trailing window as history.
+  for (size_t c = 0; c < channels; ++c) {
+    std::vector<float>& channel = work_[c];
+    std::memmove(channel.data(), channel.data() + position, kTapsPerPhase * sizeof(float));
+    channel.resize(kTapsPerPhase);
+  }
+  frac_ = frac;
+  pending_advance_ = 0;
+}
+
+}  // namespace dsp
+}  // namespace sezo
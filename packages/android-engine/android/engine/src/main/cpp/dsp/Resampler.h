@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace sezo {
+namespace dsp {
+
+/**
+ * Streaming polyphase sample-rate converter.
+ *
+ * Uses a Kaiser-windowed sinc filter bank with kTapsPerPhase taps per phase.
+ * When the reduced rate ratio has at most kMaxExactPhases output phases the
+ * conversion is exact (e.g. 44.1k <-> 48k uses 147/160 phases); otherwise the
+ * position is tracked in 32.32 fixed point and the nearest of kMaxExactPhases
+ * phases is used. Filter banks are computed once per ratio and shared between
+ * instances.
+ *
+ * The output is time-aligned with the input (no added latency): the filter's
+ * look-ahead is primed from the first block of input.
+ */
+class Resampler {
+ public:
+  static constexpr size_t kTapsPerPhase = 32;
+  static constexpr size_t kMaxExactPhases = 1024;
+
+  /**
+   * Constructor.
+   * @param input_rate Source sample rate in Hz
+   * @param output_rate Destination sample rate in Hz
+   * @param channels Interleaved channel count
+   * @param max_block_frames Output block size to pre-allocate for
+   */
+  Resampler(int32_t input_rate, int32_t output_rate, int32_t channels,
+            size_t max_block_frames = 4096);
+  ~Resampler();
+
+  /**
+   * Heap use of an instance with these settings: its work buffers and the
+   * filter bank. Banks are shared between instances with the same ratio,
+   * so summing this over several instances overestimates.
+   */
+  static size_t EstimateMemoryBytes(int32_t input_rate, int32_t output_rate, int32_t channels,
+                                    size_t max_block_frames = 4096);
+
+  /**
+   * Number of input frames the next Process() call must be given.
+   * @param output_frames Frames that will be requested
+   * @return Required input frames
+   */
+  size_t GetInputFramesNeeded(size_t output_frames) const;
+
+  /**
+   * Convert one block.
+   * Missing input (fewer than GetInputFramesNeeded()) is treated as silence;
+   * extra input is ignored.
+   * @param input Interleaved input samples
+   * @param input_frames Input frame count
+   * @param output Interleaved output samples
+   * @param output_frames Output frames to produce
+   */
+  void Process(const float* input, size_t input_frames, float* output, size_t output_frames);
+
+  /**
+   * Clear filter history (e.g. after a seek).
+   */
+  void Reset();
+
+  int32_t GetInputRate() const { return input_rate_; }
+  int32_t GetOutputRate() const { return output_rate_; }
+  int32_t GetChannels() const { return channels_; }
+
+  /**
+   * Output frames per input frame.
+   */
+  double GetRatio() const {
+    return static_cast<double>(output_rate_) / static_cast<double>(input_rate_);
+  }
+
+ private:
+  int32_t input_rate_;
+  int32_t output_rate_;
+  int32_t channels_;
+
+  // Position stepping: each output advances the input position by
+  // step_int_ + step_frac_ / denominator_ frames.
+  uint64_t step_int_ = 0;
+  uint64_t step_frac_ = 0;
+  uint64_t denominator_ = 1;
+  uint64_t frac_ = 0;
+  size_t num_phases_ = 1;
+  size_t pending_advance_ = 0;
+
+  std::shared_ptr<const std::vector<float>> filter_bank_;
+
+  // Planar per-channel work buffers: kTapsPerPhase frames of history
+  // followed by the current block's input.
+  std::vector<std::vector<float>> work_;
+};
+
+}  // namespace dsp
+}  // namespace sezo
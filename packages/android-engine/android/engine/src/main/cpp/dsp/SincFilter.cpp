@@ -0,0 +1,86 @@
+#include "dsp/SincFilter.h"
+
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace sezo {
+namespace dsp {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Kaiser beta ~70 dB stopband attenuation.
+constexpr double kKaiserBeta = 7.0;
+
+double BesselI0(double x) {
+  double sum = 1.0;
+  double term = 1.0;
+  const double half_x = x * 0.5;
+  for (int k = 1; k < 50; ++k) {
+    term *= (half_x / k) * (half_x / k);
+    sum += term;
+    if (term < sum * 1e-12) {
+      break;
+    }
+  }
+  return sum;
+}
+
+std::vector<float> DesignFilterBank(size_t taps, size_t num_phases, double cutoff) {
+  const double half_width = static_cast<double>(taps) / 2.0;
+  const double center = half_width - 1.0;
+  const double i0_beta = BesselI0(kKaiserBeta);
+
+  std::vector<float> bank(num_phases * taps);
+  std::vector<double> phase_taps(taps);
+  for (size_t phase = 0; phase < num_phases; ++phase) {
+    const double offset = static_cast<double>(phase) / static_cast<double>(num_phases);
+    double sum = 0.0;
+    for (size_t j = 0; j < taps; ++j) {
+      const double x = static_cast<double>(j) - center - offset;
+      const double arg = 2.0 * cutoff * x;
+      const double sinc = (std::abs(arg) < 1e-12) ? 1.0 : std::sin(kPi * arg) / (kPi * arg);
+      const double ratio = x / half_width;
+      const double window =
+          (std::abs(ratio) >= 1.0) ? 0.0
+                                   : BesselI0(kKaiserBeta * std::sqrt(1.0 - ratio * ratio)) / i0_beta;
+      phase_taps[j] = sinc * window;
+      sum += phase_taps[j];
+    }
+    // Normalize each phase to unity DC gain.
+    for (size_t j = 0; j < taps; ++j) {
+      bank[phase * taps + j] = static_cast<float>(phase_taps[j] / sum);
+    }
+  }
+  return bank;
+}
+
+}  // namespace
+
+// Shared between resamplers with the same design, so a session of tracks at
+// one file rate pays for it once.
+std::shared_ptr<const std::vector<float>> AcquireSincFilterBank(size_t taps,
+                                                                size_t num_phases,
+                                                                double cutoff) {
+  static std::mutex cache_mutex;
+  static std::map<std::tuple<size_t, size_t, double>, std::weak_ptr<const std::vector<float>>>
+      cache;
+
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  const auto key = std::make_tuple(taps, num_phases, cutoff);
+  auto it = cache.find(key);
+  if (it != cache.end()) {
+    if (auto bank = it->second.lock()) {
+      return bank;
+    }
+  }
+  auto bank = std::make_shared<const std::vector<float>>(DesignFilterBank(taps, num_phases, cutoff));
+  cache[key] = bank;
+  return bank;
+}
+
+}  // namespace dsp
+}  // namespace sezo
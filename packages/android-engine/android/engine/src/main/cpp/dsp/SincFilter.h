@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace sezo {
+namespace dsp {
+
+/**
+ * Polyphase Kaiser-windowed sinc filter bank, shared by the resamplers.
+ *
+ * The bank holds num_phases rows of taps coefficients. Row p interpolates at
+ * a fractional offset of p / num_phases frames past tap taps / 2 - 1, and
+ * each row is normalized to unity DC gain. Banks are computed once per
+ * (taps, phases, cutoff) and shared between instances.
+ *
+ * @param taps Taps per phase
+ * @param num_phases Number of phases
+ * @param cutoff Cutoff frequency relative to the sample rate (0.5 = Nyquist)
+ * @return Shared coefficient table
+ */
+std::shared_ptr<const std::vector<float>> AcquireSincFilterBank(size_t taps,
+                                                                size_t num_phases,
+                                                                double cutoff);
+
+}  // namespace dsp
+}  // namespace sezo
@@ -0,0 +1,245 @@
+#include "dsp/Varispeed.h"
+
+#include "dsp/MixKernels.h"
+#include "dsp/SincFilter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace sezo {
+namespace dsp {
+
+namespace {
+
+constexpr size_t kTaps = Varispeed::kSincTaps;
+
+// Window index of the frame the next output is interpolated from. Cubic
+// interpolation reads the same window at kCenter - 1 .. kCenter + 2.
+constexpr size_t kCenter = kTaps / 2 - 1;
+
+constexpr int kFractionBits = 32;
+constexpr uint64_t kFractionMask = (uint64_t{1} << kFractionBits) - 1;
+constexpr int kPhaseShift = kFractionBits - 8;  // 256 phases
+static_assert((size_t{1} << (kFractionBits - kPhaseShift)) == Varispeed::kSincPhases,
+              "phase shift must match the phase count");
+
+// Cutoff relative to Nyquist at unit rate; leaves room for the transition
+// band of a 32-tap filter.
+constexpr double kCutoffScale = 0.9;
+
+// Rates the sinc banks are designed for. Above 1 the cutoff scales down
+// with the rate so speeding up does not alias.
+constexpr double kBankRates[] = {1.0, 1.25, 1.5, 2.0, 3.0, Varispeed::kMaxRate};
+
+inline float CubicAt(const float* window, float t) {
+  // Catmull-Rom through window[kCenter - 1 .. kCenter + 2]
+  const float xm1 = window[kCenter - 1];
+  const float x0 = window[kCenter];
+  const float x1 = window[kCenter + 1];
+  const float x2 = window[kCenter + 2];
+  return x0 + 0.5f * t *
+                  (x1 - xm1 +
+                   t * (2.0f * xm1 - 5.0f * x0 + 4.0f * x1 - x2 +
+                        t * (3.0f * (x0 - x1) + x2 - xm1)));
+}
+
+}  // namespace
+
+Varispeed::Varispeed(int32_t channels, size_t max_block_frames)
+    : channels_(std::max(1, channels)) {
+  for (double bank_rate : kBankRates) {
+    sinc_banks_.push_back(
+        AcquireSincFilterBank(kTaps, kSincPhases, 0.5 * kCutoffScale / bank_rate));
+  }
+  const size_t max_input =
+      static_cast<size_t>(std::ceil(static_cast<double>(max_block_frames) * kMaxRate)) + kTaps;
+  work_.resize(static_cast<size_t>(channels_));
+  interleaved_outputs_.resize(static_cast<size_t>(channels_));
+  for (auto& channel : work_) {
+    channel.reserve(kTaps + max_input);
+  }
+  SetRate(1.0);
+  Reset();
+}
+
+Varispeed::~Varispeed() = default;
+
+void Varispeed::SetRate(double rate) {
+  rate_ = std::clamp(rate, kMinRate, kMaxRate);
+  step_ = static_cast<uint64_t>(std::llround(rate_ * static_cast<double>(uint64_t{1} << kFractionBits)));
+}
+
+void Varispeed::Reset() {
+  for (auto& channel : work_) {
+    channel.assign(kTaps, 0.0f);
+  }
+  frac_ = 0;
+  // Start with the window centred on the first input frame so the output
+  // is not delayed by the filter length.
+  pending_advance_ = kTaps - kCenter;
+  primed_ = false;
+  draining_ = false;
+  drain_position_ = 0;
+}
+
+size_t Varispeed::GetInputFramesNeeded(size_t output_frames) const {
+  const uint64_t advance = frac_ + static_cast<uint64_t>(output_frames) * step_;
+  return pending_advance_ + static_cast<size_t>(advance >> kFractionBits);
+}
+
+size_t Varispeed::GetLeadFrames() const {
+  if (!primed_) {
+    return 0;
+  }
+  const size_t start = draining_ ? drain_position_ : kCenter + (frac_ != 0 ? 1 : 0);
+  return kTaps - start;
+}
+
+size_t Varispeed::PrepareInput(size_t output_frames) {
+  const size_t needed = GetInputFramesNeeded(output_frames);
+  for (auto& channel : work_) {
+    channel.resize(kTaps + needed);
+  }
+  return needed;
+}
+
+void Varispeed::Process(const float* input, size_t input_frames, float* output,
+                        size_t output_frames) {
+  const size_t needed = PrepareInput(output_frames);
+  const size_t copy_frames = std::min(input_frames, needed);
+  const size_t channels = static_cast<size_t>(channels_);
+
+  // Deinterleave after the history so each channel's window is contiguous
+  for (size_t c = 0; c < channels; ++c) {
+    float* dst = work_[c].data() + kTaps;
+    for (size_t i = 0; i < copy_frames; ++i) {
+      dst[i] = input[i * channels + c];
+    }
+    std::fill(dst + copy_frames, dst + needed, 0.0f);
+  }
+
+  for (size_t c = 0; c < channels; ++c) {
+    interleaved_outputs_[c] = output + c;
+  }
+  Render(interleaved_outputs_.data(), channels, output_frames);
+}
+
+void Varispeed::ProcessPlanar(const PlanarInput& input, float* const* output,
+                              size_t output_frames) {
+  const size_t needed = PrepareInput(output_frames);
+  const size_t available = std::min(input.available_frames, needed);
+  const size_t first = std::min(input.first_frames, available);
+  const size_t channels = std::min<size_t>(static_cast<size_t>(channels_), 2);
+
+  for (size_t c = 0; c < channels; ++c) {
+    float* dst = work_[c].data() + kTaps;
+    if (first > 0) {
+      std::memcpy(dst, input.first[c], first * sizeof(float));
+    }
+    if (available > first) {
+      std::memcpy(dst + first, input.second[c], (available - first) * sizeof(float));
+    }
+    std::fill(dst + available, dst + needed, 0.0f);
+  }
+  Render(output, 1, output_frames);
+}
+
+void Varispeed::Render(float* const* output, size_t stride, size_t output_frames) {
+  const size_t channels = work_.size();
+  if (!primed_) {
+    // Extend the first frame backwards instead of starting from a step out
+    // of silence
+    for (auto& channel : work_) {
+      std::fill(channel.begin(), channel.begin() + kTaps, channel[kTaps]);
+    }
+  }
+
+  const size_t start = pending_advance_;
+  const uint64_t start_frac = frac_;
+  size_t position = start;
+  uint64_t frac = start_frac;
+  if (quality_ == Quality::kSinc) {
+    const size_t bank_index = static_cast<size_t>(
+        std::lower_bound(std::begin(kBankRates), std::end(kBankRates), rate_) -
+        std::begin(kBankRates));
+    const float* bank = sinc_banks_[std::min(bank_index, sinc_banks_.size() - 1)]->data();
+    const MixKernels& kernels = GetMixKernels();
+    for (size_t c = 0; c < channels; ++c) {
+      const float* samples = work_[c].data();
+      float* out = output[c];
+      position = start;
+      frac = start_frac;
+      for (size_t n = 0; n < output_frames; ++n) {
+        const float* taps = bank + (frac >> kPhaseShift) * kTaps;
+        out[n * stride] = kernels.dot_product(taps, samples + position, kTaps);
+        frac += step_;
+        position += static_cast<size_t>(frac >> kFractionBits);
+        frac &= kFractionMask;
+      }
+    }
+  } else {
+    constexpr float kFractionScale = 1.0f / static_cast<float>(uint64_t{1} << kFractionBits);
+    for (size_t c = 0; c < channels; ++c) {
+      const float* samples = work_[c].data();
+      float* out = output[c];
+      position = start;
+      frac = start_frac;
+      for (size_t n = 0; n < output_frames; ++n) {
+        out[n * stride] = CubicAt(samples + position, static_cast<float>(frac) * kFractionScale);
+        frac += step_;
+        position += static_cast<size_t>(frac >> kFractionBits);
+        frac &= kFractionMask;
+      }
+    }
+  }
+
+  // position == needed here; keep the trailing window as history
+  for (auto& channel : work_) {
+    std::memmove(channel.data(), channel.data() + position, kTaps * sizeof(float));
+    channel.resize(kTaps);
+  }
+  frac_ = frac;
+  pending_advance_ = 0;
+  primed_ = true;
+  draining_ = false;
+}
+
+size_t Varispeed::Drain(float* output, size_t max_frames) {
+  const size_t channels = static_cast<size_t>(channels_);
+  for (size_t c = 0; c < channels; ++c) {
+    interleaved_outputs_[c] = output + c;
+  }
+  return DrainTo(interleaved_outputs_.data(), channels, max_frames);
+}
+
+size_t Varispeed::DrainPlanar(float* const* output, size_t max_frames) {
+  return DrainTo(output, 1, max_frames);
+}
+
+size_t Varispeed::DrainTo(float* const* output, size_t stride, size_t max_frames) {
+  const size_t lead = GetLeadFrames();
+  if (lead == 0) {
+    return 0;
+  }
+  if (!draining_) {
+    // A fractional position rounds up to the next whole frame
+    draining_ = true;
+    drain_position_ = kTaps - lead;
+  }
+  const size_t frames = std::min(max_frames, lead);
+  for (size_t c = 0; c < work_.size(); ++c) {
+    const float* samples = work_[c].data() + drain_position_;
+    for (size_t i = 0; i < frames; ++i) {
+      output[c][i * stride] = samples[i];
+    }
+  }
+  drain_position_ += frames;
+  if (drain_position_ >= kTaps) {
+    Reset();
+  }
+  return frames;
+}
+
+}  // namespace dsp
+}  // namespace sezo
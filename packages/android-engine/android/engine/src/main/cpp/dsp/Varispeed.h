@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace sezo {
+namespace dsp {
+
+/**
+ * Streaming variable-rate resampler for tape-style speed changes.
+ *
+ * Playing at rate r reads r input frames per output frame, so speed and
+ * pitch change together, at a small fraction of the cost of a phase-vocoder
+ * time-stretch. The rate may change between blocks; the read position is
+ * tracked in 32.32 fixed point, so rate changes are continuous.
+ *
+ * Two quality tiers are available:
+ * - kCubic: 4-point Catmull-Rom interpolation. Cheapest; speeding up aliases
+ *   a little since nothing band-limits the input.
+ * - kSinc: kSincTaps-tap Kaiser-windowed sinc with kSincPhases phases. When
+ *   speeding up, the cutoff drops with the rate so the output stays
+ *   band-limited.
+ * Both tiers read the same window position, so the tier can be switched
+ * between blocks without a discontinuity.
+ *
+ * Like Resampler, the output is time-aligned with the input: the filter's
+ * look-ahead is read from the first block after Reset(). Those frames stay
+ * inside the resampler (GetLeadFrames()); Drain() hands them back at unit
+ * rate so a caller can return to reading its input directly without
+ * skipping audio.
+ *
+ * Not thread-safe: configure and process from one thread.
+ */
+class Varispeed {
+ public:
+  enum class Quality : int32_t {
+    kCubic = 0,
+    kSinc = 1,
+  };
+
+  static constexpr size_t kSincTaps = 32;
+  static constexpr size_t kSincPhases = 256;
+  static constexpr double kMinRate = 0.25;
+  static constexpr double kMaxRate = 4.0;
+
+  /**
+   * Non-interleaved input that may wrap around a ring buffer: frame i of
+   * channel c is first[c][i] below first_frames, second[c][i - first_frames]
+   * after that, and silence from available_frames on.
+   */
+  struct PlanarInput {
+    const float* first[2] = {nullptr, nullptr};
+    size_t first_frames = 0;
+    const float* second[2] = {nullptr, nullptr};
+    size_t available_frames = 0;
+  };
+
+  /**
+   * Constructor.
+   * @param channels Channel count (planar input supports up to 2)
+   * @param max_block_frames Output block size to pre-allocate for
+   */
+  explicit Varispeed(int32_t channels, size_t max_block_frames = 4096);
+  ~Varispeed();
+
+  Varispeed(const Varispeed&) = delete;
+  Varispeed& operator=(const Varispeed&) = delete;
+
+  /**
+   * Set the playback rate for the following blocks.
+   * @param rate Input frames per output frame (clamped to kMinRate..kMaxRate)
+   */
+  void SetRate(double rate);
+  double GetRate() const { return rate_; }
+
+  void SetQuality(Quality quality) { quality_ = quality; }
+  Quality GetQuality() const { return quality_; }
+
+  /**
+   * Number of input frames the next Process() call must be given.
+   * @param output_frames Frames that will be requested
+   * @return Required input frames
+   */
+  size_t GetInputFramesNeeded(size_t output_frames) const;
+
+  /**
+   * Resample one block.
+   * Missing input (fewer than GetInputFramesNeeded()) is treated as silence;
+   * extra input is ignored.
+   * @param input Interleaved input samples
+   * @param input_frames Input frame count
+   * @param output Interleaved output samples
+   * @param output_frames Output frames to produce
+   */
+  void Process(const float* input, size_t input_frames, float* output, size_t output_frames);
+
+  /**
+   * Planar variant of Process(): reads the input planes in place and writes
+   * one plane per channel. Mono and stereo only.
+   * @param input Channel planes (see PlanarInput); GetInputFramesNeeded()
+   *        frames are consumed
+   * @param output One output plane per channel, output_frames long
+   * @param output_frames Output frames to produce
+   */
+  void ProcessPlanar(const PlanarInput& input, float* const* output, size_t output_frames);
+
+  /**
+   * Input frames already consumed but not yet played: the look-ahead read
+   * since the last Reset(). 0 before the first Process() call.
+   */
+  size_t GetLeadFrames() const;
+
+  /**
+   * Play out the look-ahead at unit rate, ending exactly where the consumed
+   * input ends. Once GetLeadFrames() reaches 0 the resampler is reset.
+   * @param output Interleaved output
+   * @param max_frames Frames available in output
+   * @return Frames written
+   */
+  size_t Drain(float* output, size_t max_frames);
+
+  /**
+   * Planar variant of Drain().
+   */
+  size_t DrainPlanar(float* const* output, size_t max_frames);
+
+  /**
+   * Clear history and look-ahead (e.g. after a seek).
+   */
+  void Reset();
+
+  int32_t GetChannels() const { return channels_; }
+
+ private:
+  size_t PrepareInput(size_t output_frames);
+  void Render(float* const* output, size_t stride, size_t output_frames);
+  size_t DrainTo(float* const* output, size_t stride, size_t max_frames);
+
+  int32_t channels_;
+  double rate_ = 1.0;
+  Quality quality_ = Quality::kSinc;
+
+  // Input position: each output advances it by step_ / 2^32 frames.
+  uint64_t step_ = 0;
+  uint64_t frac_ = 0;
+  size_t pending_advance_ = 0;
+  bool primed_ = false;
+  bool draining_ = false;
+  size_t drain_position_ = 0;
+
+  // Sinc banks designed for increasing rates; the first one whose rate is at
+  // least the current rate is used.
+  std::vector<std::shared_ptr<const std::vector<float>>> sinc_banks_;
+
+  // Planar per-channel work buffers: kSincTaps frames of history followed by
+  // the current block's input.
+  std::vector<std::vector<float>> work_;
+  std::vector<float*> interleaved_outputs_;
+};
+
+}  // namespace dsp
+}  // namespace sezo
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <chrono>
+
+namespace sezo {
+namespace extraction {
+
+/**
+ * How often a waiting extraction thread re-checks its cancel flag. Cancel
+ * flags are plain atomics owned by the caller and nobody notifies the waiter
+ * when one flips, so every wait that must notice cancellation is bounded by
+ * this interval.
+ */
+constexpr auto kCancelPollInterval = std::chrono::milliseconds(5);
+
+}  // namespace extraction
+}  // namespace sezo
@@ -6,15 +6,22 @@
 #include "audio/MP3Encoder.h"
 #include "audio/WAVDecoder.h"
 #include "audio/WAVEncoder.h"
+#include "dsp/Resampler.h"
+#include "dsp/Varispeed.h"
+#include "extraction/PipelinedEncoder.h"
+#include "playback/RenderPool.h"
 #include "playback/TimeStretch.h"
 
 #include <android/log.h>
 #include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <cctype>
 #include <cmath>
 #include <cstring>
 #include <limits>
+#include <numeric>
+#include <thread>
 
 #define LOG_TAG "ExtractionPipeline"
 #define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
@@ -25,6 +32,36 @@ namespace {
 constexpr float kPi = 3.14159265358979323846f;
 constexpr float kProgressStep = 0.01f;
 
+// Output frames rendered and dropped after a seek, on top of the stretcher's
+// latency, so the resampling filters (up to 32 taps) start with history.
+constexpr int64_t kSeekFilterPrerollFrames = 64;
+constexpr size_t kSeekBlockFrames = 4096;
+
+// Decoder frame to seek to so the resampler restarts on the same filter
+// phase as a render from the top: a whole number of rate-ratio periods
+// (147 input frames for 44.1k -> 48k), at or before `output_frame`.
+// Ratios with a period longer than a seek block round down to the nearest
+// frame instead. *landed_frame receives the output frame that is reached.
+int64_t AlignedDecoderFrame(const sezo::dsp::Resampler& resampler,
+                            int64_t output_frame,
+                            int64_t* landed_frame) {
+  const int64_t input_rate = resampler.GetInputRate();
+  const int64_t output_rate = resampler.GetOutputRate();
+  const int64_t divisor = std::gcd(input_rate, output_rate);
+  const int64_t input_period = input_rate / divisor;
+  const int64_t output_period = output_rate / divisor;
+  if (output_period > static_cast<int64_t>(kSeekBlockFrames)) {
+    const int64_t decoder_frame = static_cast<int64_t>(
+        std::floor(static_cast<double>(output_frame) / resampler.GetRatio()));
+    *landed_frame = static_cast<int64_t>(
+        std::floor(static_cast<double>(decoder_frame) * resampler.GetRatio()));
+    return decoder_frame;
+  }
+  const int64_t periods = output_frame / output_period;
+  *landed_frame = periods * output_period;
+  return periods * input_period;
+}
+
 bool HasExtension(const std::string& path, const char* extension) {
   const size_t path_len = path.size();
   const size_t ext_len = std::strlen(extension);
@@ -61,6 +98,12 @@ struct OfflineTrackState {
   std::shared_ptr<sezo::playback::Track> track;
   std::unique_ptr<sezo::audio::AudioDecoder> decoder;
   std::unique_ptr<sezo::playback::TimeStretch> time_stretcher;
+  std::unique_ptr<sezo::dsp::Resampler> resampler;
+  std::vector<float> resample_input_buffer;
+  int64_t resample_source_frames = 0;
+  int64_t resample_output_frames = 0;
+  bool source_drained = false;
+  std::unique_ptr<sezo::dsp::Varispeed> varispeed;
   std::vector<float> stretch_input_buffer;
   double stretch_input_fraction = 0.0;
   int32_t channels = 0;
@@ -74,7 +117,10 @@ struct OfflineTrackState {
   bool finished = false;
 };
 
-bool InitOfflineState(OfflineTrackState& state, bool include_effects, std::string* error) {
+bool InitOfflineState(OfflineTrackState& state,
+                      int32_t output_sample_rate,
+                      bool include_effects,
+                      std::string* error) {
   if (!state.track) {
     if (error) {
       *error = "Track is null";
@@ -99,6 +145,21 @@ bool InitOfflineState(OfflineTrackState& state, bool include_effects, std::strin
 
   state.channels = state.decoder->GetFormat().channels;
   state.total_frames = state.decoder->GetFormat().total_frames;
+
+  // Render at the requested output rate; everything after the decoder
+  // (time-stretch, mixing, encoding) then runs at that rate.
+  const int32_t source_rate = state.decoder->GetFormat().sample_rate;
+  if (output_sample_rate <= 0) {
+    output_sample_rate = source_rate;
+  }
+  if (source_rate > 0 && source_rate != output_sample_rate && state.channels > 0) {
+    state.resampler = std::make_unique<sezo::dsp::Resampler>(
+        source_rate, output_sample_rate, state.channels);
+    if (state.total_frames > 0) {
+      state.total_frames = static_cast<int64_t>(
+          std::ceil(static_cast<double>(state.total_frames) * state.resampler->GetRatio()));
+    }
+  }
   state.volume = state.track->GetVolume();
   state.pan = state.track->GetPan();
   state.muted = state.track->IsMuted();
@@ -107,7 +168,7 @@ bool InitOfflineState(OfflineTrackState& state, bool include_effects, std::strin
 
   if (include_effects && state.channels > 0 && state.channels <= 2) {
     state.time_stretcher = std::make_unique<sezo::playback::TimeStretch>(
-        state.decoder->GetFormat().sample_rate,
+        output_sample_rate,
         state.channels);
     state.time_stretcher->SetPitchSemitones(state.track->GetPitchSemitones());
     state.time_stretcher->SetStretchFactor(state.track->GetStretchFactor());
@@ -116,6 +177,17 @@ bool InitOfflineState(OfflineTrackState& state, bool include_effects, std::strin
     }
   }
 
+  // Tracks in varispeed mode resample instead, like playback
+  if (state.time_stretcher && state.track->IsVarispeed()) {
+    const float speed = state.time_stretcher->GetStretchFactor();
+    state.time_stretcher.reset();
+    if (speed != 1.0f) {
+      state.varispeed = std::make_unique<sezo::dsp::Varispeed>(state.channels);
+      state.varispeed->SetRate(speed);
+      state.varispeed->SetQuality(state.track->GetVarispeedQuality());
+    }
+  }
+
   return true;
 }
 
@@ -135,12 +207,56 @@ void ApplyVolumePan(float* buffer, size_t frames, int32_t channels, float volume
 }
 
 double GetStretchFactor(const OfflineTrackState& state, bool include_effects) {
-  if (!include_effects || !state.time_stretcher) {
+  if (!include_effects) {
+    return 1.0;
+  }
+  if (state.varispeed) {
+    return state.varispeed->GetRate();
+  }
+  if (!state.time_stretcher) {
     return 1.0;
   }
   return static_cast<double>(state.time_stretcher->GetStretchFactor());
 }
 
+// Read decoded frames at the output sample rate.
+size_t ReadSourceFrames(OfflineTrackState& state, float* output, size_t frames) {
+  if (!state.resampler) {
+    return state.decoder->Read(output, frames);
+  }
+
+  const size_t input_frames = state.resampler->GetInputFramesNeeded(frames);
+  const size_t input_samples = input_frames * static_cast<size_t>(state.channels);
+  if (state.resample_input_buffer.size() < input_samples) {
+    state.resample_input_buffer.resize(input_samples);
+  }
+
+  size_t frames_read = 0;
+  if (!state.source_drained) {
+    frames_read = state.decoder->Read(state.resample_input_buffer.data(), input_frames);
+    state.resample_source_frames += static_cast<int64_t>(frames_read);
+    if (frames_read < input_frames) {
+      state.source_drained = true;
+    }
+  }
+
+  size_t output_frames = frames;
+  if (state.source_drained) {
+    // Stop once the output covers the decoded input (including the filter tail)
+    const int64_t expected = static_cast<int64_t>(std::ceil(
+        static_cast<double>(state.resample_source_frames) * state.resampler->GetRatio()));
+    const int64_t remaining = std::max<int64_t>(0, expected - state.resample_output_frames);
+    output_frames = static_cast<size_t>(std::min<int64_t>(remaining, static_cast<int64_t>(frames)));
+  }
+  if (output_frames == 0) {
+    return 0;
+  }
+
+  state.resampler->Process(state.resample_input_buffer.data(), frames_read, output, output_frames);
+  state.resample_output_frames += static_cast<int64_t>(output_frames);
+  return output_frames;
+}
+
 size_t RenderOfflineTrack(
     OfflineTrackState& state,
     float* output,
@@ -163,6 +279,31 @@ size_t RenderOfflineTrack(
     return frames;
   }
 
+  if (include_effects && state.varispeed) {
+    const size_t input_frames = state.varispeed->GetInputFramesNeeded(frames);
+    const size_t input_samples = input_frames * static_cast<size_t>(state.channels);
+    if (state.stretch_input_buffer.size() < input_samples) {
+      state.stretch_input_buffer.resize(input_samples);
+    }
+
+    const size_t frames_read = ReadSourceFrames(
+        state, state.stretch_input_buffer.data(), input_frames);
+    if (frames_read == 0) {
+      if (input_frames_read) {
+        *input_frames_read = 0;
+      }
+      return 0;
+    }
+
+    state.varispeed->Process(state.stretch_input_buffer.data(), frames_read, output, frames);
+    ApplyVolumePan(output, frames, state.channels, state.volume, state.pan);
+
+    if (input_frames_read) {
+      *input_frames_read = frames_read;
+    }
+    return frames;
+  }
+
   const bool use_time_stretch = include_effects && state.time_stretcher &&
       state.time_stretcher->IsActive() && (state.channels == 1 || state.channels == 2);
 
@@ -181,8 +322,8 @@ size_t RenderOfflineTrack(
       state.stretch_input_buffer.resize(input_samples);
     }
 
-    const size_t frames_read = state.decoder->Read(
-        state.stretch_input_buffer.data(), input_frames);
+    const size_t frames_read = ReadSourceFrames(
+        state, state.stretch_input_buffer.data(), input_frames);
     if (frames_read == 0) {
       if (input_frames_read) {
         *input_frames_read = 0;
@@ -207,7 +348,7 @@ size_t RenderOfflineTrack(
     return frames;
   }
 
-  const size_t frames_read = state.decoder->Read(output, frames);
+  const size_t frames_read = ReadSourceFrames(state, output, frames);
   if (frames_read == 0) {
     if (input_frames_read) {
       *input_frames_read = 0;
@@ -228,6 +369,218 @@ size_t RenderOfflineTrack(
   return frames_read;
 }
 
+// One track's share of a mixdown block. Each job renders into its own
+// buffer, so the blocks can be summed in track order whichever thread
+// rendered them. Stem exports also give the job the track's encoder, so
+// the block is written by the thread that rendered it.
+struct MixdownJob {
+  OfflineTrackState* state = nullptr;
+  std::vector<float>* buffer = nullptr;
+  sezo::audio::AudioEncoder* encoder = nullptr;
+  size_t offset_frames = 0;
+  size_t frames = 0;
+  size_t frames_read = 0;
+  size_t input_frames_read = 0;
+  bool write_failed = false;
+};
+
+struct MixdownBatch {
+  std::vector<MixdownJob> jobs;
+  bool include_effects = true;
+};
+
+void RenderMixdownJob(void* context, size_t index) {
+  auto* batch = static_cast<MixdownBatch*>(context);
+  MixdownJob& job = batch->jobs[index];
+  job.frames_read = RenderOfflineTrack(*job.state, job.buffer->data(), job.frames,
+                                       batch->include_effects, &job.input_frames_read);
+  if (job.encoder && job.frames_read > 0) {
+    job.write_failed = !job.encoder->Write(job.buffer->data(), job.frames_read);
+  }
+}
+
+// Start a freshly initialized track at output frame `output_frame` of its
+// own render (counted from its first frame). The decoder seeks to just
+// before it and the rest is rendered and dropped, so the stretcher and the
+// resampling filters hold the same history as when rendering from the top.
+// If the decoder cannot seek, everything up to the frame is rendered and
+// dropped instead.
+void SeekOfflineTrack(OfflineTrackState& state, int64_t output_frame, bool include_effects) {
+  if (output_frame <= 0 || !state.decoder || state.channels <= 0) {
+    return;
+  }
+
+  double stretch = GetStretchFactor(state, include_effects);
+  if (stretch <= 0.0) {
+    stretch = 1.0;
+  }
+  int64_t preroll = 0;
+  if (include_effects && state.time_stretcher) {
+    preroll += state.time_stretcher->GetLatencyFrames();
+  }
+  if (state.resampler || (include_effects && (state.time_stretcher || state.varispeed))) {
+    preroll += kSeekFilterPrerollFrames;
+  }
+  preroll = std::min(preroll, output_frame);
+
+  // Muted tracks render silence without reading, so only the count moves
+  const int64_t skipped = output_frame - preroll;
+  if (skipped > 0 && !state.muted) {
+    // Input position at the output rate, then at the decoder's rate
+    int64_t source_frame = std::llround(static_cast<double>(skipped) * stretch);
+    int64_t decoder_frame = source_frame;
+    if (state.resampler) {
+      decoder_frame = AlignedDecoderFrame(*state.resampler, source_frame, &source_frame);
+    }
+    if (state.decoder->Seek(decoder_frame)) {
+      state.resample_source_frames = decoder_frame;
+      state.resample_output_frames = source_frame;
+      state.input_frames_processed = source_frame;
+      // Landing early (phase alignment) lengthens the pre-roll to match
+      preroll = output_frame -
+                static_cast<int64_t>(std::floor(static_cast<double>(source_frame) / stretch));
+    } else {
+      LOGD("Decoder cannot seek; rendering up to the range start");
+      preroll = output_frame;
+    }
+  } else if (skipped > 0) {
+    state.input_frames_processed = std::llround(static_cast<double>(skipped) * stretch);
+  }
+
+  std::vector<float> scratch(kSeekBlockFrames * static_cast<size_t>(state.channels));
+  while (preroll > 0) {
+    const size_t frames = static_cast<size_t>(
+        std::min<int64_t>(preroll, static_cast<int64_t>(kSeekBlockFrames)));
+    size_t input_frames_read = 0;
+    const size_t rendered = RenderOfflineTrack(state, scratch.data(), frames, include_effects,
+                                               &input_frames_read);
+    if (rendered == 0) {
+      state.finished = true;
+      break;
+    }
+    state.input_frames_processed += static_cast<int64_t>(
+        input_frames_read > 0 ? input_frames_read : rendered);
+    preroll -= static_cast<int64_t>(frames);
+  }
+}
+
+// Add a track block to the mix, matching the mix's channel count.
+void MixInto(float* mix, int32_t mix_channels, const float* block, int32_t block_channels,
+             size_t frames) {
+  if (block_channels == mix_channels) {
+    for (size_t i = 0; i < frames * static_cast<size_t>(mix_channels); ++i) {
+      mix[i] += block[i];
+    }
+  } else if (block_channels == 1 && mix_channels == 2) {
+    for (size_t i = 0; i < frames; ++i) {
+      mix[i * 2] += block[i];
+      mix[i * 2 + 1] += block[i];
+    }
+  } else if (block_channels == 2 && mix_channels == 1) {
+    for (size_t i = 0; i < frames; ++i) {
+      mix[i] += 0.5f * (block[i * 2] + block[i * 2 + 1]);
+    }
+  }
+}
+
+// Output frames a track renders in total, or -1 if its length is unknown.
+int64_t ExpectedOutputFrames(const OfflineTrackState& state, bool include_effects) {
+  if (state.total_frames <= 0) {
+    return -1;
+  }
+  double stretch = GetStretchFactor(state, include_effects);
+  if (stretch <= 0.0) {
+    stretch = 1.0;
+  }
+  return static_cast<int64_t>(std::ceil(static_cast<double>(state.total_frames) / stretch));
+}
+
+double RealtimeFactor(int64_t frames,
+                      int32_t sample_rate,
+                      std::chrono::steady_clock::time_point started) {
+  const double elapsed = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - started).count();
+  if (elapsed <= 0.0 || sample_rate <= 0) {
+    return 0.0;
+  }
+  return static_cast<double>(frames) / static_cast<double>(sample_rate) / elapsed;
+}
+
+// Render buffers a stem holds during a stem export: its block plus the
+// decode/stretch and resample scratch, at up to two channels.
+constexpr size_t kStemBufferBytesPerFrame = 3 * 2 * sizeof(float);
+
+// Rough state of an open decoder (MediaCodec buffers for M4A; dr_libs
+// readers are much smaller).
+constexpr size_t kDecoderStateBytes = 64 * 1024;
+
+// A range end, when given, must come after the start.
+bool IsValidRange(const sezo::extraction::ExtractionConfig& config) {
+  return config.range_start_frames >= 0 && config.range_end_frames >= 0 &&
+         (config.range_end_frames == 0 ||
+          config.range_end_frames > config.range_start_frames);
+}
+
+size_t QueueDepth(const sezo::extraction::ExtractionConfig& config) {
+  return config.encode_queue_blocks > 0 ? static_cast<size_t>(config.encode_queue_blocks) : 0;
+}
+
+// Rough memory of one output file: the codec's own state (LAME and
+// MediaCodec keep frame buffers; WAV is written straight through) plus the
+// blocks queued ahead of it.
+size_t EstimateEncoderBytes(const sezo::extraction::ExtractionConfig& config,
+                            int32_t channels,
+                            size_t block_frames) {
+  size_t codec_bytes = 16 * 1024;
+  switch (config.format) {
+    case sezo::audio::EncoderFormat::kMP3:
+      codec_bytes = 320 * 1024;
+      break;
+    case sezo::audio::EncoderFormat::kAAC:
+    case sezo::audio::EncoderFormat::kM4A:
+      codec_bytes = 256 * 1024;
+      break;
+    default:
+      break;
+  }
+  const size_t block_bytes = block_frames * static_cast<size_t>(channels) * sizeof(float);
+  return codec_bytes + std::max<size_t>(QueueDepth(config), 1) * block_bytes;
+}
+
+// Rough memory a stem holds while its pass runs: render buffers, decoder,
+// resampler, time-stretcher and encoder, sized like InitOfflineState()
+// will create them.
+size_t EstimateStemBytes(const sezo::playback::Track& track,
+                         const sezo::extraction::ExtractionConfig& config,
+                         size_t block_frames) {
+  const int32_t channels = std::clamp(track.GetChannels(), 1, 2);
+  const int32_t source_rate = track.GetSampleRate();
+  const int32_t output_rate = config.sample_rate > 0 ? config.sample_rate : source_rate;
+
+  size_t bytes = block_frames * kStemBufferBytesPerFrame + kDecoderStateBytes +
+                 EstimateEncoderBytes(config, channels, block_frames);
+  if (source_rate > 0 && source_rate != output_rate) {
+    bytes += sezo::dsp::Resampler::EstimateMemoryBytes(source_rate, output_rate, channels,
+                                                       block_frames);
+  }
+  const bool stretched = std::abs(track.GetPitchSemitones()) > 0.01f ||
+                         std::abs(track.GetStretchFactor() - 1.0f) > 0.01f;
+  if (config.include_effects && stretched && !track.IsVarispeed()) {
+    bytes += sezo::playback::TimeStretch::EstimateMemoryBytes(output_rate, channels);
+  }
+  return bytes;
+}
+
+// Why the encode pipeline stopped taking blocks: cancellation, or a write
+// that failed on the encode thread.
+std::string EncodeStopReason(const std::atomic<bool>* cancel_flag) {
+  if (cancel_flag && cancel_flag->load(std::memory_order_acquire)) {
+    return "Extraction cancelled";
+  }
+  LOGE("Failed to write to encoder");
+  return "Failed to write to encoder";
+}
+
 }  // namespace
 
 namespace sezo {
@@ -271,10 +624,16 @@ ExtractionResult ExtractionPipeline::ExtractTrack(
     LOGE("%s", result.error_message.c_str());
     return result;
   }
+  if (!IsValidRange(config)) {
+    result.error_message = "Invalid extraction range";
+    LOGE("%s", result.error_message.c_str());
+    return result;
+  }
 
   OfflineTrackState state;
   state.track = track;
-  if (!InitOfflineState(state, config.include_effects, &result.error_message)) {
+  if (!InitOfflineState(state, config.sample_rate, config.include_effects,
+                        &result.error_message)) {
     LOGE("%s", result.error_message.c_str());
     return result;
   }
@@ -309,16 +668,27 @@ ExtractionResult ExtractionPipeline::ExtractTrack(
 
   LOGD("Extracting track '%s' to '%s'", track->GetId().c_str(), output_path.c_str());
 
+  // Render blocks, written by the encode thread while the next is rendered
+  PipelinedEncoder pipelined_encoder(encoder.get(), state.channels, kRenderBufferFrames,
+                                     QueueDepth(config), cancel_flag);
+
+  const auto started = std::chrono::steady_clock::now();
+  const int64_t range_start = std::max<int64_t>(0, config.range_start_frames);
+  SeekOfflineTrack(state, range_start, config.include_effects);
+
   // Get track duration
   const int64_t total_frames = state.total_frames;
-  int64_t input_frames_processed = 0;
+  const int64_t first_input_frame = state.input_frames_processed;
+  int64_t input_frames_processed = first_input_frame;
+  // Output frames still to export when the range has an end
+  const int64_t range_frames =
+      config.range_end_frames > 0 ? config.range_end_frames - range_start : -1;
+  int64_t range_frames_left = range_frames;
   float last_progress = -1.0f;
 
-  // Render buffer
-  std::vector<float> buffer(kRenderBufferFrames * state.channels);
-
   bool success = true;
-  while (total_frames <= 0 || input_frames_processed < total_frames) {
+  while (!state.finished && range_frames_left != 0 &&
+         (total_frames <= 0 || input_frames_processed < total_frames)) {
     if (cancel_flag && cancel_flag->load(std::memory_order_acquire)) {
       result.error_message = "Extraction cancelled";
       success = false;
@@ -339,33 +709,49 @@ ExtractionResult ExtractionPipeline::ExtractTrack(
         frames_to_render = 1;
       }
     }
+    if (range_frames_left > 0) {
+      frames_to_render = static_cast<size_t>(
+          std::min<int64_t>(range_frames_left, static_cast<int64_t>(frames_to_render)));
+    }
+
+    float* buffer = pipelined_encoder.AcquireBlock();
+    if (!buffer) {
+      result.error_message = EncodeStopReason(cancel_flag);
+      success = false;
+      break;
+    }
 
     // Render audio from track
     size_t input_frames_read = 0;
     size_t frames_rendered = RenderOfflineTrack(
-        state, buffer.data(), frames_to_render, config.include_effects, &input_frames_read);
+        state, buffer, frames_to_render, config.include_effects, &input_frames_read);
 
     if (frames_rendered == 0) {
       // End of track
       break;
     }
 
-    // Write to encoder
-    if (!encoder->Write(buffer.data(), frames_rendered)) {
-      result.error_message = "Failed to write to encoder";
-      LOGE("%s", result.error_message.c_str());
+    // Hand the block to the encoder
+    if (!pipelined_encoder.SubmitBlock(frames_rendered)) {
+      result.error_message = EncodeStopReason(cancel_flag);
       success = false;
       break;
     }
 
     input_frames_processed += static_cast<int64_t>(
         input_frames_read > 0 ? input_frames_read : frames_rendered);
+    if (range_frames_left > 0) {
+      range_frames_left -= static_cast<int64_t>(frames_rendered);
+    }
 
-    // Report progress
-    if (progress_callback && total_frames > 0 &&
+    // Report progress over the range, or the rest of the track
+    if (progress_callback && (range_frames > 0 || total_frames > first_input_frame) &&
         !(cancel_flag && cancel_flag->load(std::memory_order_acquire))) {
-      float progress = static_cast<float>(input_frames_processed) /
-                       static_cast<float>(total_frames);
+      float progress = range_frames > 0
+          ? static_cast<float>(range_frames - range_frames_left) /
+                static_cast<float>(range_frames)
+          : static_cast<float>(input_frames_processed - first_input_frame) /
+                static_cast<float>(total_frames - first_input_frame);
       progress = std::min(1.0f, std::max(0.0f, progress));
       if (progress >= 1.0f || progress - last_progress >= kProgressStep) {
         last_progress = progress;
@@ -379,6 +765,12 @@ ExtractionResult ExtractionPipeline::ExtractTrack(
     }
   }
 
+  if (success && !pipelined_encoder.Finish()) {
+    result.error_message = EncodeStopReason(cancel_flag);
+    success = false;
+  }
+  pipelined_encoder.Abort();
+
   // Close encoder
   if (!encoder->Close()) {
     result.error_message = "Failed to close encoder";
@@ -391,12 +783,14 @@ ExtractionResult ExtractionPipeline::ExtractTrack(
   result.file_size = encoder->GetFileSize();
   result.bitrate = config.bitrate;
   result.success = success;
+  result.realtime_factor = RealtimeFactor(result.duration_samples, config.sample_rate, started);
 
   if (success) {
-    LOGD("Successfully extracted track '%s': %lld frames, %lld bytes",
+    LOGD("Successfully extracted track '%s': %lld frames, %lld bytes, %.1fx realtime",
          track->GetId().c_str(),
          static_cast<long long>(result.duration_samples),
-         static_cast<long long>(result.file_size));
+         static_cast<long long>(result.file_size),
+         result.realtime_factor);
   } else if (cancel_flag && cancel_flag->load(std::memory_order_acquire)) {
     std::remove(output_path.c_str());
   }
@@ -420,6 +814,11 @@ ExtractionResult ExtractionPipeline::ExtractMixedTracks(
     LOGE("%s", result.error_message.c_str());
     return result;
   }
+  if (!IsValidRange(config)) {
+    result.error_message = "Invalid extraction range";
+    LOGE("%s", result.error_message.c_str());
+    return result;
+  }
 
   // Verify all tracks are loaded
   for (const auto& track : tracks) {
@@ -436,7 +835,7 @@ ExtractionResult ExtractionPipeline::ExtractMixedTracks(
     OfflineTrackState state;
     state.track = track;
     std::string error;
-    if (!InitOfflineState(state, config.include_effects, &error)) {
+    if (!InitOfflineState(state, config.sample_rate, config.include_effects, &error)) {
       result.error_message = error;
       LOGE("%s", result.error_message.c_str());
       return result;
@@ -510,27 +909,69 @@ ExtractionResult ExtractionPipeline::ExtractMixedTracks(
     }
   }
 
+  // Export [range_start, range_end) of the timeline; range_end < 0 = to the end
+  const int64_t range_start = std::max<int64_t>(0, config.range_start_frames);
+  int64_t range_end = -1;
+  if (config.range_end_frames > 0) {
+    range_end = has_unknown_duration
+                    ? config.range_end_frames
+                    : std::min(config.range_end_frames, total_output_frames);
+  } else if (!has_unknown_duration) {
+    range_end = total_output_frames;
+  }
+
   float last_progress = -1.0f;
 
-  // Render buffer
-  std::vector<float> buffer(kRenderBufferFrames * output_channels);
-  std::vector<float> track_buffer(kRenderBufferFrames * output_channels);
+  // Render buffers: pooled mix blocks handed to the encode thread, plus one
+  // per track for its share of the block
+  PipelinedEncoder pipelined_encoder(encoder.get(), output_channels, kRenderBufferFrames,
+                                     QueueDepth(config), cancel_flag);
+  std::vector<std::vector<float>> track_buffers(states.size());
+  for (size_t i = 0; i < states.size(); ++i) {
+    track_buffers[i].resize(
+        kRenderBufferFrames * static_cast<size_t>(std::max(output_channels, states[i].channels)));
+  }
+
+  // The calling thread renders too, so one thread fewer is started
+  size_t render_threads = config.render_threads > 0
+                              ? static_cast<size_t>(config.render_threads)
+                              : std::max(1u, std::thread::hardware_concurrency());
+  render_threads = std::min(render_threads, states.size());
+  std::unique_ptr<playback::RenderPool> pool;
+  if (render_threads > 1) {
+    pool = std::make_unique<playback::RenderPool>(render_threads - 1,
+                                                  playback::RenderPool::Priority::kBackground);
+  }
+  MixdownBatch batch;
+  batch.include_effects = config.include_effects;
+  batch.jobs.reserve(states.size());
+
+  const auto started = std::chrono::steady_clock::now();
+  // Tracks already playing at the range start seek to it
+  if (range_start > 0) {
+    for (auto& state : states) {
+      if (state.muted || (has_solo && !state.solo)) {
+        continue;
+      }
+      SeekOfflineTrack(state, range_start - state.start_time_samples, config.include_effects);
+    }
+  }
 
   bool success = true;
-  int64_t timeline_position = 0;
+  int64_t timeline_position = range_start;
   while (true) {
     if (cancel_flag && cancel_flag->load(std::memory_order_acquire)) {
       result.error_message = "Extraction cancelled";
       success = false;
       break;
     }
-    if (!has_unknown_duration && timeline_position >= total_output_frames) {
+    if (range_end >= 0 && timeline_position >= range_end) {
       break;
     }
 
     size_t frames_to_render = kRenderBufferFrames;
-    if (!has_unknown_duration) {
-      const int64_t remaining = total_output_frames - timeline_position;
+    if (range_end >= 0) {
+      const int64_t remaining = range_end - timeline_position;
       if (remaining <= 0) {
         break;
       }
@@ -542,12 +983,22 @@ ExtractionResult ExtractionPipeline::ExtractMixedTracks(
     }
 
     // Render mixed audio
-    std::memset(buffer.data(), 0, frames_to_render * output_channels * sizeof(float));
+    float* buffer = pipelined_encoder.AcquireBlock();
+    if (!buffer) {
+      result.error_message = EncodeStopReason(cancel_flag);
+      success = false;
+      break;
+    }
+    std::memset(buffer, 0, frames_to_render * output_channels * sizeof(float));
 
     bool any_track_active = false;
     bool has_future_tracks = false;
 
-    for (auto& state : states) {
+    // Plan the block, render every track's share (in parallel when there
+    // is a pool), then sum in track order
+    batch.jobs.clear();
+    for (size_t i = 0; i < states.size(); ++i) {
+      OfflineTrackState& state = states[i];
       if (!state.decoder) {
         continue;
       }
@@ -577,27 +1028,34 @@ ExtractionResult ExtractionPipeline::ExtractMixedTracks(
         continue;
       }
 
-      const size_t frames_to_read = frames_to_render - offset_frames;
-      if (track_buffer.size() < frames_to_read * output_channels) {
-        track_buffer.resize(frames_to_read * output_channels);
+      MixdownJob job;
+      job.state = &state;
+      job.buffer = &track_buffers[i];
+      job.offset_frames = offset_frames;
+      job.frames = frames_to_render - offset_frames;
+      batch.jobs.push_back(job);
+    }
+
+    if (pool && batch.jobs.size() > 1) {
+      pool->Run(&RenderMixdownJob, &batch, batch.jobs.size(), 0);
+    } else {
+      for (size_t i = 0; i < batch.jobs.size(); ++i) {
+        RenderMixdownJob(&batch, i);
       }
-      size_t input_frames_read = 0;
-      const size_t frames_read = RenderOfflineTrack(
-          state, track_buffer.data(), frames_to_read, config.include_effects, &input_frames_read);
+    }
 
-      if (frames_read == 0) {
-        state.finished = true;
+    for (const MixdownJob& job : batch.jobs) {
+      if (job.frames_read == 0) {
+        job.state->finished = true;
         continue;
       }
 
       any_track_active = true;
-      state.input_frames_processed += static_cast<int64_t>(
-          input_frames_read > 0 ? input_frames_read : frames_read);
+      job.state->input_frames_processed += static_cast<int64_t>(
+          job.input_frames_read > 0 ? job.input_frames_read : job.frames_read);
 
-      const size_t output_offset = offset_frames * output_channels;
-      for (size_t i = 0; i < frames_read * output_channels; ++i) {
-        buffer[output_offset + i] += track_buffer[i];
-      }
+      MixInto(buffer + job.offset_frames * static_cast<size_t>(output_channels), output_channels,
+              job.buffer->data(), job.state->channels, job.frames_read);
     }
 
     if (!any_track_active && !has_future_tracks && has_unknown_duration) {
@@ -609,10 +1067,9 @@ ExtractionResult ExtractionPipeline::ExtractMixedTracks(
       buffer[i] = std::max(-1.0f, std::min(1.0f, buffer[i]));
     }
 
-    // Write to encoder
-    if (!encoder->Write(buffer.data(), frames_to_render)) {
-      result.error_message = "Failed to write to encoder";
-      LOGE("%s", result.error_message.c_str());
+    // Hand the block to the encoder
+    if (!pipelined_encoder.SubmitBlock(frames_to_render)) {
+      result.error_message = EncodeStopReason(cancel_flag);
       success = false;
       break;
     }
@@ -620,10 +1077,10 @@ ExtractionResult ExtractionPipeline::ExtractMixedTracks(
     timeline_position += static_cast<int64_t>(frames_to_render);
 
     // Report progress
-    if (progress_callback && !has_unknown_duration && total_output_frames > 0 &&
+    if (progress_callback && range_end > range_start &&
         !(cancel_flag && cancel_flag->load(std::memory_order_acquire))) {
-      float progress = static_cast<float>(timeline_position) /
-                       static_cast<float>(total_output_frames);
+      float progress = static_cast<float>(timeline_position - range_start) /
+                       static_cast<float>(range_end - range_start);
       progress = std::min(1.0f, std::max(0.0f, progress));
       if (progress >= 1.0f || progress - last_progress >= kProgressStep) {
         last_progress = progress;
@@ -632,6 +1089,12 @@ ExtractionResult ExtractionPipeline::ExtractMixedTracks(
     }
   }
 
+  if (success && !pipelined_encoder.Finish()) {
+    result.error_message = EncodeStopReason(cancel_flag);
+    success = false;
+  }
+  pipelined_encoder.Abort();
+
   // Close encoder
   if (!encoder->Close()) {
     result.error_message = "Failed to close encoder";
@@ -644,12 +1107,16 @@ ExtractionResult ExtractionPipeline::ExtractMixedTracks(
   result.file_size = encoder->GetFileSize();
   result.bitrate = config.bitrate;
   result.success = success;
+  result.realtime_factor = RealtimeFactor(result.duration_samples, config.sample_rate, started);
 
   if (success) {
-    LOGD("Successfully extracted %zu mixed tracks: %lld frames, %lld bytes",
+    LOGD("Successfully extracted %zu mixed tracks: %lld frames, %lld bytes, "
+         "%.1fx realtime on %zu threads",
          tracks.size(),
          static_cast<long long>(result.duration_samples),
-         static_cast<long long>(result.file_size));
+         static_cast<long long>(result.file_size),
+         result.realtime_factor,
+         render_threads);
   } else if (cancel_flag && cancel_flag->load(std::memory_order_acquire)) {
     std::remove(output_path.c_str());
   }
@@ -657,5 +1124,437 @@ ExtractionResult ExtractionPipeline::ExtractMixedTracks(
   return result;
 }
 
+StemExportResult ExtractionPipeline::ExtractStems(
+    const std::vector<std::shared_ptr<playback::Track>>& tracks,
+    const std::vector<std::string>& stem_paths,
+    const std::string& mix_path,
+    const ExtractionConfig& config,
+    ProgressCallback progress_callback,
+    std::atomic<bool>* cancel_flag) {
+
+  StemExportResult result;
+  result.mix.output_path = mix_path;
+  result.mix.format = config.format;
+
+  if (tracks.empty()) {
+    result.error_message = "No tracks provided";
+    LOGE("%s", result.error_message.c_str());
+    return result;
+  }
+  if (stem_paths.size() != tracks.size()) {
+    result.error_message = "Expected one output path per track";
+    LOGE("%s", result.error_message.c_str());
+    return result;
+  }
+  if (config.range_start_frames > 0 || config.range_end_frames > 0) {
+    result.error_message = "Stem exports do not support a time range";
+    LOGE("%s", result.error_message.c_str());
+    return result;
+  }
+  for (const auto& track : tracks) {
+    if (!track || !track->IsLoaded()) {
+      result.error_message = "One or more tracks not loaded";
+      LOGE("%s", result.error_message.c_str());
+      return result;
+    }
+  }
+
+  result.stems.resize(tracks.size());
+  for (size_t i = 0; i < tracks.size(); ++i) {
+    result.stems[i].track_id = tracks[i]->GetId();
+    result.stems[i].output_path = stem_paths[i];
+    result.stems[i].format = config.format;
+    result.stems[i].bitrate = config.bitrate;
+  }
+
+  // Stems rendered together: consecutive tracks while their estimated
+  // memory fits the budget (at least one per pass). The mixdown joins a
+  // single pass only if its encoder fits too.
+  const bool wants_mix = !mix_path.empty();
+  std::vector<size_t> pass_ends;
+  size_t pass_bytes = 0;
+  bool mix_in_pass = wants_mix;
+  if (config.memory_budget_bytes > 0) {
+    const size_t budget = static_cast<size_t>(config.memory_budget_bytes);
+    for (size_t i = 0; i < tracks.size(); ++i) {
+      const size_t stem_bytes = EstimateStemBytes(*tracks[i], config, kRenderBufferFrames);
+      if (i > 0 && pass_bytes + stem_bytes > budget) {
+        pass_ends.push_back(i);
+        pass_bytes = 0;
+      }
+      pass_bytes += stem_bytes;
+    }
+    const size_t mix_bytes = kRenderBufferFrames * 2 * sizeof(float) +
+                             EstimateEncoderBytes(config, 2, kRenderBufferFrames);
+    mix_in_pass = wants_mix && pass_ends.empty() && pass_bytes + mix_bytes <= budget;
+  }
+  pass_ends.push_back(tracks.size());
+  const size_t stem_passes = pass_ends.size();
+  const size_t total_passes = stem_passes + (wants_mix && !mix_in_pass ? 1 : 0);
+  result.passes = static_cast<int32_t>(total_passes);
+
+  LOGD("Exporting %zu stems in %zu passes%s", tracks.size(), total_passes,
+       wants_mix ? " with mixdown" : "");
+
+  const auto started = std::chrono::steady_clock::now();
+  int64_t timeline_frames = 0;
+  bool cancelled = false;
+  for (size_t pass = 0; pass < stem_passes && !cancelled; ++pass) {
+    const size_t begin = pass == 0 ? 0 : pass_ends[pass - 1];
+    const size_t end = pass_ends[pass];
+    auto pass_progress = [&progress_callback, pass, total_passes](float progress) {
+      if (progress_callback) {
+        progress_callback((static_cast<float>(pass) + progress) /
+                          static_cast<float>(total_passes));
+      }
+    };
+    cancelled = !RenderStemPass(tracks, begin, end, mix_in_pass, config, &result,
+                                pass_progress, cancel_flag);
+    for (size_t i = begin; i < end; ++i) {
+      timeline_frames = std::max(timeline_frames, result.stems[i].duration_samples);
+    }
+  }
+
+  if (wants_mix && !mix_in_pass && !cancelled) {
+    auto mix_progress = [&progress_callback, stem_passes, total_passes](float progress) {
+      if (progress_callback) {
+        progress_callback((static_cast<float>(stem_passes) + progress) /
+                          static_cast<float>(total_passes));
+      }
+    };
+    result.mix = ExtractMixedTracks(tracks, mix_path, config, mix_progress, cancel_flag);
+    cancelled = cancel_flag && cancel_flag->load(std::memory_order_acquire);
+  }
+  if (wants_mix) {
+    timeline_frames = std::max(timeline_frames, result.mix.duration_samples);
+  }
+
+  result.success = !cancelled;
+  for (const auto& stem : result.stems) {
+    result.success = result.success && stem.success;
+  }
+  if (wants_mix) {
+    result.success = result.success && result.mix.success;
+  }
+  if (cancelled) {
+    result.error_message = "Extraction cancelled";
+    for (const auto& stem : result.stems) {
+      std::remove(stem.output_path.c_str());
+    }
+    if (wants_mix) {
+      std::remove(mix_path.c_str());
+    }
+  } else if (!result.success) {
+    result.error_message = "One or more files failed to export";
+  }
+  result.realtime_factor = RealtimeFactor(timeline_frames, config.sample_rate, started);
+
+  LOGD("Stem export %s: %zu stems, %.1fx realtime", result.success ? "finished" : "failed",
+       tracks.size(), result.realtime_factor);
+  return result;
+}
+
+bool ExtractionPipeline::RenderStemPass(
+    const std::vector<std::shared_ptr<playback::Track>>& tracks,
+    size_t begin,
+    size_t end,
+    bool with_mix,
+    const ExtractionConfig& config,
+    StemExportResult* result,
+    const ProgressCallback& progress_callback,
+    std::atomic<bool>* cancel_flag) {
+
+  const size_t count = end - begin;
+  std::vector<OfflineTrackState> states(count);
+  std::vector<std::unique_ptr<audio::AudioEncoder>> encoders(count);
+  std::vector<int64_t> frames_left(count, -1);
+  bool mix_ok = with_mix;
+
+  for (size_t i = 0; i < count; ++i) {
+    ExtractionResult& stem = result->stems[begin + i];
+    OfflineTrackState& state = states[i];
+    state.track = tracks[begin + i];
+    if (!InitOfflineState(state, config.sample_rate, config.include_effects,
+                          &stem.error_message) ||
+        state.channels <= 0) {
+      if (stem.error_message.empty()) {
+        stem.error_message = "Invalid track channels";
+      }
+      LOGE("%s", stem.error_message.c_str());
+      state.decoder.reset();
+      state.finished = true;
+      if (with_mix) {
+        mix_ok = false;
+        result->mix.error_message = stem.error_message;
+      }
+      continue;
+    }
+    frames_left[i] = ExpectedOutputFrames(state, config.include_effects);
+
+    audio::EncoderConfig encoder_config;
+    encoder_config.format = config.format;
+    encoder_config.sample_rate = config.sample_rate;
+    encoder_config.channels = state.channels;
+    encoder_config.bitrate = config.bitrate;
+    encoder_config.bits_per_sample = config.bits_per_sample;
+    encoders[i] = CreateEncoder(config.format);
+    if (!encoders[i] || !encoders[i]->Open(stem.output_path, encoder_config)) {
+      stem.error_message = "Failed to open encoder";
+      LOGE("%s: %s", stem.error_message.c_str(), stem.output_path.c_str());
+      encoders[i].reset();
+    }
+  }
+
+  // The mixdown follows solo/mute like ExtractMixedTracks
+  bool has_solo = false;
+  for (const auto& state : states) {
+    has_solo = has_solo || (state.decoder && state.solo);
+  }
+  auto audible = [has_solo](const OfflineTrackState& state) {
+    return state.decoder && !state.muted && (!has_solo || state.solo);
+  };
+
+  // A track with neither a stem nor a part in the mix needs no rendering
+  for (size_t i = 0; i < count; ++i) {
+    if (!encoders[i] && !(mix_ok && audible(states[i]))) {
+      states[i].finished = true;
+    }
+  }
+
+  // Timeline covered by the pass, and by the mixdown
+  int64_t pass_frames = 0;
+  int64_t mix_frames = 0;
+  bool has_unknown_duration = false;
+  for (size_t i = 0; i < count; ++i) {
+    if (states[i].finished) {
+      continue;
+    }
+    if (frames_left[i] < 0) {
+      has_unknown_duration = true;
+      continue;
+    }
+    const int64_t track_end = states[i].start_time_samples + frames_left[i];
+    pass_frames = std::max(pass_frames, track_end);
+    if (audible(states[i])) {
+      mix_frames = std::max(mix_frames, track_end);
+    }
+  }
+
+  std::unique_ptr<audio::AudioEncoder> mix_encoder;
+  std::unique_ptr<PipelinedEncoder> mix_pipeline;
+  int32_t mix_channels = 0;
+  if (mix_ok) {
+    for (const auto& state : states) {
+      if (state.decoder) {
+        mix_channels = state.channels;
+        break;
+      }
+    }
+    audio::EncoderConfig encoder_config;
+    encoder_config.format = config.format;
+    encoder_config.sample_rate = config.sample_rate;
+    encoder_config.channels = mix_channels;
+    encoder_config.bitrate = config.bitrate;
+    encoder_config.bits_per_sample = config.bits_per_sample;
+    mix_encoder = CreateEncoder(config.format);
+    if (mix_encoder && mix_encoder->Open(result->mix.output_path, encoder_config)) {
+      mix_pipeline = std::make_unique<PipelinedEncoder>(
+          mix_encoder.get(), mix_channels, kRenderBufferFrames, QueueDepth(config), cancel_flag);
+    } else {
+      result->mix.error_message = "Failed to open encoder";
+      LOGE("%s: %s", result->mix.error_message.c_str(), result->mix.output_path.c_str());
+      mix_encoder.reset();
+    }
+  }
+
+  std::vector<std::vector<float>> track_buffers(count);
+  for (size_t i = 0; i < count; ++i) {
+    if (!states[i].finished) {
+      track_buffers[i].resize(kRenderBufferFrames * static_cast<size_t>(states[i].channels));
+    }
+  }
+
+  size_t render_threads = config.render_threads > 0
+                              ? static_cast<size_t>(config.render_threads)
+                              : std::max(1u, std::thread::hardware_concurrency());
+  render_threads = std::min(render_threads, count);
+  std::unique_ptr<playback::RenderPool> pool;
+  if (render_threads > 1) {
+    pool = std::make_unique<playback::RenderPool>(render_threads - 1,
+                                                  playback::RenderPool::Priority::kBackground);
+  }
+  MixdownBatch batch;
+  batch.include_effects = config.include_effects;
+  batch.jobs.reserve(count);
+
+  bool cancelled = false;
+  float last_progress = -1.0f;
+  int64_t timeline_position = 0;
+  while (true) {
+    if (cancel_flag && cancel_flag->load(std::memory_order_acquire)) {
+      cancelled = true;
+      break;
+    }
+    if (!has_unknown_duration && timeline_position >= pass_frames) {
+      break;
+    }
+    size_t frames_to_render = kRenderBufferFrames;
+    if (!has_unknown_duration) {
+      frames_to_render = static_cast<size_t>(std::min<int64_t>(
+          pass_frames - timeline_position, static_cast<int64_t>(kRenderBufferFrames)));
+    }
+
+    bool has_future_tracks = false;
+    batch.jobs.clear();
+    for (size_t i = 0; i < count; ++i) {
+      OfflineTrackState& state = states[i];
+      if (state.finished) {
+        continue;
+      }
+      const int64_t track_frame = timeline_position - state.start_time_samples;
+      const size_t offset_frames =
+          track_frame < 0 ? static_cast<size_t>(std::min<int64_t>(
+                                -track_frame, static_cast<int64_t>(frames_to_render)))
+                          : 0;
+      if (offset_frames >= frames_to_render) {
+        has_future_tracks = true;
+        continue;
+      }
+      size_t frames = frames_to_render - offset_frames;
+      if (frames_left[i] >= 0) {
+        frames = static_cast<size_t>(std::min<int64_t>(frames_left[i], frames));
+      }
+      if (frames == 0) {
+        state.finished = true;
+        continue;
+      }
+
+      MixdownJob job;
+      job.state = &state;
+      job.buffer = &track_buffers[i];
+      job.encoder = encoders[i].get();
+      job.offset_frames = offset_frames;
+      job.frames = frames;
+      batch.jobs.push_back(job);
+    }
+
+    if (pool && batch.jobs.size() > 1) {
+      pool->Run(&RenderMixdownJob, &batch, batch.jobs.size(), 0);
+    } else {
+      for (size_t i = 0; i < batch.jobs.size(); ++i) {
+        RenderMixdownJob(&batch, i);
+      }
+    }
+
+    const bool mix_block = mix_pipeline &&
+                           (has_unknown_duration || timeline_position < mix_frames);
+    float* mix = nullptr;
+    size_t mix_block_frames = frames_to_render;
+    if (mix_block) {
+      if (!has_unknown_duration) {
+        mix_block_frames = static_cast<size_t>(std::min<int64_t>(
+            mix_frames - timeline_position, static_cast<int64_t>(frames_to_render)));
+      }
+      mix = mix_pipeline->AcquireBlock();
+      if (mix) {
+        std::memset(mix, 0, mix_block_frames * static_cast<size_t>(mix_channels) * sizeof(float));
+      }
+    }
+
+    bool any_track_active = false;
+    for (const MixdownJob& job : batch.jobs) {
+      const size_t index = static_cast<size_t>(job.state - states.data());
+      if (job.write_failed) {
+        ExtractionResult& stem = result->stems[begin + index];
+        stem.error_message = "Failed to write to encoder";
+        LOGE("%s: %s", stem.error_message.c_str(), stem.output_path.c_str());
+        encoders[index]->Close();
+        encoders[index].reset();
+        if (!(mix_ok && audible(*job.state))) {
+          job.state->finished = true;
+        }
+      }
+      if (job.frames_read == 0) {
+        job.state->finished = true;
+        continue;
+      }
+
+      any_track_active = true;
+      if (frames_left[index] >= 0) {
+        frames_left[index] -= static_cast<int64_t>(job.frames_read);
+      }
+      if (mix && audible(*job.state) && job.offset_frames < mix_block_frames) {
+        const size_t frames = std::min(job.frames_read, mix_block_frames - job.offset_frames);
+        MixInto(mix + job.offset_frames * static_cast<size_t>(mix_channels), mix_channels,
+                job.buffer->data(), job.state->channels, frames);
+      }
+    }
+
+    if (!any_track_active && !has_future_tracks && has_unknown_duration) {
+      break;
+    }
+
+    if (mix_block) {
+      bool submitted = false;
+      if (mix) {
+        for (size_t i = 0; i < mix_block_frames * static_cast<size_t>(mix_channels); ++i) {
+          mix[i] = std::max(-1.0f, std::min(1.0f, mix[i]));
+        }
+        submitted = mix_pipeline->SubmitBlock(mix_block_frames);
+      }
+      if (!submitted) {
+        result->mix.error_message = EncodeStopReason(cancel_flag);
+        mix_pipeline->Abort();
+        mix_pipeline.reset();
+      }
+    }
+
+    timeline_position += static_cast<int64_t>(frames_to_render);
+
+    if (progress_callback && !has_unknown_duration && pass_frames > 0 &&
+        !(cancel_flag && cancel_flag->load(std::memory_order_acquire))) {
+      float progress = static_cast<float>(timeline_position) / static_cast<float>(pass_frames);
+      progress = std::min(1.0f, std::max(0.0f, progress));
+      if (progress >= 1.0f || progress - last_progress >= kProgressStep) {
+        last_progress = progress;
+        progress_callback(progress);
+      }
+    }
+  }
+
+  if (mix_pipeline) {
+    if (cancelled || !mix_pipeline->Finish()) {
+      result->mix.error_message = EncodeStopReason(cancel_flag);
+    }
+    mix_pipeline->Abort();
+  }
+  if (mix_encoder) {
+    if (!mix_encoder->Close() && result->mix.error_message.empty()) {
+      result->mix.error_message = "Failed to close encoder";
+    }
+    result->mix.duration_samples = mix_encoder->GetFramesWritten();
+    result->mix.file_size = mix_encoder->GetFileSize();
+    result->mix.bitrate = config.bitrate;
+    result->mix.success = !cancelled && result->mix.error_message.empty();
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    ExtractionResult& stem = result->stems[begin + i];
+    if (!encoders[i]) {
+      continue;
+    }
+    if (!encoders[i]->Close() && stem.error_message.empty()) {
+      stem.error_message = "Failed to close encoder";
+    }
+    stem.duration_samples = encoders[i]->GetFramesWritten();
+    stem.file_size = encoders[i]->GetFileSize();
+    stem.success = !cancelled && stem.error_message.empty();
+    if (cancelled) {
+      stem.error_message = "Extraction cancelled";
+    }
+  }
+  return !cancelled;
+}
+
 }  // namespace extraction
 }  // namespace sezo
@@ -24,11 +24,21 @@ using ProgressCallback = std::function<void(float progress)>;
  */
 struct ExtractionConfig {
   audio::EncoderFormat format = audio::EncoderFormat::kWAV;
-  int32_t sample_rate = 44100;
+  int32_t sample_rate = 44100;  // Output rate; sources at other rates are resampled
   int32_t bitrate = 128000;  // For compressed formats
   int32_t bits_per_sample = 16;  // For WAV
   bool include_effects = true;  // Apply pitch/speed effects during extraction
   std::string output_dir;  // Optional output directory
+  int32_t render_threads = 0;  // Mixdown render threads (0 = one per core, 1 = serial)
+  int32_t encode_queue_blocks = 4;  // Blocks rendered ahead of the encoder (0 = encode inline)
+  // Stem export: estimated memory of the stems open at once (0 = unlimited)
+  int64_t memory_budget_bytes = 0;
+  // Output frames to export, at sample_rate: [range_start_frames,
+  // range_end_frames), end 0 = to the end. Tracks seek to the start instead
+  // of rendering up to it. ExtractTrack counts from the track's first frame,
+  // ExtractMixedTracks from the timeline start; stem exports take no range.
+  int64_t range_start_frames = 0;
+  int64_t range_end_frames = 0;
 };
 
 /**
@@ -43,6 +53,19 @@ struct ExtractionResult {
   int32_t bitrate = 0;
   bool success = false;
   std::string error_message;
+  double realtime_factor = 0.0;  // Seconds of audio rendered per second taken
+};
+
+/**
+ * Stem export result: one entry per track, plus the optional mixdown.
+ */
+struct StemExportResult {
+  std::vector<ExtractionResult> stems;  // Same order as the tracks
+  ExtractionResult mix;  // output_path is empty when no mixdown was requested
+  bool success = false;  // Every requested file was written
+  std::string error_message;
+  int32_t passes = 0;  // Render passes taken (more than one when over the memory budget)
+  double realtime_factor = 0.0;  // Timeline seconds exported per second taken
 };
 
 /**
@@ -57,6 +80,8 @@ class ExtractionPipeline {
 
   /**
    * Extract a single track to an audio file.
+   * Encoding runs on its own thread, up to
+   * ExtractionConfig::encode_queue_blocks blocks behind rendering.
    * @param track Track to extract
    * @param output_path Output file path
    * @param config Extraction configuration
@@ -72,6 +97,9 @@ class ExtractionPipeline {
 
   /**
    * Extract multiple tracks mixed together to an audio file.
+   * Each block's tracks are decoded and stretched in parallel (see
+   * ExtractionConfig::render_threads), then summed in track order, so the
+   * output is bit-identical to a serial render.
    * @param tracks Tracks to mix and extract
    * @param output_path Output file path
    * @param config Extraction configuration
@@ -85,12 +113,54 @@ class ExtractionPipeline {
       ProgressCallback progress_callback = nullptr,
       std::atomic<bool>* cancel_flag = nullptr);
 
+  /**
+   * Export every track to its own file in one pass over the timeline.
+   * Each track is decoded and rendered once per block; its stem is written
+   * from the render thread (up to ExtractionConfig::render_threads at a
+   * time) and, when mix_path is set, the same blocks are summed into the
+   * mixdown. Stems are rendered like ExtractTrack (from the track's first
+   * frame, mute applied); the mixdown follows solo/mute and start times.
+   *
+   * If ExtractionConfig::memory_budget_bytes cannot hold every stem at
+   * once, the stems are split over several passes and the mixdown gets a
+   * pass of its own. Each stem is charged an estimate of its render
+   * buffers, decoder, resampler, time-stretcher and encoder.
+   * @param tracks Tracks to export
+   * @param stem_paths Output path for each track, in the same order
+   * @param mix_path Mixdown output path (empty = no mixdown)
+   * @param config Extraction configuration
+   * @param progress_callback Optional progress over the whole export
+   * @return Per-file results
+   */
+  StemExportResult ExtractStems(
+      const std::vector<std::shared_ptr<playback::Track>>& tracks,
+      const std::vector<std::string>& stem_paths,
+      const std::string& mix_path,
+      const ExtractionConfig& config,
+      ProgressCallback progress_callback = nullptr,
+      std::atomic<bool>* cancel_flag = nullptr);
+
  private:
   /**
    * Create an encoder for the specified format.
    */
   std::unique_ptr<audio::AudioEncoder> CreateEncoder(audio::EncoderFormat format);
 
+  /**
+   * Render tracks [begin, end) of a stem export, plus the mixdown of all
+   * tracks when with_mix is set (the range then covers every track).
+   * @return false if cancelled
+   */
+  bool RenderStemPass(
+      const std::vector<std::shared_ptr<playback::Track>>& tracks,
+      size_t begin,
+      size_t end,
+      bool with_mix,
+      const ExtractionConfig& config,
+      StemExportResult* result,
+      const ProgressCallback& progress_callback,
+      std::atomic<bool>* cancel_flag);
+
   static constexpr size_t kRenderBufferFrames = 4096;
 };
 
@@ -0,0 +1,232 @@
+#include "extraction/ExtractionScheduler.h"
+
+#include "extraction/CancelPoll.h"
+
+#include <algorithm>
+#include <android/log.h>
+
+#define LOG_TAG "ExtractionScheduler"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+
+namespace sezo {
+namespace extraction {
+
+namespace {
+
+int64_t SteadyNowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+double NsToMs(int64_t ns) {
+  return static_cast<double>(ns) / 1e6;
+}
+
+}  // namespace
+
+ExtractionScheduler::ExtractionScheduler(int32_t concurrency)
+    : concurrency_(std::max(1, concurrency)) {}
+
+ExtractionScheduler::~ExtractionScheduler() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  cv_.notify_all();
+  for (auto& worker : workers_) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+void ExtractionScheduler::Submit(JobFunction function,
+                                 const JobOptions& options,
+                                 std::shared_ptr<std::atomic<bool>> cancel_flag) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Job job;
+    job.function = std::move(function);
+    job.cancel_flag = std::move(cancel_flag);
+    job.priority = options.priority;
+    job.submitted_ns = SteadyNowNs();
+    job.deadline_ns = options.deadline_ms > 0
+                          ? job.submitted_ns + options.deadline_ms * 1000000
+                          : 0;
+    job.sequence = next_sequence_++;
+    queue_.push_back(std::move(job));
+    ++submitted_;
+    StartWorkersLocked();
+  }
+  cv_.notify_all();
+}
+
+void ExtractionScheduler::SetConcurrency(int32_t concurrency) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    concurrency_ = std::max(1, concurrency);
+    StartWorkersLocked();
+  }
+  cv_.notify_all();
+  LOGD("Extraction concurrency set to %d", concurrency);
+}
+
+int32_t ExtractionScheduler::GetConcurrency() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return concurrency_;
+}
+
+void ExtractionScheduler::Pause() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  paused_ = true;
+}
+
+void ExtractionScheduler::Resume() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    paused_ = false;
+  }
+  cv_.notify_all();
+}
+
+bool ExtractionScheduler::IsPaused() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return paused_;
+}
+
+bool ExtractionScheduler::WaitWhilePaused(const std::atomic<bool>* cancel_flag) const {
+  auto cancelled = [cancel_flag] {
+    return cancel_flag && cancel_flag->load(std::memory_order_acquire);
+  };
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (paused_ && !shutdown_ && !cancelled()) {
+    cv_.wait_for(lock, kCancelPollInterval);
+  }
+  return !cancelled();
+}
+
+void ExtractionScheduler::Reschedule() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // A cancelled job must not wait for a busy slot; give it a thread
+    const bool has_cancelled = std::any_of(queue_.begin(), queue_.end(), IsCancelled);
+    if (has_cancelled && idle_ == 0) {
+      workers_.emplace_back(&ExtractionScheduler::WorkerLoop, this);
+    }
+  }
+  cv_.notify_all();
+}
+
+bool ExtractionScheduler::WaitUntilIdle(std::chrono::milliseconds timeout) const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return cv_.wait_for(lock, timeout, [this] { return queue_.empty() && running_ == 0; });
+}
+
+ExtractionScheduler::Metrics ExtractionScheduler::GetMetrics() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Metrics metrics;
+  metrics.concurrency = concurrency_;
+  metrics.paused = paused_;
+  metrics.queued = queue_.size();
+  metrics.running = running_;
+  metrics.submitted = submitted_;
+  metrics.completed = completed_;
+  metrics.missed_deadlines = missed_deadlines_;
+  if (started_ > 0) {
+    metrics.mean_wait_ms = NsToMs(total_wait_ns_) / static_cast<double>(started_);
+  }
+  metrics.max_wait_ms = NsToMs(max_wait_ns_);
+  if (!queue_.empty()) {
+    const auto oldest = std::min_element(
+        queue_.begin(), queue_.end(),
+        [](const Job& a, const Job& b) { return a.submitted_ns < b.submitted_ns; });
+    metrics.oldest_queued_ms = NsToMs(SteadyNowNs() - oldest->submitted_ns);
+  }
+  return metrics;
+}
+
+void ExtractionScheduler::StartWorkersLocked() {
+  // Threads are started on demand, one per job that may run, and then kept
+  const size_t wanted = std::min(static_cast<size_t>(concurrency_), running_ + queue_.size());
+  while (workers_.size() < wanted) {
+    workers_.emplace_back(&ExtractionScheduler::WorkerLoop, this);
+  }
+}
+
+bool ExtractionScheduler::IsCancelled(const Job& job) {
+  return job.cancel_flag && job.cancel_flag->load(std::memory_order_acquire);
+}
+
+bool ExtractionScheduler::RunsBefore(const Job& a, const Job& b) {
+  const bool a_cancelled = IsCancelled(a);
+  if (a_cancelled != IsCancelled(b)) {
+    return a_cancelled;
+  }
+  if (a.priority != b.priority) {
+    return a.priority > b.priority;
+  }
+  if (a.deadline_ns != b.deadline_ns) {
+    if (a.deadline_ns == 0 || b.deadline_ns == 0) {
+      return b.deadline_ns == 0;
+    }
+    return a.deadline_ns < b.deadline_ns;
+  }
+  return a.sequence < b.sequence;
+}
+
+size_t ExtractionScheduler::PickJobLocked() const {
+  // On shutdown the queue is drained even while paused
+  const bool may_start =
+      (!paused_ || shutdown_) && running_ < static_cast<size_t>(concurrency_);
+  size_t best = queue_.size();
+  for (size_t i = 0; i < queue_.size(); ++i) {
+    if (!may_start && !IsCancelled(queue_[i])) {
+      continue;
+    }
+    if (best == queue_.size() || RunsBefore(queue_[i], queue_[best])) {
+      best = i;
+    }
+  }
+  return best;
+}
+
+void ExtractionScheduler::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    size_t index = queue_.size();
+    ++idle_;
+    cv_.wait(lock, [this, &index] {
+      index = PickJobLocked();
+      return index < queue_.size() || (shutdown_ && queue_.empty());
+    });
+    --idle_;
+    if (index >= queue_.size()) {
+      break;
+    }
+
+    Job job = std::move(queue_[index]);
+    queue_.erase(queue_.begin() + static_cast<std::ptrdiff_t>(index));
+    ++running_;
+    ++started_;
+    const int64_t wait_ns = SteadyNowNs() - job.submitted_ns;
+    total_wait_ns_ += wait_ns;
+    max_wait_ns_ = std::max(max_wait_ns_, wait_ns);
+
+    lock.unlock();
+    job.function();
+    const int64_t finished_ns = SteadyNowNs();
+    lock.lock();
+
+    --running_;
+    ++completed_;
+    if (job.deadline_ns > 0 && finished_ns > job.deadline_ns) {
+      ++missed_deadlines_;
+    }
+    // A slot is free, and WaitUntilIdle() may be waiting
+    cv_.notify_all();
+  }
+}
+
+}  // namespace extraction
+}  // namespace sezo
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sezo {
+namespace extraction {
+
+/**
+ * Runs extraction jobs on a small pool of threads.
+ *
+ * Up to GetConcurrency() jobs run at once. Queued jobs are handed out by
+ * priority, then by deadline hint (earliest first, jobs without one last),
+ * then in submission order, so a short preview export does not wait behind
+ * a long mixdown of lower priority.
+ *
+ * Pause() stops queued jobs from starting; running jobs stop at their next
+ * WaitWhilePaused() checkpoint. A job whose cancel flag is set is handed out
+ * right away, even while paused or with every slot busy, so it can report
+ * its cancellation; call Reschedule() after setting a flag.
+ */
+class ExtractionScheduler {
+ public:
+  enum class Priority : int32_t {
+    kLow = 0,
+    kNormal = 1,
+    kHigh = 2,
+  };
+
+  struct JobOptions {
+    Priority priority = Priority::kNormal;
+    // Hint: the job should finish this long after submission (0 = none)
+    int64_t deadline_ms = 0;
+  };
+
+  struct Metrics {
+    int32_t concurrency = 0;
+    bool paused = false;
+    size_t queued = 0;
+    size_t running = 0;
+    uint64_t submitted = 0;
+    uint64_t completed = 0;
+    uint64_t missed_deadlines = 0;  // finished after their deadline hint
+    // Time from submission to start, over every started job
+    double mean_wait_ms = 0.0;
+    double max_wait_ms = 0.0;
+    // How long the oldest queued job has been waiting
+    double oldest_queued_ms = 0.0;
+  };
+
+  using JobFunction = std::function<void()>;
+
+  /**
+   * Constructor. Threads are started as jobs are submitted.
+   * @param concurrency Jobs allowed to run at once (at least 1)
+   */
+  explicit ExtractionScheduler(int32_t concurrency = 1);
+
+  /** Runs the jobs still queued, then stops the threads. */
+  ~ExtractionScheduler();
+
+  ExtractionScheduler(const ExtractionScheduler&) = delete;
+  ExtractionScheduler& operator=(const ExtractionScheduler&) = delete;
+
+  /**
+   * Queue a job.
+   * @param function Job body, run on a scheduler thread
+   * @param options Priority and deadline hint
+   * @param cancel_flag Optional flag that lets the job skip the queue once set
+   */
+  void Submit(JobFunction function,
+              const JobOptions& options,
+              std::shared_ptr<std::atomic<bool>> cancel_flag = nullptr);
+
+  /**
+   * Change how many jobs may run at once. Running jobs are never stopped;
+   * a lower limit applies as they finish.
+   */
+  void SetConcurrency(int32_t concurrency);
+  int32_t GetConcurrency() const;
+
+  void Pause();
+  void Resume();
+  bool IsPaused() const;
+
+  /**
+   * Checkpoint for running jobs: blocks while the scheduler is paused.
+   * @param cancel_flag Optional flag that ends the wait
+   * @return false if the job was cancelled
+   */
+  bool WaitWhilePaused(const std::atomic<bool>* cancel_flag) const;
+
+  /** Re-check the queue, e.g. after setting a job's cancel flag. */
+  void Reschedule();
+
+  /**
+   * Wait until no job is queued or running.
+   * @return false on timeout
+   */
+  bool WaitUntilIdle(std::chrono::milliseconds timeout) const;
+
+  Metrics GetMetrics() const;
+
+ private:
+  struct Job {
+    JobFunction function;
+    std::shared_ptr<std::atomic<bool>> cancel_flag;
+    Priority priority = Priority::kNormal;
+    int64_t deadline_ns = 0;  // steady_clock, 0 = none
+    int64_t submitted_ns = 0;
+    uint64_t sequence = 0;
+  };
+
+  void WorkerLoop();
+  void StartWorkersLocked();
+  // Index of the job to start next, or queue_.size() if none may start.
+  size_t PickJobLocked() const;
+  static bool IsCancelled(const Job& job);
+  static bool RunsBefore(const Job& a, const Job& b);
+
+  mutable std::mutex mutex_;
+  // Jobs queued, finished, resumed or cancelled; also wakes paused jobs
+  mutable std::condition_variable cv_;
+  std::vector<Job> queue_;
+  std::vector<std::thread> workers_;
+  int32_t concurrency_;
+  bool paused_ = false;
+  bool shutdown_ = false;
+  size_t running_ = 0;
+  size_t idle_ = 0;  // workers waiting for a job
+  uint64_t next_sequence_ = 0;
+
+  uint64_t submitted_ = 0;
+  uint64_t started_ = 0;
+  uint64_t completed_ = 0;
+  uint64_t missed_deadlines_ = 0;
+  int64_t total_wait_ns_ = 0;
+  int64_t max_wait_ns_ = 0;
+};
+
+}  // namespace extraction
+}  // namespace sezo
@@ -0,0 +1,171 @@
+#include "extraction/PipelinedEncoder.h"
+
+#include "extraction/CancelPoll.h"
+
+#include <android/log.h>
+
+#define LOG_TAG "PipelinedEncoder"
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace sezo {
+namespace extraction {
+
+PipelinedEncoder::PipelinedEncoder(audio::AudioEncoder* encoder,
+                                   int32_t channels,
+                                   size_t block_frames,
+                                   size_t depth,
+                                   std::atomic<bool>* cancel_flag)
+    : encoder_(encoder),
+      block_frames_(block_frames),
+      block_samples_(block_frames * static_cast<size_t>(channels > 0 ? channels : 1)),
+      depth_(depth),
+      cancel_flag_(cancel_flag),
+      blocks_(depth > 0 ? depth : 1, std::vector<float>(block_samples_)),
+      queued_frames_(blocks_.size(), 0) {
+  if (depth_ > 0) {
+    encode_thread_ = std::thread(&PipelinedEncoder::EncodeLoop, this);
+  }
+}
+
+PipelinedEncoder::~PipelinedEncoder() {
+  Abort();
+}
+
+bool PipelinedEncoder::IsCancelled() const {
+  return cancel_flag_ && cancel_flag_->load(std::memory_order_acquire);
+}
+
+float* PipelinedEncoder::AcquireBlock() {
+  if (depth_ == 0) {
+    return failed_ || IsCancelled() ? nullptr : blocks_[0].data();
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (queued_ == depth_) {
+    ++stats_.render_waits;
+  }
+  while (queued_ == depth_ && !stopped_) {
+    if (IsCancelled()) {
+      return nullptr;
+    }
+    block_free_cv_.wait_for(lock, kCancelPollInterval);
+  }
+  if (stopped_ || failed_ || IsCancelled()) {
+    return nullptr;
+  }
+  return blocks_[(head_ + queued_) % depth_].data();
+}
+
+bool PipelinedEncoder::SubmitBlock(size_t frames) {
+  if (frames > block_frames_) {
+    frames = block_frames_;
+  }
+
+  if (depth_ == 0) {
+    if (failed_ || IsCancelled()) {
+      return false;
+    }
+    if (!encoder_->Write(blocks_[0].data(), frames)) {
+      failed_ = true;
+      return false;
+    }
+    ++stats_.blocks;
+    return true;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopped_ || failed_ || queued_ == depth_) {
+      return false;
+    }
+    queued_frames_[(head_ + queued_) % depth_] = frames;
+    ++queued_;
+  }
+  block_queued_cv_.notify_one();
+  return !IsCancelled();
+}
+
+void PipelinedEncoder::EncodeLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  bool waiting = false;
+  while (!stopping_) {
+    if (IsCancelled()) {
+      break;
+    }
+    if (queued_ == 0) {
+      if (draining_) {
+        break;
+      }
+      if (!waiting) {
+        waiting = true;
+        ++stats_.encode_waits;
+      }
+      block_queued_cv_.wait_for(lock, kCancelPollInterval);
+      continue;
+    }
+    waiting = false;
+
+    // The block stays counted as queued while it is written, so the render
+    // side cannot reuse it
+    const size_t index = head_;
+    const size_t frames = queued_frames_[index];
+    lock.unlock();
+    const bool written = encoder_->Write(blocks_[index].data(), frames);
+    lock.lock();
+
+    if (!written) {
+      LOGE("Encoder write failed; stopping pipeline");
+      failed_ = true;
+      break;
+    }
+    head_ = (head_ + 1) % depth_;
+    --queued_;
+    ++stats_.blocks;
+    block_free_cv_.notify_one();
+  }
+  stopped_ = true;
+  lock.unlock();
+  block_free_cv_.notify_all();
+}
+
+bool PipelinedEncoder::Finish() {
+  if (depth_ == 0) {
+    return !failed_;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    draining_ = true;
+  }
+  block_queued_cv_.notify_one();
+  if (encode_thread_.joinable()) {
+    encode_thread_.join();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  return !failed_ && queued_ == 0;
+}
+
+void PipelinedEncoder::Abort() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  block_queued_cv_.notify_one();
+  if (encode_thread_.joinable()) {
+    encode_thread_.join();
+  }
+}
+
+bool PipelinedEncoder::HasFailed() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return failed_;
+}
+
+PipelinedEncoder::Stats PipelinedEncoder::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+}  // namespace extraction
+}  // namespace sezo
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "audio/AudioEncoder.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sezo {
+namespace extraction {
+
+/**
+ * Overlaps rendering with encoding during extraction.
+ *
+ * The render thread fills blocks from a fixed pool (AcquireBlock() /
+ * SubmitBlock()) and an encode thread writes them to the encoder in
+ * submission order, so a codec that blocks (AMediaCodec dequeue timeouts,
+ * LAME) no longer stalls rendering. Once every block is queued the render
+ * side waits for one to be written, which bounds memory to the pool.
+ * Both sides stop early on cancellation or a failed write.
+ *
+ * With a depth of 0 there is no encode thread: blocks are written on the
+ * calling thread in SubmitBlock(), as extraction did before.
+ *
+ * The encoder must already be open and is only used by the encode thread
+ * until Finish() or Abort() returns; closing it is left to the caller.
+ */
+class PipelinedEncoder {
+ public:
+  struct Stats {
+    uint64_t blocks = 0;        // blocks written to the encoder
+    uint64_t render_waits = 0;  // AcquireBlock() found the whole pool queued
+    uint64_t encode_waits = 0;  // the encode thread found the queue empty
+  };
+
+  /**
+   * Constructor. Starts the encode thread when depth > 0.
+   * @param encoder Open encoder; must outlive this object
+   * @param channels Interleaved channels per frame
+   * @param block_frames Frames each block holds
+   * @param depth Number of pooled blocks (0 = encode on the calling thread)
+   * @param cancel_flag Optional flag checked by both sides
+   */
+  PipelinedEncoder(audio::AudioEncoder* encoder,
+                   int32_t channels,
+                   size_t block_frames,
+                   size_t depth,
+                   std::atomic<bool>* cancel_flag = nullptr);
+  ~PipelinedEncoder();
+
+  PipelinedEncoder(const PipelinedEncoder&) = delete;
+  PipelinedEncoder& operator=(const PipelinedEncoder&) = delete;
+
+  /**
+   * Get the next block to render into, waiting while the pool is full.
+   * Calling it again before SubmitBlock() returns the same block.
+   * @return block_frames * channels samples, or nullptr once cancelled or
+   *         after a failed write
+   */
+  float* AcquireBlock();
+
+  /**
+   * Queue the acquired block for encoding.
+   * @param frames Frames rendered into the block (at most block_frames)
+   * @return false if a write has failed or extraction was cancelled
+   */
+  bool SubmitBlock(size_t frames);
+
+  /**
+   * Write every queued block and stop the encode thread.
+   * @return true if all submitted blocks were written
+   */
+  bool Finish();
+
+  /**
+   * Stop the encode thread and drop queued blocks.
+   */
+  void Abort();
+
+  /** True once an encoder write has failed. */
+  bool HasFailed() const;
+
+  Stats GetStats() const;
+
+ private:
+  void EncodeLoop();
+  bool IsCancelled() const;
+
+  audio::AudioEncoder* encoder_;
+  const size_t block_frames_;
+  const size_t block_samples_;
+  const size_t depth_;
+  std::atomic<bool>* cancel_flag_;
+
+  std::vector<std::vector<float>> blocks_;
+  std::vector<size_t> queued_frames_;  // frames rendered into each block
+
+  mutable std::mutex mutex_;
+  std::condition_variable block_queued_cv_;
+  std::condition_variable block_free_cv_;
+  size_t head_ = 0;    // oldest queued block, written next
+  size_t queued_ = 0;  // includes the block being written
+  bool draining_ = false;  // Finish(): exit once the queue is empty
+  bool stopping_ = false;  // Abort(): exit now
+  bool stopped_ = false;   // encode thread has exited
+  bool failed_ = false;
+  Stats stats_;
+
+  std::thread encode_thread_;
+};
+
+}  // namespace extraction
+}  // namespace sezo
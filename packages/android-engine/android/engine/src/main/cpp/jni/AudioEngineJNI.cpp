@@ -5,6 +5,7 @@
 #include <atomic>
 #include <memory>
 #include <string>
+#include <vector>
 
 #define LOG_TAG "AudioEngineJNI"
 #define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
@@ -29,6 +30,12 @@ struct JniPlaybackStateCallbackContext {
   jmethodID state_method = nullptr;
 };
 
+struct JniQualityCallbackContext {
+  JavaVM* jvm = nullptr;
+  jobject engine_object = nullptr;
+  jmethodID quality_method = nullptr;
+};
+
 JNIEnv* GetEnvForCallback(JavaVM* jvm, bool* did_attach) {
   if (did_attach) {
     *did_attach = false;
@@ -105,6 +112,12 @@ jobject CreateExtractionResultMap(JNIEnv* env, const AudioEngine::ExtractionResu
   jobject fileSizeObj = env->NewObject(longClass, longInit, result.file_size);
   env->CallObjectMethod(resultMap, hashMapPut, env->NewStringUTF("fileSize"), fileSizeObj);
 
+  jclass doubleClass = env->FindClass("java/lang/Double");
+  jmethodID doubleInit = env->GetMethodID(doubleClass, "<init>", "(D)V");
+  jobject realtimeObj = env->NewObject(doubleClass, doubleInit, result.realtime_factor);
+  env->CallObjectMethod(resultMap, hashMapPut,
+                        env->NewStringUTF("realtimeFactor"), realtimeObj);
+
   env->CallObjectMethod(resultMap, hashMapPut, env->NewStringUTF("errorMessage"),
                         JNIHelper::StringToJString(env, result.error_message));
 
@@ -140,6 +153,77 @@ void CallCompletionCallback(
   }
 }
 
+jobject CreateStemExportResultMap(JNIEnv* env, const AudioEngine::StemExportResult& result) {
+  jclass hashMapClass = env->FindClass("java/util/HashMap");
+  jmethodID hashMapInit = env->GetMethodID(hashMapClass, "<init>", "()V");
+  jmethodID hashMapPut = env->GetMethodID(hashMapClass, "put",
+      "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;");
+  jclass arrayListClass = env->FindClass("java/util/ArrayList");
+  jmethodID arrayListInit = env->GetMethodID(arrayListClass, "<init>", "()V");
+  jmethodID arrayListAdd = env->GetMethodID(arrayListClass, "add", "(Ljava/lang/Object;)Z");
+
+  jobject resultMap = env->NewObject(hashMapClass, hashMapInit);
+
+  jclass booleanClass = env->FindClass("java/lang/Boolean");
+  jmethodID booleanInit = env->GetMethodID(booleanClass, "<init>", "(Z)V");
+  jobject successObj = env->NewObject(booleanClass, booleanInit,
+                                      result.success ? JNI_TRUE : JNI_FALSE);
+  env->CallObjectMethod(resultMap, hashMapPut, env->NewStringUTF("success"), successObj);
+
+  jobject stemsList = env->NewObject(arrayListClass, arrayListInit);
+  for (const auto& stem : result.stems) {
+    jobject stemMap = CreateExtractionResultMap(env, stem);
+    env->CallBooleanMethod(stemsList, arrayListAdd, stemMap);
+    env->DeleteLocalRef(stemMap);
+  }
+  env->CallObjectMethod(resultMap, hashMapPut, env->NewStringUTF("stems"), stemsList);
+
+  if (!result.mix.output_path.empty()) {
+    jobject mixMap = CreateExtractionResultMap(env, result.mix);
+    env->CallObjectMethod(resultMap, hashMapPut, env->NewStringUTF("mix"), mixMap);
+  }
+
+  jclass doubleClass = env->FindClass("java/lang/Double");
+  jmethodID doubleInit = env->GetMethodID(doubleClass, "<init>", "(D)V");
+  jobject realtimeObj = env->NewObject(doubleClass, doubleInit, result.realtime_factor);
+  env->CallObjectMethod(resultMap, hashMapPut,
+                        env->NewStringUTF("realtimeFactor"), realtimeObj);
+
+  env->CallObjectMethod(resultMap, hashMapPut, env->NewStringUTF("errorMessage"),
+                        JNIHelper::StringToJString(env, result.error_message));
+
+  return resultMap;
+}
+
+void CallStemExportCompletionCallback(
+    const std::shared_ptr<JniExtractionCallbackContext>& context,
+    int64_t job_id,
+    const AudioEngine::StemExportResult& result) {
+  if (!context || !context->jvm || !context->engine_object || !context->completion_method) {
+    return;
+  }
+
+  bool did_attach = false;
+  JNIEnv* env = GetEnvForCallback(context->jvm, &did_attach);
+  if (!env) {
+    return;
+  }
+
+  jobject resultMap = CreateStemExportResultMap(env, result);
+  env->CallVoidMethod(context->engine_object, context->completion_method,
+                      static_cast<jlong>(job_id), resultMap);
+  if (env->ExceptionCheck()) {
+    env->ExceptionClear();
+  }
+
+  env->DeleteLocalRef(resultMap);
+  env->DeleteGlobalRef(context->engine_object);
+
+  if (did_attach) {
+    context->jvm->DetachCurrentThread();
+  }
+}
+
 void DeletePlaybackStateContext(JniPlaybackStateCallbackContext* context) {
   if (!context) {
     return;
@@ -186,6 +270,55 @@ void CallPlaybackStateCallback(
   }
 }
 
+void DeleteQualityContext(JniQualityCallbackContext* context) {
+  if (!context) {
+    return;
+  }
+  if (context->jvm && context->engine_object) {
+    bool did_attach = false;
+    JNIEnv* env = GetEnvForCallback(context->jvm, &did_attach);
+    if (env) {
+      env->DeleteGlobalRef(context->engine_object);
+      if (env->ExceptionCheck()) {
+        env->ExceptionClear();
+      }
+    }
+    if (did_attach) {
+      context->jvm->DetachCurrentThread();
+    }
+  }
+  delete context;
+}
+
+void CallQualityCallback(
+    const std::shared_ptr<JniQualityCallbackContext>& context,
+    const sezo::core::QualityGovernor::Step& step) {
+  if (!context || !context->jvm || !context->engine_object || !context->quality_method) {
+    return;
+  }
+
+  bool did_attach = false;
+  JNIEnv* env = GetEnvForCallback(context->jvm, &did_attach);
+  if (!env) {
+    return;
+  }
+
+  env->CallVoidMethod(context->engine_object, context->quality_method,
+                      static_cast<jint>(step.level),
+                      static_cast<jint>(step.previous_level),
+                      static_cast<jint>(step.reason),
+                      static_cast<jdouble>(step.window.p90_load_percent),
+                      static_cast<jlong>(step.window.deadline_misses),
+                      static_cast<jlong>(step.window.xruns));
+  if (env->ExceptionCheck()) {
+    env->ExceptionClear();
+  }
+
+  if (did_attach) {
+    context->jvm->DetachCurrentThread();
+  }
+}
+
 }  // namespace
 
 namespace sezo {
@@ -304,6 +437,40 @@ Java_com_sezo_audioengine_AudioEngine_nativeUnloadAllTracks(
   }
 }
 
+JNIEXPORT jboolean JNICALL
+Java_com_sezo_audioengine_AudioEngine_nativeEnablePcmCache(
+    JNIEnv* env [[maybe_unused]], jobject thiz [[maybe_unused]], jlong handle, jstring directory,
+    jlong max_bytes, jboolean use_float) {
+  (void)thiz;
+  auto* engine = reinterpret_cast<AudioEngine*>(handle);
+  if (!engine) {
+    return JNI_FALSE;
+  }
+
+  std::string dir = JNIHelper::JStringToString(env, directory);
+  return engine->EnablePcmCache(dir, max_bytes, use_float == JNI_TRUE) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL
+Java_com_sezo_audioengine_AudioEngine_nativeDisablePcmCache(
+    JNIEnv* env [[maybe_unused]], jobject thiz [[maybe_unused]], jlong handle) {
+  (void)env;
+  (void)thiz;
+  auto* engine = reinterpret_cast<AudioEngine*>(handle);
+  if (engine) {
+    engine->DisablePcmCache();
+  }
+}
+
+JNIEXPORT void JNICALL
+Java_com_sezo_audioengine_AudioEngine_nativeSetPlanarSignalPath(
+    JNIEnv* env [[maybe_unused]], jobject thiz [[maybe_unused]], jlong handle, jboolean enabled) {
+  auto* engine = reinterpret_cast<AudioEngine*>(handle);
+  if (engine) {
+    engine->SetPlanarSignalPath(enabled == JNI_TRUE);
+  }
+}
+
 JNIEXPORT void JNICALL
 Java_com_sezo_audioengine_AudioEngine_nativePlay(JNIEnv* env [[maybe_unused]], jobject thiz [[maybe_unused]], jlong handle) {
   (void)env;
@@ -395,6 +562,137 @@ Java_com_sezo_audioengine_AudioEngine_nativeGetDuration(JNIEnv* env [[maybe_unus
   return engine->GetDuration();
 }
 
+JNIEXPORT void JNICALL
+Java_com_sezo_audioengine_AudioEngine_nativeSetSeekPrimeMs(
+    JNIEnv* env [[maybe_unused]], jobject thiz [[maybe_unused]], jlong handle, jdouble prime_ms) {
+  auto* engine = reinterpret_cast<AudioEngine*>(handle);
+  if (engine) {
+    engine->SetSeekPrimeMs(prime_ms);
+  }
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_sezo_audioengine_AudioEngine_nativeIsSeekReady(
+    JNIEnv* env [[maybe_unused]], jobject thiz [[maybe_unused]], jlong handle) {
+  auto* engine = reinterpret_cast<AudioEngine*>(handle);
+  if (!engine) {
+    return JNI_FALSE;
+  }
+  return engine->IsSeekReady() ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jdouble JNICALL
+Java_com_sezo_audioengine_AudioEngine_nativeGetSeekReadyLatencyMs(
+    JNIEnv* env [[maybe_unused]], jobject thiz [[maybe_unused]], jlong handle) {
+  auto* engine = reinterpret_cast<AudioEngine*>(handle);
+  if (!engine) {
+    return -1.0;
+  }
+  return engine->GetSeekReadyLatencyMs();
+}
+
+JNIEXPORT jobject JNICALL
+Java_com_sezo_audioengine_AudioEngine_nativeGetRealtimeStats(
+    JNIEnv* env, jobject thiz [[maybe_unused]], jlong handle) {
+  auto* engine = reinterpret_cast<AudioEngine*>(handle);
+  if (!engine) {
+    return nullptr;
+  }
+
+  const auto stats = engine->GetRealtimeStats();
+  const auto& callback = stats.callback;
+
+  jclass hashMapClass = env->FindClass("java/util/HashMap");
+  jmethodID hashMapInit = env->GetMethodID(hashMapClass, "<init>", "()V");
+  jmethodID hashMapPut = env->GetMethodID(hashMapClass, "put",
+      "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;");
+  jclass longClass = env->FindClass("java/lang/Long");
+  jmethodID longInit = env->GetMethodID(longClass, "<init>", "(J)V");
+  jclass doubleClass = env->FindClass("java/lang/Double");
+  jmethodID doubleInit = env->GetMethodID(doubleClass, "<init>", "(D)V");
+
+  jobject resultMap = env->NewObject(hashMapClass, hashMapInit);
+  auto putLong = [&](const char* key, int64_t value) {
+    jobject valueObj = env->NewObject(longClass, longInit, static_cast<jlong>(value));
+    jstring keyStr = env->NewStringUTF(key);
+    env->CallObjectMethod(resultMap, hashMapPut, keyStr, valueObj);
+    env->DeleteLocalRef(keyStr);
+    env->DeleteLocalRef(valueObj);
+  };
+  auto putDouble = [&](const char* key, double value) {
+    jobject valueObj = env->NewObject(doubleClass, doubleInit, static_cast<jdouble>(value));
+    jstring keyStr = env->NewStringUTF(key);
+    env->CallObjectMethod(resultMap, hashMapPut, keyStr, valueObj);
+    env->DeleteLocalRef(keyStr);
+    env->DeleteLocalRef(valueObj);
+  };
+
+  putLong("callbacks", static_cast<int64_t>(callback.callbacks));
+  putLong("frames", static_cast<int64_t>(callback.frames));
+  putLong("framesPerCallback", callback.frames_per_callback);
+  putLong("sampleRate", callback.sample_rate);
+  putDouble("periodUs", callback.period_us);
+  putDouble("meanDurationUs", callback.mean_duration_us);
+  putDouble("maxDurationUs", callback.max_duration_us);
+  putDouble("p50DurationUs", callback.p50_duration_us);
+  putDouble("p90DurationUs", callback.p90_duration_us);
+  putDouble("p99DurationUs", callback.p99_duration_us);
+  putDouble("p999DurationUs", callback.p999_duration_us);
+  putDouble("p50LoadPercent", callback.p50_load_percent);
+  putDouble("p99LoadPercent", callback.p99_load_percent);
+  putDouble("maxLoadPercent", callback.max_load_percent);
+  putLong("deadlineMisses", static_cast<int64_t>(callback.deadline_misses));
+  putDouble("maxIntervalUs", callback.max_interval_us);
+  putLong("xrunCount", stats.xrun_count);
+  putLong("trackUnderruns", static_cast<int64_t>(stats.track_underruns));
+  putLong("renderWorkers", static_cast<int64_t>(stats.parallel_render.workers));
+  putLong("parallelBatches", static_cast<int64_t>(stats.parallel_render.pool.batches));
+  putLong("lateParallelBatches", static_cast<int64_t>(stats.parallel_render.pool.late_batches));
+  putLong("tasksOnRenderWorkers",
+          static_cast<int64_t>(stats.parallel_render.pool.tasks_on_workers));
+  putLong("parallelFallbackBlocks", static_cast<int64_t>(stats.parallel_render.fallback_blocks));
+
+  // Histogram as parallel arrays: bucket upper bounds (us) and counts. The
+  // last bound is +Inf.
+  const jsize bucket_count = static_cast<jsize>(core::CallbackStats::kDurationBuckets);
+  jdoubleArray bounds = env->NewDoubleArray(bucket_count);
+  jlongArray counts = env->NewLongArray(bucket_count);
+  std::vector<jdouble> bound_values(bucket_count);
+  std::vector<jlong> count_values(bucket_count);
+  for (jsize i = 0; i < bucket_count; ++i) {
+    bound_values[i] = core::CallbackStats::DurationBucketUpperUs(static_cast<size_t>(i));
+    count_values[i] = static_cast<jlong>(callback.duration_histogram[static_cast<size_t>(i)]);
+  }
+  env->SetDoubleArrayRegion(bounds, 0, bucket_count, bound_values.data());
+  env->SetLongArrayRegion(counts, 0, bucket_count, count_values.data());
+  env->CallObjectMethod(resultMap, hashMapPut,
+                        env->NewStringUTF("histogramUpperUs"), bounds);
+  env->CallObjectMethod(resultMap, hashMapPut,
+                        env->NewStringUTF("histogramCounts"), counts);
+
+  jobject underrunMap = env->NewObject(hashMapClass, hashMapInit);
+  for (const auto& pair : stats.track_underrun_counts) {
+    jobject valueObj = env->NewObject(longClass, longInit, static_cast<jlong>(pair.second));
+    jstring keyStr = JNIHelper::StringToJString(env, pair.first);
+    env->CallObjectMethod(underrunMap, hashMapPut, keyStr, valueObj);
+    env->DeleteLocalRef(keyStr);
+    env->DeleteLocalRef(valueObj);
+  }
+  env->CallObjectMethod(resultMap, hashMapPut,
+                        env->NewStringUTF("trackUnderrunCounts"), underrunMap);
+
+  return resultMap;
+}
+
+JNIEXPORT void JNICALL
+Java_com_sezo_audioengine_AudioEngine_nativeResetRealtimeStats(
+    JNIEnv* env [[maybe_unused]], jobject thiz [[maybe_unused]], jlong handle) {
+  auto* engine = reinterpret_cast<AudioEngine*>(handle);
+  if (engine) {
+    engine->ResetRealtimeStats();
+  }
+}
+
 JNIEXPORT void JNICALL
 Java_com_sezo_audioengine_AudioEngine_nativeSetPlaybackStateListener(
     JNIEnv* env, jobject thiz, jlong handle, jboolean enabled) {
@@ -531,6 +829,149 @@ Java_com_sezo_audioengine_AudioEngine_nativeGetSpeed(JNIEnv* env [[maybe_unused]
   return engine->GetSpeed();
 }
 
+JNIEXPORT void JNICALL
+Java_com_sezo_audioengine_AudioEngine_nativeSetMasterBusStretch(
+    JNIEnv* env [[maybe_unused]], jobject thiz [[maybe_unused]], jlong handle, jboolean enabled) {
+  auto* engine = reinterpret_cast<AudioEngine*>(handle);
+  if (engine) {
+    engine->SetMasterBusStretch(enabled == JNI_TRUE);
+  }
+}
+
+JNIEXPORT void JNICALL
+Java_com_sezo_audioengine_AudioEngine_nativeSetVarispeed(
+    JNIEnv* env [[maybe_unused]], jobject thiz [[maybe_unused]], jlong handle, jboolean enabled) {
+  auto* engine = reinterpret_cast<AudioEngine*>(handle);
+  if (engine) {
+    engine->SetVarispeed(enabled == JNI_TRUE);
+  }
+}
+
+JNIEXPORT void JNICALL
+Java_com_sezo_audioengine_AudioEngine_nativeSetVarispeedQuality(
+    JNIEnv* env [[maybe_unused]], jobject thiz [[maybe_unused]], jlong handle, jint quality) {
+  auto* engine = reinterpret_cast<AudioEngine*>(handle);
+  if (engine) {
+    engine->SetVarispeedQuality(quality == 0 ? dsp::Varispeed::Quality::kCubic
+                                             : dsp::Varispeed::Quality::kSinc);
+  }
+}
+
+JNIEXPORT void JNICALL
+Java_com_sezo_audioengine_AudioEngine_nativeSetStretchAhead(
+    JNIEnv* env [[maybe_unused]], jobject thiz [[maybe_unused]], jlong handle, jboolean enabled,
+    jdouble max_latency_ms) {
+  auto* engine = reinterpret_cast<AudioEngine*>(handle);
+  if (engine) {
+    engine->SetStretchAhead(enabled == JNI_TRUE, max_latency_ms);
+  }
+}
+
+JNIEXPORT jdouble JNICALL
+Java_com_sezo_audioengine_AudioEngine_nativeGetEffectLatencyMs(
+    JNIEnv* env [[maybe_unused]], jobject thiz [[maybe_unused]], jlong handle) {
+  auto* engine = reinterpret_cast<AudioEngine*>(handle);
+  if (!engine) {
+    return 0.0;
+  }
+  return engine->GetEffectLatencyMs();
+}
+
+JNIEXPORT jdouble JNICALL
+Java_com_sezo_audioengine_AudioEngine_nativeGetProcessingLatencyMs(
+    JNIEnv* env [[maybe_unused]], jobject thiz [[maybe_unused]], jlong handle) {
+  auto* engine = reinterpret_cast<AudioEngine*>(handle);
+  if (!engine) {
+    return 0.0;
+  }
+  return engine->GetProcessingLatencyMs();
+}
+
+JNIEXPORT void JNICALL
+Java_com_sezo_audioengine_AudioEngine_nativeSetParallelRender(
+    JNIEnv* env [[maybe_unused]], jobject thiz [[maybe_unused]], jlong handle, jboolean enabled,
+    jint worker_count) {
+  auto* engine = reinterpret_cast<AudioEngine*>(handle);
+  if (engine) {
+    engine->SetParallelRender(enabled == JNI_TRUE, worker_count);
+  }
+}
+
+JNIEXPORT void JNICALL
+Java_com_sezo_audioengine_AudioEngine_nativeSetQualityGovernor(
+    JNIEnv* env [[maybe_unused]], jobject thiz [[maybe_unused]], jlong handle, jboolean enabled,
+    jint window_ms, jdouble step_down_load_percent, jdouble step_up_load_percent,
+    jint calm_windows_to_step_up, jint hold_windows, jint max_level, jint crossfade_ms) {
+  auto* engine = reinterpret_cast<AudioEngine*>(handle);
+  if (!engine) {
+    return;
+  }
+  core::QualityGovernor::Config config;
+  config.window_ms = window_ms;
+  config.step_down_load_percent = step_down_load_percent;
+  config.step_up_load_percent = step_up_load_percent;
+  config.calm_windows_to_step_up = calm_windows_to_step_up;
+  config.hold_windows = hold_windows;
+  config.max_level = max_level;
+  config.crossfade_ms = crossfade_ms;
+  engine->SetQualityGovernor(enabled == JNI_TRUE, config);
+}
+
+JNIEXPORT void JNICALL
+Java_com_sezo_audioengine_AudioEngine_nativeSetQualityLevel(
+    JNIEnv* env [[maybe_unused]], jobject thiz [[maybe_unused]], jlong handle, jint level) {
+  auto* engine = reinterpret_cast<AudioEngine*>(handle);
+  if (engine) {
+    engine->SetQualityLevel(level);
+  }
+}
+
+JNIEXPORT jint JNICALL
+Java_com_sezo_audioengine_AudioEngine_nativeGetQualityLevel(
+    JNIEnv* env [[maybe_unused]], jobject thiz [[maybe_unused]], jlong handle) {
+  auto* engine = reinterpret_cast<AudioEngine*>(handle);
+  if (!engine) {
+    return 0;
+  }
+  return engine->GetQualityLevel();
+}
+
+JNIEXPORT void JNICALL
+Java_com_sezo_audioengine_AudioEngine_nativeSetQualityChangeListener(
+    JNIEnv* env, jobject thiz, jlong handle, jboolean enabled) {
+  auto* engine = reinterpret_cast<AudioEngine*>(handle);
+  if (!engine) {
+    return;
+  }
+  if (!enabled || !g_java_vm) {
+    engine->SetQualityChangeCallback(nullptr);
+    return;
+  }
+
+  jclass engine_class = env->GetObjectClass(thiz);
+  jmethodID quality_method = env->GetMethodID(
+      engine_class, "onNativeQualityChanged", "(IIIDJJ)V");
+  if (!quality_method) {
+    if (env->ExceptionCheck()) {
+      env->ExceptionClear();
+    }
+    LOGE("Failed to find onNativeQualityChanged");
+    engine->SetQualityChangeCallback(nullptr);
+    return;
+  }
+
+  auto context = std::shared_ptr<JniQualityCallbackContext>(
+      new JniQualityCallbackContext(), DeleteQualityContext);
+  context->jvm = g_java_vm;
+  context->engine_object = env->NewGlobalRef(thiz);
+  context->quality_method = quality_method;
+
+  engine->SetQualityChangeCallback(
+      [context](const core::QualityGovernor::Step& step) {
+        CallQualityCallback(context, step);
+      });
+}
+
 // Phase 2: Per-track effects
 JNIEXPORT void JNICALL
 Java_com_sezo_audioengine_AudioEngine_nativeSetTrackPitch(
@@ -582,6 +1023,18 @@ Java_com_sezo_audioengine_AudioEngine_nativeGetTrackSpeed(
   return 1.0f;
 }
 
+JNIEXPORT void JNICALL
+Java_com_sezo_audioengine_AudioEngine_nativeSetTrackVarispeed(
+    JNIEnv* env, jobject thiz [[maybe_unused]], jlong handle, jstring track_id, jboolean enabled) {
+  auto* engine = reinterpret_cast<AudioEngine*>(handle);
+  if (engine && track_id) {
+    const char* id_chars = env->GetStringUTFChars(track_id, nullptr);
+    std::string id_str(id_chars);
+    env->ReleaseStringUTFChars(track_id, id_chars);
+    engine->SetTrackVarispeed(id_str, enabled == JNI_TRUE);
+  }
+}
+
 // Phase 3: Recording
 JNIEXPORT jboolean JNICALL
 Java_com_sezo_audioengine_AudioEngine_nativeStartRecording(
@@ -702,7 +1155,8 @@ Java_com_sezo_audioengine_AudioEngine_nativeSetRecordingVolume(
 JNIEXPORT jobject JNICALL
 Java_com_sezo_audioengine_AudioEngine_nativeExtractTrack(
     JNIEnv* env, jobject thiz [[maybe_unused]], jlong handle, jstring track_id, jstring output_path,
-    jstring format, jint bitrate, jint bits_per_sample, jboolean include_effects) {
+    jstring format, jint bitrate, jint bits_per_sample, jboolean include_effects,
+    jdouble start_ms, jdouble end_ms) {
 
   auto* engine = reinterpret_cast<AudioEngine*>(handle);
   if (!engine) {
@@ -720,6 +1174,8 @@ Java_com_sezo_audioengine_AudioEngine_nativeExtractTrack(
   options.bitrate = static_cast<int32_t>(bitrate);
   options.bits_per_sample = static_cast<int32_t>(bits_per_sample);
   options.include_effects = (include_effects == JNI_TRUE);
+  options.start_ms = static_cast<double>(start_ms);
+  options.end_ms = static_cast<double>(end_ms);
 
   // Setup progress callback
   jclass engine_class = env->GetObjectClass(thiz);
@@ -748,7 +1204,8 @@ Java_com_sezo_audioengine_AudioEngine_nativeExtractTrack(
 JNIEXPORT jobject JNICALL
 Java_com_sezo_audioengine_AudioEngine_nativeExtractAllTracks(
     JNIEnv* env, jobject thiz [[maybe_unused]], jlong handle, jstring output_path,
-    jstring format, jint bitrate, jint bits_per_sample, jboolean include_effects) {
+    jstring format, jint bitrate, jint bits_per_sample, jboolean include_effects,
+    jdouble start_ms, jdouble end_ms) {
 
   auto* engine = reinterpret_cast<AudioEngine*>(handle);
   if (!engine) {
@@ -765,6 +1222,8 @@ Java_com_sezo_audioengine_AudioEngine_nativeExtractAllTracks(
   options.bitrate = static_cast<int32_t>(bitrate);
   options.bits_per_sample = static_cast<int32_t>(bits_per_sample);
   options.include_effects = (include_effects == JNI_TRUE);
+  options.start_ms = static_cast<double>(start_ms);
+  options.end_ms = static_cast<double>(end_ms);
 
   // Setup progress callback
   jclass engine_class = env->GetObjectClass(thiz);
@@ -794,7 +1253,8 @@ JNIEXPORT jlong JNICALL
 Java_com_sezo_audioengine_AudioEngine_nativeStartExtractTrack(
     JNIEnv* env, jobject thiz [[maybe_unused]], jlong handle, jstring track_id,
     jstring output_path, jstring format, jint bitrate, jint bits_per_sample,
-    jboolean include_effects) {
+    jboolean include_effects, jint priority, jlong deadline_ms, jdouble start_ms,
+    jdouble end_ms) {
 
   auto* engine = reinterpret_cast<AudioEngine*>(handle);
   if (!engine || !g_java_vm) {
@@ -810,6 +1270,10 @@ Java_com_sezo_audioengine_AudioEngine_nativeStartExtractTrack(
   options.bitrate = static_cast<int32_t>(bitrate);
   options.bits_per_sample = static_cast<int32_t>(bits_per_sample);
   options.include_effects = (include_effects == JNI_TRUE);
+  options.priority = static_cast<int32_t>(priority);
+  options.deadline_ms = static_cast<int64_t>(deadline_ms);
+  options.start_ms = static_cast<double>(start_ms);
+  options.end_ms = static_cast<double>(end_ms);
 
   jclass engine_class = env->GetObjectClass(thiz);
   jmethodID progress_method = env->GetMethodID(
@@ -861,7 +1325,8 @@ Java_com_sezo_audioengine_AudioEngine_nativeStartExtractTrack(
 JNIEXPORT jlong JNICALL
 Java_com_sezo_audioengine_AudioEngine_nativeStartExtractAllTracks(
     JNIEnv* env, jobject thiz [[maybe_unused]], jlong handle, jstring output_path,
-    jstring format, jint bitrate, jint bits_per_sample, jboolean include_effects) {
+    jstring format, jint bitrate, jint bits_per_sample, jboolean include_effects,
+    jint priority, jlong deadline_ms, jdouble start_ms, jdouble end_ms) {
 
   auto* engine = reinterpret_cast<AudioEngine*>(handle);
   if (!engine || !g_java_vm) {
@@ -876,6 +1341,10 @@ Java_com_sezo_audioengine_AudioEngine_nativeStartExtractAllTracks(
   options.bitrate = static_cast<int32_t>(bitrate);
   options.bits_per_sample = static_cast<int32_t>(bits_per_sample);
   options.include_effects = (include_effects == JNI_TRUE);
+  options.priority = static_cast<int32_t>(priority);
+  options.deadline_ms = static_cast<int64_t>(deadline_ms);
+  options.start_ms = static_cast<double>(start_ms);
+  options.end_ms = static_cast<double>(end_ms);
 
   jclass engine_class = env->GetObjectClass(thiz);
   jmethodID progress_method = env->GetMethodID(
@@ -924,6 +1393,88 @@ Java_com_sezo_audioengine_AudioEngine_nativeStartExtractAllTracks(
   return job_id;
 }
 
+JNIEXPORT jlong JNICALL
+Java_com_sezo_audioengine_AudioEngine_nativeStartExtractStems(
+    JNIEnv* env, jobject thiz [[maybe_unused]], jlong handle, jobjectArray track_ids,
+    jstring output_dir, jstring mix_output_path, jstring format, jint bitrate,
+    jint bits_per_sample, jboolean include_effects, jint render_threads,
+    jlong memory_budget_bytes, jint priority, jlong deadline_ms) {
+
+  auto* engine = reinterpret_cast<AudioEngine*>(handle);
+  if (!engine || !g_java_vm) {
+    return 0;
+  }
+
+  std::vector<std::string> track_id_list;
+  const jsize track_count = track_ids ? env->GetArrayLength(track_ids) : 0;
+  for (jsize i = 0; i < track_count; ++i) {
+    auto track_id = static_cast<jstring>(env->GetObjectArrayElement(track_ids, i));
+    track_id_list.push_back(JNIHelper::JStringToString(env, track_id));
+    env->DeleteLocalRef(track_id);
+  }
+  std::string output_dir_str = JNIHelper::JStringToString(env, output_dir);
+  std::string mix_output_path_str =
+      mix_output_path ? JNIHelper::JStringToString(env, mix_output_path) : std::string();
+  std::string format_str = JNIHelper::JStringToString(env, format);
+
+  AudioEngine::ExtractionOptions options;
+  options.format = format_str;
+  options.bitrate = static_cast<int32_t>(bitrate);
+  options.bits_per_sample = static_cast<int32_t>(bits_per_sample);
+  options.include_effects = (include_effects == JNI_TRUE);
+  options.render_threads = static_cast<int32_t>(render_threads);
+  options.memory_budget_bytes = static_cast<int64_t>(memory_budget_bytes);
+  options.priority = static_cast<int32_t>(priority);
+  options.deadline_ms = static_cast<int64_t>(deadline_ms);
+
+  jclass engine_class = env->GetObjectClass(thiz);
+  jmethodID progress_method = env->GetMethodID(
+      engine_class, "onNativeExtractionProgress", "(JF)V");
+  jmethodID completion_method = env->GetMethodID(
+      engine_class, "onNativeStemExportComplete", "(JLjava/util/Map;)V");
+
+  if (!progress_method && env->ExceptionCheck()) {
+    env->ExceptionClear();
+  }
+
+  if (!completion_method) {
+    if (env->ExceptionCheck()) {
+      env->ExceptionClear();
+    }
+    LOGE("Failed to find onNativeStemExportComplete");
+    return 0;
+  }
+
+  auto context = std::make_shared<JniExtractionCallbackContext>();
+  context->jvm = g_java_vm;
+  context->engine_object = env->NewGlobalRef(thiz);
+  context->progress_method = progress_method;
+  context->completion_method = completion_method;
+
+  auto job_id_holder = std::make_shared<std::atomic<int64_t>>(0);
+
+  auto progress_callback = [context, job_id_holder](float progress) {
+    CallProgressCallback(context, job_id_holder->load(std::memory_order_acquire), progress);
+  };
+
+  auto completion_callback =
+      [context, job_id_holder](int64_t job_id, const AudioEngine::StemExportResult& result) {
+        job_id_holder->store(job_id, std::memory_order_release);
+        CallStemExportCompletionCallback(context, job_id, result);
+      };
+
+  int64_t job_id = engine->StartExtractStems(
+      track_id_list, output_dir_str, mix_output_path_str, options, progress_callback,
+      completion_callback);
+  job_id_holder->store(job_id, std::memory_order_release);
+
+  if (job_id == 0) {
+    env->DeleteGlobalRef(context->engine_object);
+  }
+
+  return job_id;
+}
+
 JNIEXPORT jboolean JNICALL
 Java_com_sezo_audioengine_AudioEngine_nativeCancelExtraction(
     JNIEnv* env [[maybe_unused]], jobject thiz [[maybe_unused]],
@@ -935,4 +1486,76 @@ Java_com_sezo_audioengine_AudioEngine_nativeCancelExtraction(
   return engine->CancelExtraction(job_id) ? JNI_TRUE : JNI_FALSE;
 }
 
+JNIEXPORT void JNICALL
+Java_com_sezo_audioengine_AudioEngine_nativeSetExtractionConcurrency(
+    JNIEnv* env [[maybe_unused]], jobject thiz [[maybe_unused]], jlong handle, jint jobs) {
+  auto* engine = reinterpret_cast<AudioEngine*>(handle);
+  if (engine) {
+    engine->SetExtractionConcurrency(jobs);
+  }
+}
+
+JNIEXPORT void JNICALL
+Java_com_sezo_audioengine_AudioEngine_nativeSetExtractionsPaused(
+    JNIEnv* env [[maybe_unused]], jobject thiz [[maybe_unused]], jlong handle,
+    jboolean paused) {
+  auto* engine = reinterpret_cast<AudioEngine*>(handle);
+  if (!engine) {
+    return;
+  }
+  if (paused == JNI_TRUE) {
+    engine->PauseExtractions();
+  } else {
+    engine->ResumeExtractions();
+  }
+}
+
+JNIEXPORT jobject JNICALL
+Java_com_sezo_audioengine_AudioEngine_nativeGetExtractionMetrics(
+    JNIEnv* env, jobject thiz [[maybe_unused]], jlong handle) {
+  auto* engine = reinterpret_cast<AudioEngine*>(handle);
+  if (!engine) {
+    return nullptr;
+  }
+
+  const auto metrics = engine->GetExtractionMetrics();
+
+  jclass hashMapClass = env->FindClass("java/util/HashMap");
+  jmethodID hashMapInit = env->GetMethodID(hashMapClass, "<init>", "()V");
+  jmethodID hashMapPut = env->GetMethodID(hashMapClass, "put",
+      "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;");
+  jclass longClass = env->FindClass("java/lang/Long");
+  jmethodID longInit = env->GetMethodID(longClass, "<init>", "(J)V");
+  jclass doubleClass = env->FindClass("java/lang/Double");
+  jmethodID doubleInit = env->GetMethodID(doubleClass, "<init>", "(D)V");
+
+  jobject resultMap = env->NewObject(hashMapClass, hashMapInit);
+  auto putLong = [&](const char* key, int64_t value) {
+    jobject valueObj = env->NewObject(longClass, longInit, static_cast<jlong>(value));
+    jstring keyStr = env->NewStringUTF(key);
+    env->CallObjectMethod(resultMap, hashMapPut, keyStr, valueObj);
+    env->DeleteLocalRef(keyStr);
+    env->DeleteLocalRef(valueObj);
+  };
+  auto putDouble = [&](const char* key, double value) {
+    jobject valueObj = env->NewObject(doubleClass, doubleInit, static_cast<jdouble>(value));
+    jstring keyStr = env->NewStringUTF(key);
+    env->CallObjectMethod(resultMap, hashMapPut, keyStr, valueObj);
+    env->DeleteLocalRef(keyStr);
+    env->DeleteLocalRef(valueObj);
+  };
+
+  putLong("concurrency", metrics.concurrency);
+  putLong("paused", metrics.paused ? 1 : 0);
+  putLong("queued", static_cast<int64_t>(metrics.queued));
+  putLong("running", static_cast<int64_t>(metrics.running));
+  putLong("submitted", static_cast<int64_t>(metrics.submitted));
+  putLong("completed", static_cast<int64_t>(metrics.completed));
+  putLong("missedDeadlines", static_cast<int64_t>(metrics.missed_deadlines));
+  putDouble("meanWaitMs", metrics.mean_wait_ms);
+  putDouble("maxWaitMs", metrics.max_wait_ms);
+  putDouble("oldestQueuedMs", metrics.oldest_queued_ms);
+  return resultMap;
+}
+
 }  // extern "C"
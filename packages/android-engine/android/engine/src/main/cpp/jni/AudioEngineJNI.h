@@ -152,25 +152,48 @@ Java_com_sezo_audioengine_AudioEngine_nativeGetSpeed(JNIEnv* env, jobject thiz,
 JNIEXPORT jobject JNICALL
 Java_com_sezo_audioengine_AudioEngine_nativeExtractTrack(
     JNIEnv* env, jobject thiz, jlong handle, jstring track_id, jstring output_path,
-    jstring format, jint bitrate, jint bits_per_sample, jboolean include_effects);
+    jstring format, jint bitrate, jint bits_per_sample, jboolean include_effects,
+    jdouble start_ms, jdouble end_ms);
 
 JNIEXPORT jobject JNICALL
 Java_com_sezo_audioengine_AudioEngine_nativeExtractAllTracks(
     JNIEnv* env, jobject thiz, jlong handle, jstring output_path,
-    jstring format, jint bitrate, jint bits_per_sample, jboolean include_effects);
+    jstring format, jint bitrate, jint bits_per_sample, jboolean include_effects,
+    jdouble start_ms, jdouble end_ms);
 
 JNIEXPORT jlong JNICALL
 Java_com_sezo_audioengine_AudioEngine_nativeStartExtractTrack(
     JNIEnv* env, jobject thiz, jlong handle, jstring track_id, jstring output_path,
-    jstring format, jint bitrate, jint bits_per_sample, jboolean include_effects);
+    jstring format, jint bitrate, jint bits_per_sample, jboolean include_effects,
+    jint priority, jlong deadline_ms, jdouble start_ms, jdouble end_ms);
 
 JNIEXPORT jlong JNICALL
 Java_com_sezo_audioengine_AudioEngine_nativeStartExtractAllTracks(
     JNIEnv* env, jobject thiz, jlong handle, jstring output_path,
-    jstring format, jint bitrate, jint bits_per_sample, jboolean include_effects);
+    jstring format, jint bitrate, jint bits_per_sample, jboolean include_effects,
+    jint priority, jlong deadline_ms, jdouble start_ms, jdouble end_ms);
+
+JNIEXPORT jlong JNICALL
+Java_com_sezo_audioengine_AudioEngine_nativeStartExtractStems(
+    JNIEnv* env, jobject thiz, jlong handle, jobjectArray track_ids, jstring output_dir,
+    jstring mix_output_path, jstring format, jint bitrate, jint bits_per_sample,
+    jboolean include_effects, jint render_threads, jlong memory_budget_bytes,
+    jint priority, jlong deadline_ms);
 
 JNIEXPORT jboolean JNICALL
 Java_com_sezo_audioengine_AudioEngine_nativeCancelExtraction(
     JNIEnv* env, jobject thiz, jlong handle, jlong job_id);
 
+JNIEXPORT void JNICALL
+Java_com_sezo_audioengine_AudioEngine_nativeSetExtractionConcurrency(
+    JNIEnv* env, jobject thiz, jlong handle, jint jobs);
+
+JNIEXPORT void JNICALL
+Java_com_sezo_audioengine_AudioEngine_nativeSetExtractionsPaused(
+    JNIEnv* env, jobject thiz, jlong handle, jboolean paused);
+
+JNIEXPORT jobject JNICALL
+Java_com_sezo_audioengine_AudioEngine_nativeGetExtractionMetrics(
+    JNIEnv* env, jobject thiz, jlong handle);
+
 }  // extern "C"
@@ -0,0 +1,164 @@
+#include "DecodeScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <android/log.h>
+
+#define LOG_TAG "DecodeScheduler"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+
+namespace sezo {
+namespace playback {
+
+namespace {
+
+// Upper bound on pool size; decoding is mostly I/O and short bursts of CPU.
+constexpr size_t kMaxDefaultWorkers = 4;
+
+// RequestDecode() does not take the mutex, so a wakeup can in rare cases land
+// between a worker's check and its wait. This only bounds that case.
+constexpr auto kMissedWakeupBackstop = std::chrono::milliseconds(100);
+
+}  // namespace
+
+DecodeScheduler::DecodeScheduler(size_t worker_count) {
+  if (worker_count == 0) {
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    worker_count = std::min(cores, kMaxDefaultWorkers);
+  }
+
+  workers_.reserve(worker_count);
+  for (size_t i = 0; i < worker_count; ++i) {
+    workers_.emplace_back(&DecodeScheduler::WorkerLoop, this);
+  }
+  LOGD("Decode scheduler started with %zu workers", worker_count);
+}
+
+DecodeScheduler::~DecodeScheduler() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  wake_cv_.notify_all();
+  for (auto& worker : workers_) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+std::shared_ptr<DecodeScheduler> DecodeScheduler::GetShared() {
+  static std::mutex shared_mutex;
+  static std::weak_ptr<DecodeScheduler> shared_instance;
+
+  std::lock_guard<std::mutex> lock(shared_mutex);
+  auto scheduler = shared_instance.lock();
+  if (!scheduler) {
+    scheduler = std::make_shared<DecodeScheduler>();
+    shared_instance = scheduler;
+  }
+  return scheduler;
+}
+
+uint64_t DecodeScheduler::Register(Client* client, const std::string& name) {
+  uint64_t id = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto entry = std::make_unique<Entry>();
+    entry->id = next_id_++;
+    entry->client = client;
+    entry->name = name;
+    id = entry->id;
+    entries_.push_back(std::move(entry));
+  }
+  RequestDecode();
+  return id;
+}
+
+void DecodeScheduler::Unregister(uint64_t id) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto it = std::find_if(entries_.begin(), entries_.end(),
+                         [id](const std::unique_ptr<Entry>& entry) { return entry->id == id; });
+  if (it == entries_.end()) {
+    return;
+  }
+
+  Entry* entry = it->get();
+  idle_cv_.wait(lock, [entry] { return !entry->busy; });
+
+  // The vector may have changed while waiting; look the entry up again.
+  entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+                                [id](const std::unique_ptr<Entry>& e) { return e->id == id; }),
+                 entries_.end());
+}
+
+void DecodeScheduler::RequestDecode() {
+  wake_epoch_.fetch_add(1, std::memory_order_release);
+  wake_cv_.notify_one();
+}
+
+std::vector<DecodeScheduler::ClientStats> DecodeScheduler::GetClientStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<ClientStats> stats;
+  stats.reserve(entries_.size());
+  for (const auto& entry : entries_) {
+    ClientStats client_stats;
+    client_stats.name = entry->name;
+    client_stats.fill_ratio = entry->client->GetFillRatio();
+    client_stats.chunks_decoded = entry->chunks_decoded;
+    client_stats.starvation_count = entry->client->GetStarvationCount();
+    stats.push_back(std::move(client_stats));
+  }
+  return stats;
+}
+
+DecodeScheduler::Entry* DecodeScheduler::PickMostUrgentLocked(bool* more_pending) {
+  Entry* best = nullptr;
+  float best_fill = 2.0f;
+  size_t candidates = 0;
+  for (const auto& entry : entries_) {
+    if (entry->busy || !entry->client->NeedsDecode()) {
+      continue;
+    }
+    ++candidates;
+    const float fill = entry->client->GetFillRatio();
+    if (fill < best_fill) {
+      best_fill = fill;
+      best = entry.get();
+    }
+  }
+  *more_pending = candidates > 1;
+  return best;
+}
+
+void DecodeScheduler::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!shutdown_) {
+    const uint64_t seen_epoch = wake_epoch_.load(std::memory_order_acquire);
+    bool more_pending = false;
+    Entry* entry = PickMostUrgentLocked(&more_pending);
+    if (!entry) {
+      wake_cv_.wait_for(lock, kMissedWakeupBackstop, [this, seen_epoch] {
+        return shutdown_ || wake_epoch_.load(std::memory_order_acquire) != seen_epoch;
+      });
+      continue;
+    }
+
+    entry->busy = true;
+    if (more_pending) {
+      // Let an idle worker pick up the next most urgent client in parallel.
+      wake_cv_.notify_one();
+    }
+
+    lock.unlock();
+    entry->client->DecodeChunk();
+    lock.lock();
+
+    ++entry->chunks_decoded;
+    entry->busy = false;
+    idle_cv_.notify_all();
+  }
+}
+
+}  // namespace playback
+}  // namespace sezo
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sezo {
+namespace playback {
+
+/**
+ * Fixed-size pool of decode threads shared by all tracks.
+ *
+ * Workers service whichever registered client has the emptiest ring buffer
+ * first. They sleep until a client requests more data (typically when its
+ * buffer drops below a low watermark) instead of polling on a timer.
+ */
+class DecodeScheduler {
+ public:
+  /**
+   * Something with a ring buffer that the scheduler keeps filled.
+   * All methods are called from worker threads.
+   */
+  class Client {
+   public:
+    virtual ~Client() = default;
+
+    /**
+     * Fill level of the client's buffer; lower values are serviced first.
+     * @return Fill ratio in [0, 1]
+     */
+    virtual float GetFillRatio() const = 0;
+
+    /**
+     * Check whether the client can accept another decoded chunk.
+     * @return true if a DecodeChunk() call would make progress
+     */
+    virtual bool NeedsDecode() const = 0;
+
+    /**
+     * Decode one chunk into the client's buffer.
+     * Never called concurrently for the same client.
+     */
+    virtual void DecodeChunk() = 0;
+
+    /**
+     * Number of times the consumer found the buffer empty mid-stream.
+     * @return Starvation count
+     */
+    virtual uint64_t GetStarvationCount() const = 0;
+  };
+
+  struct ClientStats {
+    std::string name;
+    float fill_ratio = 0.0f;
+    uint64_t chunks_decoded = 0;
+    uint64_t starvation_count = 0;
+  };
+
+  /**
+   * Constructor.
+   * @param worker_count Number of decode threads (0 = based on core count)
+   */
+  explicit DecodeScheduler(size_t worker_count = 0);
+  ~DecodeScheduler();
+
+  DecodeScheduler(const DecodeScheduler&) = delete;
+  DecodeScheduler& operator=(const DecodeScheduler&) = delete;
+
+  /**
+   * Get the process-wide scheduler, creating it on first use.
+   * The pool shuts down once no track holds a reference to it.
+   */
+  static std::shared_ptr<DecodeScheduler> GetShared();
+
+  /**
+   * Register a client. It is serviced until Unregister() is called.
+   * @param client Client to service (must outlive the registration)
+   * @param name Name reported in stats
+   * @return Registration id
+   */
+  uint64_t Register(Client* client, const std::string& name);
+
+  /**
+   * Remove a client, waiting for any in-flight DecodeChunk() to finish.
+   * @param id Registration id returned by Register()
+   */
+  void Unregister(uint64_t id);
+
+  /**
+   * Wake a worker because a client may need data.
+   * Lock-free; safe to call from the audio thread.
+   */
+  void RequestDecode();
+
+  /**
+   * Snapshot of per-client counters.
+   * @return Stats for every registered client
+   */
+  std::vector<ClientStats> GetClientStats() const;
+
+  size_t GetWorkerCount() const { return workers_.size(); }
+
+ private:
+  struct Entry {
+    uint64_t id = 0;
+    Client* client = nullptr;
+    std::string name;
+    bool busy = false;
+    uint64_t chunks_decoded = 0;
+  };
+
+  void WorkerLoop();
+  Entry* PickMostUrgentLocked(bool* more_pending);
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_cv_;
+  std::condition_variable idle_cv_;
+  std::vector<std::unique_ptr<Entry>> entries_;
+  uint64_t next_id_ = 1;
+  bool shutdown_ = false;
+  std::atomic<uint64_t> wake_epoch_{0};
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace playback
+}  // namespace sezo
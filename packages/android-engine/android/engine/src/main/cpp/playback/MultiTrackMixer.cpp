@@ -1,153 +1,859 @@
 #include "MultiTrackMixer.h"
 
+#include "dsp/MixKernels.h"
+
 #include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstring>
 
 namespace sezo {
 namespace playback {
 
-MultiTrackMixer::MultiTrackMixer() = default;
+namespace {
+
+// How long the reclaim thread waits before re-checking snapshots that the
+// audio thread may still be reading.
+constexpr auto kReclaimRetryInterval = std::chrono::milliseconds(2);
+
+// Scratch buffers are sized up front so typical callbacks never allocate.
+constexpr size_t kInitialScratchFrames = 4096;
+constexpr size_t kInitialRenderTasks = 64;
+
+// Longest the priming gate stays closed after the seeks complete; a track that
+// cannot fill (e.g. a failing decoder) must not silence playback forever.
+constexpr int64_t kPrimingTimeoutNs = 1000LL * 1000 * 1000;
+
+// Fewer tracks than this are rendered on the audio thread alone; waking the
+// pool would cost more than it saves.
+constexpr size_t kParallelMinTasks = 2;
+
+// Share of the block's playback time a parallel render may take. A batch
+// that finishes later keeps the pool out of the next kParallelBackoffBlocks
+// callbacks, which the audio thread then renders on its own.
+constexpr double kParallelDeadlineFraction = 0.5;
+constexpr uint32_t kParallelBackoffBlocks = 64;
+
+// param_latest_ layout: table index in the low bits, plus a flag set by the
+// writer and cleared when Mix() takes the table.
+constexpr uint32_t kParamIndexMask = 0x3u;
+constexpr uint32_t kParamFresh = 0x4u;
+
+int64_t SteadyNowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Marks the audio thread as inside Mix() for the lifetime of the guard.
+class MixEpochGuard {
+ public:
+  explicit MixEpochGuard(std::atomic<uint64_t>& epoch) : epoch_(epoch) {
+    epoch_.fetch_add(1, std::memory_order_seq_cst);
+  }
+  ~MixEpochGuard() { epoch_.fetch_add(1, std::memory_order_seq_cst); }
+
+  MixEpochGuard(const MixEpochGuard&) = delete;
+  MixEpochGuard& operator=(const MixEpochGuard&) = delete;
+
+ private:
+  std::atomic<uint64_t>& epoch_;
+};
+
+// Gain changes are ramped across one callback to avoid zipper noise; steady
+// gains take the cheaper constant-gain kernels.
+inline bool IsFlat(const Track::GainRamp& ramp) {
+  return ramp.start_left == ramp.end_left && ramp.start_right == ramp.end_right;
+}
+
+// Accumulate a ring-buffer span (up to two segments) into the stereo output.
+// The ramp spans the whole block, so each segment gets its slice of it;
+// frames missing from a short span stay silent.
+void AccumulateSpan(const dsp::MixKernels& kernels,
+                    float* out,
+                    const core::CircularBuffer::ReadSpan& span,
+                    int32_t channels,
+                    size_t block_frames,
+                    const Track::GainRamp& ramp) {
+  const float* segments[2] = {span.first, span.second};
+  const size_t counts[2] = {span.first_count, span.second_count};
+  const bool flat = IsFlat(ramp);
+  const float delta_left = ramp.end_left - ramp.start_left;
+  const float delta_right = ramp.end_right - ramp.start_right;
+  const float inv_frames = 1.0f / static_cast<float>(block_frames);
+
+  size_t frame_offset = 0;
+  for (int i = 0; i < 2; ++i) {
+    const size_t frames = counts[i] / static_cast<size_t>(channels);
+    if (frames == 0) {
+      continue;
+    }
+    float* segment_out = out + frame_offset * 2;
+    if (flat) {
+      if (channels == 1) {
+        kernels.accumulate_mono_to_stereo(segment_out, segments[i], frames,
+                                          ramp.end_left, ramp.end_right);
+      } else {
+        kernels.accumulate_stereo(segment_out, segments[i], frames,
+                                  ramp.end_left, ramp.end_right);
+      }
+    } else {
+      const float t0 = static_cast<float>(frame_offset) * inv_frames;
+      const float t1 = static_cast<float>(frame_offset + frames) * inv_frames;
+      const float start_left = ramp.start_left + delta_left * t0;
+      const float start_right = ramp.start_right + delta_right * t0;
+      const float end_left = ramp.start_left + delta_left * t1;
+      const float end_right = ramp.start_right + delta_right * t1;
+      if (channels == 1) {
+        kernels.accumulate_mono_to_stereo_ramp(segment_out, segments[i], frames,
+                                               start_left, start_right, end_left, end_right);
+      } else {
+        kernels.accumulate_stereo_ramp(segment_out, segments[i], frames,
+                                       start_left, start_right, end_left, end_right);
+      }
+    }
+    frame_offset += frames;
+  }
+}
+
+// Planar counterpart of AccumulateSpan(): interleaves the left/right planes
+// into the stereo output while applying the gains.
+void AccumulatePlanar(const dsp::MixKernels& kernels,
+                      float* out,
+                      const Track::PlanarBlock& block,
+                      size_t block_frames,
+                      const Track::GainRamp& ramp) {
+  const bool flat = IsFlat(ramp);
+  const float delta_left = ramp.end_left - ramp.start_left;
+  const float delta_right = ramp.end_right - ramp.start_right;
+  const float inv_frames = 1.0f / static_cast<float>(block_frames);
+
+  size_t frame_offset = 0;
+  for (int i = 0; i < 2; ++i) {
+    const size_t frames = block.frames[i];
+    if (frames == 0) {
+      continue;
+    }
+    float* segment_out = out + frame_offset * 2;
+    if (flat) {
+      kernels.accumulate_planar_stereo(segment_out, block.left[i], block.right[i], frames,
+                                       ramp.end_left, ramp.end_right);
+    } else {
+      const float t0 = static_cast<float>(frame_offset) * inv_frames;
+      const float t1 = static_cast<float>(frame_offset + frames) * inv_frames;
+      kernels.accumulate_planar_stereo_ramp(segment_out, block.left[i], block.right[i], frames,
+                                            ramp.start_left + delta_left * t0,
+                                            ramp.start_right + delta_right * t0,
+                                            ramp.start_left + delta_left * t1,
+                                            ramp.start_right + delta_right * t1);
+    }
+    frame_offset += frames;
+  }
+}
+
+}  // namespace
+
+MultiTrackMixer::MultiTrackMixer() {
+  mix_buffer_.resize(kInitialScratchFrames * 2);
+  render_tasks_.reserve(kInitialRenderTasks);
+  fallback_params_.tracks.reserve(kInitialRenderTasks);
+  fallback_params_.flags.reserve(kInitialRenderTasks);
+  fallback_params_.start_samples.reserve(kInitialRenderTasks);
+  fallback_params_.channels.reserve(kInitialRenderTasks);
+  fallback_params_.gains_left.reserve(kInitialRenderTasks);
+  fallback_params_.gains_right.reserve(kInitialRenderTasks);
+  active_snapshot_.store(new TrackSnapshot(), std::memory_order_release);
+  reclaim_thread_ = std::thread(&MultiTrackMixer::ReclaimThreadFunc, this);
+}
+
+MultiTrackMixer::~MultiTrackMixer() {
+  // Tracks can outlive the mixer (the engine holds them too)
+  {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    for (const auto& track : active_snapshot_.load(std::memory_order_acquire)->tracks) {
+      track->ClearParamsListener(this);
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(reclaim_mutex_);
+    reclaim_shutdown_ = true;
+  }
+  reclaim_cv_.notify_all();
+  if (reclaim_thread_.joinable()) {
+    reclaim_thread_.join();
+  }
 
-MultiTrackMixer::~MultiTrackMixer() = default;
+  // No audio thread can be inside Mix() once the mixer is being destroyed.
+  for (const auto& retired : retired_snapshots_) {
+    delete retired.snapshot;
+  }
+  retired_snapshots_.clear();
+  delete active_snapshot_.exchange(nullptr, std::memory_order_acq_rel);
+}
 
 void MultiTrackMixer::AddTrack(std::shared_ptr<Track> track) {
-  std::lock_guard<std::mutex> lock(tracks_mutex_);
-  tracks_.push_back(track);
+  std::lock_guard<std::mutex> lock(writer_mutex_);
+  const TrackSnapshot* current = active_snapshot_.load(std::memory_order_acquire);
+  auto next = std::make_unique<TrackSnapshot>(*current);
+  track->SetParamsListener(this);
+  next->tracks.push_back(std::move(track));
+  PublishSnapshot(std::move(next));
 }
 
 bool MultiTrackMixer::RemoveTrack(const std::string& track_id) {
-  std::lock_guard<std::mutex> lock(tracks_mutex_);
-  auto it = std::find_if(tracks_.begin(), tracks_.end(),
+  std::lock_guard<std::mutex> lock(writer_mutex_);
+  const TrackSnapshot* current = active_snapshot_.load(std::memory_order_acquire);
+  auto next = std::make_unique<TrackSnapshot>(*current);
+  auto it = std::find_if(next->tracks.begin(), next->tracks.end(),
                          [&track_id](const std::shared_ptr<Track>& t) {
                            return t->GetId() == track_id;
                          });
-  if (it != tracks_.end()) {
-    tracks_.erase(it);
-    return true;
+  if (it == next->tracks.end()) {
+    return false;
   }
-  return false;
+  (*it)->ClearParamsListener(this);
+  next->tracks.erase(it);
+  PublishSnapshot(std::move(next));
+  return true;
 }
 
 void MultiTrackMixer::ClearTracks() {
-  std::lock_guard<std::mutex> lock(tracks_mutex_);
-  tracks_.clear();
+  std::lock_guard<std::mutex> lock(writer_mutex_);
+  for (const auto& track : active_snapshot_.load(std::memory_order_acquire)->tracks) {
+    track->ClearParamsListener(this);
+  }
+  PublishSnapshot(std::make_unique<TrackSnapshot>());
 }
 
 std::shared_ptr<Track> MultiTrackMixer::GetTrack(const std::string& track_id) {
-  std::lock_guard<std::mutex> lock(tracks_mutex_);
-  auto it = std::find_if(tracks_.begin(), tracks_.end(),
+  // Holding the writer lock keeps the current snapshot from being retired.
+  std::lock_guard<std::mutex> lock(writer_mutex_);
+  const TrackSnapshot* current = active_snapshot_.load(std::memory_order_acquire);
+  auto it = std::find_if(current->tracks.begin(), current->tracks.end(),
                          [&track_id](const std::shared_ptr<Track>& t) {
                            return t->GetId() == track_id;
                          });
-  return (it != tracks_.end()) ? *it : nullptr;
+  return (it != current->tracks.end()) ? *it : nullptr;
 }
 
 std::vector<std::shared_ptr<Track>> MultiTrackMixer::GetTracks() {
-  std::lock_guard<std::mutex> lock(tracks_mutex_);
-  return tracks_;
+  std::lock_guard<std::mutex> lock(writer_mutex_);
+  return active_snapshot_.load(std::memory_order_acquire)->tracks;
 }
 
-void MultiTrackMixer::Mix(float* output, size_t frames, int64_t timeline_start_sample) {
-  // Clear output buffer
-  std::memset(output, 0, frames * 2 * sizeof(float));  // Assume stereo
+void MultiTrackMixer::PublishSnapshot(std::unique_ptr<TrackSnapshot> snapshot) {
+  snapshot->generation = ++snapshot_generation_;
+  const TrackSnapshot* published = snapshot.get();
+  RetiredSnapshot retired;
+  retired.snapshot = active_snapshot_.exchange(snapshot.release(), std::memory_order_seq_cst);
+  PublishParams(*published);
+  // If the audio thread was mixing when the swap happened it may still hold the
+  // old snapshot; CanReclaim() waits for that Mix() call to finish.
+  retired.mix_epoch = mix_epoch_.load(std::memory_order_seq_cst);
+  {
+    std::lock_guard<std::mutex> lock(reclaim_mutex_);
+    retired_snapshots_.push_back(retired);
+  }
+  reclaim_cv_.notify_one();
+}
 
-  if (tracks_.empty()) {
-    return;
+void MultiTrackMixer::PublishParams(const TrackSnapshot& snapshot) {
+  FillParams(snapshot, &param_tables_[param_write_index_]);
+  // Before publishing, so Mix() never sees an audible track still parked
+  UpdateParking(param_tables_[param_write_index_]);
+  const uint32_t previous =
+      param_latest_.exchange(param_write_index_ | kParamFresh, std::memory_order_acq_rel);
+  param_write_index_ = previous & kParamIndexMask;
+}
+
+void MultiTrackMixer::UpdateParking(const ParamTable& table) {
+  const uint32_t required = ParamTable::kLoaded | (table.has_solo ? ParamTable::kSolo : 0u);
+  const uint32_t checked = required | ParamTable::kMuted;
+  const int64_t timeline = timeline_sample_.load(std::memory_order_acquire);
+  for (size_t i = 0; i < table.tracks.size(); ++i) {
+    Track* const track = table.tracks[i];
+    if ((table.flags[i] & ParamTable::kLoaded) == 0) {
+      continue;
+    }
+    const bool audible = (table.flags[i] & checked) == required;
+    if (!audible && !track->IsParked()) {
+      track->Park();
+    } else if (audible && track->IsParked()) {
+      track->Unpark(timeline - table.start_samples[i]);
+    }
   }
+}
 
-  // Check if any track is soloed
-  bool has_solo = false;
-  {
-    std::lock_guard<std::mutex> lock(tracks_mutex_);
-    for (const auto& track : tracks_) {
-      if (track->IsSolo()) {
-        has_solo = true;
-        break;
-      }
+void MultiTrackMixer::OnTrackParamsChanged(Track* track [[maybe_unused]]) {
+  std::lock_guard<std::mutex> lock(writer_mutex_);
+  PublishParams(*active_snapshot_.load(std::memory_order_acquire));
+}
+
+void MultiTrackMixer::FillParams(const TrackSnapshot& snapshot, ParamTable* table) {
+  const size_t count = snapshot.tracks.size();
+  table->generation = snapshot.generation;
+  table->has_solo = false;
+  table->tracks.resize(count);
+  table->flags.resize(count);
+  table->start_samples.resize(count);
+  table->channels.resize(count);
+  table->gains_left.resize(count);
+  table->gains_right.resize(count);
+
+  for (size_t i = 0; i < count; ++i) {
+    Track* const track = snapshot.tracks[i].get();
+    uint32_t flags = 0;
+    if (track->IsLoaded()) {
+      flags |= ParamTable::kLoaded;
+    }
+    if (track->IsMuted()) {
+      flags |= ParamTable::kMuted;
+    }
+    if (track->IsSolo()) {
+      flags |= ParamTable::kSolo;
+      table->has_solo = true;
     }
+    if (track->IsStretchOnMasterBus()) {
+      flags |= ParamTable::kOnMasterBus;
+    }
+    table->tracks[i] = track;
+    table->flags[i] = flags;
+    table->start_samples[i] = track->GetStartTimeSamples();
+    table->channels[i] = track->GetChannels();
+    track->GetTargetGains(&table->gains_left[i], &table->gains_right[i]);
   }
+}
 
-  // Mix tracks
-  std::lock_guard<std::mutex> lock(tracks_mutex_);
-  for (const auto& track : tracks_) {
-    if (!track->IsLoaded()) {
+const MultiTrackMixer::ParamTable& MultiTrackMixer::AcquireParams(const TrackSnapshot& snapshot) {
+  if (param_latest_.load(std::memory_order_relaxed) & kParamFresh) {
+    const uint32_t latest =
+        param_latest_.exchange(param_read_index_, std::memory_order_acq_rel);
+    param_read_index_ = latest & kParamIndexMask;
+  }
+  const ParamTable& table = param_tables_[param_read_index_];
+  if (table.generation == snapshot.generation) {
+    return table;
+  }
+  // The snapshot was swapped but its table has not been taken yet (or the
+  // table is already ahead of the snapshot): read the tracks directly.
+  FillParams(snapshot, &fallback_params_);
+  return fallback_params_;
+}
+
+bool MultiTrackMixer::CanReclaim(const RetiredSnapshot& retired) const {
+  if ((retired.mix_epoch & 1u) == 0) {
+    return true;
+  }
+  return mix_epoch_.load(std::memory_order_seq_cst) != retired.mix_epoch;
+}
+
+void MultiTrackMixer::ReclaimThreadFunc() {
+  std::vector<const TrackSnapshot*> to_delete;
+  std::unique_lock<std::mutex> lock(reclaim_mutex_);
+  while (!reclaim_shutdown_) {
+    if (retired_snapshots_.empty()) {
+      reclaim_cv_.wait(lock, [this] {
+        return reclaim_shutdown_ || !retired_snapshots_.empty();
+      });
       continue;
     }
 
-    // Solo logic: if any track is soloed, only play soloed tracks
-    if (has_solo && !track->IsSolo()) {
-      continue;
+    auto keep_end = std::partition(
+        retired_snapshots_.begin(), retired_snapshots_.end(),
+        [this](const RetiredSnapshot& retired) { return !CanReclaim(retired); });
+    for (auto it = keep_end; it != retired_snapshots_.end(); ++it) {
+      to_delete.push_back(it->snapshot);
     }
+    retired_snapshots_.erase(keep_end, retired_snapshots_.end());
 
-    // Skip muted tracks
-    if (track->IsMuted()) {
-      continue;
+    if (!to_delete.empty()) {
+      // Track destructors may join threads; run them without holding the lock.
+      lock.unlock();
+      for (const TrackSnapshot* snapshot : to_delete) {
+        delete snapshot;
+      }
+      to_delete.clear();
+      lock.lock();
     }
 
-    const int64_t track_start = track->GetStartTimeSamples();
-    const int64_t track_frame = timeline_start_sample - track_start;
+    if (!retired_snapshots_.empty()) {
+      reclaim_cv_.wait_for(lock, kReclaimRetryInterval);
+    }
+  }
+}
+
+bool MultiTrackMixer::Mix(float* output, size_t frames, int64_t timeline_start_sample) {
+  // Clear output buffer
+  std::memset(output, 0, frames * 2 * sizeof(float));  // Assume stereo
+
+  MixEpochGuard epoch_guard(mix_epoch_);
+  const TrackSnapshot* snapshot = active_snapshot_.load(std::memory_order_seq_cst);
+
+  // After a seek, hold output until every track has data instead of playing
+  // a burst of partial underruns.
+  if (priming_armed_.load(std::memory_order_acquire) &&
+      !TryOpenPrimingGate(snapshot, timeline_start_sample)) {
+    return false;
+  }
+
+  if (!snapshot || snapshot->tracks.empty()) {
+    return true;
+  }
+
+  timeline_sample_.store(timeline_start_sample + static_cast<int64_t>(frames),
+                         std::memory_order_release);
+  const ParamTable& params = AcquireParams(*snapshot);
+
+  const dsp::MixKernels& kernels = dsp::GetMixKernels();
 
-    if (track_frame < 0 && track_frame + static_cast<int64_t>(frames) <= 0) {
+  // Tracks sharing the global pitch/speed are summed at unity rate into the
+  // master bus, which is stretched or resampled once below.
+  if (master_stretcher_ &&
+      master_stretch_reset_pending_.exchange(false, std::memory_order_acq_rel)) {
+    master_stretcher_->Reset();
+    master_varispeed_->Reset();
+    master_input_fraction_ = 0.0;
+    master_prerolled_ = false;
+    master_lead_frames_ = 0;
+    master_drain_frames_ = 0;
+  }
+  // A bus processor switching in waits until the outgoing one has played out
+  const bool varispeed_mode = master_varispeed_enabled_.load(std::memory_order_acquire);
+  const size_t varispeed_lead = master_varispeed_ ? master_varispeed_->GetLeadFrames() : 0;
+  const bool stretch_bus = master_stretcher_ && !varispeed_mode &&
+                           master_stretcher_->IsActive() && varispeed_lead == 0;
+  const bool varispeed_bus = master_stretcher_ && varispeed_mode &&
+                             master_stretcher_->GetStretchFactor() != 1.0f &&
+                             !master_prerolled_ && master_drain_frames_ == 0;
+  const bool use_bus = stretch_bus || varispeed_bus;
+  size_t bus_frames = 0;
+  size_t bus_preroll = 0;
+  size_t bus_hold = 0;
+  if (stretch_bus) {
+    // The first block after a reset or switch-on also reads the stretcher's
+    // latency ahead, so the bus output lines up with the direct tracks
+    if (!master_prerolled_) {
+      bus_preroll = master_stretcher_->GetPrerollInputFrames();
+      master_drain_frames_ = 0;
+    }
+    const double requested_input =
+        static_cast<double>(frames) * master_stretcher_->GetStretchFactor() +
+        master_input_fraction_;
+    bus_frames = std::max<size_t>(static_cast<size_t>(requested_input), 1);
+    master_input_fraction_ = requested_input - static_cast<double>(bus_frames);
+  } else if (varispeed_bus) {
+    // The first block after a reset reads the resampler's look-ahead too
+    master_input_fraction_ = 0.0;
+    master_varispeed_->SetRate(master_stretcher_->GetStretchFactor());
+    master_varispeed_->SetQuality(master_varispeed_quality_.load(std::memory_order_relaxed));
+    bus_frames = master_varispeed_->GetInputFramesNeeded(frames);
+  }
+  if (use_bus) {
+    const size_t bus_samples = (bus_preroll + bus_frames) * 2;
+    if (bus_buffer_.size() < bus_samples) {
+      bus_buffer_.resize(bus_samples);
+    }
+    std::fill_n(bus_buffer_.data(), bus_samples, 0.0f);
+  } else {
+    master_input_fraction_ = 0.0;
+    master_lead_frames_ = 0;
+    if (master_prerolled_) {
+      // Switched off: play out the stretcher tail while bus tracks hold
+      master_prerolled_ = false;
+      master_drain_frames_ = static_cast<size_t>(master_stretcher_->GetLatencyFrames());
+    }
+    bus_hold = std::min(frames, master_drain_frames_ + varispeed_lead);
+  }
+
+  // Plan the block on this thread, render the tracks (in parallel when
+  // enabled), then sum them in snapshot order
+  render_tasks_.clear();
+  // Solo logic: if any track is soloed, only play soloed tracks
+  const uint32_t required = ParamTable::kLoaded | (params.has_solo ? ParamTable::kSolo : 0u);
+  const uint32_t checked = required | ParamTable::kMuted;
+  const size_t track_count = params.tracks.size();
+  for (size_t i = 0; i < track_count; ++i) {
+    const uint32_t flags = params.flags[i];
+    if ((flags & checked) != required) {
       continue;
     }
 
+    const bool routed_to_bus = (flags & ParamTable::kOnMasterBus) != 0;
+    const bool on_bus = use_bus && routed_to_bus;
+    float* const destination = on_bus ? bus_buffer_.data() : output;
+    const size_t block_frames = on_bus ? bus_preroll + bus_frames : frames;
+
+    int64_t track_frame = timeline_start_sample - params.start_samples[i];
+    if (on_bus) {
+      // The bus buffer holds input frames, read master_lead_frames_ ahead:
+      // a start later in this block lands where the stretched output
+      // reaches it
+      if (track_frame < 0) {
+        track_frame = -std::llround(static_cast<double>(-track_frame) *
+                                    static_cast<double>(bus_frames) /
+                                    static_cast<double>(frames));
+      }
+      track_frame += master_lead_frames_;
+    }
+
     size_t offset_frames = 0;
     if (track_frame < 0) {
       offset_frames = static_cast<size_t>(-track_frame);
     }
+    if (bus_hold > 0 && routed_to_bus) {
+      offset_frames = std::max(offset_frames, bus_hold);
+    }
 
-    const size_t frames_to_read = (offset_frames >= frames) ? 0 : (frames - offset_frames);
+    size_t frames_to_read =
+        (offset_frames >= block_frames) ? 0 : (block_frames - offset_frames);
     if (frames_to_read == 0) {
       continue;
     }
 
-    const int32_t channels = track->GetChannels();
-    if (channels <= 0) {
+    // A track back from parking stays silent until its refilled buffer
+    // lines up with the timeline
+    Track* const track = params.tracks[i];
+    if (track->IsResuming()) {
+      const size_t hold = track->SyncResume(
+          track_frame + static_cast<int64_t>(offset_frames), frames_to_read);
+      if (hold >= frames_to_read) {
+        continue;
+      }
+      offset_frames += hold;
+      frames_to_read -= hold;
+    }
+
+    const int32_t channels = params.channels[i];
+    if (channels != 1 && channels != 2) {
       continue;
     }
 
-    // Read track samples
-    if (channels == 1) {
-      if (mono_buffer_.size() < frames_to_read) {
-        mono_buffer_.resize(frames_to_read);
-      }
-      track->ReadSamples(mono_buffer_.data(), frames_to_read);
-
-      // Mix mono into stereo output
-      const size_t output_offset = offset_frames * 2;
-      for (size_t i = 0; i < frames_to_read; ++i) {
-        const float sample = mono_buffer_[i];
-        const size_t out_index = output_offset + i * 2;
-        output[out_index] += sample;
-        output[out_index + 1] += sample;
-      }
-    } else if (channels == 2) {
-      const size_t samples_needed = frames_to_read * 2;
-      if (mix_buffer_.size() < samples_needed) {
-        mix_buffer_.resize(samples_needed);
-      }
-      track->ReadSamples(mix_buffer_.data(), frames_to_read);
+    RenderTask task;
+    task.track = track;
+    task.destination = destination + offset_frames * 2;
+    task.frames = frames_to_read;
+    task.channels = channels;
+    task.gain_left = params.gains_left[i];
+    task.gain_right = params.gains_right[i];
+    render_tasks_.push_back(task);
+  }
+
+  if (!MixParallel(frames)) {
+    for (const RenderTask& task : render_tasks_) {
+      RenderTrack(kernels, task, task.destination, &mix_buffer_);
+    }
+  }
 
-      // Mix into output at the offset
-      const size_t output_offset = offset_frames * 2;
-      for (size_t i = 0; i < frames_to_read * 2; ++i) {
-        output[output_offset + i] += mix_buffer_[i];
+  if (use_bus) {
+    // Keep the stretcher fed even when no track is routed to the bus this
+    // block, so its internal timeline stays continuous.
+    if (bus_output_.size() < frames * 2) {
+      bus_output_.resize(frames * 2);
+    }
+    if (varispeed_bus) {
+      master_varispeed_->Process(bus_buffer_.data(), bus_frames, bus_output_.data(), frames);
+      master_lead_frames_ = static_cast<int64_t>(master_varispeed_->GetLeadFrames());
+    } else {
+      if (bus_preroll > 0) {
+        master_stretcher_->Preroll(bus_buffer_.data(), bus_preroll);
+        master_prerolled_ = true;
+        master_lead_frames_ = static_cast<int64_t>(bus_preroll);
       }
+      master_stretcher_->Process(bus_buffer_.data() + bus_preroll * 2, bus_frames,
+                                 bus_output_.data(), frames);
+    }
+    kernels.accumulate_stereo(output, bus_output_.data(), frames, 1.0f, 1.0f);
+  } else if (bus_hold > 0) {
+    if (bus_output_.size() < bus_hold * 2) {
+      bus_output_.resize(bus_hold * 2);
     }
+    // Only one of the two has anything left to play out
+    const size_t drained = std::min(bus_hold, master_drain_frames_);
+    if (drained > 0) {
+      master_stretcher_->Drain(bus_output_.data(), drained);
+      master_drain_frames_ -= drained;
+    }
+    master_varispeed_->Drain(bus_output_.data() + drained * 2, bus_hold - drained);
+    kernels.accumulate_stereo(output, bus_output_.data(), bus_hold, 1.0f, 1.0f);
   }
 
-  // Apply master volume
+  // Apply master volume and clip prevention in a single pass
   const float master_vol = master_volume_.load(std::memory_order_acquire);
-  if (master_vol != 1.0f) {
-    for (size_t i = 0; i < frames * 2; ++i) {
-      output[i] *= master_vol;
+  kernels.apply_gain_and_clip(output, frames * 2, master_vol);
+  return true;
+}
+
+void MultiTrackMixer::RenderTrack(const dsp::MixKernels& kernels,
+                                  const RenderTask& task,
+                                  float* out,
+                                  std::vector<float>* scratch) {
+  Track* const track = task.track;
+  const size_t frames = task.frames;
+  const Track::GainRamp ramp = track->AdvanceGainRamp(task.gain_left, task.gain_right);
+
+  // Planar tracks hand over left/right planes, stretched or not, and are
+  // interleaved here while accumulating
+  Track::PlanarBlock block;
+  if (track->AcquirePlanar(frames, &block)) {
+    AccumulatePlanar(kernels, out, block, frames, ramp);
+    track->ReleasePlanar(block);
+    return;
+  }
+
+  // Mix straight out of the track's ring buffer when it is not
+  // time-stretched
+  core::CircularBuffer::ReadSpan span;
+  if (track->AcquireRaw(frames, &span)) {
+    AccumulateSpan(kernels, out, span, task.channels, frames, ramp);
+    track->ReleaseRaw(span);
+    return;
+  }
+
+  // Read track samples
+  const size_t samples_needed = frames * static_cast<size_t>(task.channels);
+  if (scratch->size() < samples_needed) {
+    scratch->resize(samples_needed);
+  }
+  track->ReadRaw(scratch->data(), frames);
+
+  if (task.channels == 1) {
+    // Upmix into the stereo output, applying volume while accumulating
+    if (IsFlat(ramp)) {
+      kernels.accumulate_mono_to_stereo(out, scratch->data(), frames,
+                                        ramp.end_left, ramp.end_right);
+    } else {
+      kernels.accumulate_mono_to_stereo_ramp(out, scratch->data(), frames,
+                                             ramp.start_left, ramp.start_right,
+                                             ramp.end_left, ramp.end_right);
+    }
+  } else {
+    // Mix into output at the offset, applying volume/pan while accumulating
+    if (IsFlat(ramp)) {
+      kernels.accumulate_stereo(out, scratch->data(), frames,
+                                ramp.end_left, ramp.end_right);
+    } else {
+      kernels.accumulate_stereo_ramp(out, scratch->data(), frames,
+                                     ramp.start_left, ramp.start_right,
+                                     ramp.end_left, ramp.end_right);
+    }
+  }
+}
+
+void MultiTrackMixer::RenderSlotTask(void* context, size_t index) {
+  auto* mixer = static_cast<MultiTrackMixer*>(context);
+  const RenderTask& task = mixer->render_tasks_[index];
+  RenderSlot& slot = mixer->render_slots_[index];
+  std::fill_n(slot.output.data(), task.frames * 2, 0.0f);
+  RenderTrack(dsp::GetMixKernels(), task, slot.output.data(), &slot.scratch);
+}
+
+bool MultiTrackMixer::MixParallel(size_t frames) {
+  RenderPool* const pool = render_pool_.load(std::memory_order_acquire);
+  if (!pool || !parallel_render_.load(std::memory_order_acquire) ||
+      render_tasks_.size() < kParallelMinTasks) {
+    return false;
+  }
+
+  // Every task renders into its own slot, whichever thread runs it, so the
+  // sum below is the same whether or not the pool helped
+  if (render_slots_.size() < render_tasks_.size()) {
+    render_slots_.resize(render_tasks_.size());
+  }
+  for (size_t i = 0; i < render_tasks_.size(); ++i) {
+    const size_t samples = render_tasks_[i].frames * 2;
+    if (render_slots_[i].output.size() < samples) {
+      render_slots_[i].output.resize(samples);
+    }
+  }
+
+  if (parallel_backoff_blocks_ > 0) {
+    // A recent batch overran: keep the pool out of the way for a while
+    --parallel_backoff_blocks_;
+    parallel_fallback_blocks_.fetch_add(1, std::memory_order_relaxed);
+    for (size_t i = 0; i < render_tasks_.size(); ++i) {
+      RenderSlotTask(this, i);
+    }
+  } else {
+    const int32_t sample_rate = render_sample_rate_.load(std::memory_order_relaxed);
+    const int64_t budget_ns =
+        sample_rate > 0 ? static_cast<int64_t>(static_cast<double>(frames) * 1e9 *
+                                               kParallelDeadlineFraction / sample_rate)
+                        : 0;
+    const int64_t deadline_ns = budget_ns > 0 ? SteadyNowNs() + budget_ns : 0;
+    if (!pool->Run(&MultiTrackMixer::RenderSlotTask, this, render_tasks_.size(), deadline_ns)) {
+      parallel_backoff_blocks_ = kParallelBackoffBlocks;
+    }
+  }
+
+  const dsp::MixKernels& kernels = dsp::GetMixKernels();
+  for (size_t i = 0; i < render_tasks_.size(); ++i) {
+    const RenderTask& task = render_tasks_[i];
+    kernels.accumulate_stereo(task.destination, render_slots_[i].output.data(), task.frames,
+                              1.0f, 1.0f);
+  }
+  return true;
+}
+
+void MultiTrackMixer::SetParallelRender(bool enabled, int32_t sample_rate, size_t worker_count) {
+  if (enabled) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    render_sample_rate_.store(sample_rate, std::memory_order_relaxed);
+    if (!render_pool_owner_) {
+      // Created once and kept, so Mix() never sees the pool go away
+      render_pool_owner_ = std::make_unique<RenderPool>(worker_count);
+      render_pool_.store(render_pool_owner_.get(), std::memory_order_release);
+    }
+  }
+  parallel_render_.store(enabled, std::memory_order_release);
+}
+
+bool MultiTrackMixer::IsParallelRender() const {
+  return parallel_render_.load(std::memory_order_acquire);
+}
+
+MultiTrackMixer::ParallelRenderStats MultiTrackMixer::GetParallelRenderStats() const {
+  ParallelRenderStats stats;
+  const RenderPool* pool = render_pool_.load(std::memory_order_acquire);
+  if (pool) {
+    stats.workers = pool->GetWorkerCount();
+    stats.pool = pool->GetStats();
+  }
+  stats.fallback_blocks = parallel_fallback_blocks_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void MultiTrackMixer::ArmPrimingGate(size_t prime_frames) {
+  prime_frames_.store(prime_frames, std::memory_order_relaxed);
+  priming_armed_at_ns_.store(SteadyNowNs(), std::memory_order_relaxed);
+  last_priming_latency_ns_.store(-1, std::memory_order_relaxed);
+  priming_hold_.store(true, std::memory_order_relaxed);
+  priming_armed_.store(true, std::memory_order_release);
+}
+
+void MultiTrackMixer::ReleasePrimingHold() {
+  priming_released_at_ns_.store(SteadyNowNs(), std::memory_order_relaxed);
+  priming_hold_.store(false, std::memory_order_release);
+}
+
+bool MultiTrackMixer::PollPrimingGate(int64_t timeline_sample) {
+  if (!priming_armed_.load(std::memory_order_acquire)) {
+    return true;
+  }
+  // Holding the writer lock keeps the current snapshot from being retired.
+  std::lock_guard<std::mutex> lock(writer_mutex_);
+  return TryOpenPrimingGate(active_snapshot_.load(std::memory_order_acquire), timeline_sample);
+}
+
+int64_t MultiTrackMixer::GetLastPrimingLatencyNs() const {
+  return last_priming_latency_ns_.load(std::memory_order_acquire);
+}
+
+uint64_t MultiTrackMixer::GetPrimingTimeoutCount() const {
+  return priming_timeouts_.load(std::memory_order_relaxed);
+}
+
+bool MultiTrackMixer::TracksPrimed(const TrackSnapshot& snapshot, int64_t timeline_sample) const {
+  const size_t prime_frames = prime_frames_.load(std::memory_order_relaxed);
+  bool has_solo = false;
+  for (const auto& track : snapshot.tracks) {
+    if (track->IsSolo()) {
+      has_solo = true;
+      break;
+    }
+  }
+
+  for (const auto& track : snapshot.tracks) {
+    if (!track->IsLoaded() || track->IsMuted() || (has_solo && !track->IsSolo())) {
+      continue;
+    }
+    // Tracks that start later are filling from their start in the meantime
+    if (timeline_sample < track->GetStartTimeSamples()) {
+      continue;
+    }
+    if (!track->IsPrimed(prime_frames)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool MultiTrackMixer::TryOpenPrimingGate(const TrackSnapshot* snapshot, int64_t timeline_sample) {
+  if (priming_hold_.load(std::memory_order_acquire)) {
+    return false;
+  }
+
+  const int64_t now = SteadyNowNs();
+  const bool primed = !snapshot || TracksPrimed(*snapshot, timeline_sample);
+  const bool timed_out =
+      now - priming_released_at_ns_.load(std::memory_order_relaxed) > kPrimingTimeoutNs;
+  if (!primed && !timed_out) {
+    return false;
+  }
+
+  // The audio thread and a polling control thread may race to open the gate
+  bool expected = true;
+  if (priming_armed_.compare_exchange_strong(expected, false, std::memory_order_acq_rel)) {
+    if (!primed) {
+      priming_timeouts_.fetch_add(1, std::memory_order_relaxed);
     }
+    last_priming_latency_ns_.store(now - priming_armed_at_ns_.load(std::memory_order_relaxed),
+                                   std::memory_order_release);
+  }
+  return true;
+}
+
+void MultiTrackMixer::ConfigureMasterStretch(int32_t sample_rate) {
+  master_stretcher_ = std::make_unique<TimeStretch>(sample_rate, 2);
+  master_varispeed_ = std::make_unique<dsp::Varispeed>(2, kInitialScratchFrames);
+  bus_buffer_.resize(kInitialScratchFrames * 2);
+  bus_output_.resize(kInitialScratchFrames * 2);
+}
+
+void MultiTrackMixer::SetMasterStretch(float semitones, float factor) {
+  if (master_stretcher_) {
+    master_stretcher_->SetPitchSemitones(semitones);
+    master_stretcher_->SetStretchFactor(factor);
+  }
+}
+
+void MultiTrackMixer::SetMasterVarispeed(bool enabled) {
+  master_varispeed_enabled_.store(enabled, std::memory_order_release);
+}
+
+bool MultiTrackMixer::IsMasterVarispeed() const {
+  return master_varispeed_enabled_.load(std::memory_order_acquire);
+}
+
+void MultiTrackMixer::SetMasterVarispeedQuality(dsp::Varispeed::Quality quality) {
+  master_varispeed_quality_.store(quality, std::memory_order_relaxed);
+}
+
+void MultiTrackMixer::SetMasterStretchQuality(TimeStretch::Quality quality,
+                                              size_t crossfade_frames) {
+  if (master_stretcher_) {
+    master_stretcher_->SetQuality(quality, crossfade_frames);
   }
+}
 
-  // Clip prevention (soft limiting)
-  for (size_t i = 0; i < frames * 2; ++i) {
-    output[i] = std::clamp(output[i], -1.0f, 1.0f);
+bool MultiTrackMixer::IsMasterStretchActive() const {
+  if (!master_stretcher_) {
+    return false;
+  }
+  if (IsMasterVarispeed()) {
+    return master_stretcher_->GetStretchFactor() != 1.0f;
   }
+  return master_stretcher_->IsActive();
+}
+
+void MultiTrackMixer::ResetMasterStretch() {
+  master_stretch_reset_pending_.store(true, std::memory_order_release);
+}
+
+int64_t MultiTrackMixer::GetMasterLatencyFrames() const {
+  // Varispeed is time-aligned and adds no latency
+  return IsMasterStretchActive() && !IsMasterVarispeed() ? master_stretcher_->GetLatencyFrames()
+                                                          : 0;
 }
 
 void MultiTrackMixer::SetMasterVolume(float volume) {
@@ -1,11 +1,15 @@
 #pragma once
 
+#include "RenderPool.h"
 #include "Track.h"
+#include "dsp/MixKernels.h"
 
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <memory>
 #include <mutex>
+#include <thread>
 #include <vector>
 
 namespace sezo {
@@ -14,11 +18,39 @@ namespace playback {
 /**
  * Mixes multiple audio tracks together.
  * Handles solo/mute logic and master volume.
+ *
+ * The track list is published as an immutable snapshot (RCU style). Mix()
+ * reads the current snapshot wait-free and never touches a shared_ptr
+ * reference count, so control threads can add/remove tracks without ever
+ * blocking the audio callback. Replaced snapshots are released on a
+ * dedicated reclaim thread once the audio thread is known to have left them,
+ * which keeps Track destructors (and their thread joins) off the callback.
+ *
+ * With parallel rendering enabled, Mix() plans the block on the audio
+ * thread, renders each audible track into its own slot on a RenderPool
+ * (the audio thread takes part), then sums the slots in snapshot order, so
+ * the result does not depend on which thread rendered what. A batch that
+ * overruns half the block period sends rendering back to the audio thread
+ * alone for a while.
+ *
+ * What Mix() needs to plan a block (gains, start time, channels, mute/solo
+ * and routing flags) is kept in a flat table with one array per field,
+ * rebuilt by control threads whenever a track reports a change and handed
+ * to the audio thread through a triple buffer. Planning then scans a few
+ * contiguous arrays instead of loading a handful of atomics from every
+ * Track; only tracks that are actually rendered are dereferenced.
+ *
+ * Tracks that cannot be heard (muted or soloed out) are parked: they stop
+ * decoding and skip seeks while the timeline moves on. When one becomes
+ * audible again it seeks to the current position on a decode worker and
+ * fades in once Mix() has lined the refilled buffer up with the timeline.
+ *
+ * Mix() must only be called from a single audio thread at a time.
  */
-class MultiTrackMixer {
+class MultiTrackMixer : private Track::ParamsListener {
  public:
   MultiTrackMixer();
-  ~MultiTrackMixer();
+  ~MultiTrackMixer() override;
 
   /**
    * Add a track to the mixer.
@@ -53,11 +85,126 @@ class MultiTrackMixer {
 
   /**
    * Mix all tracks and write to output buffer.
+   * While the priming gate is closed the output is silence and the caller
+   * should not advance the timeline.
    * @param output Output buffer (stereo interleaved)
    * @param frames Number of frames to render
    * @param timeline_start_sample Timeline position for the first frame
+   * @return false if the priming gate held the output back
    */
-  void Mix(float* output, size_t frames, int64_t timeline_start_sample);
+  bool Mix(float* output, size_t frames, int64_t timeline_start_sample);
+
+  /**
+   * Close the priming gate ahead of a seek. Mix() outputs silence until
+   * ReleasePrimingHold() is called and every audible track has buffered
+   * prime_frames (or the priming timeout expires).
+   * @param prime_frames Frames each track must have buffered
+   */
+  void ArmPrimingGate(size_t prime_frames);
+
+  /**
+   * Let the gate open once tracks are primed (call after the seeks complete).
+   */
+  void ReleasePrimingHold();
+
+  /**
+   * Check the gate from a control thread, opening it if all tracks are
+   * primed. Lets seek readiness be observed while the transport is paused.
+   * @param timeline_sample Current timeline position
+   * @return true if the gate is open
+   */
+  bool PollPrimingGate(int64_t timeline_sample);
+
+  /**
+   * Time from ArmPrimingGate() until the gate opened.
+   * @return Latency in nanoseconds, or -1 while the gate is still closed
+   */
+  int64_t GetLastPrimingLatencyNs() const;
+
+  /**
+   * Number of times the gate opened on timeout instead of all tracks priming.
+   */
+  uint64_t GetPrimingTimeoutCount() const;
+
+  /**
+   * Create the master-bus stretcher. Tracks flagged with
+   * Track::SetStretchOnMasterBus() are then mixed at unity rate into a
+   * stereo bus that is pitch-shifted/time-stretched once, instead of once
+   * per track. Call before the audio stream starts.
+   * @param sample_rate Output sample rate
+   */
+  void ConfigureMasterStretch(int32_t sample_rate);
+
+  /**
+   * Set the master-bus pitch and speed (no effect until configured).
+   * @param semitones Pitch shift
+   * @param factor Speed factor
+   */
+  void SetMasterStretch(float semitones, float factor);
+
+  /**
+   * Render the master-bus speed by resampling instead of time-stretching:
+   * pitch follows speed and the master pitch is ignored. Switching modes
+   * lets the outgoing processor play out first while bus tracks hold.
+   * @param enabled true for varispeed
+   */
+  void SetMasterVarispeed(bool enabled);
+  bool IsMasterVarispeed() const;
+
+  /**
+   * Interpolation used by the master-bus varispeed (default: windowed sinc).
+   * @param quality Quality tier
+   */
+  void SetMasterVarispeedQuality(dsp::Varispeed::Quality quality);
+
+  /**
+   * Quality tier of the master-bus stretcher (see
+   * TimeStretch::SetQuality()). Call off the audio thread.
+   * @param quality Quality tier
+   * @param crossfade_frames Crossfade length in output frames
+   */
+  void SetMasterStretchQuality(TimeStretch::Quality quality, size_t crossfade_frames);
+
+  /**
+   * Whether the master-bus stretcher or varispeed is currently processing.
+   */
+  bool IsMasterStretchActive() const;
+
+  /**
+   * Clear the master-bus stretcher state on the next mixed block (e.g. after
+   * a seek). Safe to call from any thread.
+   */
+  void ResetMasterStretch();
+
+  /**
+   * Processing latency of the master-bus stretcher while it is active, in
+   * frames. Bus tracks are read this far ahead so the stretched bus stays
+   * aligned with tracks mixed directly.
+   */
+  int64_t GetMasterLatencyFrames() const;
+
+  /**
+   * Render tracks on a pool of helper threads alongside the audio thread.
+   * The pool is started on the first enable and kept afterwards; safe to
+   * toggle while playing.
+   * @param enabled true to render in parallel
+   * @param sample_rate Output sample rate, for the per-block deadline
+   * @param worker_count Helper threads (0 = one less than the cores); only
+   *                     used when the pool is first started
+   */
+  void SetParallelRender(bool enabled, int32_t sample_rate, size_t worker_count = 0);
+  bool IsParallelRender() const;
+
+  struct ParallelRenderStats {
+    size_t workers = 0;
+    RenderPool::Stats pool;
+    uint64_t fallback_blocks = 0;  // rendered on the audio thread after an overrun
+  };
+
+  /**
+   * Parallel render counters. Safe to call from any thread.
+   */
+  ParallelRenderStats GetParallelRenderStats() const;
 
   /**
    * Set master volume.
@@ -72,13 +219,148 @@ class MultiTrackMixer {
   float GetMasterVolume() const;
 
  private:
-  std::vector<std::shared_ptr<Track>> tracks_;
-  std::mutex tracks_mutex_;
+  struct TrackSnapshot {
+    std::vector<std::shared_ptr<Track>> tracks;
+    uint64_t generation = 0;
+  };
+
+  // Per-track hot state, one array per field, in snapshot order. Only
+  // trusted by Mix() when generation matches the snapshot it is mixing, which
+  // also keeps the Track pointers alive.
+  struct ParamTable {
+    enum Flags : uint32_t {
+      kLoaded = 1u << 0,
+      kMuted = 1u << 1,
+      kSolo = 1u << 2,
+      kOnMasterBus = 1u << 3,
+    };
+
+    uint64_t generation = 0;
+    bool has_solo = false;
+    std::vector<Track*> tracks;
+    std::vector<uint32_t> flags;
+    std::vector<int64_t> start_samples;
+    std::vector<int32_t> channels;
+    std::vector<float> gains_left;
+    std::vector<float> gains_right;
+  };
+
+  // One audible track's share of the block, planned by Mix()
+  struct RenderTask {
+    Track* track = nullptr;
+    float* destination = nullptr;  // output or master bus, at the track's offset
+    size_t frames = 0;
+    int32_t channels = 0;
+    float gain_left = 1.0f;
+    float gain_right = 1.0f;
+  };
+
+  // Per-task buffers for parallel rendering, used by whichever thread runs
+  // the task
+  struct RenderSlot {
+    std::vector<float> output;  // stereo, summed into the destination afterwards
+    std::vector<float> scratch;
+  };
+
+  struct RetiredSnapshot {
+    const TrackSnapshot* snapshot = nullptr;
+    uint64_t mix_epoch = 0;
+  };
+
+  // Must be called with writer_mutex_ held.
+  void PublishSnapshot(std::unique_ptr<TrackSnapshot> snapshot);
+  void PublishParams(const TrackSnapshot& snapshot);
+  void UpdateParking(const ParamTable& table);
+  void OnTrackParamsChanged(Track* track) override;
+  static void FillParams(const TrackSnapshot& snapshot, ParamTable* table);
+  // Latest params for the snapshot Mix() is using. Audio thread only.
+  const ParamTable& AcquireParams(const TrackSnapshot& snapshot);
+  bool CanReclaim(const RetiredSnapshot& retired) const;
+  bool TracksPrimed(const TrackSnapshot& snapshot, int64_t timeline_sample) const;
+  bool TryOpenPrimingGate(const TrackSnapshot* snapshot, int64_t timeline_sample);
+  void ReclaimThreadFunc();
+  static void RenderTrack(const dsp::MixKernels& kernels,
+                          const RenderTask& task,
+                          float* out,
+                          std::vector<float>* scratch);
+  static void RenderSlotTask(void* context, size_t index);
+  bool MixParallel(size_t frames);
+
+  // Current snapshot, read wait-free by Mix().
+  std::atomic<const TrackSnapshot*> active_snapshot_{nullptr};
+  // Incremented on Mix() entry and exit; odd while the audio thread is mixing.
+  std::atomic<uint64_t> mix_epoch_{0};
+  // Serializes snapshot writers. Never taken by Mix().
+  std::mutex writer_mutex_;
+  uint64_t snapshot_generation_ = 0;
+
+  // Triple-buffered params. param_latest_ holds the index of the newest
+  // table, flagged until Mix() swaps it for the one it was reading; the
+  // writer (under writer_mutex_) and the audio thread each own one of the
+  // other two, so neither side ever waits. fallback_params_ is rebuilt on
+  // the audio thread for the block or two where a new snapshot and its
+  // table are not both visible yet.
+  ParamTable param_tables_[3];
+  std::atomic<uint32_t> param_latest_{2};
+  uint32_t param_write_index_ = 0;
+  uint32_t param_read_index_ = 1;
+  ParamTable fallback_params_;
+
+  // Snapshots waiting for the audio thread to move on.
+  std::mutex reclaim_mutex_;
+  std::condition_variable reclaim_cv_;
+  std::vector<RetiredSnapshot> retired_snapshots_;
+  bool reclaim_shutdown_ = false;
+  std::thread reclaim_thread_;
+
   std::atomic<float> master_volume_{1.0f};
+  // Timeline position after the last mixed block; where unparked tracks
+  // are sent to
+  std::atomic<int64_t> timeline_sample_{0};
+
+  // Seek priming gate. Timestamps are steady_clock nanoseconds.
+  std::atomic<bool> priming_armed_{false};
+  std::atomic<bool> priming_hold_{false};
+  std::atomic<size_t> prime_frames_{0};
+  std::atomic<int64_t> priming_armed_at_ns_{0};
+  std::atomic<int64_t> priming_released_at_ns_{0};
+  std::atomic<int64_t> last_priming_latency_ns_{0};
+  std::atomic<uint64_t> priming_timeouts_{0};
+
+  // Master-bus time-stretch. The stretcher is created before the stream
+  // starts; the bus buffers and input fraction belong to the audio thread.
+  std::unique_ptr<TimeStretch> master_stretcher_;
+  std::atomic<bool> master_stretch_reset_pending_{false};
+  double master_input_fraction_ = 0.0;
+  // Delay compensation: once pre-rolled, bus tracks lead the timeline by
+  // master_lead_frames_. When the bus switches off, its tail drains for
+  // master_drain_frames_ while those tracks hold.
+  bool master_prerolled_ = false;
+  int64_t master_lead_frames_ = 0;
+  size_t master_drain_frames_ = 0;
+  std::vector<float> bus_buffer_;
+  std::vector<float> bus_output_;
+
+  // Master-bus varispeed, created alongside the stretcher. Its look-ahead
+  // plays out like the stretcher tail when the bus switches off.
+  std::unique_ptr<dsp::Varispeed> master_varispeed_;
+  std::atomic<bool> master_varispeed_enabled_{false};
+  std::atomic<dsp::Varispeed::Quality> master_varispeed_quality_{dsp::Varispeed::Quality::kSinc};
+
+  // Parallel rendering. The pool is created once (under writer_mutex_) and
+  // only read through render_pool_ afterwards; the tasks, slots and backoff
+  // belong to the audio thread.
+  std::unique_ptr<RenderPool> render_pool_owner_;
+  std::atomic<RenderPool*> render_pool_{nullptr};
+  std::atomic<bool> parallel_render_{false};
+  std::atomic<int32_t> render_sample_rate_{0};
+  std::atomic<uint64_t> parallel_fallback_blocks_{0};
+  uint32_t parallel_backoff_blocks_ = 0;
+  std::vector<RenderTask> render_tasks_;
+  std::vector<RenderSlot> render_slots_;
 
   // Temporary mix buffer
   std::vector<float> mix_buffer_;
-  std::vector<float> mono_buffer_;
 };
 
 }  // namespace playback
@@ -1,6 +1,8 @@
 #include "OboePlayer.h"
 #include <android/log.h>
 
+#include <chrono>
+
 #define LOG_TAG "OboePlayer"
 #define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
@@ -137,6 +139,32 @@ bool OboePlayer::IsHealthy() const {
          state == oboe::StreamState::Paused;
 }
 
+int32_t OboePlayer::GetSampleRate() const {
+  if (stream_ && stream_->getSampleRate() > 0) {
+    return stream_->getSampleRate();
+  }
+  return sample_rate_;
+}
+
+core::CallbackStats::Snapshot OboePlayer::GetCallbackStats() const {
+  return callback_stats_.GetSnapshot();
+}
+
+void OboePlayer::ResetCallbackStats() {
+  callback_stats_.Reset();
+}
+
+int32_t OboePlayer::GetXRunCount() const {
+  if (!stream_ || !stream_->isXRunCountSupported()) {
+    return -1;
+  }
+  auto result = stream_->getXRunCount();
+  if (!result) {
+    return -1;
+  }
+  return result.value();
+}
+
 bool OboePlayer::RestartStream() {
   // Prevent concurrent recovery attempts
   bool expected = false;
@@ -192,23 +220,31 @@ oboe::DataCallbackResult OboePlayer::onAudioReady(
     oboe::AudioStream* audio_stream,
     void* audio_data,
     int32_t num_frames) {
-  (void)audio_stream;
   auto* output_buffer = static_cast<float*>(audio_data);
 
   // Check if we should be playing
   if (!transport_->IsPlaying()) {
     // Fill with silence
     std::fill_n(output_buffer, num_frames * 2, 0.0f);
+    callback_stats_.MarkIdle();
     return oboe::DataCallbackResult::Continue;
   }
 
+  const int64_t callback_start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
   const int64_t timeline_start = clock_->GetPosition();
 
-  // Mix all tracks
-  mixer_->Mix(output_buffer, num_frames, timeline_start);
+  // Mix all tracks. After a seek the mixer outputs silence until every track
+  // is primed; the timeline stays put until then.
+  if (mixer_->Mix(output_buffer, num_frames, timeline_start)) {
+    // Advance master clock
+    clock_->Advance(num_frames);
+  }
 
-  // Advance master clock
-  clock_->Advance(num_frames);
+  const int64_t callback_end_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  callback_stats_.Record(callback_start_ns, callback_end_ns, num_frames,
+                         audio_stream->getSampleRate());
 
   return oboe::DataCallbackResult::Continue;
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "MultiTrackMixer.h"
+#include "core/CallbackStats.h"
 #include "core/MasterClock.h"
 #include "core/TransportController.h"
 
@@ -70,6 +71,31 @@ class OboePlayer : public oboe::AudioStreamDataCallback,
    */
   bool IsHealthy() const;
 
+  /**
+   * Sample rate the device stream actually runs at.
+   * May differ from the requested rate when the device does not support it.
+   * @return Stream sample rate (requested rate if no stream is open)
+   */
+  int32_t GetSampleRate() const;
+
+  /**
+   * Timing statistics for onAudioReady() (duration, load, deadline misses).
+   * @return Snapshot of the counters since the last reset
+   */
+  core::CallbackStats::Snapshot GetCallbackStats() const;
+
+  /**
+   * Clear the callback timing statistics.
+   */
+  void ResetCallbackStats();
+
+  /**
+   * Underruns reported by the device stream. The count restarts whenever the
+   * stream is reopened.
+   * @return XRun count, or -1 if unavailable
+   */
+  int32_t GetXRunCount() const;
+
   /**
    * Attempt to restart the audio stream after a disconnect or error.
    * Closes the old stream and reopens with the same parameters.
@@ -116,6 +142,7 @@ class OboePlayer : public oboe::AudioStreamDataCallback,
   std::atomic<bool> was_playing_before_error_{false};
 
   StreamErrorCallback error_callback_;
+  core::CallbackStats callback_stats_;
 };
 
 }  // namespace playback
@@ -0,0 +1,177 @@
+#include "RenderPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <android/log.h>
+#include <sys/resource.h>
+
+#define LOG_TAG "RenderPool"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+
+namespace sezo {
+namespace playback {
+
+namespace {
+
+// More helpers than this rarely pays for itself: most callbacks have only a
+// handful of expensive (time-stretched) tracks.
+constexpr size_t kMaxDefaultWorkers = 7;
+
+// How long an idle worker keeps checking for the next batch before sleeping.
+// Covers back-to-back batches (e.g. a callback split in two) without keeping
+// a core busy between callbacks.
+constexpr auto kIdleSpin = std::chrono::microseconds(200);
+
+// Run() wakes sleepers without taking the mutex, so a wakeup can in rare
+// cases land between a worker's check and its wait. This only bounds that
+// case; the caller does the work in the meantime.
+constexpr auto kMissedWakeupBackstop = std::chrono::milliseconds(20);
+
+// ANDROID_PRIORITY_URGENT_AUDIO, the priority the framework gives audio
+// threads that are not SCHED_FIFO.
+constexpr int kWorkerNice = -19;
+
+constexpr uint64_t kTaskMask = 0xffffffffULL;
+
+int64_t SteadyNowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+uint64_t BatchOf(uint64_t claim) {
+  return claim >> 32;
+}
+
+}  // namespace
+
+RenderPool::RenderPool(size_t worker_count, Priority priority) : priority_(priority) {
+  if (worker_count == 0) {
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    worker_count = std::min(cores - 1, kMaxDefaultWorkers);
+  }
+
+  workers_.reserve(worker_count);
+  for (size_t i = 0; i < worker_count; ++i) {
+    workers_.emplace_back(&RenderPool::WorkerLoop, this);
+  }
+  LOGD("Render pool started with %zu workers", worker_count);
+}
+
+RenderPool::~RenderPool() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    shutdown_.store(true, std::memory_order_release);
+  }
+  wake_cv_.notify_all();
+  for (auto& worker : workers_) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+bool RenderPool::Run(TaskFunction function, void* context, size_t count, int64_t deadline_ns) {
+  if (count == 0) {
+    return true;
+  }
+
+  batch_ = (batch_ + 1) & kTaskMask;
+  function_.store(function, std::memory_order_relaxed);
+  context_.store(context, std::memory_order_relaxed);
+  count_.store(count, std::memory_order_relaxed);
+  done_.store(0, std::memory_order_relaxed);
+  // Publishes the batch; pairs with the sleepers_ check in WorkerLoop()
+  claim_.store(batch_ << 32, std::memory_order_seq_cst);
+  if (sleepers_.load(std::memory_order_seq_cst) > 0) {
+    wake_cv_.notify_all();
+  }
+
+  const size_t ran = Drain(batch_);
+  while (done_.load(std::memory_order_acquire) < count) {
+    std::this_thread::yield();
+  }
+
+  batches_.fetch_add(1, std::memory_order_relaxed);
+  tasks_on_caller_.fetch_add(ran, std::memory_order_relaxed);
+  if (deadline_ns > 0 && SteadyNowNs() > deadline_ns) {
+    late_batches_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+size_t RenderPool::Drain(uint64_t batch) {
+  uint64_t claim = claim_.load(std::memory_order_acquire);
+  if (BatchOf(claim) != batch) {
+    return 0;
+  }
+  // Possibly already the next batch's values; the claim below then fails
+  const TaskFunction function = function_.load(std::memory_order_relaxed);
+  void* const context = context_.load(std::memory_order_relaxed);
+  const size_t count = count_.load(std::memory_order_relaxed);
+
+  size_t ran = 0;
+  while (BatchOf(claim) == batch && (claim & kTaskMask) < count) {
+    if (!claim_.compare_exchange_weak(claim, claim + 1, std::memory_order_acq_rel,
+                                      std::memory_order_acquire)) {
+      continue;
+    }
+    function(context, static_cast<size_t>(claim & kTaskMask));
+    done_.fetch_add(1, std::memory_order_release);
+    ++ran;
+    claim = claim_.load(std::memory_order_acquire);
+  }
+  return ran;
+}
+
+void RenderPool::WorkerLoop() {
+  if (priority_ == Priority::kAudio && setpriority(PRIO_PROCESS, 0, kWorkerNice) != 0) {
+    LOGD("Render worker keeps default priority");
+  }
+
+  uint64_t last_batch = BatchOf(claim_.load(std::memory_order_acquire));
+  while (!shutdown_.load(std::memory_order_acquire)) {
+    const uint64_t batch = BatchOf(claim_.load(std::memory_order_acquire));
+    if (batch != last_batch) {
+      last_batch = batch;
+      tasks_on_workers_.fetch_add(Drain(batch), std::memory_order_relaxed);
+      continue;
+    }
+
+    const auto spin_until = std::chrono::steady_clock::now() + kIdleSpin;
+    bool woke = false;
+    while (std::chrono::steady_clock::now() < spin_until) {
+      if (BatchOf(claim_.load(std::memory_order_acquire)) != last_batch) {
+        woke = true;
+        break;
+      }
+      std::this_thread::yield();
+    }
+    if (woke) {
+      continue;
+    }
+
+    sleepers_.fetch_add(1, std::memory_order_seq_cst);
+    {
+      std::unique_lock<std::mutex> lock(sleep_mutex_);
+      wake_cv_.wait_for(lock, kMissedWakeupBackstop, [this, last_batch] {
+        return shutdown_.load(std::memory_order_acquire) ||
+               BatchOf(claim_.load(std::memory_order_seq_cst)) != last_batch;
+      });
+    }
+    sleepers_.fetch_sub(1, std::memory_order_relaxed);
+  }
+}
+
+RenderPool::Stats RenderPool::GetStats() const {
+  Stats stats;
+  stats.batches = batches_.load(std::memory_order_relaxed);
+  stats.tasks_on_workers = tasks_on_workers_.load(std::memory_order_relaxed);
+  stats.tasks_on_caller = tasks_on_caller_.load(std::memory_order_relaxed);
+  stats.late_batches = late_batches_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+}  // namespace playback
+}  // namespace sezo
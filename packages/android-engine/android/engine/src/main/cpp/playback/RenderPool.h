@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sezo {
+namespace playback {
+
+/**
+ * Fixed pool of render threads that help the audio callback with one batch
+ * of independent tasks at a time (e.g. one per track).
+ *
+ * Run() publishes the batch and works on it from the calling thread too.
+ * Tasks are claimed from a shared counter, so whichever thread is free takes
+ * the next one; a worker that is slow to wake simply leaves more for the
+ * caller. Nothing on the caller's side blocks: the batch is published with
+ * atomics and sleeping workers are woken without taking a lock.
+ *
+ * Run() must only be called from one thread at a time.
+ */
+class RenderPool {
+ public:
+  using TaskFunction = void (*)(void* context, size_t task);
+
+  enum class Priority {
+    kAudio,       // helpers of the audio callback (urgent-audio nice level)
+    kBackground,  // offline rendering; default scheduling
+  };
+
+  struct Stats {
+    uint64_t batches = 0;
+    uint64_t tasks_on_workers = 0;
+    uint64_t tasks_on_caller = 0;
+    uint64_t late_batches = 0;  // finished after their deadline
+  };
+
+  /**
+   * Constructor.
+   * @param worker_count Number of helper threads (0 = one less than the cores)
+   * @param priority Scheduling priority of the helper threads
+   */
+  explicit RenderPool(size_t worker_count = 0, Priority priority = Priority::kAudio);
+  ~RenderPool();
+
+  RenderPool(const RenderPool&) = delete;
+  RenderPool& operator=(const RenderPool&) = delete;
+
+  /**
+   * Run function(context, i) for every i in [0, count) and wait until all of
+   * them have finished. A task claimed by a worker always runs to completion,
+   * so the wait can outlast the deadline; the return value lets the caller
+   * stop handing work to the pool for a while.
+   * @param function Task body, called concurrently for different tasks
+   * @param context Passed to every call
+   * @param count Number of tasks
+   * @param deadline_ns steady_clock time the batch should finish by (0 = none)
+   * @return false if the batch finished after the deadline
+   */
+  bool Run(TaskFunction function, void* context, size_t count, int64_t deadline_ns);
+
+  size_t GetWorkerCount() const { return workers_.size(); }
+
+  /**
+   * Counters since construction. Safe to call from any thread.
+   */
+  Stats GetStats() const;
+
+ private:
+  void WorkerLoop();
+  // Claims and runs tasks of the given batch until none are left.
+  size_t Drain(uint64_t batch);
+
+  std::vector<std::thread> workers_;
+  Priority priority_;
+
+  // Batch description. Relaxed atomics: they are only trusted by a thread
+  // that then claims a task of the matching batch through claim_.
+  std::atomic<TaskFunction> function_{nullptr};
+  std::atomic<void*> context_{nullptr};
+  std::atomic<size_t> count_{0};
+  // Batch number in the upper 32 bits, next unclaimed task in the lower 32
+  std::atomic<uint64_t> claim_{0};
+  std::atomic<size_t> done_{0};
+  uint64_t batch_ = 0;
+
+  // Idle workers spin briefly for the next batch, then sleep here
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_cv_;
+  std::atomic<int32_t> sleepers_{0};
+  std::atomic<bool> shutdown_{false};
+
+  std::atomic<uint64_t> batches_{0};
+  std::atomic<uint64_t> tasks_on_workers_{0};
+  std::atomic<uint64_t> tasks_on_caller_{0};
+  std::atomic<uint64_t> late_batches_{0};
+};
+
+}  // namespace playback
+}  // namespace sezo
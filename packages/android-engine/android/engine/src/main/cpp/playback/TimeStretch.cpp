@@ -1,5 +1,6 @@
 #include "TimeStretch.h"
 #include <cstring>
+#include "dsp/MixKernels.h"
 #include "signalsmith-stretch.h"
 #include <android/log.h>
 #include <algorithm>
@@ -13,24 +14,68 @@
 namespace sezo {
 namespace playback {
 
+namespace {
+
+// One channel of a PlanarInput, indexed the way Signalsmith reads its inputs.
+struct PlanarChannel {
+  const float* first;
+  const float* second;
+  size_t first_frames;
+  size_t available_frames;
+
+  float operator[](size_t i) const {
+    if (i < first_frames) {
+      return first[i];
+    }
+    return i < available_frames ? second[i - first_frames] : 0.0f;
+  }
+};
+
+struct PlanarChannels {
+  PlanarChannel channels[2];
+  const PlanarChannel& operator[](int c) const { return channels[c]; }
+};
+
+constexpr float kMinStretchFactor = 0.5f;
+constexpr float kMaxStretchFactor = 2.0f;
+
+// Input frames per call the history holds beyond the longest lag. Callbacks
+// and decode chunks stay well under it; larger calls skip the history.
+constexpr size_t kHistoryBlockFrames = 8192;
+
+// Signalsmith's default preset analyses 120 ms blocks every 30 ms. Per
+// channel it keeps the input and output history plus several spectra and
+// FFT scratch, roughly eight floats per block sample.
+constexpr float kDefaultBlockSeconds = 0.12f;
+constexpr float kDefaultIntervalSeconds = 0.03f;
+constexpr size_t kStretchFloatsPerBlockSample = 8;
+
+// Per-channel wrapper buffers allocated by the constructor
+constexpr size_t kWrapperBufferFrames = 4096;
+
+size_t QualityIndex(TimeStretch::Quality quality) {
+  return static_cast<size_t>(quality);
+}
+
+}  // namespace
+
 TimeStretch::TimeStretch(int32_t sample_rate, int32_t channels)
     : sample_rate_(sample_rate), channels_(channels) {
 
-  // Create the Signalsmith Stretch instance
-  stretcher_ = std::make_unique<StretcherType>();
-
-  // Configure with default preset
-  // Prefer quality for debugging artifacting; split computation to reduce spikes.
   const float sample_rate_f = static_cast<float>(sample_rate);
-  stretcher_->presetDefault(channels, sample_rate_f, true);
   tonality_limit_ = sample_rate_f > 0.0f ? (8000.0f / sample_rate_f) : 0.0f;
 
+  // Start on the default preset
+  tiers_[0] = MakeTier(Quality::kHigh);
+  active_ = tiers_[0].get();
+  const StretcherType& stretcher = *active_->stretcher;
+
   // Get latency values
-  input_latency_ = stretcher_->inputLatency();
-  output_latency_ = stretcher_->outputLatency();
+  input_latency_ = stretcher.inputLatency();
+  output_latency_ = stretcher.outputLatency();
 
   // Pre-allocate buffers (max expected frame size ~2048)
-  const size_t max_frames = 4096;
+  const size_t max_frames = kWrapperBufferFrames;
   for (int c = 0; c < 2; ++c) {
     input_buffers_[c].resize(max_frames);
     output_buffers_[c].resize(max_frames);
@@ -42,9 +87,9 @@ TimeStretch::TimeStretch(int32_t sample_rate, int32_t channels)
        channels,
        input_latency_,
        output_latency_,
-       stretcher_->blockSamples(),
-       stretcher_->intervalSamples(),
-       stretcher_->splitComputation() ? 1 : 0);
+       stretcher.blockSamples(),
+       stretcher.intervalSamples(),
+       stretcher.splitComputation() ? 1 : 0);
 }
 
 TimeStretch::~TimeStretch() {
@@ -59,7 +104,7 @@ void TimeStretch::SetPitchSemitones(float semitones) {
 
 void TimeStretch::SetStretchFactor(float factor) {
   // Clamp to reasonable range
-  factor = std::clamp(factor, 0.5f, 2.0f);
+  factor = std::clamp(factor, kMinStretchFactor, kMaxStretchFactor);
   stretch_factor_.store(factor, std::memory_order_release);
 }
 
@@ -79,6 +124,208 @@ bool TimeStretch::IsActive() const {
   return std::abs(pitch) > 0.01f || std::abs(stretch - 1.0f) > 0.01f;
 }
 
+size_t TimeStretch::EstimateMemoryBytes(int32_t sample_rate, int32_t channels) {
+  const size_t channel_count = static_cast<size_t>(std::max(1, channels));
+  const float sample_rate_f = static_cast<float>(std::max(1, sample_rate));
+  const size_t block = static_cast<size_t>(sample_rate_f * kDefaultBlockSeconds);
+  const size_t interval = static_cast<size_t>(sample_rate_f * kDefaultIntervalSeconds);
+  const size_t stretcher_floats =
+      channel_count * (block * kStretchFloatsPerBlockSample + interval);
+  // Input and output buffers, always sized for two channels
+  const size_t wrapper_floats = 2 * 2 * kWrapperBufferFrames;
+  return (stretcher_floats + wrapper_floats) * sizeof(float);
+}
+
+std::unique_ptr<TimeStretch::Tier> TimeStretch::MakeTier(Quality quality) const {
+  auto tier = std::make_unique<Tier>();
+  tier->quality = quality;
+  tier->stretcher = std::make_unique<StretcherType>();
+
+  // Split computation throughout to reduce per-callback spikes
+  const float sample_rate_f = static_cast<float>(sample_rate_);
+  switch (quality) {
+    case Quality::kHigh:
+      tier->stretcher->presetDefault(channels_, sample_rate_f, true);
+      break;
+    case Quality::kMedium:
+      tier->stretcher->presetCheaper(channels_, sample_rate_f, true);
+      break;
+    case Quality::kLow:
+      // Half the cheaper preset's block (100 ms) at its 2.5x hop ratio
+      tier->stretcher->configure(channels_, static_cast<int>(sample_rate_f * 0.05f),
+                                 static_cast<int>(sample_rate_f * 0.02f), true);
+      break;
+  }
+  tier->latency = tier->stretcher->inputLatency() + tier->stretcher->outputLatency();
+  return tier;
+}
+
+size_t TimeStretch::LagFor(const Tier& tier) const {
+  // The latency difference in input frames at the current speed. Fixed until
+  // the tier is next switched to or reset, so later speed changes shift the
+  // tier's latency slightly rather than glitching its input.
+  const int32_t difference = std::max(0, GetLatencyFrames() - tier.latency);
+  return static_cast<size_t>(std::lround(static_cast<float>(difference) *
+                                         stretch_factor_.load(std::memory_order_acquire)));
+}
+
+void TimeStretch::SetQuality(Quality quality, size_t crossfade_frames) {
+  std::lock_guard<std::mutex> lock(tiers_mutex_);
+  auto& slot = tiers_[QualityIndex(quality)];
+  if (!slot) {
+    slot = MakeTier(quality);
+    LOGI("TimeStretch tier %d built: latency %d, block %d, interval %d",
+         static_cast<int>(quality), slot->latency, slot->stretcher->blockSamples(),
+         slot->stretcher->intervalSamples());
+  }
+  if (quality != Quality::kHigh && history_[0].empty()) {
+    // Allocated before a cheaper tier is first requested, so the processing
+    // thread never sizes them. A pre-roll is at most the longest lag.
+    const size_t max_lag = static_cast<size_t>(
+        std::ceil(static_cast<float>(GetLatencyFrames()) * kMaxStretchFactor));
+    history_block_frames_ = std::max(kHistoryBlockFrames, max_lag);
+    const size_t max_output_frames = static_cast<size_t>(
+        std::ceil(static_cast<float>(history_block_frames_) / kMinStretchFactor));
+    for (int c = 0; c < channels_; ++c) {
+      history_[c].assign(max_lag + history_block_frames_, 0.0f);
+      transition_buffers_[c].assign(max_output_frames, 0.0f);
+    }
+  }
+  crossfade_frames_.store(crossfade_frames, std::memory_order_relaxed);
+  requested_quality_.store(quality, std::memory_order_release);
+}
+
+TimeStretch::Quality TimeStretch::GetQuality() const {
+  return requested_quality_.load(std::memory_order_acquire);
+}
+
+TimeStretch::Quality TimeStretch::GetActiveQuality() const {
+  return active_quality_.load(std::memory_order_acquire);
+}
+
+void TimeStretch::UpdateTransition() {
+  const Quality requested = requested_quality_.load(std::memory_order_acquire);
+  if (incoming_) {
+    // Switched back before the new tier was heard: drop it
+    if (requested == active_->quality && warmup_remaining_ > 0) {
+      incoming_ = nullptr;
+    }
+    return;
+  }
+  if (requested == active_->quality) {
+    return;
+  }
+
+  Tier* tier = tiers_[QualityIndex(requested)].get();
+  tier->stretcher->reset();
+  tier->pitch_dirty = true;
+  tier->lag = LagFor(*tier);
+  incoming_ = tier;
+  // The incoming tier starts from silence: wait until its output covers the
+  // full latency and one analysis block before it is heard
+  warmup_remaining_ = static_cast<size_t>(GetLatencyFrames()) +
+                      static_cast<size_t>(tier->stretcher->blockSamples());
+  crossfade_length_ = std::max<size_t>(1, crossfade_frames_.load(std::memory_order_relaxed));
+  crossfade_position_ = 0;
+}
+
+template <typename Inputs>
+void TimeStretch::AppendHistory(const Inputs& inputs, size_t input_frames) {
+  if (!history_valid_) {
+    // Start from silence: the tiers reading it are still warming up
+    for (int c = 0; c < channels_; ++c) {
+      std::fill(history_[c].begin(), history_[c].end(), 0.0f);
+    }
+    history_end_ = 0;
+    history_valid_ = true;
+  }
+
+  const size_t capacity = history_[0].size();
+  for (int c = 0; c < channels_; ++c) {
+    float* history = history_[c].data();
+    size_t position = history_end_;
+    for (size_t i = 0; i < input_frames; ++i) {
+      history[position] = inputs[c][i];
+      if (++position == capacity) {
+        position = 0;
+      }
+    }
+  }
+  history_end_ = (history_end_ + input_frames) % capacity;
+}
+
+void TimeStretch::RenderTier(Tier& tier, size_t input_frames, float* const* output,
+                             size_t output_frames) {
+  // This call's input, tier.lag frames back from the end of the history
+  const size_t capacity = history_[0].size();
+  const size_t start = (history_end_ + capacity - input_frames - tier.lag) % capacity;
+  PlanarChannels channels;
+  for (int c = 0; c < channels_; ++c) {
+    channels.channels[c] = {history_[c].data() + start, history_[c].data(),
+                            std::min(input_frames, capacity - start), input_frames};
+  }
+  ApplyPitch(tier);
+  tier.stretcher->process(channels, static_cast<int>(input_frames),
+                          output, static_cast<int>(output_frames));
+}
+
+void TimeStretch::MixTransition(float* const* output, size_t output_frames) {
+  const float* incoming[2] = {transition_buffers_[0].data(), transition_buffers_[1].data()};
+  size_t i = std::min(output_frames, warmup_remaining_);
+  warmup_remaining_ -= i;
+  if (i == output_frames) {
+    return;
+  }
+
+  const float step = 1.0f / static_cast<float>(crossfade_length_);
+  for (; i < output_frames && crossfade_position_ < crossfade_length_; ++i) {
+    const float mix = static_cast<float>(++crossfade_position_) * step;
+    for (int c = 0; c < channels_; ++c) {
+      output[c][i] += (incoming[c][i] - output[c][i]) * mix;
+    }
+  }
+  for (int c = 0; c < channels_; ++c) {
+    std::copy(incoming[c] + i, incoming[c] + output_frames, output[c] + i);
+  }
+
+  if (crossfade_position_ >= crossfade_length_) {
+    LOGI("TimeStretch switched to tier %d", static_cast<int>(incoming_->quality));
+    active_ = incoming_;
+    incoming_ = nullptr;
+    active_quality_.store(active_->quality, std::memory_order_release);
+  }
+}
+
+template <typename Inputs>
+void TimeStretch::Render(const Inputs& inputs, size_t input_frames, float* const* output,
+                         size_t output_frames) {
+  UpdateTransition();
+  const bool fits_history = input_frames <= history_block_frames_ &&
+                            output_frames <= transition_buffers_[0].size();
+  if (!fits_history && incoming_) {
+    // Too large for the preallocated buffers: finish the switch at once
+    active_ = incoming_;
+    incoming_ = nullptr;
+    active_quality_.store(active_->quality, std::memory_order_release);
+  }
+  if ((active_->lag == 0 && !incoming_) || !fits_history) {
+    // Plain case: the input goes straight to the stretcher
+    history_valid_ = false;
+    ApplyPitch(*active_);
+    active_->stretcher->process(inputs, static_cast<int>(input_frames),
+                                output, static_cast<int>(output_frames));
+    return;
+  }
+
+  AppendHistory(inputs, input_frames);
+  RenderTier(*active_, input_frames, output, output_frames);
+  if (incoming_) {
+    float* incoming[2] = {transition_buffers_[0].data(), transition_buffers_[1].data()};
+    RenderTier(*incoming_, input_frames, incoming, output_frames);
+    MixTransition(output, output_frames);
+  }
+}
+
 void TimeStretch::Process(const float* input, size_t input_frames, float* output, size_t output_frames) {
   if (!input || !output || output_frames == 0) {
     return;
@@ -114,31 +361,31 @@ void TimeStretch::Process(const float* input, size_t input_frames, float* output
     return;
   }
 
-  // Load current parameters
-  const float pitch = pitch_semitones_.load(std::memory_order_acquire);
+  DeinterleaveInput(input, input_frames);
+  ProcessBuffers(input_frames, output_frames);
+  InterleaveOutput(output, output_frames);
+}
 
+void TimeStretch::ApplyPitch(Tier& tier) {
   // Update stretcher parameters if they changed
-  if (std::abs(pitch - last_pitch_) > 0.001f) {
-    stretcher_->setTransposeSemitones(pitch, tonality_limit_);
-    last_pitch_ = pitch;
+  const float pitch = pitch_semitones_.load(std::memory_order_acquire);
+  if (tier.pitch_dirty || std::abs(pitch - tier.last_pitch) > 0.001f) {
+    tier.stretcher->setTransposeSemitones(pitch, tonality_limit_);
+    tier.last_pitch = pitch;
+    tier.pitch_dirty = false;
   }
+}
 
-  // Ensure buffers are large enough
+void TimeStretch::DeinterleaveInput(const float* input, size_t input_frames) {
   for (int c = 0; c < channels_; ++c) {
     if (input_buffers_[c].size() < input_frames) {
       input_buffers_[c].resize(input_frames);
     }
-    if (output_buffers_[c].size() < output_frames) {
-      output_buffers_[c].resize(output_frames);
-    }
   }
 
-  // De-interleave input samples into separate channel buffers
   if (channels_ == 2) {
-    for (size_t i = 0; i < input_frames; ++i) {
-      input_buffers_[0][i] = input[i * 2];      // Left
-      input_buffers_[1][i] = input[i * 2 + 1];  // Right
-    }
+    dsp::GetMixKernels().deinterleave_stereo(input_buffers_[0].data(), input_buffers_[1].data(),
+                                             input, input_frames);
   } else {
     // Mono or other channel configs
     for (int c = 0; c < channels_; ++c) {
@@ -147,35 +394,138 @@ void TimeStretch::Process(const float* input, size_t input_frames, float* output
       }
     }
   }
+}
+
+void TimeStretch::ProcessBuffers(size_t input_frames, size_t output_frames) {
+  for (int c = 0; c < channels_; ++c) {
+    if (output_buffers_[c].size() < output_frames) {
+      output_buffers_[c].resize(output_frames);
+    }
+  }
 
   // Create array of pointers for Signalsmith API
   float* input_ptrs[2] = {input_buffers_[0].data(), input_buffers_[1].data()};
   float* output_ptrs[2] = {output_buffers_[0].data(), output_buffers_[1].data()};
+  Render(input_ptrs, input_frames, output_ptrs, output_frames);
+}
 
-  // Process through Signalsmith Stretch
-  const int input_samples = static_cast<int>(input_frames);
-  const int output_samples = static_cast<int>(output_frames);
-  stretcher_->process(input_ptrs, input_samples, output_ptrs, output_samples);
-
-  // Re-interleave output samples
+void TimeStretch::InterleaveOutput(float* output, size_t output_frames) {
   if (channels_ == 2) {
-    for (int i = 0; i < output_samples; ++i) {
-      output[i * 2] = output_buffers_[0][i];      // Left
-      output[i * 2 + 1] = output_buffers_[1][i];  // Right
-    }
+    dsp::GetMixKernels().interleave_stereo(output, output_buffers_[0].data(),
+                                           output_buffers_[1].data(), output_frames);
   } else {
     // Mono or other channel configs
     for (int c = 0; c < channels_; ++c) {
-      for (int i = 0; i < output_samples; ++i) {
+      for (size_t i = 0; i < output_frames; ++i) {
         output[i * channels_ + c] = output_buffers_[c][i];
       }
     }
   }
 }
 
+size_t TimeStretch::GetPrerollInputFrames() const {
+  return static_cast<size_t>(std::ceil(static_cast<float>(GetLatencyFrames()) *
+                                       stretch_factor_.load(std::memory_order_acquire)));
+}
+
+void TimeStretch::Preroll(const float* input, size_t input_frames) {
+  if (!input || input_frames == 0 || (channels_ != 1 && channels_ != 2)) {
+    return;
+  }
+  // The discarded output spans the same time as the input at this speed
+  const float stretch = stretch_factor_.load(std::memory_order_acquire);
+  const size_t output_frames = static_cast<size_t>(
+      std::lround(static_cast<float>(input_frames) / stretch));
+  DeinterleaveInput(input, input_frames);
+  ProcessBuffers(input_frames, output_frames);
+}
+
+void TimeStretch::PrerollPlanar(const PlanarInput& input, size_t input_frames) {
+  if (input_frames == 0 || (channels_ != 1 && channels_ != 2)) {
+    return;
+  }
+  PlanarChannels channels;
+  for (int c = 0; c < channels_; ++c) {
+    channels.channels[c] = {input.first[c], input.second[c], input.first_frames,
+                            std::min(input.available_frames, input_frames)};
+  }
+  const float stretch = stretch_factor_.load(std::memory_order_acquire);
+  const size_t output_frames = static_cast<size_t>(
+      std::lround(static_cast<float>(input_frames) / stretch));
+  for (int c = 0; c < channels_; ++c) {
+    if (output_buffers_[c].size() < output_frames) {
+      output_buffers_[c].resize(output_frames);
+    }
+  }
+  float* output_ptrs[2] = {output_buffers_[0].data(), output_buffers_[1].data()};
+  Render(channels, input_frames, output_ptrs, output_frames);
+}
+
+void TimeStretch::Drain(float* output, size_t output_frames) {
+  if (!output || output_frames == 0 || (channels_ != 1 && channels_ != 2)) {
+    return;
+  }
+  // Silence in at unit rate; pitch stays where it was so the tail sounds
+  // the way it was rendered
+  for (int c = 0; c < channels_; ++c) {
+    if (input_buffers_[c].size() < output_frames) {
+      input_buffers_[c].resize(output_frames);
+    }
+    std::fill_n(input_buffers_[c].data(), output_frames, 0.0f);
+  }
+  ProcessBuffers(output_frames, output_frames);
+  InterleaveOutput(output, output_frames);
+}
+
+void TimeStretch::DrainPlanar(float* const* output, size_t output_frames) {
+  if (!output || output_frames == 0 || (channels_ != 1 && channels_ != 2)) {
+    return;
+  }
+  for (int c = 0; c < channels_; ++c) {
+    if (input_buffers_[c].size() < output_frames) {
+      input_buffers_[c].resize(output_frames);
+    }
+    std::fill_n(input_buffers_[c].data(), output_frames, 0.0f);
+  }
+  float* input_ptrs[2] = {input_buffers_[0].data(), input_buffers_[1].data()};
+  Render(input_ptrs, output_frames, output, output_frames);
+}
+
+void TimeStretch::ProcessPlanar(const PlanarInput& input, size_t input_frames,
+                                float* const* output, size_t output_frames) {
+  if (!output || output_frames == 0 || (channels_ != 1 && channels_ != 2)) {
+    return;
+  }
+
+  PlanarChannels channels;
+  for (int c = 0; c < channels_; ++c) {
+    channels.channels[c] = {input.first[c], input.second[c], input.first_frames,
+                            std::min(input.available_frames, input_frames)};
+  }
+
+  if (!IsActive()) {
+    // Bypass: copy what is available and pad with silence
+    for (int c = 0; c < channels_; ++c) {
+      for (size_t i = 0; i < output_frames; ++i) {
+        output[c][i] = i < input_frames ? channels.channels[c][i] : 0.0f;
+      }
+    }
+    return;
+  }
+
+  Render(channels, input_frames, output, output_frames);
+}
+
 void TimeStretch::Reset() {
-  stretcher_->reset();
-  last_pitch_ = 0.0f;
+  // Nothing to keep continuous across a reset: adopt the requested tier now
+  const Quality requested = requested_quality_.load(std::memory_order_acquire);
+  active_ = tiers_[QualityIndex(requested)].get();
+  incoming_ = nullptr;
+  active_->stretcher->reset();
+  active_->pitch_dirty = true;
+  active_->lag = LagFor(*active_);
+  history_valid_ = false;
+  active_quality_.store(requested, std::memory_order_release);
   last_stretch_ = 1.0f;
 
   LOGI("TimeStretch reset");
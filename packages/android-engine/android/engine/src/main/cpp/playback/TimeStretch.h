@@ -1,8 +1,10 @@
 #pragma once
 
+#include <array>
 #include <memory>
 #include <cstdint>
 #include <atomic>
+#include <mutex>
 #include <vector>
 
 // Forward declaration to avoid including the large Signalsmith header here
@@ -25,11 +27,28 @@ namespace playback {
  *
  * Thread Safety:
  * - SetPitchSemitones() and SetStretchFactor() can be called from any thread
+ * - SetQuality() can be called from any thread except the processing one
  * - Process() is designed to be called from the real-time audio thread
  * - Reset() should only be called when audio processing is stopped
  */
 class TimeStretch {
  public:
+  /**
+   * Processing quality tiers, from most to least CPU per second of audio:
+   * - kHigh: Signalsmith's default preset (the initial tier)
+   * - kMedium: the cheaper preset, with longer hops between spectra
+   * - kLow: half-length blocks at the cheaper hop ratio
+   * Cheaper tiers have less latency of their own; their input is delayed to
+   * make up the difference, so GetLatencyFrames() and the delay
+   * compensation built on it are the same for every tier.
+   */
+  enum class Quality : int32_t {
+    kHigh = 0,
+    kMedium = 1,
+    kLow = 2,
+  };
+  static constexpr int32_t kQualityCount = 3;
+
   /**
    * Constructs a TimeStretch instance.
    *
@@ -100,6 +119,70 @@ class TimeStretch {
    */
   void Process(const float* input, size_t input_frames, float* output, size_t output_frames);
 
+  /**
+   * Non-interleaved input that may wrap around a ring buffer: frame i of
+   * channel c is first[c][i] below first_frames, second[c][i - first_frames]
+   * after that, and silence from available_frames on.
+   */
+  struct PlanarInput {
+    const float* first[2] = {nullptr, nullptr};
+    size_t first_frames = 0;
+    const float* second[2] = {nullptr, nullptr};
+    size_t available_frames = 0;
+  };
+
+  /**
+   * Planar variant of Process(): reads the channel planes in place and writes
+   * one plane per channel, skipping the interleave/de-interleave copies.
+   * Mono and stereo only.
+   *
+   * @param input Channel planes (see PlanarInput)
+   * @param input_frames Number of input frames to consume
+   * @param output One output plane per channel, output_frames long
+   * @param output_frames Number of output frames
+   *
+   * Thread-safe: Should only be called from audio callback thread
+   */
+  void ProcessPlanar(const PlanarInput& input, size_t input_frames,
+                     float* const* output, size_t output_frames);
+
+  /**
+   * Input frames to pre-roll after a reset so the output lines up with the
+   * input instead of trailing it by the processing latency: the total
+   * latency in input frames at the current stretch factor.
+   */
+  size_t GetPrerollInputFrames() const;
+
+  /**
+   * Feeds input ahead of playback and discards the matching output, so the
+   * next Process() call starts at the same position as its input. Used for
+   * delay compensation after a reset or when effects switch on.
+   *
+   * @param input Interleaved samples to pre-roll
+   * @param input_frames Number of input frames (normally GetPrerollInputFrames())
+   */
+  void Preroll(const float* input, size_t input_frames);
+
+  /**
+   * Planar variant of Preroll().
+   */
+  void PrerollPlanar(const PlanarInput& input, size_t input_frames);
+
+  /**
+   * Plays out the audio still inside the stretcher by feeding silence, even
+   * when effects are now off. After a pre-roll, draining GetLatencyFrames()
+   * frames hands playback back to the unprocessed input without a jump.
+   *
+   * @param output Interleaved output, output_frames long
+   * @param output_frames Number of frames to drain
+   */
+  void Drain(float* output, size_t output_frames);
+
+  /**
+   * Planar variant of Drain().
+   */
+  void DrainPlanar(float* const* output, size_t output_frames);
+
   /**
    * Resets the internal state of the time-stretcher.
    *
@@ -110,35 +193,120 @@ class TimeStretch {
    */
   void Reset();
 
+  /**
+   * Switches to another quality tier. The tier's stretcher is built here
+   * (kept afterwards, so switching back does not allocate); the processing
+   * thread then runs it alongside the current one until it has warmed up
+   * and crossfades over. A Reset() switches immediately.
+   *
+   * @param quality Tier to switch to
+   * @param crossfade_frames Crossfade length in output frames
+   *
+   * Thread-safe: Call from any thread other than the processing thread
+   */
+  void SetQuality(Quality quality, size_t crossfade_frames);
+
+  /**
+   * Gets the tier most recently requested with SetQuality().
+   */
+  Quality GetQuality() const;
+
+  /**
+   * Gets the tier producing the output. Trails GetQuality() while a switch
+   * is warming up or crossfading.
+   */
+  Quality GetActiveQuality() const;
+
   /**
    * Checks if effects are currently active (pitch != 0 or speed != 1.0)
    */
   bool IsActive() const;
 
+  /**
+   * Total processing delay (input plus output latency) in frames, the same
+   * for every quality tier.
+   */
+  int32_t GetLatencyFrames() const { return input_latency_ + output_latency_; }
+
+  /**
+   * Rough heap use of a new instance (the initial kHigh tier plus this
+   * wrapper's buffers), for sizing offline work before it is created.
+   * Cheaper tiers built later by SetQuality() add to it.
+   */
+  static size_t EstimateMemoryBytes(int32_t sample_rate, int32_t channels);
+
  private:
-  [[maybe_unused]] int32_t sample_rate_;
+  using StretcherType = signalsmith::stretch::SignalsmithStretch<float, void>;
+
+  // One configured stretcher per quality tier
+  struct Tier {
+    Quality quality = Quality::kHigh;
+    std::unique_ptr<StretcherType> stretcher;
+    int32_t latency = 0;  // the tier's own input plus output latency
+    size_t lag = 0;       // input frames the tier trails the input by
+    float last_pitch = 0.0f;
+    bool pitch_dirty = true;
+  };
+
+  std::unique_ptr<Tier> MakeTier(Quality quality) const;
+  size_t LagFor(const Tier& tier) const;
+  void ApplyPitch(Tier& tier);
+  void UpdateTransition();
+  template <typename Inputs>
+  void Render(const Inputs& inputs, size_t input_frames, float* const* output,
+              size_t output_frames);
+  template <typename Inputs>
+  void AppendHistory(const Inputs& inputs, size_t input_frames);
+  void RenderTier(Tier& tier, size_t input_frames, float* const* output, size_t output_frames);
+  void MixTransition(float* const* output, size_t output_frames);
+  void ProcessBuffers(size_t input_frames, size_t output_frames);
+  void DeinterleaveInput(const float* input, size_t input_frames);
+  void InterleaveOutput(float* output, size_t output_frames);
+
+  int32_t sample_rate_;
   int32_t channels_;
 
   // Atomic parameters for thread-safe access
   std::atomic<float> pitch_semitones_{0.0f};
   std::atomic<float> stretch_factor_{1.0f};
 
-  // Signalsmith Stretch instance (using unique_ptr to hide implementation)
-  using StretcherType = signalsmith::stretch::SignalsmithStretch<float, void>;
-  std::unique_ptr<StretcherType> stretcher_;
+  // Quality tiers (using unique_ptr to hide the Signalsmith implementation).
+  // A slot is filled by SetQuality() before the tier is requested through
+  // requested_quality_, and never replaced, so the processing thread can
+  // read the slot it was asked to switch to.
+  std::array<std::unique_ptr<Tier>, kQualityCount> tiers_;
+  std::mutex tiers_mutex_;
+  std::atomic<Quality> requested_quality_{Quality::kHigh};
+  std::atomic<Quality> active_quality_{Quality::kHigh};
+  std::atomic<size_t> crossfade_frames_{0};
+
+  // Processing-thread state. While a cheaper tier is active or a switch is
+  // under way, input goes through history_ so each tier can read it at its
+  // own lag; the incoming tier is warmed up on discarded output first.
+  Tier* active_ = nullptr;
+  Tier* incoming_ = nullptr;
+  size_t warmup_remaining_ = 0;
+  size_t crossfade_position_ = 0;
+  size_t crossfade_length_ = 0;
+  // history_ and transition_buffers_ are sized by the first SetQuality()
+  // for a cheaper tier, before that tier can be requested.
+  std::vector<float> history_[2];
+  size_t history_block_frames_ = 0;
+  size_t history_end_ = 0;
+  bool history_valid_ = false;
+  std::vector<float> transition_buffers_[2];
 
   // Internal buffers for processing
   std::vector<float> input_buffers_[2];   // Separate buffers per channel
   std::vector<float> output_buffers_[2];  // Separate buffers per channel
   std::vector<float> temp_buffer_;        // Temporary working buffer
 
-  // Latency compensation
+  // Latency compensation (kHigh tier)
   int32_t input_latency_ = 0;
   int32_t output_latency_ = 0;
   float tonality_limit_ = 0.0f;
 
   // Last applied parameters (to detect changes)
-  float last_pitch_ = 0.0f;
   float last_stretch_ = 1.0f;
 };
 
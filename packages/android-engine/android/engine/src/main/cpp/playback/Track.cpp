@@ -1,7 +1,9 @@
 #include "Track.h"
 #include "audio/M4ADecoder.h"
+#include "audio/PcmCache.h"
 #include "audio/MP3Decoder.h"
 #include "audio/WAVDecoder.h"
+#include "dsp/MixKernels.h"
 
 #include <algorithm>
 #include <cmath>
@@ -20,8 +22,50 @@
 namespace sezo {
 namespace playback {
 
-Track::Track(const std::string& id, const std::string& file_path)
-    : id_(id), file_path_(file_path) {}
+namespace {
+
+// Frames decoded per scheduler work item.
+constexpr size_t kDecodeChunkFrames = 4096;
+
+// Smallest work item when stretching ahead; smaller chunks keep the amount
+// rendered ahead close to the requested limit.
+constexpr size_t kMinAheadChunkFrames = 256;
+
+// Pitch/speed changes at least this large flush the audio rendered ahead
+// instead of waiting for it to play out.
+constexpr float kFlushPitchSemitones = 0.5f;
+constexpr float kFlushStretchRatio = 0.05f;
+
+// Builds a TimeStretch or Varispeed planar input from the two ring spans.
+template <typename PlanarInput>
+PlanarInput MakePlanarInput(const core::CircularBuffer::ReadSpan& left,
+                            const core::CircularBuffer::ReadSpan& right,
+                            size_t available) {
+  PlanarInput input;
+  if (available > 0) {
+    input.first[0] = left.first;
+    input.first[1] = right.first;
+    input.first_frames = left.first_count;
+    input.second[0] = left.second;
+    input.second[1] = right.second;
+    input.available_frames = available;
+  }
+  return input;
+}
+
+void CopySpan(const core::CircularBuffer::ReadSpan& span, float* destination) {
+  std::copy(span.first, span.first + span.first_count, destination);
+  if (span.second_count > 0) {
+    std::copy(span.second, span.second + span.second_count, destination + span.first_count);
+  }
+}
+
+}  // namespace
+
+Track::Track(const std::string& id,
+             const std::string& file_path,
+             std::shared_ptr<DecodeScheduler> scheduler)
+    : id_(id), file_path_(file_path), scheduler_(std::move(scheduler)) {}
 
 Track::~Track() {
   Unload();
@@ -32,60 +76,139 @@ bool Track::Load() {
     return true;
   }
 
-  // Determine decoder type based on file extension
-  if (file_path_.find(".mp3") != std::string::npos) {
-    decoder_ = std::make_unique<audio::MP3Decoder>();
-  } else if (file_path_.find(".m4a") != std::string::npos ||
-             file_path_.find(".mp4") != std::string::npos) {
-    decoder_ = std::make_unique<audio::M4ADecoder>();
-  } else if (file_path_.find(".wav") != std::string::npos) {
-    decoder_ = std::make_unique<audio::WAVDecoder>();
-  } else {
-    return false;  // Unsupported format
+  // Compressed sources already decoded into the PCM cache open as a
+  // memory-mapped WAV; otherwise decode normally and fill the cache in the
+  // background.
+  if (pcm_cache_ && audio::PcmCache::IsCacheable(file_path_)) {
+    decoder_ = pcm_cache_->OpenCached(file_path_);
+    if (decoder_) {
+      cache_backed_ = true;
+      LOGD("Track %s: using cached PCM", id_.c_str());
+    } else {
+      pcm_cache_->Prefetch(file_path_);
+    }
   }
 
-  if (!decoder_->Open(file_path_)) {
-    decoder_.reset();
-    return false;
+  if (!decoder_) {
+    // Determine decoder type based on file extension
+    if (file_path_.find(".mp3") != std::string::npos) {
+      decoder_ = std::make_unique<audio::MP3Decoder>();
+    } else if (file_path_.find(".m4a") != std::string::npos ||
+               file_path_.find(".mp4") != std::string::npos) {
+      decoder_ = std::make_unique<audio::M4ADecoder>();
+    } else if (file_path_.find(".wav") != std::string::npos) {
+      decoder_ = std::make_unique<audio::WAVDecoder>();
+    } else {
+      return false;  // Unsupported format
+    }
+
+    if (!decoder_->Open(file_path_)) {
+      decoder_.reset();
+      return false;
+    }
+  }
+
+  // Kept outside the decoder so a cache swap never races readers of the format
+  format_ = decoder_->GetFormat();
+  const int32_t source_rate = format_.sample_rate;
+  const int32_t channels = format_.channels;
+  if (output_sample_rate_ <= 0) {
+    output_sample_rate_ = source_rate;
+  }
+
+  // Resample on the decode workers so the audio thread only sees output-rate
+  // samples
+  resampler_.reset();
+  size_t source_chunk_frames = kDecodeChunkFrames;
+  if (source_rate != output_sample_rate_) {
+    resampler_ = std::make_unique<dsp::Resampler>(
+        source_rate, output_sample_rate_, channels, kDecodeChunkFrames);
+    source_chunk_frames = resampler_->GetInputFramesNeeded(kDecodeChunkFrames) + 1;
+    resample_buffer_.resize(kDecodeChunkFrames * channels);
+    LOGD("Track %s: resampling %d Hz -> %d Hz", id_.c_str(), source_rate, output_sample_rate_);
   }
 
   // Create circular buffer (e.g., 1 second of audio)
-  const size_t buffer_size = decoder_->GetFormat().sample_rate * decoder_->GetFormat().channels;
-  buffer_ = std::make_unique<core::CircularBuffer>(buffer_size);
+  const size_t buffer_size = static_cast<size_t>(output_sample_rate_) * channels;
+
+  // Stretching ahead decodes in smaller chunks and stops once the limit is
+  // buffered. A chunk can stretch to twice its length at half speed, so the
+  // free-space check reserves room for that.
+  stretch_ahead_ = stretch_ahead_requested_ && (channels == 1 || channels == 2);
+  chunk_frames_ = kDecodeChunkFrames;
+  size_t chunk_output_frames = kDecodeChunkFrames;
+  if (stretch_ahead_) {
+    const size_t max_ahead = std::min(stretch_ahead_frames_requested_,
+                                      static_cast<size_t>(output_sample_rate_) / 2);
+    chunk_frames_ = std::clamp(max_ahead / 4, kMinAheadChunkFrames, kDecodeChunkFrames);
+    chunk_output_frames = chunk_frames_ * 2;
+    ahead_limit_samples_ = std::max(max_ahead, chunk_frames_) * channels;
+    stretch_output_buffer_.resize(chunk_output_frames * channels);
+  }
+  planar_ = planar_requested_ && channels == 2;
+  if (planar_) {
+    buffer_ = std::make_unique<core::CircularBuffer>(static_cast<size_t>(output_sample_rate_));
+    right_buffer_ = std::make_unique<core::CircularBuffer>(static_cast<size_t>(output_sample_rate_));
+    for (auto& plane : planar_output_) {
+      plane.resize(kDecodeChunkFrames);
+    }
+  } else {
+    buffer_ = std::make_unique<core::CircularBuffer>(buffer_size, static_cast<size_t>(channels));
+  }
 
   // Phase 2: Create time-stretcher
-  time_stretcher_ = std::make_unique<TimeStretch>(
-      decoder_->GetFormat().sample_rate,
-      decoder_->GetFormat().channels);
+  time_stretcher_ = std::make_unique<TimeStretch>(output_sample_rate_, channels);
+  const TimeStretch::Quality quality = stretch_quality_.load(std::memory_order_relaxed);
+  if (quality != TimeStretch::Quality::kHigh) {
+    // Nothing is playing yet, so start on the tier without a crossfade
+    time_stretcher_->SetQuality(quality, stretch_crossfade_frames_.load(std::memory_order_relaxed));
+    time_stretcher_->Reset();
+  }
+  varispeed_ = std::make_unique<dsp::Varispeed>(channels, kDecodeChunkFrames);
+  varispeed_reset_pending_.store(false, std::memory_order_relaxed);
 
-  // Start streaming thread
-  streaming_active_.store(true, std::memory_order_release);
-  streaming_thread_ = std::make_unique<std::thread>(&Track::StreamingThreadFunc, this);
+  // Hand the buffer to the shared decode pool; refill when it is half empty
+  low_watermark_samples_ = buffer_size / 2;
+  decode_buffer_.resize(source_chunk_frames * channels);
+  decode_chunk_samples_ = chunk_output_frames * channels;
+  ahead_source_frame_ = 0;
+  rendered_active_.store(false, std::memory_order_relaxed);
+  ahead_output_fraction_ = 0.0;
+  ahead_tail_rendered_ = false;
+  source_exhausted_.store(false, std::memory_order_release);
+  if (!scheduler_) {
+    scheduler_ = DecodeScheduler::GetShared();
+  }
+  scheduler_id_ = scheduler_->Register(this, id_);
 
   is_loaded_.store(true, std::memory_order_release);
+  UpdateTargetGains();
   LOGD("Track loaded: %s", id_.c_str());
   return true;
 }
 
 void Track::Unload() {
   if (is_loaded_.load(std::memory_order_acquire)) {
-    // Stop streaming thread
-    streaming_active_.store(false, std::memory_order_release);
-    streaming_cv_.notify_all();
-
-    if (streaming_thread_ && streaming_thread_->joinable()) {
-      streaming_thread_->join();
-    }
-    streaming_thread_.reset();
+    // Stop decoding; waits for an in-flight chunk to finish
+    scheduler_->Unregister(scheduler_id_);
+    scheduler_id_ = 0;
 
     {
       std::lock_guard<std::mutex> lock(decoder_mutex_);
       decoder_->Close();
       decoder_.reset();
+      cache_backed_ = false;
     }
     buffer_.reset();
+    right_buffer_.reset();
+    planar_pending_frames_ = 0;
     time_stretcher_.reset();
+    varispeed_.reset();
+    resampler_.reset();
     is_loaded_.store(false, std::memory_order_release);
+    parked_.store(false, std::memory_order_relaxed);
+    resume_state_.store(ResumeState::kNone, std::memory_order_relaxed);
+    NotifyParamsChanged();
     LOGD("Track unloaded: %s", id_.c_str());
   }
 }
@@ -93,28 +216,411 @@ void Track::Unload() {
 size_t Track::ReadSamples(float* output, size_t frames) {
   if (!is_loaded_.load(std::memory_order_acquire) || muted_.load(std::memory_order_acquire)) {
     // If muted, fill with silence
-    const int32_t channels = decoder_ ? decoder_->GetFormat().channels : 2;
+    const int32_t channels = format_.channels > 0 ? format_.channels : 2;
     std::fill_n(output, frames * channels, 0.0f);
     return frames;
   }
 
-  const int32_t channels = decoder_->GetFormat().channels;
-  const float vol = volume_.load(std::memory_order_acquire);
-  const float pan_value = pan_.load(std::memory_order_acquire);
-  const bool use_time_stretch =
-      time_stretcher_ && time_stretcher_->IsActive() && (channels == 1 || channels == 2);
+  const int32_t channels = format_.channels;
+  const size_t frames_processed = ReadUnscaled(output, frames, channels);
+
+  // Apply volume and pan
+  const float left_gain = target_gain_left_.load(std::memory_order_acquire);
+  const float right_gain = target_gain_right_.load(std::memory_order_acquire);
+  if (channels == 2) {
+    dsp::GetMixKernels().scale_stereo(output, frames_processed, left_gain, right_gain);
+  } else if (channels == 1 && left_gain != 1.0f) {
+    // Mono, just apply volume
+    for (size_t i = 0; i < frames_processed; ++i) {
+      output[i] *= left_gain;
+    }
+  }
+
+  return frames_processed;
+}
+
+size_t Track::ReadRaw(float* output, size_t frames) {
+  if (!is_loaded_.load(std::memory_order_acquire) || muted_.load(std::memory_order_acquire)) {
+    const int32_t channels = format_.channels > 0 ? format_.channels : 2;
+    std::fill_n(output, frames * channels, 0.0f);
+    return frames;
+  }
+
+  return ReadUnscaled(output, frames, format_.channels);
+}
+
+bool Track::AcquireRaw(size_t frames, core::CircularBuffer::ReadSpan* span) {
+  if (!is_loaded_.load(std::memory_order_acquire) || muted_.load(std::memory_order_acquire)) {
+    return false;
+  }
+  // While the stretcher tail or varispeed look-ahead plays out the track is
+  // mixed via ReadRaw()
+  if (planar_ || UseOwnStretch() || UseVarispeed() || stretch_prerolled_ ||
+      stretch_drain_frames_ > 0 || varispeed_->GetLeadFrames() > 0) {
+    return false;
+  }
+
+  stretch_input_fraction_ = 0.0;
+  const size_t samples_needed = frames * static_cast<size_t>(format_.channels);
+  *span = buffer_->AcquireRead(samples_needed);
+  if (span->size() < samples_needed) {
+    NoteUnderrun("buffer", samples_needed, span->size(), frames);
+  }
+  return true;
+}
+
+void Track::ReleaseRaw(const core::CircularBuffer::ReadSpan& span) {
+  buffer_->CommitRead(span.size());
+  RequestDecodeIfLow();
+}
+
+bool Track::AcquirePlanar(size_t frames, PlanarBlock* block) {
+  if (!planar_ || !is_loaded_.load(std::memory_order_acquire) ||
+      muted_.load(std::memory_order_acquire)) {
+    return false;
+  }
+
+  *block = PlanarBlock();
+  planar_pending_frames_ = 0;
+  core::CircularBuffer::ReadSpan left;
+  core::CircularBuffer::ReadSpan right;
+
+  // A processor switching in waits until the outgoing one has played out
+  SyncVarispeed();
+  const bool stretching = UseOwnStretch() && varispeed_->GetLeadFrames() == 0;
+  SyncStretchCompensation(stretching);
+  const bool resampling = !stretching && UseVarispeed() && stretch_drain_frames_ == 0;
+
+  if (!stretching && !resampling && stretch_drain_frames_ == 0 &&
+      varispeed_->GetLeadFrames() == 0) {
+    // Hand out the ring planes in place; ReleasePlanar() consumes them
+    stretch_input_fraction_ = 0.0;
+    const size_t available = AcquirePlanarSpans(frames, &left, &right);
+    if (available < frames) {
+      NoteUnderrun("buffer", frames * 2, available * 2, frames);
+    }
+    if (available > 0) {
+      block->left[0] = left.first;
+      block->right[0] = right.first;
+      block->frames[0] = left.first_count;
+      block->left[1] = left.second;
+      block->right[1] = right.second;
+      block->frames[1] = available - left.first_count;
+    }
+    planar_pending_frames_ = available;
+    return true;
+  }
+
+  for (auto& plane : planar_output_) {
+    if (plane.size() < frames) {
+      plane.resize(frames);
+    }
+  }
+  float* outputs[2] = {planar_output_[0].data(), planar_output_[1].data()};
+
+  if (resampling) {
+    // Resample straight from the ring planes into the track's output planes
+    stretch_input_fraction_ = 0.0;
+    const size_t input_frames = varispeed_->GetInputFramesNeeded(frames);
+    const size_t available = AcquirePlanarSpans(input_frames, &left, &right);
+    if (available < input_frames) {
+      NoteUnderrun("varispeed", input_frames * 2, available * 2, frames);
+    }
+    const dsp::Varispeed::PlanarInput input =
+        MakePlanarInput<dsp::Varispeed::PlanarInput>(left, right, available);
+    varispeed_->ProcessPlanar(input, outputs, frames);
+    buffer_->CommitRead(available);
+    right_buffer_->CommitRead(available);
+
+    block->left[0] = outputs[0];
+    block->right[0] = outputs[1];
+    block->frames[0] = frames;
+    return true;
+  }
+
+  if (!stretching) {
+    // Play out the stretcher tail or varispeed look-ahead, then continue
+    // from the ring
+    stretch_input_fraction_ = 0.0;
+    size_t drained = std::min(frames, stretch_drain_frames_);
+    if (drained > 0) {
+      time_stretcher_->DrainPlanar(outputs, drained);
+      stretch_drain_frames_ -= drained;
+    }
+    float* remaining[2] = {outputs[0] + drained, outputs[1] + drained};
+    drained += varispeed_->DrainPlanar(remaining, frames - drained);
+
+    const size_t available = AcquirePlanarSpans(frames - drained, &left, &right);
+    if (available < frames - drained) {
+      NoteUnderrun("buffer", (frames - drained) * 2, available * 2, frames);
+    }
+    CopySpan(left, outputs[0] + drained);
+    CopySpan(right, outputs[1] + drained);
+    buffer_->CommitRead(available);
+    right_buffer_->CommitRead(available);
+
+    block->left[0] = outputs[0];
+    block->right[0] = outputs[1];
+    block->frames[0] = drained + available;
+    return true;
+  }
+
+  if (!stretch_prerolled_) {
+    PrerollStretchPlanar();
+  }
+
+  // Stretch straight from the ring planes into the track's output planes
+  const size_t input_frames = NextStretchInputFrames(frames);
+  const size_t available = AcquirePlanarSpans(input_frames, &left, &right);
+  if (available < input_frames) {
+    NoteUnderrun("stretch", input_frames * 2, available * 2, frames);
+  }
+
+  const TimeStretch::PlanarInput input =
+      MakePlanarInput<TimeStretch::PlanarInput>(left, right, available);
+  time_stretcher_->ProcessPlanar(input, input_frames, outputs, frames);
+  buffer_->CommitRead(available);
+  right_buffer_->CommitRead(available);
+
+  block->left[0] = outputs[0];
+  block->right[0] = outputs[1];
+  block->frames[0] = frames;
+  return true;
+}
+
+void Track::ReleasePlanar(const PlanarBlock& block) {
+  (void)block;
+  if (planar_pending_frames_ > 0) {
+    buffer_->CommitRead(planar_pending_frames_);
+    right_buffer_->CommitRead(planar_pending_frames_);
+    planar_pending_frames_ = 0;
+  }
+  RequestDecodeIfLow();
+}
+
+void Track::SyncStretchCompensation(bool stretching) {
+  // Audio thread, once per block: pick up seeks and effect on/off switches
+  if (stretch_resync_pending_.exchange(false, std::memory_order_acq_rel)) {
+    stretch_prerolled_ = false;
+    stretch_drain_frames_ = 0;
+  }
+  if (!stretching && stretch_prerolled_) {
+    // The ring leads the stretcher output; drain for that long
+    stretch_prerolled_ = false;
+    stretch_drain_frames_ = static_cast<size_t>(time_stretcher_->GetLatencyFrames());
+  }
+}
+
+void Track::PrerollStretch(int32_t channels) {
+  // Feed the stretcher its latency's worth of upcoming input so its output
+  // lines up with the timeline, like an unprocessed track
+  const size_t input_samples = time_stretcher_->GetPrerollInputFrames() * channels;
+  if (stretch_input_buffer_.size() < input_samples) {
+    stretch_input_buffer_.resize(input_samples);
+  }
+  const size_t samples_read = buffer_->Read(stretch_input_buffer_.data(), input_samples);
+  time_stretcher_->Preroll(stretch_input_buffer_.data(), samples_read / channels);
+  stretch_prerolled_ = true;
+  stretch_drain_frames_ = 0;
+}
+
+void Track::PrerollStretchPlanar() {
+  core::CircularBuffer::ReadSpan left;
+  core::CircularBuffer::ReadSpan right;
+  const size_t available =
+      AcquirePlanarSpans(time_stretcher_->GetPrerollInputFrames(), &left, &right);
+  time_stretcher_->PrerollPlanar(MakePlanarInput<TimeStretch::PlanarInput>(left, right, available), available);
+  buffer_->CommitRead(available);
+  right_buffer_->CommitRead(available);
+  stretch_prerolled_ = true;
+  stretch_drain_frames_ = 0;
+}
+
+size_t Track::DrainStretch(float* output, size_t frames, int32_t channels) {
+  if (stretch_drain_frames_ == 0 || (channels != 1 && channels != 2)) {
+    return 0;
+  }
+  const size_t drained = std::min(frames, stretch_drain_frames_);
+  time_stretcher_->Drain(output, drained);
+  stretch_drain_frames_ -= drained;
+  return drained;
+}
+
+size_t Track::AcquirePlanarSpans(size_t frames,
+                                 core::CircularBuffer::ReadSpan* left,
+                                 core::CircularBuffer::ReadSpan* right) {
+  // The decode workers publish the left plane before the right one, so the
+  // right ring bounds what both can supply.
+  const uint64_t reset_count = planar_reset_count_.load(std::memory_order_acquire);
+  *right = right_buffer_->AcquireRead(frames);
+  *left = buffer_->AcquireRead(right->size());
+  if (left->size() != right->size() ||
+      planar_reset_count_.load(std::memory_order_acquire) != reset_count) {
+    // A seek landed between the two reads; drop this block
+    *left = core::CircularBuffer::ReadSpan();
+    *right = core::CircularBuffer::ReadSpan();
+    return 0;
+  }
+  return left->size();
+}
+
+size_t Track::ReadPlanarInterleaved(float* output, size_t frames) {
+  PlanarBlock block;
+  if (!AcquirePlanar(frames, &block)) {
+    std::fill_n(output, frames * 2, 0.0f);
+    return frames;
+  }
+
+  const dsp::MixKernels& kernels = dsp::GetMixKernels();
+  size_t frames_read = 0;
+  for (int i = 0; i < 2; ++i) {
+    if (block.frames[i] > 0) {
+      kernels.interleave_stereo(output + frames_read * 2, block.left[i], block.right[i],
+                                block.frames[i]);
+      frames_read += block.frames[i];
+    }
+  }
+  if (frames_read < frames) {
+    std::fill_n(output + frames_read * 2, (frames - frames_read) * 2, 0.0f);
+  }
+  ReleasePlanar(block);
+  return frames_read;
+}
+
+size_t Track::BufferedSamples() const {
+  if (planar_) {
+    return std::min(buffer_->Available(), right_buffer_->Available()) * 2;
+  }
+  return buffer_->Available();
+}
+
+size_t Track::FreeSamples() const {
+  if (planar_) {
+    return std::min(buffer_->FreeSpace(), right_buffer_->FreeSpace()) * 2;
+  }
+  return buffer_->FreeSpace();
+}
+
+size_t Track::CapacitySamples() const {
+  return planar_ ? buffer_->Capacity() * 2 : buffer_->Capacity();
+}
+
+size_t Track::ReadVarispeed(float* output, size_t frames, int32_t channels) {
+  const size_t input_frames = varispeed_->GetInputFramesNeeded(frames);
+  const size_t input_samples = input_frames * static_cast<size_t>(channels);
+  if (stretch_input_buffer_.size() < input_samples) {
+    stretch_input_buffer_.resize(input_samples);
+  }
+  const size_t samples_read = buffer_->Read(stretch_input_buffer_.data(), input_samples);
+  if (samples_read < input_samples) {
+    NoteUnderrun("varispeed", input_samples, samples_read, frames);
+  }
+  varispeed_->Process(stretch_input_buffer_.data(), samples_read / channels, output, frames);
+  return frames;
+}
+
+void Track::SyncVarispeed() {
+  // Audio thread, once per block: pick up seeks and the current settings
+  if (varispeed_reset_pending_.exchange(false, std::memory_order_acq_rel)) {
+    varispeed_->Reset();
+  }
+  varispeed_->SetRate(time_stretcher_->GetStretchFactor());
+  varispeed_->SetQuality(varispeed_quality_.load(std::memory_order_relaxed));
+}
+
+size_t Track::NextStretchInputFrames(size_t output_frames) {
+  const float stretch = time_stretcher_->GetStretchFactor();
+  const double requested_input =
+      static_cast<double>(output_frames) * stretch + stretch_input_fraction_;
+  size_t input_frames = static_cast<size_t>(requested_input);
+  stretch_input_fraction_ = requested_input - static_cast<double>(input_frames);
+  return std::max<size_t>(input_frames, 1);
+}
+
+void Track::NoteUnderrun(const char* kind, size_t needed, size_t read, size_t frames) {
+  if (!source_exhausted_.load(std::memory_order_acquire)) {
+    starvation_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (++underrun_log_counter_ % 50 == 0) {
+    LOGW("Track %s %s underrun: need=%zu read=%zu avail=%zu frames=%zu",
+         id_.c_str(),
+         kind,
+         needed,
+         read,
+         BufferedSamples(),
+         frames);
+  }
+}
+
+void Track::RequestDecodeIfLow() {
+  // Ask the decode pool for more data once the buffer drains. Stretching
+  // ahead keeps only a short lead, so top it up as soon as it drops.
+  const size_t watermark = StretchesAhead() ? ahead_limit_samples_ : low_watermark_samples_;
+  if (BufferedSamples() < watermark &&
+      !source_exhausted_.load(std::memory_order_acquire)) {
+    scheduler_->RequestDecode();
+  }
+}
+
+Track::GainRamp Track::AdvanceGainRamp(float target_left, float target_right) {
+  if (!gain_ramp_primed_) {
+    // Start at the target so a freshly added track does not fade in.
+    applied_gain_left_ = target_left;
+    applied_gain_right_ = target_right;
+    gain_ramp_primed_ = true;
+  }
+
+  GainRamp ramp;
+  ramp.start_left = applied_gain_left_;
+  ramp.start_right = applied_gain_right_;
+  ramp.end_left = target_left;
+  ramp.end_right = target_right;
+  applied_gain_left_ = target_left;
+  applied_gain_right_ = target_right;
+  return ramp;
+}
+
+void Track::GetTargetGains(float* left, float* right) const {
+  *left = target_gain_left_.load(std::memory_order_acquire);
+  *right = target_gain_right_.load(std::memory_order_acquire);
+}
+
+void Track::SetParamsListener(ParamsListener* listener) {
+  params_listener_.store(listener, std::memory_order_release);
+}
+
+void Track::ClearParamsListener(ParamsListener* listener) {
+  params_listener_.compare_exchange_strong(listener, nullptr, std::memory_order_acq_rel);
+}
+
+void Track::NotifyParamsChanged() {
+  ParamsListener* const listener = params_listener_.load(std::memory_order_acquire);
+  if (listener) {
+    listener->OnTrackParamsChanged(this);
+  }
+}
+
+size_t Track::ReadUnscaled(float* output, size_t frames, int32_t channels) {
+  if (planar_) {
+    return ReadPlanarInterleaved(output, frames);
+  }
+
+  // A processor switching in waits until the outgoing one has played out
+  SyncVarispeed();
+  const bool use_time_stretch = UseOwnStretch() && (channels == 1 || channels == 2) &&
+                                varispeed_->GetLeadFrames() == 0;
+  SyncStretchCompensation(use_time_stretch);
+  const bool use_varispeed = !use_time_stretch && UseVarispeed() && stretch_drain_frames_ == 0;
   size_t frames_processed = frames;
 
-  // Phase 2: Apply time-stretch/pitch-shift effects BEFORE volume/pan
+  // Phase 2: Apply time-stretch/pitch-shift effects (volume/pan are applied by the caller)
   if (use_time_stretch) {
+    if (!stretch_prerolled_) {
+      PrerollStretch(channels);
+    }
     const float stretch = time_stretcher_->GetStretchFactor();
     const float pitch = time_stretcher_->GetPitchSemitones();
-    const double requested_input = static_cast<double>(frames) * stretch + stretch_input_fraction_;
-    size_t input_frames = static_cast<size_t>(requested_input);
-    stretch_input_fraction_ = requested_input - static_cast<double>(input_frames);
-    if (input_frames < 1) {
-      input_frames = 1;
-    }
+    const size_t input_frames = NextStretchInputFrames(frames);
 
     const size_t input_samples = input_frames * channels;
     if (stretch_input_buffer_.size() < input_samples) {
@@ -127,6 +633,9 @@ size_t Track::ReadSamples(float* output, size_t frames) {
       std::fill_n(stretch_input_buffer_.data() + samples_read,
                   input_samples - samples_read,
                   0.0f);
+      if (!source_exhausted_.load(std::memory_order_acquire)) {
+        starvation_count_.fetch_add(1, std::memory_order_relaxed);
+      }
       if (++underrun_log_counter_ % 50 == 0) {
         LOGW("Track %s stretch underrun: need=%zu read=%zu avail=%zu out_frames=%zu in_frames=%zu stretch=%.3f pitch=%.2f",
              id_.c_str(),
@@ -152,55 +661,54 @@ size_t Track::ReadSamples(float* output, size_t frames) {
            available_samples,
            samples_read);
     }
+  } else if (use_varispeed) {
+    stretch_input_fraction_ = 0.0;
+    frames_processed = ReadVarispeed(output, frames, channels);
   } else {
     stretch_input_fraction_ = 0.0;
-    const size_t samples_needed = frames * channels;
-    const size_t available_samples = buffer_->Available();
-    const size_t samples_read = buffer_->Read(output, samples_needed);
+    size_t drained = DrainStretch(output, frames, channels);
+    drained += varispeed_->Drain(output + drained * channels, frames - drained);
+    float* const destination = output + drained * channels;
+    const size_t samples_needed = (frames - drained) * channels;
+    const size_t samples_read = buffer_->Read(destination, samples_needed);
     if (samples_read < samples_needed) {
-      std::fill_n(output + samples_read, samples_needed - samples_read, 0.0f);
-      if (++underrun_log_counter_ % 50 == 0) {
-        LOGW("Track %s buffer underrun: need=%zu read=%zu avail=%zu frames=%zu",
-             id_.c_str(),
-             samples_needed,
-             samples_read,
-             available_samples,
-             frames);
-      }
+      std::fill_n(destination + samples_read, samples_needed - samples_read, 0.0f);
+      NoteUnderrun("buffer", samples_needed, samples_read, frames);
     }
-    frames_processed = samples_read / channels;
+    frames_processed = drained + samples_read / channels;
   }
 
-  // Apply volume and pan (for stereo)
-  if (channels == 2) {
-    // Calculate pan gains (equal power panning)
-    const float left_gain = vol * std::cos((pan_value + 1.0f) * 0.25f * M_PI);
-    const float right_gain = vol * std::sin((pan_value + 1.0f) * 0.25f * M_PI);
-
-    for (size_t i = 0; i < frames_processed * 2; i += 2) {
-      output[i] *= left_gain;       // Left channel
-      output[i + 1] *= right_gain;  // Right channel
-    }
-  } else if (channels == 1 && vol != 1.0f) {
-    // Mono, just apply volume
-    for (size_t i = 0; i < frames_processed; ++i) {
-      output[i] *= vol;
-    }
-  }
-
-  // Notify streaming thread that buffer has space
-  streaming_cv_.notify_one();
-
+  RequestDecodeIfLow();
   return frames_processed;
 }
 
 bool Track::Seek(int64_t frame) {
-  if (!is_loaded_.load(std::memory_order_acquire) || !decoder_) {
+  if (!is_loaded_.load(std::memory_order_acquire)) {
     return false;
   }
+  if (parked_.load(std::memory_order_acquire)) {
+    // Unpark() seeks to wherever the timeline is by then
+    return true;
+  }
 
   std::lock_guard<std::mutex> lock(decoder_mutex_);
+  if (!decoder_) {
+    return false;
+  }
+  return SeekLocked(frame);
+}
+
+bool Track::SeekLocked(int64_t frame) {
+  // Called with decoder_mutex_ held
+  SwapToCachedDecoder();
+  ahead_source_frame_ = std::max<int64_t>(frame, 0);
+  resume_frame_.store(ahead_source_frame_, std::memory_order_relaxed);
   const int64_t total_frames = decoder_->GetFormat().total_frames;
+  if (resampler_) {
+    // Output-rate position to source-rate position
+    frame = static_cast<int64_t>(std::llround(static_cast<double>(frame) / resampler_->GetRatio()));
+    resampler_->Reset();
+  }
   int64_t clamped_frame = frame;
   if (total_frames > 0) {
     clamped_frame = std::clamp(frame, int64_t{0}, total_frames);
@@ -208,33 +716,144 @@ bool Track::Seek(int64_t frame) {
     clamped_frame = 0;
   }
 
+  planar_reset_count_.fetch_add(1, std::memory_order_acq_rel);
   buffer_->Reset();
+  if (right_buffer_) {
+    right_buffer_->Reset();
+  }
 
   // Phase 2: Reset time-stretcher after seek to avoid artifacts
   if (time_stretcher_) {
     time_stretcher_->Reset();
   }
-  stretch_input_fraction_ = 0.0;
+  // Stretch-ahead flushes run on a decode worker while the audio thread
+  // reads; it owns the fraction then (and never stretches, so it stays 0).
+  if (!stretch_ahead_) {
+    stretch_input_fraction_ = 0.0;
+    stretch_resync_pending_.store(true, std::memory_order_release);
+  }
+  varispeed_reset_pending_.store(true, std::memory_order_release);
+  rendered_active_.store(StretchesAhead(), std::memory_order_relaxed);
+  if (time_stretcher_) {
+    rendered_pitch_.store(time_stretcher_->GetPitchSemitones(), std::memory_order_relaxed);
+    rendered_stretch_.store(time_stretcher_->GetStretchFactor(), std::memory_order_relaxed);
+  }
+  ahead_output_fraction_ = 0.0;
+  ahead_tail_rendered_ = false;
+  ahead_preroll_frames_ = rendered_active_.load(std::memory_order_relaxed)
+                              ? time_stretcher_->GetPrerollInputFrames()
+                              : 0;
 
   const bool result = decoder_->Seek(clamped_frame);
-  streaming_cv_.notify_all();
+  source_exhausted_.store(false, std::memory_order_release);
+  scheduler_->RequestDecode();
   return result;
 }
 
 int64_t Track::GetDuration() const {
-  return is_loaded_ ? decoder_->GetFormat().total_frames : 0;
+  if (!is_loaded_) {
+    return 0;
+  }
+  const int64_t total_frames = format_.total_frames;
+  if (!resampler_) {
+    return total_frames;
+  }
+  return static_cast<int64_t>(std::llround(static_cast<double>(total_frames) * resampler_->GetRatio()));
 }
 
 int32_t Track::GetSampleRate() const {
-  return is_loaded_ ? decoder_->GetFormat().sample_rate : 0;
+  return is_loaded_ ? format_.sample_rate : 0;
+}
+
+void Track::SetPcmCache(std::shared_ptr<audio::PcmCache> cache) {
+  if (is_loaded_.load(std::memory_order_acquire)) {
+    LOGW("Track %s: PCM cache must be set before Load()", id_.c_str());
+    return;
+  }
+  pcm_cache_ = std::move(cache);
+}
+
+bool Track::IsCacheBacked() const {
+  std::lock_guard<std::mutex> lock(decoder_mutex_);
+  return cache_backed_;
+}
+
+void Track::SwapToCachedDecoder() {
+  // Called with decoder_mutex_ held. Once the background decode has finished,
+  // seeks on compressed tracks switch to the memory-mapped copy.
+  if (cache_backed_ || !pcm_cache_ || !audio::PcmCache::IsCacheable(file_path_)) {
+    return;
+  }
+  auto cached = pcm_cache_->OpenCached(file_path_);
+  if (!cached) {
+    return;
+  }
+  const audio::AudioFormat& cached_format = cached->GetFormat();
+  if (cached_format.sample_rate != format_.sample_rate ||
+      cached_format.channels != format_.channels) {
+    LOGW("Track %s: cached PCM format mismatch, keeping source decoder", id_.c_str());
+    return;
+  }
+  decoder_->Close();
+  decoder_ = std::move(cached);
+  cache_backed_ = true;
+  LOGD("Track %s: switched to cached PCM", id_.c_str());
+}
+
+void Track::SetPlanar(bool planar) {
+  if (is_loaded_.load(std::memory_order_acquire)) {
+    LOGW("Track %s: planar mode must be set before Load()", id_.c_str());
+    return;
+  }
+  planar_requested_ = planar;
+}
+
+void Track::SetStretchAhead(bool enabled, size_t max_ahead_frames) {
+  if (is_loaded_.load(std::memory_order_acquire)) {
+    LOGW("Track %s: stretch-ahead mode must be set before Load()", id_.c_str());
+    return;
+  }
+  stretch_ahead_requested_ = enabled;
+  stretch_ahead_frames_requested_ = max_ahead_frames;
+}
+
+int64_t Track::GetEffectLatencyFrames() const {
+  if (!is_loaded_.load(std::memory_order_acquire) || !StretchesAhead()) {
+    return 0;
+  }
+  return static_cast<int64_t>(BufferedSamples() / static_cast<size_t>(format_.channels));
+}
+
+int64_t Track::GetProcessingLatencyFrames() const {
+  if (!is_loaded_.load(std::memory_order_acquire) || !(UseOwnStretch() || StretchesAhead())) {
+    return 0;
+  }
+  return time_stretcher_->GetLatencyFrames();
+}
+
+uint64_t Track::GetStretchFlushCount() const {
+  return stretch_flush_count_.load(std::memory_order_relaxed);
+}
+
+void Track::SetOutputSampleRate(int32_t sample_rate) {
+  if (is_loaded_.load(std::memory_order_acquire)) {
+    LOGW("Track %s: output sample rate must be set before Load()", id_.c_str());
+    return;
+  }
+  output_sample_rate_ = std::max(0, sample_rate);
+}
+
+int32_t Track::GetOutputSampleRate() const {
+  return is_loaded_ ? output_sample_rate_ : 0;
 }
 
 int32_t Track::GetChannels() const {
-  return is_loaded_ ? decoder_->GetFormat().channels : 0;
+  return is_loaded_ ? format_.channels : 0;
 }
 
 void Track::SetStartTimeSamples(int64_t start_time_samples) {
   start_time_samples_.store(std::max<int64_t>(0, start_time_samples), std::memory_order_release);
+  NotifyParamsChanged();
 }
 
 int64_t Track::GetStartTimeSamples() const {
@@ -243,6 +862,7 @@ int64_t Track::GetStartTimeSamples() const {
 
 void Track::SetVolume(float volume) {
   volume_.store(std::clamp(volume, 0.0f, 2.0f), std::memory_order_release);
+  UpdateTargetGains();
 }
 
 float Track::GetVolume() const {
@@ -251,6 +871,7 @@ float Track::GetVolume() const {
 
 void Track::SetMuted(bool muted) {
   muted_.store(muted, std::memory_order_release);
+  NotifyParamsChanged();
 }
 
 bool Track::IsMuted() const {
@@ -259,6 +880,7 @@ bool Track::IsMuted() const {
 
 void Track::SetSolo(bool solo) {
   solo_.store(solo, std::memory_order_release);
+  NotifyParamsChanged();
 }
 
 bool Track::IsSolo() const {
@@ -267,6 +889,22 @@ bool Track::IsSolo() const {
 
 void Track::SetPan(float pan) {
   pan_.store(std::clamp(pan, -1.0f, 1.0f), std::memory_order_release);
+  UpdateTargetGains();
+}
+
+void Track::UpdateTargetGains() {
+  const float vol = volume_.load(std::memory_order_acquire);
+  float left_gain = vol;
+  float right_gain = vol;
+  if (GetChannels() == 2) {
+    // Equal power panning
+    const float pan_value = pan_.load(std::memory_order_acquire);
+    left_gain = vol * std::cos((pan_value + 1.0f) * 0.25f * M_PI);
+    right_gain = vol * std::sin((pan_value + 1.0f) * 0.25f * M_PI);
+  }
+  target_gain_left_.store(left_gain, std::memory_order_release);
+  target_gain_right_.store(right_gain, std::memory_order_release);
+  NotifyParamsChanged();
 }
 
 float Track::GetPan() const {
@@ -277,6 +915,7 @@ float Track::GetPan() const {
 void Track::SetPitchSemitones(float semitones) {
   if (time_stretcher_) {
     time_stretcher_->SetPitchSemitones(semitones);
+    WakeStretchAhead();
   }
 }
 
@@ -287,6 +926,7 @@ float Track::GetPitchSemitones() const {
 void Track::SetStretchFactor(float factor) {
   if (time_stretcher_) {
     time_stretcher_->SetStretchFactor(factor);
+    WakeStretchAhead();
   }
 }
 
@@ -294,52 +934,437 @@ float Track::GetStretchFactor() const {
   return time_stretcher_ ? time_stretcher_->GetStretchFactor() : 1.0f;
 }
 
-void Track::StreamingThreadFunc() {
-  // Buffer for reading from decoder (e.g., 4096 frames)
-  const size_t chunk_frames = 4096;
-  const int32_t channels = decoder_->GetFormat().channels;
-  std::vector<float> temp_buffer(chunk_frames * channels);
+void Track::SetStretchOnMasterBus(bool on_master_bus) {
+  stretch_on_master_bus_.store(on_master_bus, std::memory_order_release);
+  NotifyParamsChanged();
+  WakeStretchAhead();
+}
+
+bool Track::IsStretchOnMasterBus() const {
+  return stretch_on_master_bus_.load(std::memory_order_acquire);
+}
+
+void Track::SetStretchQuality(TimeStretch::Quality quality, size_t crossfade_frames) {
+  stretch_quality_.store(quality, std::memory_order_relaxed);
+  stretch_crossfade_frames_.store(crossfade_frames, std::memory_order_relaxed);
+  if (time_stretcher_) {
+    time_stretcher_->SetQuality(quality, crossfade_frames);
+  }
+}
+
+TimeStretch::Quality Track::GetStretchQuality() const {
+  return stretch_quality_.load(std::memory_order_relaxed);
+}
+
+void Track::SetVarispeed(bool enabled) {
+  varispeed_enabled_.store(enabled, std::memory_order_release);
+  WakeStretchAhead();
+}
+
+bool Track::IsVarispeed() const {
+  return varispeed_enabled_.load(std::memory_order_acquire);
+}
+
+void Track::SetVarispeedQuality(dsp::Varispeed::Quality quality) {
+  varispeed_quality_.store(quality, std::memory_order_relaxed);
+}
+
+dsp::Varispeed::Quality Track::GetVarispeedQuality() const {
+  return varispeed_quality_.load(std::memory_order_relaxed);
+}
+
+bool Track::UseOwnStretch() const {
+  return time_stretcher_ && !stretch_ahead_ && time_stretcher_->IsActive() &&
+         !varispeed_enabled_.load(std::memory_order_acquire) &&
+         !stretch_on_master_bus_.load(std::memory_order_acquire);
+}
+
+bool Track::UseVarispeed() const {
+  // Varispeed ignores pitch, so only a speed change needs it
+  return varispeed_ && varispeed_enabled_.load(std::memory_order_acquire) &&
+         time_stretcher_->GetStretchFactor() != 1.0f &&
+         !stretch_on_master_bus_.load(std::memory_order_acquire);
+}
+
+bool Track::StretchesAhead() const {
+  return stretch_ahead_ && time_stretcher_ && time_stretcher_->IsActive() &&
+         !varispeed_enabled_.load(std::memory_order_acquire) &&
+         !stretch_on_master_bus_.load(std::memory_order_acquire);
+}
 
-  LOGD("Streaming thread started for track: %s", id_.c_str());
+bool Track::StretchAheadStale() const {
+  // Whether the settings moved far enough from what is buffered to flush it
+  const bool active = StretchesAhead();
+  if (active != rendered_active_.load(std::memory_order_relaxed)) {
+    return true;
+  }
+  if (!active) {
+    return false;
+  }
+  const float pitch = time_stretcher_->GetPitchSemitones();
+  const float stretch = time_stretcher_->GetStretchFactor();
+  const float rendered_stretch = rendered_stretch_.load(std::memory_order_relaxed);
+  return std::fabs(pitch - rendered_pitch_.load(std::memory_order_relaxed)) >=
+             kFlushPitchSemitones ||
+         std::fabs(stretch / rendered_stretch - 1.0f) >= kFlushStretchRatio;
+}
 
-  while (streaming_active_.load(std::memory_order_acquire)) {
-    // Check if buffer needs filling (has space for at least one chunk)
-    const size_t free_space = buffer_->FreeSpace();
-    const size_t samples_per_chunk = chunk_frames * channels;
+void Track::WakeStretchAhead() {
+  // Settings changed; let a decode worker flush the ring if it has to
+  if (stretch_ahead_ && is_loaded_.load(std::memory_order_acquire)) {
+    scheduler_->RequestDecode();
+  }
+}
+
+bool Track::UpdateStretchAhead() {
+  // Called with decoder_mutex_ held, before each chunk. Small changes simply
+  // apply to the next chunk; large ones discard what was rendered with the
+  // old settings and restart from the audible position.
+  const bool active = StretchesAhead();
+  const float pitch = time_stretcher_->GetPitchSemitones();
+  const float stretch = time_stretcher_->GetStretchFactor();
+  if (!StretchAheadStale()) {
+    rendered_active_.store(active, std::memory_order_relaxed);
+    rendered_pitch_.store(pitch, std::memory_order_relaxed);
+    rendered_stretch_.store(stretch, std::memory_order_relaxed);
+    return active;
+  }
+
+  // Each buffered frame stands for rendered_stretch_ source frames; the
+  // stretcher was pre-rolled, so its latency does not add to the lead.
+  const size_t channels = static_cast<size_t>(format_.channels);
+  double pending = static_cast<double>(BufferedSamples() / channels);
+  if (rendered_active_.load(std::memory_order_relaxed)) {
+    pending *= rendered_stretch_.load(std::memory_order_relaxed);
+  }
+  const int64_t playhead = ahead_source_frame_ - static_cast<int64_t>(std::llround(pending));
+  SeekLocked(std::max<int64_t>(playhead, 0));
+  stretch_flush_count_.fetch_add(1, std::memory_order_relaxed);
+  LOGD("Track %s: stretch changed (pitch %.2f, speed %.3f), re-rendering from frame %lld",
+       id_.c_str(), pitch, stretch, static_cast<long long>(playhead));
+  return rendered_active_.load(std::memory_order_relaxed);
+}
+
+size_t Track::RenderStretchAhead(const float* input, size_t frames) {
+  // Called with decoder_mutex_ held; renders into stretch_output_buffer_.
+  // The first input after a seek pre-rolls the stretcher's latency.
+  if (ahead_preroll_frames_ > 0) {
+    const size_t preroll = std::min(frames, ahead_preroll_frames_);
+    time_stretcher_->Preroll(input, preroll);
+    ahead_preroll_frames_ -= preroll;
+    input += preroll * static_cast<size_t>(format_.channels);
+    frames -= preroll;
+  }
+  const double requested =
+      static_cast<double>(frames) / rendered_stretch_.load(std::memory_order_relaxed) +
+      ahead_output_fraction_;
+  const size_t output_frames = static_cast<size_t>(requested);
+  ahead_output_fraction_ = requested - static_cast<double>(output_frames);
+  if (output_frames == 0) {
+    return 0;
+  }
+  const size_t output_samples = output_frames * static_cast<size_t>(format_.channels);
+  if (stretch_output_buffer_.size() < output_samples) {
+    stretch_output_buffer_.resize(output_samples);
+  }
+  time_stretcher_->Process(input, frames, stretch_output_buffer_.data(), output_frames);
+  return output_frames;
+}
 
-    if (free_space >= samples_per_chunk) {
-      // Read from decoder
-      size_t frames_read = 0;
-      {
-        std::lock_guard<std::mutex> lock(decoder_mutex_);
-        if (decoder_) {
-          frames_read = decoder_->Read(temp_buffer.data(), chunk_frames);
-        }
+void Track::Park() {
+  parked_.store(true, std::memory_order_release);
+  LOGD("Track %s parked", id_.c_str());
+}
+
+void Track::Unpark(int64_t frame) {
+  resume_frame_.store(std::max<int64_t>(frame, 0), std::memory_order_relaxed);
+  resume_state_.store(ResumeState::kSeekPending, std::memory_order_release);
+  parked_.store(false, std::memory_order_release);
+  if (scheduler_) {
+    scheduler_->RequestDecode();
+  }
+  LOGD("Track %s resuming at frame %lld", id_.c_str(), static_cast<long long>(frame));
+}
+
+bool Track::IsParked() const {
+  return parked_.load(std::memory_order_acquire);
+}
+
+bool Track::IsResuming() const {
+  return resume_state_.load(std::memory_order_acquire) != ResumeState::kNone;
+}
+
+size_t Track::SyncResume(int64_t track_frame, size_t frames) {
+  if (resume_state_.load(std::memory_order_acquire) != ResumeState::kFilling) {
+    return frames;
+  }
+
+  const size_t channels = static_cast<size_t>(format_.channels);
+  const int64_t reach = static_cast<int64_t>(CapacitySamples() / channels / 2);
+  int64_t head = resume_frame_.load(std::memory_order_relaxed);
+  if (track_frame - head > reach || head - track_frame > reach) {
+    resume_frame_.store(std::max<int64_t>(track_frame, 0), std::memory_order_relaxed);
+    resume_state_.store(ResumeState::kSeekPending, std::memory_order_release);
+    scheduler_->RequestDecode();
+    return frames;
+  }
+
+  if (track_frame > head) {
+    // The seek finished behind the playhead; drop what is already late
+    const size_t late = static_cast<size_t>(track_frame - head);
+    const size_t dropped = DropFrames(late);
+    head += static_cast<int64_t>(dropped);
+    resume_frame_.store(head, std::memory_order_relaxed);
+    if (dropped < late) {
+      if (source_exhausted_.load(std::memory_order_acquire) && BufferedSamples() == 0) {
+        // Resumed past the end of the file: nothing left to line up
+        resume_state_.store(ResumeState::kNone, std::memory_order_release);
       }
+      return frames;
+    }
+  }
+
+  const size_t hold = static_cast<size_t>(head - track_frame);
+  if (hold >= frames || !IsPrimed(frames - hold)) {
+    return frames;
+  }
+
+  // Fade in across the first block
+  applied_gain_left_ = 0.0f;
+  applied_gain_right_ = 0.0f;
+  gain_ramp_primed_ = true;
+  resume_state_.store(ResumeState::kNone, std::memory_order_release);
+  return hold;
+}
+
+size_t Track::DropFrames(size_t frames) {
+  if (planar_) {
+    core::CircularBuffer::ReadSpan left;
+    core::CircularBuffer::ReadSpan right;
+    const size_t available = AcquirePlanarSpans(frames, &left, &right);
+    buffer_->CommitRead(available);
+    right_buffer_->CommitRead(available);
+    RequestDecodeIfLow();
+    return available;
+  }
+  const size_t channels = static_cast<size_t>(format_.channels);
+  const core::CircularBuffer::ReadSpan span = buffer_->AcquireRead(frames * channels);
+  buffer_->CommitRead(span.size());
+  RequestDecodeIfLow();
+  return span.size() / channels;
+}
+
+bool Track::IsPrimed(size_t frames) const {
+  if (!is_loaded_.load(std::memory_order_acquire) || !buffer_) {
+    return true;
+  }
+  const ResumeState resume = resume_state_.load(std::memory_order_acquire);
+  if (resume == ResumeState::kSeekPending || resume == ResumeState::kSeeking) {
+    return false;
+  }
+  if (source_exhausted_.load(std::memory_order_acquire)) {
+    return true;
+  }
+  // The decode pool stops writing once less than a chunk of space is left,
+  // or once the stretch-ahead limit is buffered
+  const size_t capacity = CapacitySamples();
+  size_t fillable = capacity - std::min(capacity, decode_chunk_samples_);
+  if (StretchesAhead()) {
+    fillable = std::min(fillable, ahead_limit_samples_);
+  }
+  // Stretching on the audio thread first pre-rolls the stretcher's latency
+  // (stretching ahead pre-rolls on the decode side instead)
+  if (!stretch_ahead_ && time_stretcher_->IsActive() &&
+      !varispeed_enabled_.load(std::memory_order_acquire)) {
+    frames += time_stretcher_->GetPrerollInputFrames();
+  }
+  const size_t needed = std::min(frames * static_cast<size_t>(format_.channels), fillable);
+  return BufferedSamples() >= needed;
+}
+
+uint64_t Track::GetStarvationCount() const {
+  return starvation_count_.load(std::memory_order_relaxed);
+}
+
+void Track::ResetStarvationCount() {
+  starvation_count_.store(0, std::memory_order_relaxed);
+}
+
+float Track::GetFillRatio() const {
+  if (!buffer_) {
+    return 1.0f;
+  }
+  return static_cast<float>(BufferedSamples()) / static_cast<float>(CapacitySamples());
+}
+
+bool Track::NeedsDecode() const {
+  if (!buffer_ || parked_.load(std::memory_order_acquire)) {
+    return false;
+  }
+  if (resume_state_.load(std::memory_order_acquire) == ResumeState::kSeekPending) {
+    return true;
+  }
+  // A flush re-renders from the playhead, even after end of file
+  if (stretch_ahead_ && StretchAheadStale()) {
+    return true;
+  }
+  if (source_exhausted_.load(std::memory_order_acquire)) {
+    return false;
+  }
+  if (StretchesAhead() && BufferedSamples() >= ahead_limit_samples_) {
+    return false;
+  }
+  return FreeSamples() >= decode_chunk_samples_;
+}
+
+void Track::DecodeChunk() {
+  const int32_t channels = format_.channels;
 
-      if (frames_read > 0) {
-        // Write to circular buffer
-        const size_t samples_to_write = frames_read * channels;
-        const size_t samples_written = buffer_->Write(temp_buffer.data(), samples_to_write);
+  // Hold the decoder lock across the write so a concurrent Seek() cannot
+  // interleave stale samples after its buffer reset.
+  std::lock_guard<std::mutex> lock(decoder_mutex_);
+  if (!decoder_) {
+    return;
+  }
 
-        if (samples_written < samples_to_write) {
-          LOGD("Warning: Buffer full, dropped %zu samples",
-               samples_to_write - samples_written);
-        }
+  // Leaving the parked state seeks here rather than on the control thread.
+  // An Unpark() during the seek sets kSeekPending again, so it is repeated.
+  ResumeState pending = ResumeState::kSeekPending;
+  if (resume_state_.compare_exchange_strong(pending, ResumeState::kSeeking,
+                                            std::memory_order_acq_rel)) {
+    SeekLocked(resume_frame_.load(std::memory_order_relaxed));
+    ResumeState seeking = ResumeState::kSeeking;
+    resume_state_.compare_exchange_strong(seeking, ResumeState::kFilling,
+                                          std::memory_order_acq_rel);
+  }
+
+  const bool stretch = stretch_ahead_ && UpdateStretchAhead();
+  const size_t source_frames =
+      resampler_ ? resampler_->GetInputFramesNeeded(chunk_frames_) : chunk_frames_;
+
+  // The direct-into-ring paths skip the copy through decode_buffer_, which
+  // stretching ahead needs (and uses to track the source position).
+  if (!planar_ && !stretch_ahead_ && !decoder_->SupportsMappedReads() && !resampler_ &&
+      DecodeIntoBuffer(source_frames)) {
+    return;
+  }
+
+  // Memory-mapped float WAVs are borrowed straight from the mapping so the
+  // samples are copied only once, into the ring buffer.
+  size_t frames_read = 0;
+  const float* source = decode_buffer_.data();
+  if (decoder_->SupportsMappedReads()) {
+    frames_read = decoder_->ReadMapped(&source, source_frames);
+  } else {
+    frames_read = decoder_->Read(decode_buffer_.data(), source_frames);
+  }
+
+  if (frames_read == 0) {
+    // End of file or error; seeking clears this. When stretching ahead, flush
+    // the stretcher's tail with silence first so the last notes still play.
+    if (stretch && !ahead_tail_rendered_) {
+      ahead_tail_rendered_ = true;
+      const size_t tail_frames = std::min(
+          static_cast<size_t>(std::ceil(time_stretcher_->GetLatencyFrames() *
+                                        rendered_stretch_.load(std::memory_order_relaxed))),
+          decode_buffer_.size() / channels);
+      std::fill_n(decode_buffer_.data(), tail_frames * channels, 0.0f);
+      const size_t output_frames = RenderStretchAhead(decode_buffer_.data(), tail_frames);
+      if (planar_) {
+        WritePlanar(stretch_output_buffer_.data(), output_frames);
       } else {
-        // End of file or error
-        // For now, just wait - seeking will reset position
-        std::unique_lock<std::mutex> lock(streaming_mutex_);
-        streaming_cv_.wait_for(lock, std::chrono::milliseconds(100));
+        buffer_->Write(stretch_output_buffer_.data(), output_frames * channels);
       }
-    } else {
-      // Buffer is full enough, wait for consumption
-      std::unique_lock<std::mutex> lock(streaming_mutex_);
-      streaming_cv_.wait_for(lock, std::chrono::milliseconds(10));
     }
+    source_exhausted_.store(true, std::memory_order_release);
+    return;
+  }
+
+  if (resampler_) {
+    // A short read means end of file; only emit output covered by real input
+    size_t output_frames = chunk_frames_;
+    if (frames_read < source_frames) {
+      output_frames = std::min(output_frames, static_cast<size_t>(std::ceil(
+          static_cast<double>(frames_read) * resampler_->GetRatio())));
+    }
+
+    // Resample straight into the ring when the free space does not wrap
+    const size_t output_samples = output_frames * channels;
+    if (!planar_ && !stretch_ahead_) {
+      const auto span = buffer_->AcquireWrite(output_samples);
+      if (span.first_count == output_samples) {
+        resampler_->Process(source, frames_read, span.first, output_frames);
+        buffer_->CommitWrite(output_samples);
+        return;
+      }
+    }
+    resampler_->Process(source, frames_read, resample_buffer_.data(), output_frames);
+    source = resample_buffer_.data();
+    frames_read = output_frames;
+  }
+
+  ahead_source_frame_ += static_cast<int64_t>(frames_read);
+  if (stretch) {
+    frames_read = RenderStretchAhead(source, frames_read);
+    source = stretch_output_buffer_.data();
+  }
+
+  if (planar_) {
+    WritePlanar(source, frames_read);
+    return;
+  }
+
+  const size_t samples_to_write = frames_read * channels;
+  const size_t samples_written = buffer_->Write(source, samples_to_write);
+  if (samples_written < samples_to_write) {
+    LOGD("Warning: Buffer full, dropped %zu samples", samples_to_write - samples_written);
   }
+}
+
+void Track::WritePlanar(const float* interleaved, size_t frames) {
+  // Called with decoder_mutex_ held. Both rings share a write position, so
+  // their free space wraps at the same frame.
+  const auto left = buffer_->AcquireWrite(frames);
+  const auto right = right_buffer_->AcquireWrite(frames);
+  const size_t frames_to_write = std::min(left.size(), right.size());
+  const size_t first_frames = std::min(frames_to_write, left.first_count);
 
-  LOGD("Streaming thread stopped for track: %s", id_.c_str());
+  const dsp::MixKernels& kernels = dsp::GetMixKernels();
+  kernels.deinterleave_stereo(left.first, right.first, interleaved, first_frames);
+  if (frames_to_write > first_frames) {
+    kernels.deinterleave_stereo(left.second, right.second, interleaved + first_frames * 2,
+                                frames_to_write - first_frames);
+  }
+  // Left first: readers size their reads from the right plane
+  buffer_->CommitWrite(frames_to_write);
+  right_buffer_->CommitWrite(frames_to_write);
+  if (frames_to_write < frames) {
+    LOGD("Warning: Buffer full, dropped %zu frames", frames - frames_to_write);
+  }
+}
+
+bool Track::DecodeIntoBuffer(size_t source_frames) {
+  // Decode straight into the ring buffer's free space. Called with
+  // decoder_mutex_ held; falls back to the copying path when a wrap point
+  // would split a frame.
+  const size_t channels = static_cast<size_t>(format_.channels);
+  const auto span = buffer_->AcquireWrite(source_frames * channels);
+  if (span.size() == 0 || span.first_count % channels != 0) {
+    return false;
+  }
+
+  size_t frames_read = decoder_->Read(span.first, span.first_count / channels);
+  if (frames_read == span.first_count / channels && span.second_count >= channels) {
+    frames_read += decoder_->Read(span.second, span.second_count / channels);
+  }
+
+  if (frames_read == 0) {
+    // End of file or error; seeking clears this
+    source_exhausted_.store(true, std::memory_order_release);
+    return true;
+  }
+  buffer_->CommitWrite(frames_read * channels);
+  return true;
 }
 
 }  // namespace playback
@@ -2,32 +2,118 @@
 
 #include "audio/AudioDecoder.h"
 #include "core/CircularBuffer.h"
+#include "dsp/Resampler.h"
+#include "dsp/Varispeed.h"
+#include "playback/DecodeScheduler.h"
 #include "playback/TimeStretch.h"
 
 #include <atomic>
 #include <cstdint>
 #include <memory>
 #include <string>
-#include <thread>
-#include <condition_variable>
 #include <mutex>
 #include <vector>
 
 namespace sezo {
+namespace audio {
+class PcmCache;
+}  // namespace audio
+
 namespace playback {
 
 /**
  * Represents a single audio track with its own controls and buffer.
+ * The buffer is kept filled by a DecodeScheduler shared between tracks.
  */
-class Track {
+class Track : public DecodeScheduler::Client {
  public:
   /**
    * Constructor.
    * @param id Unique track identifier
    * @param file_path Path to the audio file
+   * @param scheduler Decode scheduler (nullptr = process-wide shared pool)
+   */
+  Track(const std::string& id,
+        const std::string& file_path,
+        std::shared_ptr<DecodeScheduler> scheduler = nullptr);
+  ~Track() override;
+
+  /**
+   * Set the rate the track is played back at (normally the device rate).
+   * Files at a different rate are resampled on the decode workers, so
+   * everything downstream (buffer, time-stretch, mixer) runs at this rate.
+   * Must be called before Load(); 0 keeps the file's own rate.
+   * @param sample_rate Output sample rate in Hz
+   */
+  void SetOutputSampleRate(int32_t sample_rate);
+
+  /**
+   * Use a pre-decoded PCM cache for compressed sources.
+   * Cached files load memory-mapped; uncached ones are queued for background
+   * decoding and the track switches over at the next seek once ready.
+   * Must be called before Load().
+   * @param cache PCM cache (nullptr disables)
+   */
+  void SetPcmCache(std::shared_ptr<audio::PcmCache> cache);
+
+  /**
+   * Whether the track currently reads from the PCM cache.
+   */
+  bool IsCacheBacked() const;
+
+  /**
+   * Carry stereo audio as separate left/right planes from the ring buffer
+   * through the time-stretcher to the mixer, instead of interleaved frames.
+   * The decode workers de-interleave once and the output is interleaved
+   * once, at the final mix. Mono tracks are unaffected.
+   * Must be called before Load().
+   * @param planar true for the planar signal path
+   */
+  void SetPlanar(bool planar);
+
+  /**
+   * Whether the loaded track uses the planar signal path.
+   */
+  bool IsPlanar() const { return planar_; }
+
+  /**
+   * Run this track's time-stretch on the decode workers instead of the audio
+   * thread: decoded audio is stretched ahead of time into the ring buffer and
+   * the callback only copies and mixes it. Pitch/speed changes are heard once
+   * the audio already rendered ahead has played (see
+   * GetEffectLatencyFrames()); large changes flush the ring and re-render
+   * from the playhead instead of waiting.
+   * Must be called before Load().
+   * @param enabled true to stretch ahead
+   * @param max_ahead_frames Output frames rendered ahead at most
+   */
+  void SetStretchAhead(bool enabled, size_t max_ahead_frames);
+
+  /**
+   * Whether the loaded track stretches ahead on the decode workers.
+   */
+  bool IsStretchAhead() const { return stretch_ahead_; }
+
+  /**
+   * Delay before a pitch/speed change is heard: output frames already
+   * rendered ahead with the previous settings. 0 unless stretching ahead.
+   */
+  int64_t GetEffectLatencyFrames() const;
+
+  /**
+   * Number of times a large pitch/speed change flushed the audio rendered
+   * ahead.
    */
-  Track(const std::string& id, const std::string& file_path);
-  ~Track();
+  uint64_t GetStretchFlushCount() const;
+
+  /**
+   * Processing latency of this track's stretcher while it is in use, in
+   * output frames. Stretched tracks pre-roll this much input from the
+   * buffer, so they stay sample-aligned with unprocessed tracks; when the
+   * effect switches off the stretcher tail is played out for the same time.
+   * 0 while the track plays unprocessed or on the master bus.
+   */
+  int64_t GetProcessingLatencyFrames() const;
 
   /**
    * Load the track (open file and start buffering).
@@ -48,9 +134,115 @@ class Track {
    */
   size_t ReadSamples(float* output, size_t frames);
 
+  /**
+   * Read audio samples without applying volume or pan.
+   * The mixer uses this together with AdvanceGainRamp() so gains are applied
+   * while accumulating instead of in a separate pass.
+   * @param output Output buffer
+   * @param frames Number of frames to read
+   * @return Number of frames actually read
+   */
+  size_t ReadRaw(float* output, size_t frames);
+
+  /**
+   * Zero-copy alternative to ReadRaw(): borrow the next frames straight from
+   * the ring buffer. Only possible while time-stretch is bypassed and the
+   * track is audible; otherwise returns false and the caller uses ReadRaw().
+   * The span is short on underrun. Pass it to ReleaseRaw() once mixed.
+   * Audio thread only.
+   * @param frames Number of frames wanted
+   * @param span Receives the buffered samples
+   * @return true if span is valid
+   */
+  bool AcquireRaw(size_t frames, core::CircularBuffer::ReadSpan* span);
+
+  /**
+   * Release a span returned by AcquireRaw().
+   * @param span Span that was mixed
+   */
+  void ReleaseRaw(const core::CircularBuffer::ReadSpan& span);
+
+  /**
+   * Planar stereo block borrowed from the track. Each plane comes in up to
+   * two segments (frames[0] then frames[1]) where the ring buffer wraps.
+   */
+  struct PlanarBlock {
+    const float* left[2] = {nullptr, nullptr};
+    const float* right[2] = {nullptr, nullptr};
+    size_t frames[2] = {0, 0};
+    size_t size() const { return frames[0] + frames[1]; }
+  };
+
+  /**
+   * Planar counterpart of AcquireRaw(): borrow the next frames as left/right
+   * planes, time-stretched if needed. Only for planar tracks that are
+   * audible; otherwise returns false. The block is short on underrun.
+   * Pass it to ReleasePlanar() once mixed. Audio thread only.
+   * @param frames Number of frames wanted
+   * @param block Receives the planes
+   * @return true if block is valid
+   */
+  bool AcquirePlanar(size_t frames, PlanarBlock* block);
+
+  /**
+   * Release a block returned by AcquirePlanar().
+   * @param block Block that was mixed
+   */
+  void ReleasePlanar(const PlanarBlock& block);
+
+  /**
+   * Per-block gain ramp for the left/right output channels.
+   * Mono tracks use the same gain on both sides.
+   */
+  struct GainRamp {
+    float start_left = 1.0f;
+    float start_right = 1.0f;
+    float end_left = 1.0f;
+    float end_right = 1.0f;
+  };
+
+  /**
+   * Get the gain ramp for the next block and advance to the given target.
+   * Audio thread only: the ramp state is owned by the caller of Mix().
+   * @param target_left Left gain at the end of the block
+   * @param target_right Right gain at the end of the block
+   */
+  GainRamp AdvanceGainRamp(float target_left, float target_right);
+
+  /**
+   * Output gains derived from volume and pan (what the ramp heads towards).
+   * @param left Receives the left gain
+   * @param right Receives the right gain
+   */
+  void GetTargetGains(float* left, float* right) const;
+
+  /**
+   * Told about control changes that affect how the mixer plans a block:
+   * gains, mute/solo, start time, master-bus routing and load state.
+   * Called on the thread making the change.
+   */
+  class ParamsListener {
+   public:
+    virtual ~ParamsListener() = default;
+    virtual void OnTrackParamsChanged(Track* track) = 0;
+  };
+
+  /**
+   * Attach the listener for control changes (one per track).
+   * @param listener Listener to notify
+   */
+  void SetParamsListener(ParamsListener* listener);
+
+  /**
+   * Detach a listener set with SetParamsListener(); no-op if another one has
+   * replaced it since.
+   * @param listener Listener to detach
+   */
+  void ClearParamsListener(ParamsListener* listener);
+
   /**
    * Seek to a specific position.
-   * @param frame Frame position
+   * @param frame Frame position at the output sample rate
    * @return true if successful
    */
   bool Seek(int64_t frame);
@@ -59,8 +251,9 @@ class Track {
   const std::string& GetId() const { return id_; }
   const std::string& GetFilePath() const { return file_path_; }
   bool IsLoaded() const { return is_loaded_.load(std::memory_order_acquire); }
-  int64_t GetDuration() const;
-  int32_t GetSampleRate() const;
+  int64_t GetDuration() const;        // frames at the output sample rate
+  int32_t GetSampleRate() const;      // source file rate
+  int32_t GetOutputSampleRate() const;
   int32_t GetChannels() const;
   void SetStartTimeSamples(int64_t start_time_samples);
   int64_t GetStartTimeSamples() const;
@@ -81,21 +274,166 @@ class Track {
   void SetStretchFactor(float factor);
   float GetStretchFactor() const;
 
+  /**
+   * Leave this track's pitch/speed to the mixer's master-bus stretcher.
+   * The track then plays at unity rate and its own stretcher is bypassed;
+   * the pitch/speed values are kept (extraction still renders them).
+   * @param on_master_bus true to route through the master bus
+   */
+  void SetStretchOnMasterBus(bool on_master_bus);
+  bool IsStretchOnMasterBus() const;
+
+  /**
+   * Change speed by resampling instead of time-stretching: pitch follows
+   * speed like a tape machine, at a fraction of the stretcher's CPU, and the
+   * pitch control is ignored. Switching modes lets the outgoing processor
+   * play out its buffered audio first, so no audio is skipped or repeated.
+   * @param enabled true for varispeed
+   */
+  void SetVarispeed(bool enabled);
+  bool IsVarispeed() const;
+
+  /**
+   * Interpolation used in varispeed mode (default: windowed sinc).
+   * @param quality Quality tier
+   */
+  void SetVarispeedQuality(dsp::Varispeed::Quality quality);
+  dsp::Varispeed::Quality GetVarispeedQuality() const;
+
+  /**
+   * Time-stretch quality tier (default: kHigh). The new tier warms up next
+   * to the current one and crossfades in, without moving the playhead.
+   * Builds the tier's stretcher on first use, so call off the audio thread.
+   * @param quality Quality tier
+   * @param crossfade_frames Crossfade length in output frames
+   */
+  void SetStretchQuality(TimeStretch::Quality quality, size_t crossfade_frames);
+  TimeStretch::Quality GetStretchQuality() const;
+
+  /**
+   * Park the track while it cannot be heard (muted or soloed out): decoding
+   * stops and seeks are deferred. The mixer keeps the track's place on the
+   * timeline meanwhile, so nothing has to be consumed to stay in sync.
+   */
+  void Park();
+
+  /**
+   * Leave the parked state. A decode worker seeks to frame and refills the
+   * buffer; the mixer then lines the buffered audio up with the timeline
+   * (see SyncResume()) and fades the track in.
+   * @param frame Track position playback is expected to resume at
+   */
+  void Unpark(int64_t frame);
+  bool IsParked() const;
+
+  /**
+   * Whether an unparked track is still seeking or filling.
+   */
+  bool IsResuming() const;
+
+  /**
+   * Line a resuming track up with the timeline. Audio thread only.
+   * Audio that is already late is dropped; if the buffer is too far off
+   * (e.g. the transport moved while the track was parked) the seek is
+   * repeated. Once enough is buffered the resume ends with a fade-in.
+   * @param track_frame Track position of the first frame to be mixed
+   * @param frames Frames to be mixed
+   * @return Leading frames to leave silent (frames = skip the block)
+   */
+  size_t SyncResume(int64_t track_frame, size_t frames);
+
+  /**
+   * Whether enough audio is buffered to start playing after a seek.
+   * Tracks that reached end of file always count as primed.
+   * @param frames Frames required (capped to what the buffer can hold)
+   * @return true if primed
+   */
+  bool IsPrimed(size_t frames) const;
+
+  /**
+   * Number of callbacks that found the buffer empty before end of file.
+   * @return Starvation count
+   */
+  uint64_t GetStarvationCount() const override;
+
+  /**
+   * Clear the starvation count (e.g. when callback statistics are reset).
+   */
+  void ResetStarvationCount();
+
  private:
-  void StreamingThreadFunc();
+  // DecodeScheduler::Client (called from decode workers)
+  float GetFillRatio() const override;
+  bool NeedsDecode() const override;
+  void DecodeChunk() override;
+  size_t ReadUnscaled(float* output, size_t frames, int32_t channels);
+  size_t ReadPlanarInterleaved(float* output, size_t frames);
+  size_t NextStretchInputFrames(size_t output_frames);
+  bool UseOwnStretch() const;
+  bool UseVarispeed() const;
+  void SyncVarispeed();
+  size_t ReadVarispeed(float* output, size_t frames, int32_t channels);
+  bool StretchesAhead() const;
+  bool StretchAheadStale() const;
+  void WakeStretchAhead();
+  bool UpdateStretchAhead();
+  size_t RenderStretchAhead(const float* input, size_t frames);
+  bool SeekLocked(int64_t frame);
+  void PrerollStretch(int32_t channels);
+  void PrerollStretchPlanar();
+  size_t DrainStretch(float* output, size_t frames, int32_t channels);
+  void SyncStretchCompensation(bool stretching);
+  size_t AcquirePlanarSpans(size_t frames,
+                            core::CircularBuffer::ReadSpan* left,
+                            core::CircularBuffer::ReadSpan* right);
+  size_t BufferedSamples() const;
+  size_t FreeSamples() const;
+  size_t CapacitySamples() const;
+  void WritePlanar(const float* interleaved, size_t frames);
+  void NoteUnderrun(const char* kind, size_t needed, size_t read, size_t frames);
+  void RequestDecodeIfLow();
+  bool DecodeIntoBuffer(size_t source_frames);
+  void SwapToCachedDecoder();
+  void UpdateTargetGains();
+  void NotifyParamsChanged();
+  size_t DropFrames(size_t frames);
 
   std::string id_;
   std::string file_path_;
   std::unique_ptr<audio::AudioDecoder> decoder_;
+  audio::AudioFormat format_{0, 0, 0};
+  std::shared_ptr<audio::PcmCache> pcm_cache_;
+  bool cache_backed_ = false;
   std::unique_ptr<core::CircularBuffer> buffer_;
   std::atomic<bool> is_loaded_{false};
 
-  // Streaming thread
-  std::unique_ptr<std::thread> streaming_thread_;
-  std::atomic<bool> streaming_active_{false};
-  std::mutex streaming_mutex_;
-  std::condition_variable streaming_cv_;
-  std::mutex decoder_mutex_;
+  // Planar mode: buffer_ holds the left plane and right_buffer_ the right one.
+  // Both are written in lockstep by the decode workers.
+  bool planar_requested_ = false;
+  bool planar_ = false;
+  std::unique_ptr<core::CircularBuffer> right_buffer_;
+  std::vector<float> planar_output_[2];
+  size_t planar_pending_frames_ = 0;
+  // Bumped by Seek() before the rings are reset, so a read that straddles
+  // the reset is discarded instead of leaving the planes out of step.
+  std::atomic<uint64_t> planar_reset_count_{0};
+
+  // Decoding is done by the shared scheduler; the audio thread asks for more
+  // data once the buffer drains below the low watermark.
+  std::shared_ptr<DecodeScheduler> scheduler_;
+  uint64_t scheduler_id_ = 0;
+  size_t low_watermark_samples_ = 0;
+  std::vector<float> decode_buffer_;
+  size_t decode_chunk_samples_ = 0;
+  size_t chunk_frames_ = 0;
+
+  // Source-rate to output-rate conversion, run by the decode workers
+  int32_t output_sample_rate_ = 0;
+  std::unique_ptr<dsp::Resampler> resampler_;
+  std::vector<float> resample_buffer_;
+  std::atomic<bool> source_exhausted_{false};
+  std::atomic<uint64_t> starvation_count_{0};
+  mutable std::mutex decoder_mutex_;
 
   // Per-track controls (atomic for thread safety)
   std::atomic<float> volume_{1.0f};
@@ -104,10 +442,64 @@ class Track {
   std::atomic<float> pan_{0.0f};
   std::atomic<int64_t> start_time_samples_{0};
 
+  // Output gains derived from volume/pan on the control thread, so the audio
+  // thread never evaluates the pan law.
+  std::atomic<float> target_gain_left_{1.0f};
+  std::atomic<float> target_gain_right_{1.0f};
+  float applied_gain_left_ = 1.0f;
+  float applied_gain_right_ = 1.0f;
+  bool gain_ramp_primed_ = false;
+  std::atomic<ParamsListener*> params_listener_{nullptr};
+
+  // Parking. Unpark() asks a decode worker to seek (kSeekPending ->
+  // kSeeking -> kFilling); the audio thread then finishes the resume, or
+  // sends it back to kSeekPending. resume_frame_ is the track position at
+  // the head of the buffer while resuming.
+  enum class ResumeState : uint8_t { kNone, kSeekPending, kSeeking, kFilling };
+  std::atomic<bool> parked_{false};
+  std::atomic<ResumeState> resume_state_{ResumeState::kNone};
+  std::atomic<int64_t> resume_frame_{0};
+
   // Phase 2: Real-time effects
   std::unique_ptr<TimeStretch> time_stretcher_;
+  std::atomic<bool> stretch_on_master_bus_{false};
+  std::atomic<TimeStretch::Quality> stretch_quality_{TimeStretch::Quality::kHigh};
+  std::atomic<size_t> stretch_crossfade_frames_{0};
   std::vector<float> stretch_input_buffer_;
   double stretch_input_fraction_ = 0.0;
+
+  // Delay compensation on the audio thread: once pre-rolled, the ring read
+  // position leads the stretcher output by its latency. Switching the effect
+  // off drains the stretcher for that long before reading the ring again.
+  bool stretch_prerolled_ = false;
+  size_t stretch_drain_frames_ = 0;
+  std::atomic<bool> stretch_resync_pending_{false};  // set by Seek()
+
+  // Varispeed mode: the audio thread resamples from the ring instead of
+  // stretching. The resampler belongs to the audio thread; Seek() asks it to
+  // reset through varispeed_reset_pending_.
+  std::atomic<bool> varispeed_enabled_{false};
+  std::atomic<dsp::Varispeed::Quality> varispeed_quality_{dsp::Varispeed::Quality::kSinc};
+  std::unique_ptr<dsp::Varispeed> varispeed_;
+  std::atomic<bool> varispeed_reset_pending_{false};
+
+  // Stretch-ahead mode: the decode workers render through time_stretcher_
+  // into the ring. The rendered_* settings describe the buffered audio; they
+  // are written under decoder_mutex_ and read by NeedsDecode() to spot a
+  // pending flush. The remaining state is guarded by decoder_mutex_.
+  bool stretch_ahead_requested_ = false;
+  size_t stretch_ahead_frames_requested_ = 0;
+  bool stretch_ahead_ = false;
+  size_t ahead_limit_samples_ = 0;
+  std::atomic<bool> rendered_active_{false};
+  std::atomic<float> rendered_pitch_{0.0f};
+  std::atomic<float> rendered_stretch_{1.0f};
+  int64_t ahead_source_frame_ = 0;  // output-rate source frames fed so far
+  double ahead_output_fraction_ = 0.0;
+  size_t ahead_preroll_frames_ = 0;  // input still to pre-roll after a seek
+  bool ahead_tail_rendered_ = false;
+  std::vector<float> stretch_output_buffer_;
+  std::atomic<uint64_t> stretch_flush_count_{0};
   uint32_t stretch_log_counter_ = 0;
   uint32_t underrun_log_counter_ = 0;
 };
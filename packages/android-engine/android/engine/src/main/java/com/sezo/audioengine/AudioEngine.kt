@@ -6,7 +6,9 @@ class AudioEngine {
   private var nativeHandle: Long = 0
   private var extractionProgressListener: ((Long, Float) -> Unit)? = null
   private var extractionCompletionListener: ((Long, ExtractionResult) -> Unit)? = null
+  private var stemExportCompletionListener: ((Long, StemExportResult) -> Unit)? = null
   private var playbackStateListener: ((String, Double, Double) -> Unit)? = null
+  private var qualityChangeListener: ((QualityChange) -> Unit)? = null
 
   init {
     System.loadLibrary("sezo_audio_engine")
@@ -19,12 +21,14 @@ class AudioEngine {
 
   fun release() {
     setPlaybackStateListener(null)
+    setQualityChangeListener(null)
     nativeRelease(nativeHandle)
   }
 
   fun destroy() {
     if (nativeHandle != 0L) {
       setPlaybackStateListener(null)
+      setQualityChangeListener(null)
       nativeDestroy(nativeHandle)
       nativeHandle = 0
     }
@@ -44,6 +48,21 @@ class AudioEngine {
     nativeUnloadAllTracks(nativeHandle)
   }
 
+  // Pre-decoded PCM cache for MP3/M4A tracks (LRU-bounded by maxBytes)
+  @JvmOverloads
+  fun enablePcmCache(directory: String, maxBytes: Long, useFloat: Boolean = false): Boolean {
+    return nativeEnablePcmCache(nativeHandle, directory, maxBytes, useFloat)
+  }
+
+  fun disablePcmCache() {
+    nativeDisablePcmCache(nativeHandle)
+  }
+
+  // Planar (non-interleaved) stereo path for tracks loaded afterwards
+  fun setPlanarSignalPath(enabled: Boolean) {
+    nativeSetPlanarSignalPath(nativeHandle, enabled)
+  }
+
   // Playback control
   fun play() {
     nativePlay(nativeHandle)
@@ -81,6 +100,88 @@ class AudioEngine {
     return nativeGetDuration(nativeHandle)
   }
 
+  // Seek priming: output resumes once every track has buffered primeMs
+  fun setSeekPrimeMs(primeMs: Double) {
+    nativeSetSeekPrimeMs(nativeHandle, primeMs)
+  }
+
+  fun isSeekReady(): Boolean {
+    return nativeIsSeekReady(nativeHandle)
+  }
+
+  fun getSeekReadyLatencyMs(): Double {
+    return nativeGetSeekReadyLatencyMs(nativeHandle)
+  }
+
+  // Audio callback health: timing histogram, load percentiles, xruns, underruns
+  data class RealtimeStats(
+    val callbacks: Long,
+    val framesPerCallback: Int,
+    val sampleRate: Int,
+    val periodUs: Double,
+    val meanDurationUs: Double,
+    val maxDurationUs: Double,
+    val p50DurationUs: Double,
+    val p90DurationUs: Double,
+    val p99DurationUs: Double,
+    val p999DurationUs: Double,
+    val p50LoadPercent: Double,
+    val p99LoadPercent: Double,
+    val maxLoadPercent: Double,
+    val deadlineMisses: Long,
+    val maxIntervalUs: Double,
+    val xrunCount: Int,
+    val trackUnderruns: Long,
+    val trackUnderrunCounts: Map<String, Long>,
+    val renderWorkers: Int,
+    val parallelBatches: Long,
+    val lateParallelBatches: Long,
+    val tasksOnRenderWorkers: Long,
+    val parallelFallbackBlocks: Long,
+    val histogramUpperUs: DoubleArray,
+    val histogramCounts: LongArray
+  )
+
+  fun getRealtimeStats(): RealtimeStats {
+    val map = nativeGetRealtimeStats(nativeHandle) ?: emptyMap<String, Any?>()
+    fun long(key: String) = (map[key] as? Number)?.toLong() ?: 0L
+    fun double(key: String) = (map[key] as? Number)?.toDouble() ?: 0.0
+    return RealtimeStats(
+      callbacks = long("callbacks"),
+      framesPerCallback = long("framesPerCallback").toInt(),
+      sampleRate = long("sampleRate").toInt(),
+      periodUs = double("periodUs"),
+      meanDurationUs = double("meanDurationUs"),
+      maxDurationUs = double("maxDurationUs"),
+      p50DurationUs = double("p50DurationUs"),
+      p90DurationUs = double("p90DurationUs"),
+      p99DurationUs = double("p99DurationUs"),
+      p999DurationUs = double("p999DurationUs"),
+      p50LoadPercent = double("p50LoadPercent"),
+      p99LoadPercent = double("p99LoadPercent"),
+      maxLoadPercent = double("maxLoadPercent"),
+      deadlineMisses = long("deadlineMisses"),
+      maxIntervalUs = double("maxIntervalUs"),
+      xrunCount = (map["xrunCount"] as? Number)?.toInt() ?: -1,
+      trackUnderruns = long("trackUnderruns"),
+      trackUnderrunCounts = (map["trackUnderrunCounts"] as? Map<*, *>)
+        ?.entries
+        ?.associate { it.key.toString() to ((it.value as? Number)?.toLong() ?: 0L) }
+        ?: emptyMap(),
+      renderWorkers = long("renderWorkers").toInt(),
+      parallelBatches = long("parallelBatches"),
+      lateParallelBatches = long("lateParallelBatches"),
+      tasksOnRenderWorkers = long("tasksOnRenderWorkers"),
+      parallelFallbackBlocks = long("parallelFallbackBlocks"),
+      histogramUpperUs = map["histogramUpperUs"] as? DoubleArray ?: DoubleArray(0),
+      histogramCounts = map["histogramCounts"] as? LongArray ?: LongArray(0)
+    )
+  }
+
+  fun resetRealtimeStats() {
+    nativeResetRealtimeStats(nativeHandle)
+  }
+
   fun setPlaybackStateListener(listener: ((String, Double, Double) -> Unit)?) {
     playbackStateListener = listener
     if (nativeHandle != 0L) {
@@ -131,6 +232,89 @@ class AudioEngine {
     return nativeGetSpeed(nativeHandle)
   }
 
+  // One stretcher on the summed bus for the global pitch/speed (default on)
+  fun setMasterBusStretch(enabled: Boolean) {
+    nativeSetMasterBusStretch(nativeHandle, enabled)
+  }
+
+  // Speed by resampling (pitch follows speed) instead of time-stretching
+  fun setVarispeed(enabled: Boolean) {
+    nativeSetVarispeed(nativeHandle, enabled)
+  }
+
+  // Varispeed interpolation: windowed sinc (default) or cheaper cubic
+  fun setVarispeedQuality(windowedSinc: Boolean) {
+    nativeSetVarispeedQuality(nativeHandle, if (windowedSinc) 1 else 0)
+  }
+
+  // Stretch on the decode threads ahead of playback, for tracks loaded afterwards
+  fun setStretchAhead(enabled: Boolean, maxLatencyMs: Double = 150.0) {
+    nativeSetStretchAhead(nativeHandle, enabled, maxLatencyMs)
+  }
+
+  // Delay before a pitch/speed change is heard while stretching ahead
+  fun getEffectLatencyMs(): Double {
+    return nativeGetEffectLatencyMs(nativeHandle)
+  }
+
+  // Pitch/speed latency compensated by pre-rolling stretched audio
+  fun getProcessingLatencyMs(): Double {
+    return nativeGetProcessingLatencyMs(nativeHandle)
+  }
+
+  // Render tracks on helper threads alongside the audio callback (0 = cores - 1)
+  @JvmOverloads
+  fun setParallelRender(enabled: Boolean, workerCount: Int = 0) {
+    nativeSetParallelRender(nativeHandle, enabled, workerCount)
+  }
+
+  // Adaptive time-stretch quality: thresholds for the quality governor
+  data class QualityGovernorConfig(
+    val windowMs: Int = 500,
+    val stepDownLoadPercent: Double = 80.0,
+    val stepUpLoadPercent: Double = 45.0,
+    val calmWindowsToStepUp: Int = 8,
+    val holdWindows: Int = 2,
+    val maxLevel: Int = 2,
+    val crossfadeMs: Int = 50
+  )
+
+  // A quality level change; reason is "load", "deadlineMiss", "xrun", "recovered" or "manual"
+  data class QualityChange(
+    val level: Int,
+    val previousLevel: Int,
+    val reason: String,
+    val p90LoadPercent: Double,
+    val deadlineMisses: Long,
+    val xruns: Long
+  )
+
+  // Step stretchers to cheaper tiers under callback load, and back when calm
+  @JvmOverloads
+  fun setQualityGovernor(enabled: Boolean, config: QualityGovernorConfig = QualityGovernorConfig()) {
+    nativeSetQualityGovernor(
+      nativeHandle, enabled, config.windowMs, config.stepDownLoadPercent,
+      config.stepUpLoadPercent, config.calmWindowsToStepUp, config.holdWindows,
+      config.maxLevel, config.crossfadeMs
+    )
+  }
+
+  // 0 = full quality; higher levels are cheaper time-stretch tiers
+  fun setQualityLevel(level: Int) {
+    nativeSetQualityLevel(nativeHandle, level)
+  }
+
+  fun getQualityLevel(): Int {
+    return nativeGetQualityLevel(nativeHandle)
+  }
+
+  fun setQualityChangeListener(listener: ((QualityChange) -> Unit)?) {
+    qualityChangeListener = listener
+    if (nativeHandle != 0L) {
+      nativeSetQualityChangeListener(nativeHandle, listener != null)
+    }
+  }
+
   // Effects (Phase 2) - Per-track controls
   fun setTrackPitch(trackId: String, semitones: Float) {
     nativeSetTrackPitch(nativeHandle, trackId, semitones)
@@ -148,6 +332,10 @@ class AudioEngine {
     return nativeGetTrackSpeed(nativeHandle, trackId)
   }
 
+  fun setTrackVarispeed(trackId: String, enabled: Boolean) {
+    nativeSetTrackVarispeed(nativeHandle, trackId, enabled)
+  }
+
   // Recording (Phase 3)
   data class RecordingConfig(
     val sampleRate: Int = 44100,
@@ -214,13 +402,21 @@ class AudioEngine {
   }
 
   // Extraction (Phase 6)
+  companion object {
+    // Background job priorities: higher runs first, then earlier deadlineMs
+    const val EXTRACTION_PRIORITY_LOW = 0
+    const val EXTRACTION_PRIORITY_NORMAL = 1
+    const val EXTRACTION_PRIORITY_HIGH = 2
+  }
+
   data class ExtractionResult(
     val success: Boolean,
     val trackId: String?,
     val outputPath: String,
     val durationSamples: Long,
     val fileSize: Long,
-    val errorMessage: String?
+    val errorMessage: String?,
+    val realtimeFactor: Double = 0.0
   )
 
   fun extractTrack(
@@ -229,10 +425,13 @@ class AudioEngine {
     format: String = "wav",
     bitrate: Int = 128000,
     bitsPerSample: Int = 16,
-    includeEffects: Boolean = true
+    includeEffects: Boolean = true,
+    startMs: Double = 0.0,
+    endMs: Double = 0.0
   ): ExtractionResult {
     val resultMap = nativeExtractTrack(
-      nativeHandle, trackId, outputPath, format, bitrate, bitsPerSample, includeEffects
+      nativeHandle, trackId, outputPath, format, bitrate, bitsPerSample, includeEffects,
+      startMs, endMs
     ) as? Map<*, *> ?: return ExtractionResult(
       success = false,
       trackId = trackId,
@@ -248,7 +447,8 @@ class AudioEngine {
       outputPath = resultMap["outputPath"] as? String ?: outputPath,
       durationSamples = resultMap["durationSamples"] as? Long ?: 0L,
       fileSize = resultMap["fileSize"] as? Long ?: 0L,
-      errorMessage = resultMap["errorMessage"] as? String
+      errorMessage = resultMap["errorMessage"] as? String,
+      realtimeFactor = (resultMap["realtimeFactor"] as? Number)?.toDouble() ?: 0.0
     )
   }
 
@@ -258,10 +458,15 @@ class AudioEngine {
     format: String = "wav",
     bitrate: Int = 128000,
     bitsPerSample: Int = 16,
-    includeEffects: Boolean = true
+    includeEffects: Boolean = true,
+    priority: Int = EXTRACTION_PRIORITY_NORMAL,
+    deadlineMs: Long = 0L,
+    startMs: Double = 0.0,
+    endMs: Double = 0.0
   ): Long {
     return nativeStartExtractTrack(
-      nativeHandle, trackId, outputPath, format, bitrate, bitsPerSample, includeEffects
+      nativeHandle, trackId, outputPath, format, bitrate, bitsPerSample, includeEffects,
+      priority, deadlineMs, startMs, endMs
     )
   }
 
@@ -270,10 +475,13 @@ class AudioEngine {
     format: String = "wav",
     bitrate: Int = 128000,
     bitsPerSample: Int = 16,
-    includeEffects: Boolean = true
+    includeEffects: Boolean = true,
+    startMs: Double = 0.0,
+    endMs: Double = 0.0
   ): ExtractionResult {
     val resultMap = nativeExtractAllTracks(
-      nativeHandle, outputPath, format, bitrate, bitsPerSample, includeEffects
+      nativeHandle, outputPath, format, bitrate, bitsPerSample, includeEffects,
+      startMs, endMs
     ) as? Map<*, *> ?: return ExtractionResult(
       success = false,
       trackId = null,
@@ -289,7 +497,8 @@ class AudioEngine {
       outputPath = resultMap["outputPath"] as? String ?: outputPath,
       durationSamples = resultMap["durationSamples"] as? Long ?: 0L,
       fileSize = resultMap["fileSize"] as? Long ?: 0L,
-      errorMessage = resultMap["errorMessage"] as? String
+      errorMessage = resultMap["errorMessage"] as? String,
+      realtimeFactor = (resultMap["realtimeFactor"] as? Number)?.toDouble() ?: 0.0
     )
   }
 
@@ -298,17 +507,95 @@ class AudioEngine {
     format: String = "wav",
     bitrate: Int = 128000,
     bitsPerSample: Int = 16,
-    includeEffects: Boolean = true
+    includeEffects: Boolean = true,
+    priority: Int = EXTRACTION_PRIORITY_NORMAL,
+    deadlineMs: Long = 0L,
+    startMs: Double = 0.0,
+    endMs: Double = 0.0
   ): Long {
     return nativeStartExtractAllTracks(
-      nativeHandle, outputPath, format, bitrate, bitsPerSample, includeEffects
+      nativeHandle, outputPath, format, bitrate, bitsPerSample, includeEffects,
+      priority, deadlineMs, startMs, endMs
     )
   }
 
+  data class StemExportResult(
+    val success: Boolean,
+    val stems: List<ExtractionResult>,
+    val mix: ExtractionResult?,
+    val errorMessage: String?,
+    val realtimeFactor: Double = 0.0
+  )
+
+  // Writes outputDir/<trackId>.<format> per track (empty trackIds = all loaded tracks)
+  fun startExtractStems(
+    trackIds: List<String>,
+    outputDir: String,
+    mixOutputPath: String? = null,
+    format: String = "wav",
+    bitrate: Int = 128000,
+    bitsPerSample: Int = 16,
+    includeEffects: Boolean = true,
+    renderThreads: Int = 0,
+    memoryBudgetBytes: Long = 0L,
+    priority: Int = EXTRACTION_PRIORITY_NORMAL,
+    deadlineMs: Long = 0L
+  ): Long {
+    return nativeStartExtractStems(
+      nativeHandle, trackIds.toTypedArray(), outputDir, mixOutputPath, format, bitrate,
+      bitsPerSample, includeEffects, renderThreads, memoryBudgetBytes, priority, deadlineMs
+    )
+  }
+
+  fun setStemExportCompletionListener(listener: ((Long, StemExportResult) -> Unit)?) {
+    stemExportCompletionListener = listener
+  }
+
   fun cancelExtraction(jobId: Long): Boolean {
     return nativeCancelExtraction(nativeHandle, jobId)
   }
 
+  data class ExtractionMetrics(
+    val concurrency: Int,
+    val paused: Boolean,
+    val queued: Int,
+    val running: Int,
+    val submitted: Long,
+    val completed: Long,
+    val missedDeadlines: Long,
+    val meanWaitMs: Double,
+    val maxWaitMs: Double,
+    val oldestQueuedMs: Double
+  )
+
+  // Background jobs allowed to run at once (default 2)
+  fun setExtractionConcurrency(jobs: Int) {
+    nativeSetExtractionConcurrency(nativeHandle, jobs)
+  }
+
+  // Paused: queued jobs wait and running jobs hold at their next progress step
+  fun setExtractionsPaused(paused: Boolean) {
+    nativeSetExtractionsPaused(nativeHandle, paused)
+  }
+
+  fun getExtractionMetrics(): ExtractionMetrics {
+    val map = nativeGetExtractionMetrics(nativeHandle) ?: emptyMap<String, Any?>()
+    fun long(key: String) = (map[key] as? Number)?.toLong() ?: 0L
+    fun double(key: String) = (map[key] as? Number)?.toDouble() ?: 0.0
+    return ExtractionMetrics(
+      concurrency = long("concurrency").toInt(),
+      paused = long("paused") != 0L,
+      queued = long("queued").toInt(),
+      running = long("running").toInt(),
+      submitted = long("submitted"),
+      completed = long("completed"),
+      missedDeadlines = long("missedDeadlines"),
+      meanWaitMs = double("meanWaitMs"),
+      maxWaitMs = double("maxWaitMs"),
+      oldestQueuedMs = double("oldestQueuedMs")
+    )
+  }
+
   fun setExtractionProgressListener(listener: ((Long, Float) -> Unit)?) {
     extractionProgressListener = listener
   }
@@ -324,6 +611,29 @@ class AudioEngine {
 
   @Keep
   private fun onNativeExtractionComplete(jobId: Long, result: Map<String, Any?>) {
+    extractionCompletionListener?.invoke(jobId, parseExtractionResult(result))
+  }
+
+  @Keep
+  private fun onNativeStemExportComplete(jobId: Long, result: Map<String, Any?>) {
+    val stems = (result["stems"] as? List<*>).orEmpty().mapNotNull { stem ->
+      (stem as? Map<*, *>)?.let { parseExtractionResult(it) }
+    }
+    val mix = (result["mix"] as? Map<*, *>)?.let { parseExtractionResult(it) }
+
+    stemExportCompletionListener?.invoke(
+      jobId,
+      StemExportResult(
+        success = result["success"] as? Boolean ?: false,
+        stems = stems,
+        mix = mix,
+        errorMessage = (result["errorMessage"] as? String)?.takeIf { it.isNotEmpty() },
+        realtimeFactor = (result["realtimeFactor"] as? Number)?.toDouble() ?: 0.0
+      )
+    )
+  }
+
+  private fun parseExtractionResult(result: Map<*, *>): ExtractionResult {
     val success = result["success"] as? Boolean ?: false
     val trackId = result["trackId"] as? String
     val outputPath = result["outputPath"] as? String ?: ""
@@ -336,17 +646,19 @@ class AudioEngine {
       else -> 0L
     }
     val errorMessage = result["errorMessage"] as? String
+    val realtimeFactor = when (val value = result["realtimeFactor"]) {
+      is Number -> value.toDouble()
+      else -> 0.0
+    }
 
-    extractionCompletionListener?.invoke(
-      jobId,
-      ExtractionResult(
-        success = success,
-        trackId = trackId,
-        outputPath = outputPath,
-        durationSamples = durationSamples,
-        fileSize = fileSize,
-        errorMessage = errorMessage
-      )
+    return ExtractionResult(
+      success = success,
+      trackId = trackId,
+      outputPath = outputPath,
+      durationSamples = durationSamples,
+      fileSize = fileSize,
+      errorMessage = errorMessage,
+      realtimeFactor = realtimeFactor
     )
   }
 
@@ -362,6 +674,27 @@ class AudioEngine {
     playbackStateListener?.invoke(mappedState, positionMs, durationMs)
   }
 
+  @Keep
+  private fun onNativeQualityChanged(
+    level: Int,
+    previousLevel: Int,
+    reason: Int,
+    p90LoadPercent: Double,
+    deadlineMisses: Long,
+    xruns: Long
+  ) {
+    val mappedReason = when (reason) {
+      0 -> "load"
+      1 -> "deadlineMiss"
+      2 -> "xrun"
+      3 -> "recovered"
+      else -> "manual"
+    }
+    qualityChangeListener?.invoke(
+      QualityChange(level, previousLevel, mappedReason, p90LoadPercent, deadlineMisses, xruns)
+    )
+  }
+
   // Native method declarations
   private external fun nativeCreate(): Long
   private external fun nativeDestroy(handle: Long)
@@ -373,6 +706,11 @@ class AudioEngine {
   ): Boolean
   private external fun nativeUnloadTrack(handle: Long, trackId: String): Boolean
   private external fun nativeUnloadAllTracks(handle: Long)
+  private external fun nativeEnablePcmCache(
+    handle: Long, directory: String, maxBytes: Long, useFloat: Boolean
+  ): Boolean
+  private external fun nativeDisablePcmCache(handle: Long)
+  private external fun nativeSetPlanarSignalPath(handle: Long, enabled: Boolean)
 
   private external fun nativePlay(handle: Long)
   private external fun nativePause(handle: Long)
@@ -383,6 +721,11 @@ class AudioEngine {
   private external fun nativeRestartStream(handle: Long): Boolean
   private external fun nativeGetCurrentPosition(handle: Long): Double
   private external fun nativeGetDuration(handle: Long): Double
+  private external fun nativeSetSeekPrimeMs(handle: Long, primeMs: Double)
+  private external fun nativeIsSeekReady(handle: Long): Boolean
+  private external fun nativeGetSeekReadyLatencyMs(handle: Long): Double
+  private external fun nativeGetRealtimeStats(handle: Long): Map<String, Any?>?
+  private external fun nativeResetRealtimeStats(handle: Long)
   private external fun nativeSetPlaybackStateListener(handle: Long, enabled: Boolean)
 
   private external fun nativeSetTrackVolume(handle: Long, trackId: String, volume: Float)
@@ -397,11 +740,27 @@ class AudioEngine {
   private external fun nativeGetPitch(handle: Long): Float
   private external fun nativeSetSpeed(handle: Long, rate: Float)
   private external fun nativeGetSpeed(handle: Long): Float
+  private external fun nativeSetMasterBusStretch(handle: Long, enabled: Boolean)
+  private external fun nativeSetVarispeed(handle: Long, enabled: Boolean)
+  private external fun nativeSetVarispeedQuality(handle: Long, quality: Int)
+  private external fun nativeSetStretchAhead(handle: Long, enabled: Boolean, maxLatencyMs: Double)
+  private external fun nativeGetEffectLatencyMs(handle: Long): Double
+  private external fun nativeGetProcessingLatencyMs(handle: Long): Double
+  private external fun nativeSetParallelRender(handle: Long, enabled: Boolean, workerCount: Int)
+  private external fun nativeSetQualityGovernor(
+    handle: Long, enabled: Boolean, windowMs: Int, stepDownLoadPercent: Double,
+    stepUpLoadPercent: Double, calmWindowsToStepUp: Int, holdWindows: Int,
+    maxLevel: Int, crossfadeMs: Int
+  )
+  private external fun nativeSetQualityLevel(handle: Long, level: Int)
+  private external fun nativeGetQualityLevel(handle: Long): Int
+  private external fun nativeSetQualityChangeListener(handle: Long, enabled: Boolean)
 
   private external fun nativeSetTrackPitch(handle: Long, trackId: String, semitones: Float)
   private external fun nativeGetTrackPitch(handle: Long, trackId: String): Float
   private external fun nativeSetTrackSpeed(handle: Long, trackId: String, rate: Float)
   private external fun nativeGetTrackSpeed(handle: Long, trackId: String): Float
+  private external fun nativeSetTrackVarispeed(handle: Long, trackId: String, enabled: Boolean)
 
   // Recording (Phase 3)
   private external fun nativeStartRecording(
@@ -415,23 +774,36 @@ class AudioEngine {
 
   private external fun nativeExtractTrack(
     handle: Long, trackId: String, outputPath: String,
-    format: String, bitrate: Int, bitsPerSample: Int, includeEffects: Boolean
+    format: String, bitrate: Int, bitsPerSample: Int, includeEffects: Boolean,
+    startMs: Double, endMs: Double
   ): Any?
 
   private external fun nativeExtractAllTracks(
     handle: Long, outputPath: String,
-    format: String, bitrate: Int, bitsPerSample: Int, includeEffects: Boolean
+    format: String, bitrate: Int, bitsPerSample: Int, includeEffects: Boolean,
+    startMs: Double, endMs: Double
   ): Any?
 
   private external fun nativeStartExtractTrack(
     handle: Long, trackId: String, outputPath: String,
-    format: String, bitrate: Int, bitsPerSample: Int, includeEffects: Boolean
+    format: String, bitrate: Int, bitsPerSample: Int, includeEffects: Boolean,
+    priority: Int, deadlineMs: Long, startMs: Double, endMs: Double
   ): Long
 
   private external fun nativeStartExtractAllTracks(
     handle: Long, outputPath: String,
-    format: String, bitrate: Int, bitsPerSample: Int, includeEffects: Boolean
+    format: String, bitrate: Int, bitsPerSample: Int, includeEffects: Boolean,
+    priority: Int, deadlineMs: Long, startMs: Double, endMs: Double
+  ): Long
+
+  private external fun nativeStartExtractStems(
+    handle: Long, trackIds: Array<String>, outputDir: String, mixOutputPath: String?,
+    format: String, bitrate: Int, bitsPerSample: Int, includeEffects: Boolean,
+    renderThreads: Int, memoryBudgetBytes: Long, priority: Int, deadlineMs: Long
   ): Long
 
   private external fun nativeCancelExtraction(handle: Long, jobId: Long): Boolean
+  private external fun nativeSetExtractionConcurrency(handle: Long, jobs: Int)
+  private external fun nativeSetExtractionsPaused(handle: Long, paused: Boolean)
+  private external fun nativeGetExtractionMetrics(handle: Long): Map<String, Any?>?
 }
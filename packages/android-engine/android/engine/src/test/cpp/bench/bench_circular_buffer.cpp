@@ -0,0 +1,120 @@
+#include "bench_harness.h"
+
+#include "core/CircularBuffer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace sezo {
+namespace bench {
+
+namespace {
+
+constexpr size_t kCapacitySamples = 48000 * 2;
+
+// Single-threaded write followed by read of the same block.
+void BM_WriteRead(BenchState& state) {
+  const size_t block = static_cast<size_t>(state.Arg());
+  core::CircularBuffer buffer(kCapacitySamples);
+  std::vector<float> input(block, 0.25f);
+  std::vector<float> output(block);
+  while (state.KeepRunning()) {
+    buffer.Write(input.data(), block);
+    buffer.Read(output.data(), block);
+    DoNotOptimize(output[0]);
+  }
+  state.SetItemsProcessed(state.Iterations() * static_cast<int64_t>(block));
+  state.SetBytesProcessed(state.Iterations() * static_cast<int64_t>(block * sizeof(float)) * 2);
+}
+
+// Producer thread keeps the buffer topped up while the timed loop consumes
+// callback-sized blocks, as the decode pool and audio thread do.
+void BM_ProducerConsumer(BenchState& state) {
+  const size_t block = static_cast<size_t>(state.Arg());
+  core::CircularBuffer buffer(kCapacitySamples);
+  std::atomic<bool> stop{false};
+  std::thread producer([&buffer, &stop] {
+    std::vector<float> chunk(4096 * 2, 0.5f);
+    while (!stop.load(std::memory_order_relaxed)) {
+      if (buffer.FreeSpace() >= chunk.size()) {
+        buffer.Write(chunk.data(), chunk.size());
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  std::vector<float> output(block);
+  int64_t samples_read = 0;
+  int64_t short_reads = 0;
+  while (state.KeepRunning()) {
+    const size_t read = buffer.Read(output.data(), block);
+    samples_read += static_cast<int64_t>(read);
+    if (read < block) {
+      ++short_reads;
+    }
+    DoNotOptimize(output[0]);
+  }
+  stop.store(true, std::memory_order_relaxed);
+  producer.join();
+
+  state.SetItemsProcessed(samples_read);
+  state.SetBytesProcessed(samples_read * static_cast<int64_t>(sizeof(float)));
+  state.SetCounter("short_reads", static_cast<double>(short_reads));
+}
+
+// Same contention test through the span API: the producer fills the ring in
+// place and the consumer sums straight out of it, as Track and the mixer do.
+void BM_ProducerConsumerSpans(BenchState& state) {
+  const size_t block = static_cast<size_t>(state.Arg());
+  core::CircularBuffer buffer(kCapacitySamples, 2);
+  std::atomic<bool> stop{false};
+  std::thread producer([&buffer, &stop] {
+    while (!stop.load(std::memory_order_relaxed)) {
+      auto span = buffer.AcquireWrite(4096 * 2);
+      if (span.size() < 4096 * 2) {
+        std::this_thread::yield();
+        continue;
+      }
+      std::fill_n(span.first, span.first_count, 0.5f);
+      std::fill_n(span.second, span.second_count, 0.5f);
+      buffer.CommitWrite(span.size());
+    }
+  });
+
+  int64_t samples_read = 0;
+  int64_t short_reads = 0;
+  float sum = 0.0f;
+  while (state.KeepRunning()) {
+    const auto span = buffer.AcquireRead(block);
+    for (size_t i = 0; i < span.first_count; ++i) {
+      sum += span.first[i];
+    }
+    for (size_t i = 0; i < span.second_count; ++i) {
+      sum += span.second[i];
+    }
+    buffer.CommitRead(span.size());
+    samples_read += static_cast<int64_t>(span.size());
+    if (span.size() < block) {
+      ++short_reads;
+    }
+  }
+  DoNotOptimize(sum);
+  stop.store(true, std::memory_order_relaxed);
+  producer.join();
+
+  state.SetItemsProcessed(samples_read);
+  state.SetBytesProcessed(samples_read * static_cast<int64_t>(sizeof(float)));
+  state.SetCounter("short_reads", static_cast<double>(short_reads));
+}
+
+}  // namespace
+
+SEZO_BENCHMARK("circular_buffer/write_read", BM_WriteRead, {64, 512, 4096});
+SEZO_BENCHMARK("circular_buffer/producer_consumer", BM_ProducerConsumer, {128, 512});
+SEZO_BENCHMARK("circular_buffer/producer_consumer_spans", BM_ProducerConsumerSpans, {128, 512});
+
+}  // namespace bench
+}  // namespace sezo
@@ -0,0 +1,208 @@
+#include "bench_harness.h"
+
+#include "audio/MP3Decoder.h"
+#include "audio/MP3Encoder.h"
+#include "audio/WAVDecoder.h"
+#include "audio/WAVEncoder.h"
+#include "extraction/PipelinedEncoder.h"
+#include "test_helpers.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sezo {
+namespace bench {
+
+namespace {
+
+constexpr int32_t kSampleRate = 48000;
+constexpr int32_t kChannels = 2;
+constexpr size_t kChunkFrames = 4096;
+
+// Decode loop matching the track's decode chunk; rewinds at end of file with
+// the timer paused so the seek cost is not counted.
+void RunDecode(BenchState& state, audio::AudioDecoder& decoder) {
+  const int32_t channels = decoder.GetFormat().channels;
+  std::vector<float> buffer(kChunkFrames * static_cast<size_t>(channels));
+  int64_t frames = 0;
+  while (state.KeepRunning()) {
+    size_t read = decoder.Read(buffer.data(), kChunkFrames);
+    if (read == 0) {
+      state.PauseTiming();
+      decoder.Seek(0);
+      state.ResumeTiming();
+      read = decoder.Read(buffer.data(), kChunkFrames);
+    }
+    DoNotOptimize(buffer[0]);
+    frames += static_cast<int64_t>(read);
+  }
+  state.SetItemsProcessed(frames);
+  state.SetBytesProcessed(frames * channels * static_cast<int64_t>(sizeof(float)));
+  const double seconds = static_cast<double>(state.Elapsed().count()) / 1e9;
+  if (seconds > 0.0) {
+    state.SetCounter("realtime_factor",
+                     static_cast<double>(frames) / decoder.GetFormat().sample_rate / seconds);
+  }
+}
+
+void RunWavDecode(BenchState& state, bool use_float, bool allow_memory_map) {
+  test::ScopedTempFile file(test::MakeTempPath("sezo_bench_decode", ".wav"));
+  if (!WriteTestWav(file.path(), kSampleRate, kChannels, 10.0, use_float)) {
+    state.SkipWithMessage("Failed to write source WAV");
+    return;
+  }
+  audio::WAVDecoder decoder(allow_memory_map);
+  if (!decoder.Open(file.path())) {
+    state.SkipWithMessage("Failed to open source WAV");
+    return;
+  }
+  RunDecode(state, decoder);
+  state.SetCounter("memory_mapped", decoder.IsMemoryMapped() ? 1.0 : 0.0);
+}
+
+void BM_WavS16Mapped(BenchState& state) { RunWavDecode(state, false, true); }
+void BM_WavS16Streamed(BenchState& state) { RunWavDecode(state, false, false); }
+void BM_WavF32Mapped(BenchState& state) { RunWavDecode(state, true, true); }
+void BM_WavF32Streamed(BenchState& state) { RunWavDecode(state, true, false); }
+
+void BM_Mp3Decode(BenchState& state) {
+  const std::string path = test::FixturePath("short.mp3");
+  if (!test::FileExists(path)) {
+    state.SkipWithMessage("Missing fixture: " + path);
+    return;
+  }
+  audio::MP3Decoder decoder;
+  if (!decoder.Open(path)) {
+    state.SkipWithMessage("Failed to open " + path);
+    return;
+  }
+  RunDecode(state, decoder);
+}
+
+// Encoder write throughput in extraction-sized chunks. The file is reopened
+// every minute of audio to keep disk usage bounded.
+void RunWavEncode(BenchState& state, int32_t bits_per_sample) {
+  test::ScopedTempFile file(test::MakeTempPath("sezo_bench_encode", ".wav"));
+  audio::EncoderConfig config;
+  config.format = audio::EncoderFormat::kWAV;
+  config.sample_rate = kSampleRate;
+  config.channels = kChannels;
+  config.bits_per_sample = bits_per_sample;
+
+  std::vector<float> chunk(kChunkFrames * kChannels);
+  FillTestSignal(chunk.data(), kChunkFrames, kChannels, kSampleRate);
+
+  auto encoder = std::make_unique<audio::WAVEncoder>();
+  if (!encoder->Open(file.path(), config)) {
+    state.SkipWithMessage("Failed to open encoder");
+    return;
+  }
+
+  int64_t frames = 0;
+  while (state.KeepRunning()) {
+    if (encoder->GetFramesWritten() >= 60 * kSampleRate) {
+      state.PauseTiming();
+      encoder->Close();
+      encoder = std::make_unique<audio::WAVEncoder>();
+      encoder->Open(file.path(), config);
+      state.ResumeTiming();
+    }
+    encoder->Write(chunk.data(), kChunkFrames);
+    frames += static_cast<int64_t>(kChunkFrames);
+  }
+  encoder->Close();
+
+  state.SetItemsProcessed(frames);
+  state.SetBytesProcessed(frames * kChannels * (bits_per_sample / 8));
+}
+
+void BM_WavEncode16(BenchState& state) { RunWavEncode(state, 16); }
+void BM_WavEncode24(BenchState& state) { RunWavEncode(state, 24); }
+
+std::unique_ptr<audio::AudioEncoder> MakeEncoder(audio::EncoderFormat format) {
+  if (format == audio::EncoderFormat::kMP3) {
+    return std::make_unique<audio::MP3Encoder>();
+  }
+  return std::make_unique<audio::WAVEncoder>();
+}
+
+// Extraction-shaped render + encode: each block is synthesized (a sine per
+// sample stands in for decode/stretch work) and then encoded. Arg is the
+// number of pooled blocks; 0 encodes on the render thread as before, so
+// comparing the two gives the speedup of overlapping them.
+void RunExtractEncode(BenchState& state, audio::EncoderFormat format) {
+  const bool mp3 = format == audio::EncoderFormat::kMP3;
+  test::ScopedTempFile file(test::MakeTempPath("sezo_bench_extract", mp3 ? ".mp3" : ".wav"));
+  audio::EncoderConfig config;
+  config.format = format;
+  config.sample_rate = kSampleRate;
+  config.channels = kChannels;
+  config.bitrate = 192000;
+  config.bits_per_sample = 16;
+
+  const size_t depth = static_cast<size_t>(state.Arg());
+  auto encoder = MakeEncoder(format);
+  if (!encoder->Open(file.path(), config)) {
+    state.SkipWithMessage(mp3 ? "MP3 encoder unavailable (built without LAME)"
+                              : "Failed to open encoder");
+    return;
+  }
+  auto pipeline = std::make_unique<extraction::PipelinedEncoder>(
+      encoder.get(), kChannels, kChunkFrames, depth);
+
+  int64_t frames = 0;
+  int64_t frames_in_file = 0;
+  while (state.KeepRunning()) {
+    if (frames_in_file >= 60 * kSampleRate) {
+      state.PauseTiming();
+      pipeline->Finish();
+      encoder->Close();
+      encoder = MakeEncoder(format);
+      encoder->Open(file.path(), config);
+      pipeline = std::make_unique<extraction::PipelinedEncoder>(
+          encoder.get(), kChannels, kChunkFrames, depth);
+      frames_in_file = 0;
+      state.ResumeTiming();
+    }
+    float* block = pipeline->AcquireBlock();
+    if (!block) {
+      state.SkipWithMessage("Encoder write failed");
+      return;
+    }
+    FillTestSignal(block, kChunkFrames, kChannels, kSampleRate);
+    pipeline->SubmitBlock(kChunkFrames);
+    frames += static_cast<int64_t>(kChunkFrames);
+    frames_in_file += static_cast<int64_t>(kChunkFrames);
+  }
+  // Drain inside the measurement so queued blocks are not free
+  state.ResumeTiming();
+  pipeline->Finish();
+  state.PauseTiming();
+  encoder->Close();
+
+  state.SetItemsProcessed(frames);
+  const double seconds = static_cast<double>(state.Elapsed().count()) / 1e9;
+  if (seconds > 0.0) {
+    state.SetCounter("realtime_factor", static_cast<double>(frames) / kSampleRate / seconds);
+  }
+  state.SetCounter("render_waits", static_cast<double>(pipeline->GetStats().render_waits));
+}
+
+void BM_ExtractWav(BenchState& state) { RunExtractEncode(state, audio::EncoderFormat::kWAV); }
+void BM_ExtractMp3(BenchState& state) { RunExtractEncode(state, audio::EncoderFormat::kMP3); }
+
+}  // namespace
+
+SEZO_BENCHMARK("decode/wav_s16_mmap", BM_WavS16Mapped);
+SEZO_BENCHMARK("decode/wav_s16_stream", BM_WavS16Streamed);
+SEZO_BENCHMARK("decode/wav_f32_mmap", BM_WavF32Mapped);
+SEZO_BENCHMARK("decode/wav_f32_stream", BM_WavF32Streamed);
+SEZO_BENCHMARK("decode/mp3", BM_Mp3Decode);
+SEZO_BENCHMARK("encode/wav_s16", BM_WavEncode16);
+SEZO_BENCHMARK("encode/wav_s24", BM_WavEncode24);
+SEZO_BENCHMARK("extract/wav", BM_ExtractWav, {0, 4});
+SEZO_BENCHMARK("extract/mp3", BM_ExtractMp3, {0, 4});
+
+}  // namespace bench
+}  // namespace sezo
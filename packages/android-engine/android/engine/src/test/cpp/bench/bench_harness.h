@@ -0,0 +1,130 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace sezo {
+namespace bench {
+
+/**
+ * Per-run state handed to a benchmark body.
+ *
+ * Usage mirrors Google Benchmark so the suite can move to it later:
+ *
+ *   while (state.KeepRunning()) { ... }
+ *   state.SetItemsProcessed(...);
+ */
+class BenchState {
+ public:
+  BenchState(int64_t arg, std::chrono::nanoseconds min_time, int64_t min_iterations);
+
+  /**
+   * Advance to the next timed iteration.
+   * @return false once enough time and iterations have been collected
+   */
+  bool KeepRunning();
+
+  /**
+   * Exclude setup work inside the loop from the measurement.
+   */
+  void PauseTiming();
+  void ResumeTiming();
+
+  /** Argument the benchmark was registered with (e.g. track count). */
+  int64_t Arg() const { return arg_; }
+
+  int64_t Iterations() const { return iterations_; }
+
+  /** Totals across all iterations; reported as per-second rates. */
+  void SetItemsProcessed(int64_t items) { items_processed_ = items; }
+  void SetBytesProcessed(int64_t bytes) { bytes_processed_ = bytes; }
+
+  /** Extra numbers reported verbatim (e.g. realtime factor, underruns). */
+  void SetCounter(const std::string& name, double value) { counters_[name] = value; }
+
+  /** Mark the run as skipped (e.g. missing fixture). */
+  void SkipWithMessage(const std::string& message);
+
+  std::chrono::nanoseconds Elapsed() const { return elapsed_; }
+  int64_t ItemsProcessed() const { return items_processed_; }
+  int64_t BytesProcessed() const { return bytes_processed_; }
+  const std::map<std::string, double>& Counters() const { return counters_; }
+  bool Skipped() const { return skipped_; }
+  const std::string& SkipMessage() const { return skip_message_; }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  int64_t arg_;
+  std::chrono::nanoseconds min_time_;
+  int64_t min_iterations_;
+  int64_t iterations_ = 0;
+  bool started_ = false;
+  bool paused_ = false;
+  Clock::time_point segment_start_;
+  std::chrono::nanoseconds elapsed_{0};
+  int64_t items_processed_ = 0;
+  int64_t bytes_processed_ = 0;
+  std::map<std::string, double> counters_;
+  bool skipped_ = false;
+  std::string skip_message_;
+};
+
+using BenchFunction = std::function<void(BenchState&)>;
+
+/**
+ * Register a benchmark, optionally once per argument ("name/arg").
+ * @param name Benchmark name
+ * @param function Benchmark body
+ * @param args Arguments; empty registers a single run with arg 0
+ * @return Always 0 (lets registration run from a static initializer)
+ */
+int RegisterBenchmark(const std::string& name,
+                      BenchFunction function,
+                      const std::vector<int64_t>& args = {});
+
+/**
+ * Keep the compiler from discarding a computed value.
+ */
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * Fill a buffer with a deterministic test signal (sine plus a little noise).
+ */
+void FillTestSignal(float* data, size_t frames, int32_t channels, int32_t sample_rate);
+
+/**
+ * Write a WAV file of the test signal.
+ * @param path Output path
+ * @param sample_rate Sample rate in Hz
+ * @param channels Channel count
+ * @param seconds Duration
+ * @param use_float Write IEEE float32 instead of PCM16
+ * @return true if successful
+ */
+bool WriteTestWav(const std::string& path,
+                  int32_t sample_rate,
+                  int32_t channels,
+                  double seconds,
+                  bool use_float);
+
+}  // namespace bench
+}  // namespace sezo
+
+#define SEZO_BENCH_CONCAT_INNER(a, b) a##b
+#define SEZO_BENCH_CONCAT(a, b) SEZO_BENCH_CONCAT_INNER(a, b)
+
+/**
+ * Register a benchmark from file scope:
+ *   SEZO_BENCHMARK("mixer/mix", BM_Mix, {1, 2, 4});
+ */
+#define SEZO_BENCHMARK(name, function, ...) \
+  static const int SEZO_BENCH_CONCAT(sezo_bench_registered_, __LINE__) = \
+      ::sezo::bench::RegisterBenchmark(name, function, ##__VA_ARGS__)
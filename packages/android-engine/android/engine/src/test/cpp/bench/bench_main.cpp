@@ -0,0 +1,298 @@
+#include "bench_harness.h"
+
+#include "dsp/MixKernels.h"
+
+#include "dr_wav.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+namespace sezo {
+namespace bench {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+struct Registration {
+  std::string name;
+  BenchFunction function;
+  int64_t arg = 0;
+};
+
+std::vector<Registration>& Registry() {
+  static std::vector<Registration> registry;
+  return registry;
+}
+
+struct Options {
+  std::string filter;
+  std::string output_path;
+  std::chrono::nanoseconds min_time = std::chrono::milliseconds(200);
+  bool list_only = false;
+};
+
+bool ParseArgs(int argc, char** argv, Options* options) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg.rfind("--filter=", 0) == 0) {
+      options->filter = arg.substr(9);
+    } else if (arg.rfind("--out=", 0) == 0) {
+      options->output_path = arg.substr(6);
+    } else if (arg.rfind("--min_time_ms=", 0) == 0) {
+      options->min_time = std::chrono::milliseconds(std::atoll(arg.c_str() + 14));
+    } else if (arg == "--list") {
+      options->list_only = true;
+    } else {
+      std::fprintf(stderr,
+                   "Usage: %s [--filter=SUBSTRING] [--min_time_ms=N] [--out=FILE.json] [--list]\n",
+                   argv[0]);
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string JsonEscape(const std::string& value) {
+  std::string escaped;
+  escaped.reserve(value.size());
+  for (char c : value) {
+    switch (c) {
+      case '"': escaped += "\\\""; break;
+      case '\\': escaped += "\\\\"; break;
+      case '\n': escaped += "\\n"; break;
+      case '\t': escaped += "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char buffer[8];
+          std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+          escaped += buffer;
+        } else {
+          escaped += c;
+        }
+    }
+  }
+  return escaped;
+}
+
+std::string JsonNumber(double value) {
+  if (!std::isfinite(value)) {
+    return "null";
+  }
+  std::ostringstream out;
+  out.precision(10);
+  out << value;
+  return out.str();
+}
+
+std::string CurrentDate() {
+  const std::time_t now = std::time(nullptr);
+  std::tm utc{};
+  gmtime_r(&now, &utc);
+  char buffer[32];
+  std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &utc);
+  return buffer;
+}
+
+}  // namespace
+
+BenchState::BenchState(int64_t arg, std::chrono::nanoseconds min_time, int64_t min_iterations)
+    : arg_(arg), min_time_(min_time), min_iterations_(min_iterations) {}
+
+bool BenchState::KeepRunning() {
+  if (skipped_) {
+    return false;
+  }
+  if (!started_) {
+    started_ = true;
+    segment_start_ = Clock::now();
+    return true;
+  }
+  ++iterations_;
+  const auto elapsed = paused_ ? elapsed_ : elapsed_ + (Clock::now() - segment_start_);
+  if (elapsed >= min_time_ && iterations_ >= min_iterations_) {
+    if (!paused_) {
+      elapsed_ += Clock::now() - segment_start_;
+      paused_ = true;
+    }
+    return false;
+  }
+  return true;
+}
+
+void BenchState::PauseTiming() {
+  if (!paused_) {
+    elapsed_ += Clock::now() - segment_start_;
+    paused_ = true;
+  }
+}
+
+void BenchState::ResumeTiming() {
+  if (paused_) {
+    paused_ = false;
+    segment_start_ = Clock::now();
+  }
+}
+
+void BenchState::SkipWithMessage(const std::string& message) {
+  skipped_ = true;
+  skip_message_ = message;
+}
+
+int RegisterBenchmark(const std::string& name,
+                      BenchFunction function,
+                      const std::vector<int64_t>& args) {
+  if (args.empty()) {
+    Registry().push_back({name, function, 0});
+  } else {
+    for (int64_t arg : args) {
+      Registry().push_back({name + "/" + std::to_string(arg), function, arg});
+    }
+  }
+  return 0;
+}
+
+void FillTestSignal(float* data, size_t frames, int32_t channels, int32_t sample_rate) {
+  uint32_t noise = 0x12345678u;
+  for (size_t i = 0; i < frames; ++i) {
+    const double t = static_cast<double>(i) / static_cast<double>(sample_rate);
+    for (int32_t c = 0; c < channels; ++c) {
+      noise = noise * 1664525u + 1013904223u;
+      const float dither = (static_cast<float>(noise >> 8) / 16777216.0f - 0.5f) * 0.01f;
+      data[i * channels + c] =
+          static_cast<float>(0.4 * std::sin(2.0 * kPi * (440.0 + 110.0 * c) * t)) + dither;
+    }
+  }
+}
+
+bool WriteTestWav(const std::string& path,
+                  int32_t sample_rate,
+                  int32_t channels,
+                  double seconds,
+                  bool use_float) {
+  drwav_data_format format;
+  format.container = drwav_container_riff;
+  format.format = use_float ? DR_WAVE_FORMAT_IEEE_FLOAT : DR_WAVE_FORMAT_PCM;
+  format.channels = static_cast<drwav_uint32>(channels);
+  format.sampleRate = static_cast<drwav_uint32>(sample_rate);
+  format.bitsPerSample = use_float ? 32 : 16;
+
+  drwav wav;
+  if (!drwav_init_file_write(&wav, path.c_str(), &format, nullptr)) {
+    return false;
+  }
+
+  const size_t frames = static_cast<size_t>(seconds * sample_rate);
+  std::vector<float> samples(frames * static_cast<size_t>(channels));
+  FillTestSignal(samples.data(), frames, channels, sample_rate);
+  drwav_uint64 written = 0;
+  if (use_float) {
+    written = drwav_write_pcm_frames(&wav, frames, samples.data());
+  } else {
+    std::vector<int16_t> pcm(samples.size());
+    for (size_t i = 0; i < samples.size(); ++i) {
+      pcm[i] = static_cast<int16_t>(std::lrint(samples[i] * 32767.0f));
+    }
+    written = drwav_write_pcm_frames(&wav, frames, pcm.data());
+  }
+  drwav_uninit(&wav);
+  return written == frames;
+}
+
+}  // namespace bench
+}  // namespace sezo
+
+int main(int argc, char** argv) {
+  using namespace sezo::bench;
+
+  Options options;
+  if (!ParseArgs(argc, argv, &options)) {
+    return 2;
+  }
+
+  std::ostringstream json;
+  json << "{\n  \"context\": {\n"
+       << "    \"date\": \"" << CurrentDate() << "\",\n"
+       << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+       << "    \"mix_kernels\": \"" << JsonEscape(sezo::dsp::GetMixKernels().name) << "\",\n"
+#if defined(NDEBUG)
+       << "    \"build_type\": \"release\",\n"
+#else
+       << "    \"build_type\": \"debug\",\n"
+#endif
+       << "    \"compiler\": \"" << JsonEscape(__VERSION__) << "\",\n"
+       << "    \"min_time_ms\": "
+       << std::chrono::duration_cast<std::chrono::milliseconds>(options.min_time).count() << "\n"
+       << "  },\n  \"benchmarks\": [";
+
+  bool first = true;
+  for (const auto& registration : Registry()) {
+    if (!options.filter.empty() && registration.name.find(options.filter) == std::string::npos) {
+      continue;
+    }
+    if (options.list_only) {
+      std::cout << registration.name << "\n";
+      continue;
+    }
+
+    BenchState state(registration.arg, options.min_time, 1);
+    registration.function(state);
+
+    const double seconds = std::chrono::duration<double>(state.Elapsed()).count();
+    const int64_t iterations = state.Iterations();
+    json << (first ? "\n" : ",\n") << "    {\n"
+         << "      \"name\": \"" << JsonEscape(registration.name) << "\",\n";
+    first = false;
+    if (state.Skipped()) {
+      json << "      \"skipped\": true,\n"
+           << "      \"message\": \"" << JsonEscape(state.SkipMessage()) << "\"\n    }";
+      std::fprintf(stderr, "%-40s skipped: %s\n", registration.name.c_str(),
+                   state.SkipMessage().c_str());
+      continue;
+    }
+
+    const double ns_per_iteration =
+        iterations > 0 ? seconds * 1e9 / static_cast<double>(iterations) : 0.0;
+    json << "      \"iterations\": " << iterations << ",\n"
+         << "      \"real_time_ns\": " << JsonNumber(ns_per_iteration);
+    if (state.ItemsProcessed() > 0 && seconds > 0.0) {
+      json << ",\n      \"items_per_second\": "
+           << JsonNumber(static_cast<double>(state.ItemsProcessed()) / seconds);
+    }
+    if (state.BytesProcessed() > 0 && seconds > 0.0) {
+      json << ",\n      \"bytes_per_second\": "
+           << JsonNumber(static_cast<double>(state.BytesProcessed()) / seconds);
+    }
+    for (const auto& counter : state.Counters()) {
+      json << ",\n      \"" << JsonEscape(counter.first) << "\": " << JsonNumber(counter.second);
+    }
+    json << "\n    }";
+
+    std::fprintf(stderr, "%-40s %12.0f ns/iter %10lld iters\n", registration.name.c_str(),
+                 ns_per_iteration, static_cast<long long>(iterations));
+  }
+  json << "\n  ]\n}\n";
+
+  if (options.list_only) {
+    return 0;
+  }
+  if (options.output_path.empty()) {
+    std::cout << json.str();
+  } else {
+    std::ofstream out(options.output_path);
+    if (!out) {
+      std::fprintf(stderr, "Failed to write %s\n", options.output_path.c_str());
+      return 1;
+    }
+    out << json.str();
+  }
+  return 0;
+}
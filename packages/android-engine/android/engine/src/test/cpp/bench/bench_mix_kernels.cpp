@@ -0,0 +1,110 @@
+#include "bench_harness.h"
+
+#include "dsp/MixKernels.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sezo {
+namespace bench {
+
+namespace {
+
+constexpr int32_t kSampleRate = 48000;
+
+// Each kernel is registered once per table from GetAvailableMixKernels(), so
+// "mix_kernels/<kernel>/scalar/N" sits next to the SIMD runs of the same N in
+// the JSON output. Inputs stay in cache; this measures the kernels alone.
+struct KernelBuffers {
+  explicit KernelBuffers(size_t frames)
+      : mono(frames), stereo(frames * 2), out(frames * 2, 0.0f) {
+    FillTestSignal(mono.data(), frames, 1, kSampleRate);
+    FillTestSignal(stereo.data(), frames, 2, kSampleRate);
+  }
+
+  std::vector<float> mono;
+  std::vector<float> stereo;
+  std::vector<float> out;
+};
+
+void SetRates(BenchState& state, size_t frames, size_t bytes_per_frame) {
+  state.SetItemsProcessed(state.Iterations() * static_cast<int64_t>(frames));
+  state.SetBytesProcessed(state.Iterations() * static_cast<int64_t>(frames * bytes_per_frame));
+}
+
+void BM_AccumulateMonoToStereo(BenchState& state, const dsp::MixKernels& kernels) {
+  const size_t frames = static_cast<size_t>(state.Arg());
+  KernelBuffers buffers(frames);
+  while (state.KeepRunning()) {
+    kernels.accumulate_mono_to_stereo(buffers.out.data(), buffers.mono.data(), frames,
+                                      0.5f, 0.25f);
+    DoNotOptimize(buffers.out[0]);
+  }
+  SetRates(state, frames, 3 * sizeof(float));
+}
+
+void BM_AccumulateStereo(BenchState& state, const dsp::MixKernels& kernels) {
+  const size_t frames = static_cast<size_t>(state.Arg());
+  KernelBuffers buffers(frames);
+  while (state.KeepRunning()) {
+    kernels.accumulate_stereo(buffers.out.data(), buffers.stereo.data(), frames, 0.5f, 0.25f);
+    DoNotOptimize(buffers.out[0]);
+  }
+  SetRates(state, frames, 4 * sizeof(float));
+}
+
+// Gains alternate so the buffer neither decays to denormals nor overflows.
+void BM_ScaleStereo(BenchState& state, const dsp::MixKernels& kernels) {
+  const size_t frames = static_cast<size_t>(state.Arg());
+  KernelBuffers buffers(frames);
+  bool up = false;
+  while (state.KeepRunning()) {
+    const float gain = up ? 2.0f : 0.5f;
+    kernels.scale_stereo(buffers.stereo.data(), frames, gain, gain);
+    up = !up;
+    DoNotOptimize(buffers.stereo[0]);
+  }
+  SetRates(state, frames, 2 * sizeof(float));
+}
+
+// Gain above 1 so the clip branch is taken for part of the signal.
+void BM_ApplyGainAndClip(BenchState& state, const dsp::MixKernels& kernels) {
+  const size_t frames = static_cast<size_t>(state.Arg());
+  KernelBuffers buffers(frames);
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    buffers.out = buffers.stereo;
+    state.ResumeTiming();
+    kernels.apply_gain_and_clip(buffers.out.data(), frames * 2, 1.5f);
+    DoNotOptimize(buffers.out[0]);
+  }
+  SetRates(state, frames, 2 * sizeof(float));
+}
+
+using KernelBench = void (*)(BenchState&, const dsp::MixKernels&);
+
+int RegisterKernelBenchmarks() {
+  const std::vector<std::pair<const char*, KernelBench>> benches = {
+      {"accumulate_mono_to_stereo", BM_AccumulateMonoToStereo},
+      {"accumulate_stereo", BM_AccumulateStereo},
+      {"scale_stereo", BM_ScaleStereo},
+      {"apply_gain_and_clip", BM_ApplyGainAndClip},
+  };
+  for (const auto& bench : benches) {
+    for (const dsp::MixKernels* kernels : dsp::GetAvailableMixKernels()) {
+      const KernelBench function = bench.second;
+      RegisterBenchmark(std::string("mix_kernels/") + bench.first + "/" + kernels->name,
+                        [function, kernels](BenchState& state) { function(state, *kernels); },
+                        {256, 4096});
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+static const int kKernelBenchmarksRegistered = RegisterKernelBenchmarks();
+
+}  // namespace bench
+}  // namespace sezo
@@ -0,0 +1,184 @@
+#include "bench_harness.h"
+
+#include "playback/MultiTrackMixer.h"
+#include "playback/Track.h"
+#include "test_helpers.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sezo {
+namespace bench {
+
+namespace {
+
+constexpr int32_t kSampleRate = 48000;
+constexpr size_t kBlockFrames = 256;
+constexpr double kSourceSeconds = 10.0;
+
+// Seek everything back to the start a second before the source runs out, so
+// no iteration mixes an exhausted track.
+constexpr int64_t kRewindFrames = static_cast<int64_t>((kSourceSeconds - 1.0) * kSampleRate);
+
+bool WaitUntilPrimed(const std::vector<std::shared_ptr<playback::Track>>& tracks) {
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  for (const auto& track : tracks) {
+    while (!track->IsPrimed(kBlockFrames)) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        return false;
+      }
+      std::this_thread::yield();
+    }
+  }
+  return true;
+}
+
+// Full callback path: per-track buffer reads, gain ramps and summing. The
+// decode pool runs alongside, as on device; time spent waiting for it is
+// excluded so the figure is the audio thread's cost alone.
+void RunMix(BenchState& state, bool planar, float stretch, bool master_bus = false,
+            bool stretch_ahead = false, bool varispeed = false, size_t render_workers = 0) {
+  const size_t track_count = static_cast<size_t>(state.Arg());
+  test::ScopedTempDir dir(test::MakeTempPath("sezo_bench_mix", ""));
+  const std::string path = dir.path() + "/source.wav";
+  if (!WriteTestWav(path, kSampleRate, 2, kSourceSeconds, true)) {
+    state.SkipWithMessage("Failed to write source WAV");
+    return;
+  }
+
+  playback::MultiTrackMixer mixer;
+  if (master_bus) {
+    mixer.ConfigureMasterStretch(kSampleRate);
+    mixer.SetMasterStretch(0.0f, stretch);
+    mixer.SetMasterVarispeed(varispeed);
+  }
+  if (render_workers > 0) {
+    mixer.SetParallelRender(true, kSampleRate, render_workers);
+  }
+  std::vector<std::shared_ptr<playback::Track>> tracks;
+  for (size_t i = 0; i < track_count; ++i) {
+    auto track = std::make_shared<playback::Track>("track_" + std::to_string(i), path);
+    track->SetPlanar(planar);
+    track->SetVarispeed(varispeed);
+    track->SetStretchAhead(stretch_ahead, kSampleRate * 150 / 1000);
+    if (!track->Load()) {
+      state.SkipWithMessage("Failed to load track");
+      return;
+    }
+    track->SetPan(i % 2 == 0 ? -0.25f : 0.25f);
+    track->SetStretchFactor(stretch);
+    track->SetStretchOnMasterBus(master_bus);
+    mixer.AddTrack(track);
+    tracks.push_back(track);
+  }
+
+  std::vector<float> output(kBlockFrames * 2);
+  int64_t timeline = 0;
+  int64_t waits_failed = 0;
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    if (timeline >= kRewindFrames) {
+      for (auto& track : tracks) {
+        track->Seek(0);
+      }
+      timeline = 0;
+    }
+    if (!WaitUntilPrimed(tracks)) {
+      ++waits_failed;
+    }
+    state.ResumeTiming();
+
+    mixer.Mix(output.data(), kBlockFrames, timeline);
+    DoNotOptimize(output[0]);
+    timeline += static_cast<int64_t>(kBlockFrames);
+  }
+
+  uint64_t starvation = 0;
+  for (const auto& track : tracks) {
+    starvation += track->GetStarvationCount();
+  }
+
+  const int64_t frames = state.Iterations() * static_cast<int64_t>(kBlockFrames);
+  state.SetItemsProcessed(frames * static_cast<int64_t>(track_count));
+  const double seconds = static_cast<double>(state.Elapsed().count()) / 1e9;
+  if (seconds > 0.0) {
+    state.SetCounter("realtime_factor",
+                     static_cast<double>(frames) / kSampleRate / seconds);
+  }
+  state.SetCounter("starvation", static_cast<double>(starvation));
+  state.SetCounter("prime_timeouts", static_cast<double>(waits_failed));
+  if (render_workers > 0) {
+    const auto render = mixer.GetParallelRenderStats();
+    const uint64_t rendered = render.pool.tasks_on_workers + render.pool.tasks_on_caller;
+    state.SetCounter("worker_task_share",
+                     rendered > 0 ? static_cast<double>(render.pool.tasks_on_workers) /
+                                        static_cast<double>(rendered)
+                                  : 0.0);
+    state.SetCounter("late_batches", static_cast<double>(render.pool.late_batches));
+  }
+}
+
+void BM_Mix(BenchState& state) {
+  RunMix(state, false, 1.0f);
+}
+
+// Same, with stereo carried as left/right planes up to the final mix
+void BM_MixPlanar(BenchState& state) {
+  RunMix(state, true, 1.0f);
+}
+
+void BM_MixStretched(BenchState& state) {
+  RunMix(state, false, 1.25f);
+}
+
+void BM_MixPlanarStretched(BenchState& state) {
+  RunMix(state, true, 1.25f);
+}
+
+// Same speed change rendered once on the summed master bus
+void BM_MixMasterBusStretched(BenchState& state) {
+  RunMix(state, false, 1.25f, true);
+}
+
+// Same speed change rendered ahead on the decode pool; the callback only mixes
+void BM_MixStretchedAhead(BenchState& state) {
+  RunMix(state, false, 1.25f, false, true);
+}
+
+// Same speed change as a varispeed resample, pitch following speed
+void BM_MixVarispeed(BenchState& state) {
+  RunMix(state, false, 1.25f, false, false, true);
+}
+
+// Stretched tracks rendered across the audio thread plus N pool workers;
+// compare against mix_stretched to see scaling with core count
+void BM_MixStretchedParallel1(BenchState& state) {
+  RunMix(state, false, 1.25f, false, false, false, 1);
+}
+
+void BM_MixStretchedParallel3(BenchState& state) {
+  RunMix(state, false, 1.25f, false, false, false, 3);
+}
+
+void BM_MixStretchedParallel7(BenchState& state) {
+  RunMix(state, false, 1.25f, false, false, false, 7);
+}
+
+}  // namespace
+
+SEZO_BENCHMARK("mixer/mix", BM_Mix, {1, 2, 4, 8, 16, 32, 64});
+SEZO_BENCHMARK("mixer/mix_planar", BM_MixPlanar, {1, 2, 4, 8, 16, 32, 64});
+SEZO_BENCHMARK("mixer/mix_stretched", BM_MixStretched, {1, 4, 16});
+SEZO_BENCHMARK("mixer/mix_planar_stretched", BM_MixPlanarStretched, {1, 4, 16});
+SEZO_BENCHMARK("mixer/mix_master_bus_stretched", BM_MixMasterBusStretched, {1, 4, 16});
+SEZO_BENCHMARK("mixer/mix_stretched_ahead", BM_MixStretchedAhead, {1, 4, 16});
+SEZO_BENCHMARK("mixer/mix_varispeed", BM_MixVarispeed, {1, 4, 16});
+SEZO_BENCHMARK("mixer/mix_stretched_parallel_1w", BM_MixStretchedParallel1, {4, 16, 24});
+SEZO_BENCHMARK("mixer/mix_stretched_parallel_3w", BM_MixStretchedParallel3, {4, 16, 24});
+SEZO_BENCHMARK("mixer/mix_stretched_parallel_7w", BM_MixStretchedParallel7, {4, 16, 24});
+
+}  // namespace bench
+}  // namespace sezo
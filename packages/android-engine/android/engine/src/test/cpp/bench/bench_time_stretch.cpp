@@ -0,0 +1,76 @@
+#include "bench_harness.h"
+
+#include "playback/TimeStretch.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace sezo {
+namespace bench {
+
+namespace {
+
+constexpr int32_t kSampleRate = 48000;
+constexpr int32_t kChannels = 2;
+constexpr size_t kBlockFrames = 512;
+
+struct StretchSetting {
+  const char* name;
+  float pitch_semitones;
+  float stretch_factor;
+};
+
+// Realtime cost of one track's pitch/tempo processing at callback block size.
+// Output frames are fixed; input grows with the stretch factor as in Track.
+void RunTimeStretch(BenchState& state, const StretchSetting& setting) {
+  playback::TimeStretch stretcher(kSampleRate, kChannels);
+  stretcher.SetPitchSemitones(setting.pitch_semitones);
+  stretcher.SetStretchFactor(setting.stretch_factor);
+
+  const size_t input_frames = static_cast<size_t>(
+      std::ceil(static_cast<double>(kBlockFrames) * setting.stretch_factor));
+  std::vector<float> input(input_frames * kChannels);
+  FillTestSignal(input.data(), input_frames, kChannels, kSampleRate);
+  std::vector<float> output(kBlockFrames * kChannels);
+
+  while (state.KeepRunning()) {
+    stretcher.Process(input.data(), input_frames, output.data(), kBlockFrames);
+    DoNotOptimize(output[0]);
+  }
+
+  const int64_t frames = state.Iterations() * static_cast<int64_t>(kBlockFrames);
+  state.SetItemsProcessed(frames);
+  const double seconds = static_cast<double>(state.Elapsed().count()) / 1e9;
+  if (seconds > 0.0) {
+    state.SetCounter("realtime_factor",
+                     static_cast<double>(frames) / kSampleRate / seconds);
+  }
+  state.SetCounter("active", stretcher.IsActive() ? 1.0 : 0.0);
+}
+
+const StretchSetting kSettings[] = {
+    {"bypass", 0.0f, 1.0f},
+    {"pitch_up4", 4.0f, 1.0f},
+    {"pitch_down4", -4.0f, 1.0f},
+    {"pitch_up12", 12.0f, 1.0f},
+    {"stretch_0.5", 0.0f, 0.5f},
+    {"stretch_1.5", 0.0f, 1.5f},
+    {"stretch_2.0", 0.0f, 2.0f},
+    {"pitch_up3_stretch_1.25", 3.0f, 1.25f},
+};
+
+int RegisterTimeStretchBenchmarks() {
+  for (const auto& setting : kSettings) {
+    RegisterBenchmark(std::string("time_stretch/") + setting.name,
+                      [setting](BenchState& state) { RunTimeStretch(state, setting); });
+  }
+  return 0;
+}
+
+}  // namespace
+
+static const int kTimeStretchRegistered = RegisterTimeStretchBenchmarks();
+
+}  // namespace bench
+}  // namespace sezo
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include "core/CallbackStats.h"
+
+#include <cmath>
+
+namespace sezo {
+namespace core {
+
+namespace {
+
+constexpr int32_t kSampleRate = 48000;
+constexpr int32_t kFrames = 480;  // 10 ms period
+
+void RecordDurationUs(CallbackStats& stats, int64_t start_us, int64_t duration_us) {
+  stats.Record(start_us * 1000, (start_us + duration_us) * 1000, kFrames, kSampleRate);
+}
+
+}  // namespace
+
+TEST(CallbackStatsTest, EmptySnapshotIsZero) {
+  CallbackStats stats;
+  const auto snapshot = stats.GetSnapshot();
+  EXPECT_EQ(snapshot.callbacks, 0u);
+  EXPECT_DOUBLE_EQ(snapshot.p99_duration_us, 0.0);
+  EXPECT_DOUBLE_EQ(snapshot.mean_duration_us, 0.0);
+}
+
+TEST(CallbackStatsTest, PercentilesFollowDistribution) {
+  CallbackStats stats;
+  int64_t start_us = 1000;
+  // 990 fast callbacks at 100 us and 10 slow ones at 5 ms.
+  for (int i = 0; i < 990; ++i) {
+    RecordDurationUs(stats, start_us, 100);
+    start_us += 10000;
+  }
+  for (int i = 0; i < 10; ++i) {
+    RecordDurationUs(stats, start_us, 5000);
+    start_us += 10000;
+  }
+
+  const auto snapshot = stats.GetSnapshot();
+  EXPECT_EQ(snapshot.callbacks, 1000u);
+  EXPECT_EQ(snapshot.frames, 1000u * kFrames);
+  EXPECT_NEAR(snapshot.period_us, 10000.0, 1e-6);
+  EXPECT_NEAR(snapshot.max_duration_us, 5000.0, 1e-6);
+  EXPECT_NEAR(snapshot.mean_duration_us, 149.0, 1e-6);
+
+  // Within one bucket (a quarter octave) of the true value.
+  EXPECT_GT(snapshot.p50_duration_us, 100.0 / 1.19);
+  EXPECT_LT(snapshot.p50_duration_us, 100.0 * 1.19);
+  EXPECT_GT(snapshot.p999_duration_us, 5000.0 / 1.19);
+  EXPECT_LE(snapshot.p999_duration_us, 5000.0);
+
+  EXPECT_NEAR(snapshot.p50_load_percent, 1.0, 2.5);
+  EXPECT_NEAR(snapshot.max_load_percent, 50.0, 1e-6);
+  EXPECT_EQ(snapshot.deadline_misses, 0u);
+  EXPECT_NEAR(snapshot.max_interval_us, 10000.0, 1e-6);
+
+  uint64_t histogram_total = 0;
+  for (uint64_t count : snapshot.duration_histogram) {
+    histogram_total += count;
+  }
+  EXPECT_EQ(histogram_total, 1000u);
+}
+
+TEST(CallbackStatsTest, CountsDeadlineMissesAndOverflow) {
+  CallbackStats stats;
+  RecordDurationUs(stats, 1000, 12000);      // over the 10 ms period
+  RecordDurationUs(stats, 20000, 1000000);   // far past the last bucket
+  const auto snapshot = stats.GetSnapshot();
+  EXPECT_EQ(snapshot.deadline_misses, 2u);
+  EXPECT_EQ(snapshot.duration_histogram[CallbackStats::kDurationBuckets - 1], 1u);
+  EXPECT_NEAR(snapshot.max_duration_us, 1000000.0, 1e-6);
+  EXPECT_LE(snapshot.p99_duration_us, snapshot.max_duration_us);
+  EXPECT_TRUE(std::isinf(CallbackStats::DurationBucketUpperUs(CallbackStats::kDurationBuckets - 1)));
+}
+
+TEST(CallbackStatsTest, MarkIdleSkipsIntervalAndResetClears) {
+  CallbackStats stats;
+  RecordDurationUs(stats, 1000, 50);
+  stats.MarkIdle();
+  RecordDurationUs(stats, 5000000, 50);  // after a long pause
+  RecordDurationUs(stats, 5010000, 50);
+  EXPECT_NEAR(stats.GetSnapshot().max_interval_us, 10000.0, 1e-6);
+
+  stats.Reset();
+  const auto snapshot = stats.GetSnapshot();
+  EXPECT_EQ(snapshot.callbacks, 0u);
+  EXPECT_EQ(snapshot.deadline_misses, 0u);
+  EXPECT_DOUBLE_EQ(snapshot.max_duration_us, 0.0);
+}
+
+}  // namespace core
+}  // namespace sezo
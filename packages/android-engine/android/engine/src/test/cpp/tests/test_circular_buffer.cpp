@@ -2,6 +2,10 @@
 
 #include "core/CircularBuffer.h"
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 namespace sezo {
 namespace core {
 
@@ -29,7 +33,7 @@ TEST(CircularBufferTest, WrapAroundPreservesOrder) {
 TEST(CircularBufferTest, AvailableAndFreeSpaceInvariants) {
   const size_t capacity = 8;
   CircularBuffer buffer(capacity);
-  const size_t expected_total = capacity - 1;
+  const size_t expected_total = capacity;
 
   auto expect_invariant = [&]() {
     EXPECT_EQ(buffer.Available() + buffer.FreeSpace(), expected_total);
@@ -65,7 +69,7 @@ TEST(CircularBufferTest, ResetClearsReadWritePositions) {
 
   buffer.Reset();
   EXPECT_EQ(buffer.Available(), 0u);
-  EXPECT_EQ(buffer.FreeSpace(), 5u);
+  EXPECT_EQ(buffer.FreeSpace(), 6u);
   EXPECT_EQ(buffer.Read(output, 4), 0u);
 
   EXPECT_EQ(buffer.Write(input, 2), 2u);
@@ -74,5 +78,114 @@ TEST(CircularBufferTest, ResetClearsReadWritePositions) {
   EXPECT_FLOAT_EQ(output[1], input[1]);
 }
 
+TEST(CircularBufferTest, FullCapacityIsUsable) {
+  CircularBuffer buffer(6);
+  float input[8] = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f};
+  EXPECT_EQ(buffer.Write(input, 8), 6u);
+  EXPECT_EQ(buffer.Available(), 6u);
+  EXPECT_EQ(buffer.FreeSpace(), 0u);
+  EXPECT_EQ(buffer.Write(input, 1), 0u);
+}
+
+TEST(CircularBufferTest, CapacityRoundsDownToWholeFrames) {
+  CircularBuffer buffer(11, 2);
+  EXPECT_EQ(buffer.Capacity(), 10u);
+  EXPECT_EQ(buffer.FrameSize(), 2u);
+  std::vector<float> input(12, 1.0f);
+  EXPECT_EQ(buffer.Write(input.data(), input.size()), 10u);
+}
+
+TEST(CircularBufferTest, SpansSplitAtWrapAndCommitInPlace) {
+  CircularBuffer buffer(8);
+  float input[6] = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  float output[6] = {};
+  ASSERT_EQ(buffer.Write(input, 6), 6u);
+  ASSERT_EQ(buffer.Read(output, 6), 6u);
+
+  // Positions are now 6 of 8: a 5-sample span wraps after 2
+  auto write_span = buffer.AcquireWrite(5);
+  ASSERT_EQ(write_span.size(), 5u);
+  EXPECT_EQ(write_span.first_count, 2u);
+  EXPECT_EQ(write_span.second_count, 3u);
+  for (size_t i = 0; i < write_span.first_count; ++i) {
+    write_span.first[i] = 10.0f + static_cast<float>(i);
+  }
+  for (size_t i = 0; i < write_span.second_count; ++i) {
+    write_span.second[i] = 12.0f + static_cast<float>(i);
+  }
+  buffer.CommitWrite(4);  // publish only part of the span
+  EXPECT_EQ(buffer.Available(), 4u);
+
+  auto read_span = buffer.AcquireRead(8);
+  ASSERT_EQ(read_span.size(), 4u);
+  EXPECT_EQ(read_span.first_count, 2u);
+  EXPECT_FLOAT_EQ(read_span.first[0], 10.0f);
+  EXPECT_FLOAT_EQ(read_span.first[1], 11.0f);
+  EXPECT_FLOAT_EQ(read_span.second[0], 12.0f);
+  EXPECT_FLOAT_EQ(read_span.second[1], 13.0f);
+  buffer.CommitRead(3);
+  EXPECT_EQ(buffer.Available(), 1u);
+  EXPECT_EQ(buffer.Read(output, 2), 1u);
+  EXPECT_FLOAT_EQ(output[0], 13.0f);
+}
+
+TEST(CircularBufferTest, ResetDuringReadSpanDiscardsOldData) {
+  CircularBuffer buffer(8);
+  float input[4] = {1.0f, 2.0f, 3.0f, 4.0f};
+  ASSERT_EQ(buffer.Write(input, 4), 4u);
+
+  auto span = buffer.AcquireRead(2);
+  ASSERT_EQ(span.size(), 2u);
+  buffer.Reset();
+  buffer.CommitRead(span.size());  // must not undo the reset
+  EXPECT_EQ(buffer.Available(), 0u);
+
+  float fresh[2] = {9.0f, 8.0f};
+  float output[4] = {};
+  ASSERT_EQ(buffer.Write(fresh, 2), 2u);
+  EXPECT_EQ(buffer.Read(output, 4), 2u);
+  EXPECT_FLOAT_EQ(output[0], 9.0f);
+  EXPECT_FLOAT_EQ(output[1], 8.0f);
+}
+
+TEST(CircularBufferTest, ProducerConsumerPreservesSequence) {
+  CircularBuffer buffer(1000, 2);
+  constexpr size_t kTotal = 200000;
+  std::thread producer([&buffer] {
+    size_t next = 0;
+    while (next < kTotal) {
+      auto span = buffer.AcquireWrite(std::min<size_t>(96, kTotal - next));
+      for (size_t i = 0; i < span.first_count; ++i) {
+        span.first[i] = static_cast<float>(next++);
+      }
+      for (size_t i = 0; i < span.second_count; ++i) {
+        span.second[i] = static_cast<float>(next++);
+      }
+      buffer.CommitWrite(span.size());
+      if (span.size() == 0) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  size_t expected = 0;
+  bool in_order = true;
+  std::vector<float> block(128);
+  while (expected < kTotal) {
+    const size_t read = buffer.Read(block.data(), block.size());
+    for (size_t i = 0; i < read; ++i) {
+      if (block[i] != static_cast<float>(expected++)) {
+        in_order = false;
+      }
+    }
+    if (read == 0) {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  EXPECT_TRUE(in_order);
+  EXPECT_EQ(expected, kTotal);
+}
+
 }  // namespace core
 }  // namespace sezo
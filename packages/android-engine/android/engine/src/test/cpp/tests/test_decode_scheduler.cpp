@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "playback/DecodeScheduler.h"
+
+namespace sezo {
+namespace playback {
+
+namespace {
+
+class FakeClient : public DecodeScheduler::Client {
+ public:
+  FakeClient(int id, int capacity, std::vector<int>* order, std::mutex* order_mutex)
+      : id_(id), capacity_(capacity), order_(order), order_mutex_(order_mutex) {}
+
+  float GetFillRatio() const override {
+    return static_cast<float>(fill_.load()) / static_cast<float>(capacity_);
+  }
+
+  bool NeedsDecode() const override { return enabled_.load() && fill_.load() < capacity_; }
+
+  void DecodeChunk() override {
+    in_decode_.store(true);
+    if (decode_delay_ms_ > 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(decode_delay_ms_));
+    }
+    {
+      std::lock_guard<std::mutex> lock(*order_mutex_);
+      order_->push_back(id_);
+    }
+    fill_.fetch_add(1);
+    in_decode_.store(false);
+  }
+
+  uint64_t GetStarvationCount() const override { return 3; }
+
+  void Drain(int amount) { fill_.fetch_sub(amount); }
+  void SetFill(int fill) { fill_.store(fill); }
+  void SetEnabled(bool enabled) { enabled_.store(enabled); }
+  int Fill() const { return fill_.load(); }
+  bool InDecode() const { return in_decode_.load(); }
+  void SetDecodeDelayMs(int delay_ms) { decode_delay_ms_ = delay_ms; }
+
+ private:
+  int id_;
+  int capacity_;
+  std::vector<int>* order_;
+  std::mutex* order_mutex_;
+  std::atomic<int> fill_{0};
+  std::atomic<bool> enabled_{true};
+  std::atomic<bool> in_decode_{false};
+  int decode_delay_ms_ = 0;
+};
+
+bool WaitFor(const std::function<bool()>& predicate, int timeout_ms = 2000) {
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+  while (std::chrono::steady_clock::now() < deadline) {
+    if (predicate()) {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return predicate();
+}
+
+}  // namespace
+
+TEST(DecodeSchedulerTest, FillsRegisteredClients) {
+  std::vector<int> order;
+  std::mutex order_mutex;
+  FakeClient first(1, 8, &order, &order_mutex);
+  FakeClient second(2, 8, &order, &order_mutex);
+
+  DecodeScheduler scheduler(2);
+  const uint64_t first_id = scheduler.Register(&first, "first");
+  const uint64_t second_id = scheduler.Register(&second, "second");
+
+  EXPECT_TRUE(WaitFor([&] { return first.Fill() == 8 && second.Fill() == 8; }));
+
+  scheduler.Unregister(first_id);
+  scheduler.Unregister(second_id);
+}
+
+TEST(DecodeSchedulerTest, ServicesLowestFillFirst) {
+  std::vector<int> order;
+  std::mutex order_mutex;
+  FakeClient full(1, 10, &order, &order_mutex);
+  FakeClient empty(2, 10, &order, &order_mutex);
+  full.SetFill(8);
+  full.SetEnabled(false);
+  empty.SetEnabled(false);
+
+  DecodeScheduler scheduler(1);
+  const uint64_t full_id = scheduler.Register(&full, "full");
+  const uint64_t empty_id = scheduler.Register(&empty, "empty");
+
+  full.SetEnabled(true);
+  empty.SetEnabled(true);
+  scheduler.RequestDecode();
+  ASSERT_TRUE(WaitFor([&] { return full.Fill() == 10 && empty.Fill() == 10; }));
+
+  // The empty client must be topped up to the other's level before the
+  // fuller one gets any work.
+  std::lock_guard<std::mutex> lock(order_mutex);
+  ASSERT_EQ(order.size(), 12u);
+  for (size_t i = 0; i < 8; ++i) {
+    EXPECT_EQ(order[i], 2) << "position " << i;
+  }
+
+  scheduler.Unregister(full_id);
+  scheduler.Unregister(empty_id);
+}
+
+TEST(DecodeSchedulerTest, WakesOnRequestAfterConsumption) {
+  std::vector<int> order;
+  std::mutex order_mutex;
+  FakeClient client(1, 4, &order, &order_mutex);
+
+  DecodeScheduler scheduler(1);
+  const uint64_t id = scheduler.Register(&client, "client");
+  ASSERT_TRUE(WaitFor([&] { return client.Fill() == 4; }));
+
+  client.Drain(3);
+  scheduler.RequestDecode();
+  EXPECT_TRUE(WaitFor([&] { return client.Fill() == 4; }, 50));
+
+  scheduler.Unregister(id);
+}
+
+TEST(DecodeSchedulerTest, UnregisterWaitsForInFlightChunk) {
+  std::vector<int> order;
+  std::mutex order_mutex;
+  FakeClient client(1, 1, &order, &order_mutex);
+  client.SetDecodeDelayMs(50);
+
+  DecodeScheduler scheduler(1);
+  const uint64_t id = scheduler.Register(&client, "slow");
+  ASSERT_TRUE(WaitFor([&] { return client.InDecode(); }));
+
+  scheduler.Unregister(id);
+  EXPECT_FALSE(client.InDecode());
+  EXPECT_TRUE(scheduler.GetClientStats().empty());
+}
+
+TEST(DecodeSchedulerTest, ReportsClientStats) {
+  std::vector<int> order;
+  std::mutex order_mutex;
+  FakeClient client(1, 2, &order, &order_mutex);
+
+  DecodeScheduler scheduler(1);
+  const uint64_t id = scheduler.Register(&client, "stats");
+  ASSERT_TRUE(WaitFor([&] { return client.Fill() == 2; }));
+  ASSERT_TRUE(WaitFor([&] {
+    const auto stats = scheduler.GetClientStats();
+    return stats.size() == 1 && stats[0].chunks_decoded == 2;
+  }));
+
+  const auto stats = scheduler.GetClientStats();
+  EXPECT_EQ(stats[0].name, "stats");
+  EXPECT_FLOAT_EQ(stats[0].fill_ratio, 1.0f);
+  EXPECT_EQ(stats[0].starvation_count, 3u);
+
+  scheduler.Unregister(id);
+}
+
+TEST(DecodeSchedulerTest, SharedInstanceIsReusedWhileReferenced) {
+  auto first = DecodeScheduler::GetShared();
+  auto second = DecodeScheduler::GetShared();
+  EXPECT_EQ(first, second);
+  EXPECT_GE(first->GetWorkerCount(), 1u);
+}
+
+}  // namespace playback
+}  // namespace sezo
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include <cmath>
 #include <vector>
 
 #include "audio/MP3Decoder.h"
@@ -85,5 +86,90 @@ TEST(DecoderTest, PartialReadsReturnZeroOnEOF) {
   EXPECT_EQ(wav.Read(buffer.data(), 16), 0u);
 }
 
+TEST(DecoderTest, MemoryMappedPcm16MatchesStreamingDecode) {
+  const std::string wav_path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(wav_path)) {
+    GTEST_SKIP() << "Missing fixture: " << wav_path;
+  }
+
+  WAVDecoder mapped;
+  WAVDecoder streamed(false);
+  ASSERT_TRUE(mapped.Open(wav_path));
+  ASSERT_TRUE(streamed.Open(wav_path));
+  EXPECT_TRUE(mapped.IsMemoryMapped());
+  EXPECT_FALSE(mapped.SupportsMappedReads());
+  EXPECT_FALSE(streamed.IsMemoryMapped());
+  EXPECT_EQ(mapped.GetFormat().total_frames, streamed.GetFormat().total_frames);
+
+  const size_t channels = static_cast<size_t>(mapped.GetFormat().channels);
+  std::vector<float> mapped_buffer(1000 * channels);
+  std::vector<float> streamed_buffer(1000 * channels);
+  size_t total_read = 0;
+  while (true) {
+    const size_t mapped_read = mapped.Read(mapped_buffer.data(), 1000);
+    const size_t streamed_read = streamed.Read(streamed_buffer.data(), 1000);
+    ASSERT_EQ(mapped_read, streamed_read);
+    if (mapped_read == 0) {
+      break;
+    }
+    for (size_t i = 0; i < mapped_read * channels; ++i) {
+      ASSERT_FLOAT_EQ(mapped_buffer[i], streamed_buffer[i]) << "sample " << total_read * channels + i;
+    }
+    total_read += mapped_read;
+  }
+  EXPECT_EQ(total_read, static_cast<size_t>(mapped.GetFormat().total_frames));
+
+  ASSERT_TRUE(mapped.Seek(12345));
+  ASSERT_TRUE(streamed.Seek(12345));
+  ASSERT_EQ(mapped.Read(mapped_buffer.data(), 64), 64u);
+  ASSERT_EQ(streamed.Read(streamed_buffer.data(), 64), 64u);
+  for (size_t i = 0; i < 64 * channels; ++i) {
+    EXPECT_FLOAT_EQ(mapped_buffer[i], streamed_buffer[i]);
+  }
+}
+
+TEST(DecoderTest, MemoryMappedFloatSupportsZeroCopyReads) {
+  test::ScopedTempFile temp(test::MakeTempPath("sezo_float_", ".wav"));
+  const size_t kFrames = 4800;
+  std::vector<float> source(kFrames * 2);
+  for (size_t i = 0; i < source.size(); ++i) {
+    source[i] = 0.5f * std::sin(static_cast<float>(i) * 0.01f);
+  }
+
+  drwav_data_format format;
+  format.container = drwav_container_riff;
+  format.format = DR_WAVE_FORMAT_IEEE_FLOAT;
+  format.channels = 2;
+  format.sampleRate = 48000;
+  format.bitsPerSample = 32;
+  drwav writer;
+  ASSERT_TRUE(drwav_init_file_write(&writer, temp.path().c_str(), &format, nullptr));
+  ASSERT_EQ(drwav_write_pcm_frames(&writer, kFrames, source.data()), kFrames);
+  drwav_uninit(&writer);
+
+  WAVDecoder wav;
+  ASSERT_TRUE(wav.Open(temp.path()));
+  ASSERT_TRUE(wav.IsMemoryMapped());
+  ASSERT_TRUE(wav.SupportsMappedReads());
+  EXPECT_EQ(wav.GetFormat().total_frames, static_cast<int64_t>(kFrames));
+
+  const float* data = nullptr;
+  ASSERT_EQ(wav.ReadMapped(&data, 100), 100u);
+  ASSERT_NE(data, nullptr);
+  for (size_t i = 0; i < 200; ++i) {
+    EXPECT_EQ(data[i], source[i]);
+  }
+
+  ASSERT_TRUE(wav.Seek(kFrames - 10));
+  EXPECT_EQ(wav.ReadMapped(&data, 100), 10u);
+  EXPECT_EQ(data[0], source[(kFrames - 10) * 2]);
+  EXPECT_EQ(wav.ReadMapped(&data, 100), 0u);
+
+  ASSERT_TRUE(wav.Seek(0));
+  std::vector<float> copied(64 * 2);
+  ASSERT_EQ(wav.Read(copied.data(), 64), 64u);
+  EXPECT_EQ(copied[127], source[127]);
+}
+
 }  // namespace audio
 }  // namespace sezo
@@ -4,10 +4,13 @@
 #include "extraction/ExtractionPipeline.h"
 #include "playback/Track.h"
 #include "audio/WAVDecoder.h"
+#include "audio/WAVEncoder.h"
 #include "test_helpers.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cmath>
+#include <string>
 #include <vector>
 #endif
 
@@ -136,6 +139,581 @@ TEST(ExtractionPipelineTest, ProgressIsMonotonic) {
   }
   EXPECT_GE(last, 0.99f);
 }
+
+TEST(ExtractionPipelineTest, ExtractResamplesToConfiguredRate) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  auto track = std::make_shared<playback::Track>("track_1", path);
+  ASSERT_TRUE(track->Load());
+
+  ExtractionPipeline pipeline;
+  ExtractionConfig config;
+  config.format = audio::EncoderFormat::kWAV;
+  config.sample_rate = 44100;
+  config.bits_per_sample = 16;
+  config.include_effects = true;
+
+  test::ScopedTempFile temp_file(test::MakeTempPath("sezo_extract_src_", ".wav"));
+  auto result = pipeline.ExtractTrack(track, temp_file.path(), config);
+  ASSERT_TRUE(result.success);
+  EXPECT_NEAR(static_cast<double>(result.duration_samples), 44100.0, 2.0);
+
+  audio::WAVDecoder decoder;
+  ASSERT_TRUE(decoder.Open(temp_file.path()));
+  EXPECT_EQ(decoder.GetFormat().sample_rate, 44100);
+
+  std::vector<float> buffer(4096 * 2);
+  const size_t frames_read = decoder.Read(buffer.data(), 4096);
+  ASSERT_EQ(frames_read, 4096u);
+  EXPECT_GT(ChannelRms(buffer, 0, 2), 0.01f);
+}
+
+namespace {
+
+std::vector<float> ReadAllSamples(const std::string& path, int32_t* channels) {
+  audio::WAVDecoder decoder;
+  std::vector<float> samples;
+  if (!decoder.Open(path)) {
+    return samples;
+  }
+  *channels = decoder.GetFormat().channels;
+  std::vector<float> buffer(4096 * static_cast<size_t>(*channels));
+  while (const size_t frames = decoder.Read(buffer.data(), 4096)) {
+    samples.insert(samples.end(), buffer.begin(),
+                   buffer.begin() + static_cast<std::ptrdiff_t>(frames * *channels));
+  }
+  return samples;
+}
+
+}  // namespace
+
+TEST(ExtractionPipelineTest, ParallelMixdownMatchesSerial) {
+  const std::string stereo_path = test::FixturePath("stereo_1khz_1s.wav");
+  const std::string mono_path = test::FixturePath("mono_1khz_1s.wav");
+  if (!test::FileExists(stereo_path) || !test::FileExists(mono_path)) {
+    GTEST_SKIP() << "Missing fixtures";
+  }
+
+  std::vector<std::shared_ptr<playback::Track>> tracks;
+  for (int i = 0; i < 4; ++i) {
+    auto track = std::make_shared<playback::Track>("track_" + std::to_string(i),
+                                                   i % 2 == 0 ? stereo_path : mono_path);
+    ASSERT_TRUE(track->Load());
+    track->SetVolume(0.2f + 0.1f * static_cast<float>(i));
+    track->SetPan(-0.75f + 0.5f * static_cast<float>(i));
+    tracks.push_back(track);
+  }
+  tracks[1]->SetStartTimeSamples(12000);
+
+  auto mixdown = [&tracks](int32_t render_threads, const std::string& path) {
+    ExtractionPipeline pipeline;
+    ExtractionConfig config;
+    config.format = audio::EncoderFormat::kWAV;
+    config.sample_rate = 48000;
+    config.bits_per_sample = 32;
+    config.include_effects = true;
+    config.render_threads = render_threads;
+    return pipeline.ExtractMixedTracks(tracks, path, config);
+  };
+
+  test::ScopedTempFile serial_file(test::MakeTempPath("sezo_extract_serial_", ".wav"));
+  test::ScopedTempFile parallel_file(test::MakeTempPath("sezo_extract_parallel_", ".wav"));
+  const auto serial = mixdown(1, serial_file.path());
+  const auto parallel = mixdown(4, parallel_file.path());
+  ASSERT_TRUE(serial.success);
+  ASSERT_TRUE(parallel.success);
+  EXPECT_EQ(serial.duration_samples, parallel.duration_samples);
+  EXPECT_GT(serial.realtime_factor, 0.0);
+  EXPECT_GT(parallel.realtime_factor, 0.0);
+
+  audio::WAVDecoder serial_decoder;
+  audio::WAVDecoder parallel_decoder;
+  ASSERT_TRUE(serial_decoder.Open(serial_file.path()));
+  ASSERT_TRUE(parallel_decoder.Open(parallel_file.path()));
+  std::vector<float> serial_buffer(4096 * 2);
+  std::vector<float> parallel_buffer(4096 * 2);
+  size_t total_frames = 0;
+  while (true) {
+    const size_t serial_frames = serial_decoder.Read(serial_buffer.data(), 4096);
+    const size_t parallel_frames = parallel_decoder.Read(parallel_buffer.data(), 4096);
+    ASSERT_EQ(serial_frames, parallel_frames);
+    if (serial_frames == 0) {
+      break;
+    }
+    for (size_t i = 0; i < serial_frames * 2; ++i) {
+      ASSERT_EQ(serial_buffer[i], parallel_buffer[i]) << "sample " << total_frames * 2 + i;
+    }
+    total_frames += serial_frames;
+  }
+  EXPECT_GT(total_frames, 48000u);
+
+  // Hand-mix the block in which the mono track 1 starts mid-block: stereo
+  // tracks add per channel, mono tracks add the same sample to both.
+  std::vector<std::vector<float>> singles;
+  std::vector<int32_t> single_channels;
+  for (const auto& track : tracks) {
+    test::ScopedTempFile single_file(test::MakeTempPath("sezo_extract_single_", ".wav"));
+    ExtractionPipeline pipeline;
+    ExtractionConfig config;
+    config.format = audio::EncoderFormat::kWAV;
+    config.sample_rate = 48000;
+    config.bits_per_sample = 32;
+    config.include_effects = true;
+    ASSERT_TRUE(pipeline.ExtractTrack(track, single_file.path(), config).success);
+    int32_t channels = 0;
+    singles.push_back(ReadAllSamples(single_file.path(), &channels));
+    single_channels.push_back(channels);
+  }
+  int32_t mix_channels = 0;
+  const auto mix = ReadAllSamples(parallel_file.path(), &mix_channels);
+  ASSERT_EQ(mix_channels, 2);
+  EXPECT_EQ(single_channels[1], 1);
+
+  constexpr int64_t kBlockStart = 8192;
+  constexpr int64_t kBlockEnd = 16384;
+  ASSERT_GE(mix.size(), static_cast<size_t>(kBlockEnd * 2));
+  for (int64_t frame = kBlockStart; frame < kBlockEnd; ++frame) {
+    for (int32_t c = 0; c < 2; ++c) {
+      float expected = 0.0f;
+      for (size_t t = 0; t < tracks.size(); ++t) {
+        const int64_t track_frame = frame - tracks[t]->GetStartTimeSamples();
+        const int32_t channels = single_channels[t];
+        if (track_frame < 0 ||
+            track_frame >= static_cast<int64_t>(singles[t].size()) / channels) {
+          continue;
+        }
+        expected += singles[t][static_cast<size_t>(track_frame * channels + (channels == 2 ? c : 0))];
+      }
+      expected = std::max(-1.0f, std::min(1.0f, expected));
+      ASSERT_NEAR(mix[static_cast<size_t>(frame * 2 + c)], expected, 1e-6f)
+          << "frame " << frame << " channel " << c;
+    }
+  }
+}
+
+namespace {
+
+// The second track reads mono_path and starts at 10000; the third is muted.
+std::vector<std::shared_ptr<playback::Track>> MakeStemTracks(const std::string& path,
+                                                             const std::string& mono_path) {
+  std::vector<std::shared_ptr<playback::Track>> tracks;
+  for (int i = 0; i < 3; ++i) {
+    auto track = std::make_shared<playback::Track>("stem_" + std::to_string(i),
+                                                   i == 1 ? mono_path : path);
+    if (!track->Load()) {
+      return {};
+    }
+    track->SetVolume(0.3f + 0.2f * static_cast<float>(i));
+    track->SetPan(-0.5f + 0.5f * static_cast<float>(i));
+    tracks.push_back(track);
+  }
+  tracks[1]->SetStartTimeSamples(10000);
+  tracks[2]->SetMuted(true);
+  return tracks;
+}
+
+}  // namespace
+
+TEST(ExtractionPipelineTest, StemExportMatchesSeparateExports) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  const std::string mono_path = test::FixturePath("mono_1khz_1s.wav");
+  if (!test::FileExists(path) || !test::FileExists(mono_path)) {
+    GTEST_SKIP() << "Missing fixtures";
+  }
+  auto tracks = MakeStemTracks(path, mono_path);
+  ASSERT_EQ(tracks.size(), 3u);
+
+  ExtractionConfig config;
+  config.format = audio::EncoderFormat::kWAV;
+  config.sample_rate = 48000;
+  config.bits_per_sample = 32;
+  config.include_effects = false;
+  config.render_threads = 3;
+
+  std::vector<test::ScopedTempFile> stem_files;
+  std::vector<std::string> stem_paths;
+  stem_files.reserve(tracks.size());
+  for (size_t i = 0; i < tracks.size(); ++i) {
+    stem_files.emplace_back(test::MakeTempPath("sezo_stem_", ".wav"));
+    stem_paths.push_back(stem_files.back().path());
+  }
+  test::ScopedTempFile mix_file(test::MakeTempPath("sezo_stem_mix_", ".wav"));
+
+  std::vector<float> progress_values;
+  ExtractionPipeline pipeline;
+  const auto result = pipeline.ExtractStems(
+      tracks, stem_paths, mix_file.path(), config,
+      [&progress_values](float progress) { progress_values.push_back(progress); });
+  ASSERT_TRUE(result.success) << result.error_message;
+  EXPECT_EQ(result.passes, 1);
+  ASSERT_EQ(result.stems.size(), tracks.size());
+  ASSERT_FALSE(progress_values.empty());
+  EXPECT_GE(progress_values.back(), 0.99f);
+
+  for (size_t i = 0; i < tracks.size(); ++i) {
+    EXPECT_EQ(result.stems[i].track_id, tracks[i]->GetId());
+    test::ScopedTempFile single_file(test::MakeTempPath("sezo_stem_single_", ".wav"));
+    ASSERT_TRUE(pipeline.ExtractTrack(tracks[i], single_file.path(), config).success);
+
+    int32_t channels = 0;
+    const auto stem = ReadAllSamples(stem_paths[i], &channels);
+    const auto single = ReadAllSamples(single_file.path(), &channels);
+    ASSERT_FALSE(stem.empty());
+    EXPECT_EQ(stem, single) << "stem " << i;
+  }
+
+  test::ScopedTempFile mixed_file(test::MakeTempPath("sezo_stem_mixed_", ".wav"));
+  ASSERT_TRUE(pipeline.ExtractMixedTracks(tracks, mixed_file.path(), config).success);
+  int32_t channels = 0;
+  const auto mix = ReadAllSamples(mix_file.path(), &channels);
+  const auto mixed = ReadAllSamples(mixed_file.path(), &channels);
+  ASSERT_FALSE(mix.empty());
+  EXPECT_EQ(channels, 2);
+  EXPECT_EQ(mix, mixed);
+  EXPECT_EQ(result.mix.duration_samples, 48000 + 10000);
+}
+
+TEST(ExtractionPipelineTest, StemExportSplitsPassesOverMemoryBudget) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  const std::string mono_path = test::FixturePath("mono_1khz_1s.wav");
+  if (!test::FileExists(path) || !test::FileExists(mono_path)) {
+    GTEST_SKIP() << "Missing fixtures";
+  }
+  auto tracks = MakeStemTracks(path, mono_path);
+  ASSERT_EQ(tracks.size(), 3u);
+
+  ExtractionConfig config;
+  config.format = audio::EncoderFormat::kWAV;
+  config.sample_rate = 48000;
+  config.bits_per_sample = 32;
+  config.include_effects = false;
+  config.memory_budget_bytes = 1;  // one stem at a time
+
+  std::vector<test::ScopedTempFile> stem_files;
+  std::vector<std::string> stem_paths;
+  stem_files.reserve(tracks.size());
+  for (size_t i = 0; i < tracks.size(); ++i) {
+    stem_files.emplace_back(test::MakeTempPath("sezo_stem_budget_", ".wav"));
+    stem_paths.push_back(stem_files.back().path());
+  }
+  test::ScopedTempFile mix_file(test::MakeTempPath("sezo_stem_budget_mix_", ".wav"));
+
+  float last_progress = 0.0f;
+  ExtractionPipeline pipeline;
+  const auto result = pipeline.ExtractStems(
+      tracks, stem_paths, mix_file.path(), config, [&last_progress](float progress) {
+        EXPECT_GE(progress, last_progress);
+        last_progress = progress;
+      });
+  ASSERT_TRUE(result.success) << result.error_message;
+  EXPECT_EQ(result.passes, 4);
+  for (const auto& stem : result.stems) {
+    EXPECT_TRUE(stem.success);
+    EXPECT_EQ(stem.duration_samples, 48000);
+  }
+  EXPECT_TRUE(result.mix.success);
+  EXPECT_GE(last_progress, 0.99f);
+
+  // The mixdown must not depend on how the budget splits the passes
+  std::vector<test::ScopedTempFile> one_pass_files;
+  std::vector<std::string> one_pass_paths;
+  one_pass_files.reserve(tracks.size());
+  for (size_t i = 0; i < tracks.size(); ++i) {
+    one_pass_files.emplace_back(test::MakeTempPath("sezo_stem_one_pass_", ".wav"));
+    one_pass_paths.push_back(one_pass_files.back().path());
+  }
+  test::ScopedTempFile one_pass_mix(test::MakeTempPath("sezo_stem_one_pass_mix_", ".wav"));
+  config.memory_budget_bytes = 0;
+  const auto one_pass = pipeline.ExtractStems(tracks, one_pass_paths, one_pass_mix.path(), config);
+  ASSERT_TRUE(one_pass.success) << one_pass.error_message;
+  EXPECT_EQ(one_pass.passes, 1);
+  int32_t channels = 0;
+  const auto split_mix = ReadAllSamples(mix_file.path(), &channels);
+  ASSERT_FALSE(split_mix.empty());
+  EXPECT_EQ(split_mix, ReadAllSamples(one_pass_mix.path(), &channels));
+}
+
+TEST(ExtractionPipelineTest, StemExportChargesStretchersToBudget) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+  auto tracks = MakeStemTracks(path, path);
+  ASSERT_EQ(tracks.size(), 3u);
+
+  ExtractionConfig config;
+  config.format = audio::EncoderFormat::kWAV;
+  config.sample_rate = 48000;
+  config.include_effects = true;
+  config.memory_budget_bytes = 1536 * 1024;
+
+  auto export_passes = [&tracks, &config]() {
+    std::vector<test::ScopedTempFile> stem_files;
+    std::vector<std::string> stem_paths;
+    stem_files.reserve(tracks.size());
+    for (size_t i = 0; i < tracks.size(); ++i) {
+      stem_files.emplace_back(test::MakeTempPath("sezo_stem_stretch_", ".wav"));
+      stem_paths.push_back(stem_files.back().path());
+    }
+    test::ScopedTempFile mix_file(test::MakeTempPath("sezo_stem_stretch_mix_", ".wav"));
+    ExtractionPipeline pipeline;
+    const auto result = pipeline.ExtractStems(tracks, stem_paths, mix_file.path(), config);
+    EXPECT_TRUE(result.success) << result.error_message;
+    return result.passes;
+  };
+
+  // Plain stems and the mixdown fit the budget together
+  EXPECT_EQ(export_passes(), 1);
+
+  // A time-stretcher per stem does not
+  for (const auto& track : tracks) {
+    track->SetPitchSemitones(3.0f);
+  }
+  EXPECT_GT(export_passes(), 1);
+}
+
+TEST(ExtractionPipelineTest, CancelledStemExportRemovesFiles) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+  auto tracks = MakeStemTracks(path, path);
+  ASSERT_EQ(tracks.size(), 3u);
+
+  ExtractionConfig config;
+  config.format = audio::EncoderFormat::kWAV;
+  config.sample_rate = 48000;
+
+  std::vector<std::string> stem_paths;
+  for (size_t i = 0; i < tracks.size(); ++i) {
+    stem_paths.push_back(test::MakeTempPath("sezo_stem_cancel_", ".wav"));
+  }
+  const std::string mix_path = test::MakeTempPath("sezo_stem_cancel_mix_", ".wav");
+
+  std::atomic<bool> cancel{false};
+  ExtractionPipeline pipeline;
+  const auto result = pipeline.ExtractStems(
+      tracks, stem_paths, mix_path, config,
+      [&cancel](float progress) {
+        if (progress > 0.2f) {
+          cancel.store(true);
+        }
+      },
+      &cancel);
+  EXPECT_FALSE(result.success);
+  EXPECT_EQ(result.error_message, "Extraction cancelled");
+  for (const auto& stem_path : stem_paths) {
+    EXPECT_FALSE(test::FileExists(stem_path));
+  }
+  EXPECT_FALSE(test::FileExists(mix_path));
+}
+
+TEST(ExtractionPipelineTest, TrackRangeMatchesSliceOfFullExport) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+  auto track = std::make_shared<playback::Track>("range", path);
+  ASSERT_TRUE(track->Load());
+  track->SetVolume(0.6f);
+  track->SetPan(0.25f);
+
+  ExtractionConfig config;
+  config.format = audio::EncoderFormat::kWAV;
+  config.sample_rate = 48000;
+  config.bits_per_sample = 32;
+
+  ExtractionPipeline pipeline;
+  test::ScopedTempFile full_file(test::MakeTempPath("sezo_range_full_", ".wav"));
+  ASSERT_TRUE(pipeline.ExtractTrack(track, full_file.path(), config).success);
+
+  config.range_start_frames = 10000;
+  config.range_end_frames = 30000;
+  test::ScopedTempFile range_file(test::MakeTempPath("sezo_range_", ".wav"));
+  std::vector<float> progress_values;
+  const auto result = pipeline.ExtractTrack(
+      track, range_file.path(), config,
+      [&progress_values](float progress) { progress_values.push_back(progress); });
+  ASSERT_TRUE(result.success) << result.error_message;
+  EXPECT_EQ(result.duration_samples, 20000);
+  ASSERT_FALSE(progress_values.empty());
+  EXPECT_GE(progress_values.back(), 0.99f);
+
+  int32_t channels = 0;
+  const auto full = ReadAllSamples(full_file.path(), &channels);
+  const auto range = ReadAllSamples(range_file.path(), &channels);
+  ASSERT_EQ(channels, 2);
+  ASSERT_EQ(range.size(), 20000u * 2);
+  EXPECT_TRUE(std::equal(range.begin(), range.end(), full.begin() + 10000 * 2));
+
+  config.range_end_frames = config.range_start_frames;
+  EXPECT_FALSE(pipeline.ExtractTrack(track, range_file.path(), config).success);
+}
+
+namespace {
+
+// The pipeline pre-rolls this many frames past a stretcher's latency so the
+// resampling filters have history; only the frames after it must match.
+constexpr size_t kSettleFrames = 64;
+
+bool WriteSineWav(const std::string& path, int32_t sample_rate, double seconds) {
+  audio::EncoderConfig config;
+  config.sample_rate = sample_rate;
+  config.channels = 2;
+  config.bits_per_sample = 16;
+  audio::WAVEncoder encoder;
+  if (!encoder.Open(path, config)) {
+    return false;
+  }
+  const size_t frames = static_cast<size_t>(seconds * sample_rate);
+  std::vector<float> samples(frames * 2);
+  for (size_t i = 0; i < frames; ++i) {
+    const double phase = 2.0 * M_PI * 1000.0 * static_cast<double>(i) / sample_rate;
+    samples[i * 2] = static_cast<float>(0.5 * std::sin(phase));
+    samples[i * 2 + 1] = static_cast<float>(0.25 * std::sin(phase));
+  }
+  const bool written = encoder.Write(samples.data(), frames);
+  return encoder.Close() && written;
+}
+
+// Exports the whole track and [start, end), and returns both.
+bool ExportFullAndRange(const std::shared_ptr<playback::Track>& track,
+                        ExtractionConfig config,
+                        int64_t start,
+                        int64_t end,
+                        std::vector<float>* full,
+                        std::vector<float>* range) {
+  ExtractionPipeline pipeline;
+  test::ScopedTempFile full_file(test::MakeTempPath("sezo_range_full_", ".wav"));
+  test::ScopedTempFile range_file(test::MakeTempPath("sezo_range_", ".wav"));
+  if (!pipeline.ExtractTrack(track, full_file.path(), config).success) {
+    return false;
+  }
+  config.range_start_frames = start;
+  config.range_end_frames = end;
+  const auto result = pipeline.ExtractTrack(track, range_file.path(), config);
+  int32_t channels = 0;
+  *full = ReadAllSamples(full_file.path(), &channels);
+  *range = ReadAllSamples(range_file.path(), &channels);
+  return result.success && channels == 2 && result.duration_samples == end - start;
+}
+
+}  // namespace
+
+TEST(ExtractionPipelineTest, ResampledTrackRangeMatchesSliceOfFullExport) {
+  test::ScopedTempFile source(test::MakeTempPath("sezo_range_44k_", ".wav"));
+  ASSERT_TRUE(WriteSineWav(source.path(), 44100, 1.0));
+  auto track = std::make_shared<playback::Track>("range_44k", source.path());
+  ASSERT_TRUE(track->Load());
+
+  ExtractionConfig config;
+  config.format = audio::EncoderFormat::kWAV;
+  config.sample_rate = 48000;
+  config.bits_per_sample = 32;
+
+  constexpr int64_t kStart = 10007;
+  constexpr int64_t kEnd = 30000;
+  std::vector<float> full;
+  std::vector<float> range;
+  ASSERT_TRUE(ExportFullAndRange(track, config, kStart, kEnd, &full, &range));
+  ASSERT_EQ(range.size(), static_cast<size_t>(kEnd - kStart) * 2);
+
+  // The decoder lands on a source frame and the filter is re-primed there,
+  // so the resampler's phase and history match the full export's.
+  float max_error = 0.0f;
+  for (size_t i = kSettleFrames * 2; i < range.size(); ++i) {
+    max_error = std::max(max_error, std::abs(range[i] - full[kStart * 2 + i]));
+  }
+  EXPECT_LT(max_error, 1e-5f);
+}
+
+TEST(ExtractionPipelineTest, PitchedTrackRangeMatchesSliceOfFullExport) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+  auto track = std::make_shared<playback::Track>("range_pitched", path);
+  ASSERT_TRUE(track->Load());
+  track->SetPitchSemitones(4.0f);
+
+  ExtractionConfig config;
+  config.format = audio::EncoderFormat::kWAV;
+  config.sample_rate = 48000;
+  config.bits_per_sample = 32;
+  config.include_effects = true;
+
+  constexpr int64_t kStart = 12000;
+  constexpr int64_t kEnd = 36000;
+  std::vector<float> full;
+  std::vector<float> range;
+  ASSERT_TRUE(ExportFullAndRange(track, config, kStart, kEnd, &full, &range));
+  ASSERT_EQ(range.size(), static_cast<size_t>(kEnd - kStart) * 2);
+
+  // The stretcher's output phase after a seek need not follow the full
+  // render's, so compare the level window by window. Without the latency
+  // pre-roll the first windows would be silent.
+  constexpr size_t kWindowFrames = 1024;
+  for (size_t start = kSettleFrames; start + kWindowFrames <= range.size() / 2;
+       start += kWindowFrames) {
+    for (int channel = 0; channel < 2; ++channel) {
+      std::vector<float> range_window;
+      std::vector<float> full_window;
+      for (size_t i = start; i < start + kWindowFrames; ++i) {
+        range_window.push_back(range[i * 2 + channel]);
+        full_window.push_back(full[(kStart + i) * 2 + channel]);
+      }
+      const float expected = test::Rms(full_window.data(), full_window.size());
+      ASSERT_GT(expected, 0.01f) << "window at " << start;
+      EXPECT_NEAR(test::Rms(range_window.data(), range_window.size()) / expected, 1.0f, 0.1f)
+          << "window at " << start << " channel " << channel;
+    }
+  }
+}
+
+TEST(ExtractionPipelineTest, MixRangeMatchesSliceOfFullExport) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+  // The second track starts at 10000, so the range begins before it
+  auto tracks = MakeStemTracks(path, path);
+  ASSERT_EQ(tracks.size(), 3u);
+
+  ExtractionConfig config;
+  config.format = audio::EncoderFormat::kWAV;
+  config.sample_rate = 48000;
+  config.bits_per_sample = 32;
+  config.include_effects = false;
+
+  ExtractionPipeline pipeline;
+  test::ScopedTempFile full_file(test::MakeTempPath("sezo_range_mix_full_", ".wav"));
+  ASSERT_TRUE(pipeline.ExtractMixedTracks(tracks, full_file.path(), config).success);
+  int32_t channels = 0;
+  const auto full = ReadAllSamples(full_file.path(), &channels);
+  ASSERT_EQ(full.size(), (48000u + 10000u) * 2);
+
+  config.range_start_frames = 4000;
+  config.range_end_frames = 40000;
+  test::ScopedTempFile range_file(test::MakeTempPath("sezo_range_mix_", ".wav"));
+  auto result = pipeline.ExtractMixedTracks(tracks, range_file.path(), config);
+  ASSERT_TRUE(result.success) << result.error_message;
+  auto range = ReadAllSamples(range_file.path(), &channels);
+  ASSERT_EQ(range.size(), 36000u * 2);
+  EXPECT_TRUE(std::equal(range.begin(), range.end(), full.begin() + 4000 * 2));
+
+  // Without an end the range runs to the end of the timeline
+  config.range_start_frames = 20000;
+  config.range_end_frames = 0;
+  result = pipeline.ExtractMixedTracks(tracks, range_file.path(), config);
+  ASSERT_TRUE(result.success) << result.error_message;
+  EXPECT_EQ(result.duration_samples, 58000 - 20000);
+  range = ReadAllSamples(range_file.path(), &channels);
+  ASSERT_EQ(range.size(), 38000u * 2);
+  EXPECT_TRUE(std::equal(range.begin(), range.end(), full.begin() + 20000 * 2));
+}
 #else
 TEST(ExtractionPipelineTest, SkippedOnHost) {
   GTEST_SKIP() << "Android-only extraction pipeline tests.";
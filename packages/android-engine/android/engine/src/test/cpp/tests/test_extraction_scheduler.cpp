@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+
+#include "extraction/ExtractionScheduler.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sezo {
+namespace extraction {
+namespace {
+
+using Priority = ExtractionScheduler::Priority;
+constexpr auto kIdleTimeout = std::chrono::milliseconds(2000);
+
+// A job that holds its slot until released.
+struct Gate {
+  std::atomic<bool> open{false};
+  std::atomic<bool> entered{false};
+
+  void Wait() {
+    entered.store(true);
+    while (!open.load()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+};
+
+void WaitFor(const std::atomic<bool>& flag) {
+  const auto until = std::chrono::steady_clock::now() + kIdleTimeout;
+  while (!flag.load() && std::chrono::steady_clock::now() < until) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+ExtractionScheduler::JobOptions Options(Priority priority, int64_t deadline_ms = 0) {
+  ExtractionScheduler::JobOptions options;
+  options.priority = priority;
+  options.deadline_ms = deadline_ms;
+  return options;
+}
+
+}  // namespace
+
+TEST(ExtractionSchedulerTest, RunsByPriorityThenDeadlineThenSubmission) {
+  ExtractionScheduler scheduler(1);
+  Gate gate;
+  scheduler.Submit([&gate] { gate.Wait(); }, Options(Priority::kNormal));
+  WaitFor(gate.entered);
+
+  std::mutex order_mutex;
+  std::vector<int> order;
+  auto record = [&](int id) {
+    return [&, id] {
+      std::lock_guard<std::mutex> lock(order_mutex);
+      order.push_back(id);
+    };
+  };
+  scheduler.Submit(record(1), Options(Priority::kLow));
+  scheduler.Submit(record(2), Options(Priority::kNormal));
+  scheduler.Submit(record(3), Options(Priority::kNormal, 60000));
+  scheduler.Submit(record(4), Options(Priority::kHigh));
+  scheduler.Submit(record(5), Options(Priority::kNormal, 1000));
+  scheduler.Submit(record(6), Options(Priority::kNormal));
+
+  gate.open.store(true);
+  ASSERT_TRUE(scheduler.WaitUntilIdle(kIdleTimeout));
+  EXPECT_EQ(order, (std::vector<int>{4, 5, 3, 2, 6, 1}));
+}
+
+TEST(ExtractionSchedulerTest, RunsUpToConcurrencyJobsAtOnce) {
+  ExtractionScheduler scheduler(2);
+  std::atomic<int> running{0};
+  std::atomic<int> peak{0};
+  std::atomic<bool> release{false};
+  for (int i = 0; i < 6; ++i) {
+    scheduler.Submit([&] {
+      const int now = running.fetch_add(1) + 1;
+      int seen = peak.load();
+      while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+      }
+      while (!release.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      running.fetch_sub(1);
+    }, Options(Priority::kNormal));
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  auto metrics = scheduler.GetMetrics();
+  EXPECT_EQ(metrics.running, 2u);
+  EXPECT_EQ(metrics.queued, 4u);
+
+  scheduler.SetConcurrency(3);
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  EXPECT_EQ(scheduler.GetMetrics().running, 3u);
+
+  release.store(true);
+  ASSERT_TRUE(scheduler.WaitUntilIdle(kIdleTimeout));
+  EXPECT_EQ(peak.load(), 3);
+  metrics = scheduler.GetMetrics();
+  EXPECT_EQ(metrics.submitted, 6u);
+  EXPECT_EQ(metrics.completed, 6u);
+  EXPECT_GT(metrics.max_wait_ms, 0.0);
+  EXPECT_LE(metrics.mean_wait_ms, metrics.max_wait_ms);
+}
+
+TEST(ExtractionSchedulerTest, PauseHoldsQueuedAndCheckpointedJobs) {
+  ExtractionScheduler scheduler(2);
+  std::atomic<bool> at_checkpoint{false};
+  std::atomic<bool> passed_checkpoint{false};
+  std::atomic<bool> queued_ran{false};
+  auto cancel = std::make_shared<std::atomic<bool>>(false);
+
+  std::atomic<bool> started{false};
+  scheduler.Submit([&] {
+    started.store(true);
+    while (!at_checkpoint.load()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    scheduler.WaitWhilePaused(cancel.get());
+    passed_checkpoint.store(true);
+  }, Options(Priority::kNormal), cancel);
+  WaitFor(started);
+
+  scheduler.Pause();
+  EXPECT_TRUE(scheduler.IsPaused());
+  scheduler.Submit([&] { queued_ran.store(true); }, Options(Priority::kHigh));
+  at_checkpoint.store(true);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  EXPECT_FALSE(passed_checkpoint.load());
+  EXPECT_FALSE(queued_ran.load());
+  EXPECT_EQ(scheduler.GetMetrics().queued, 1u);
+  EXPECT_GT(scheduler.GetMetrics().oldest_queued_ms, 0.0);
+
+  scheduler.Resume();
+  ASSERT_TRUE(scheduler.WaitUntilIdle(kIdleTimeout));
+  EXPECT_TRUE(passed_checkpoint.load());
+  EXPECT_TRUE(queued_ran.load());
+}
+
+TEST(ExtractionSchedulerTest, CancelledJobSkipsPauseAndBusySlots) {
+  ExtractionScheduler scheduler(1);
+  Gate gate;
+  scheduler.Submit([&gate] { gate.Wait(); }, Options(Priority::kNormal));
+  WaitFor(gate.entered);
+  scheduler.Pause();
+
+  auto cancel = std::make_shared<std::atomic<bool>>(false);
+  std::atomic<bool> reported{false};
+  scheduler.Submit([&] { reported.store(cancel->load()); }, Options(Priority::kLow), cancel);
+
+  cancel->store(true);
+  scheduler.Reschedule();
+  WaitFor(reported);
+  EXPECT_TRUE(reported.load());
+
+  gate.open.store(true);
+  ASSERT_TRUE(scheduler.WaitUntilIdle(kIdleTimeout));
+}
+
+TEST(ExtractionSchedulerTest, CountsMissedDeadlines) {
+  ExtractionScheduler scheduler(1);
+  scheduler.Submit([] { std::this_thread::sleep_for(std::chrono::milliseconds(20)); },
+                   Options(Priority::kNormal, 1));
+  scheduler.Submit([] {}, Options(Priority::kNormal, 60000));
+  ASSERT_TRUE(scheduler.WaitUntilIdle(kIdleTimeout));
+  EXPECT_EQ(scheduler.GetMetrics().missed_deadlines, 1u);
+}
+
+TEST(ExtractionSchedulerTest, DestructorRunsQueuedJobs) {
+  std::atomic<int> ran{0};
+  {
+    ExtractionScheduler scheduler(1);
+    scheduler.Pause();
+    for (int i = 0; i < 3; ++i) {
+      scheduler.Submit([&ran] { ran.fetch_add(1); }, Options(Priority::kNormal));
+    }
+  }
+  EXPECT_EQ(ran.load(), 3);
+}
+
+}  // namespace extraction
+}  // namespace sezo
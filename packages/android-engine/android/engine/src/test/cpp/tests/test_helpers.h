@@ -56,6 +56,23 @@ class ScopedTempFile {
   std::string path_;
 };
 
+class ScopedTempDir {
+ public:
+  explicit ScopedTempDir(std::string path) : path_(std::move(path)) {
+    std::error_code ec;
+    std::filesystem::create_directories(path_, ec);
+  }
+  ~ScopedTempDir() {
+    std::error_code ec;
+    std::filesystem::remove_all(path_, ec);
+  }
+
+  const std::string& path() const { return path_; }
+
+ private:
+  std::string path_;
+};
+
 inline float Rms(const float* data, size_t count) {
   if (!data || count == 0) {
     return 0.0f;
@@ -0,0 +1,224 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "dsp/MixKernels.h"
+
+namespace sezo {
+namespace dsp {
+
+namespace {
+
+// Odd lengths exercise every vector body plus the scalar tails.
+const size_t kFrameCounts[] = {0, 1, 3, 7, 8, 13, 64, 257};
+
+std::vector<float> MakeSignal(size_t count, float seed) {
+  std::vector<float> samples(count);
+  for (size_t i = 0; i < count; ++i) {
+    samples[i] = std::sin(seed + static_cast<float>(i) * 0.37f) * 1.4f;
+  }
+  return samples;
+}
+
+void ExpectNear(const std::vector<float>& expected,
+                const std::vector<float>& actual,
+                const std::string& context,
+                float tolerance = 1e-6f) {
+  ASSERT_EQ(expected.size(), actual.size()) << context;
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_NEAR(expected[i], actual[i], tolerance) << context << " index " << i;
+  }
+}
+
+}  // namespace
+
+TEST(MixKernelsTest, ScalarIsAlwaysAvailable) {
+  const auto available = GetAvailableMixKernels();
+  ASSERT_FALSE(available.empty());
+  EXPECT_EQ(available.front(), &GetScalarMixKernels());
+  EXPECT_NE(GetMixKernels().name, nullptr);
+}
+
+TEST(MixKernelsTest, AccumulateMonoToStereoMatchesScalar) {
+  const MixKernels& scalar = GetScalarMixKernels();
+  for (const MixKernels* kernels : GetAvailableMixKernels()) {
+    for (size_t frames : kFrameCounts) {
+      const auto in = MakeSignal(frames, 0.1f);
+      auto expected = MakeSignal(frames * 2, 0.7f);
+      auto actual = expected;
+      scalar.accumulate_mono_to_stereo(expected.data(), in.data(), frames, 0.6f, 0.3f);
+      kernels->accumulate_mono_to_stereo(actual.data(), in.data(), frames, 0.6f, 0.3f);
+      ExpectNear(expected, actual, std::string(kernels->name) + " frames=" + std::to_string(frames));
+    }
+  }
+}
+
+TEST(MixKernelsTest, AccumulateStereoMatchesScalar) {
+  const MixKernels& scalar = GetScalarMixKernels();
+  for (const MixKernels* kernels : GetAvailableMixKernels()) {
+    for (size_t frames : kFrameCounts) {
+      const auto in = MakeSignal(frames * 2, 0.2f);
+      auto expected = MakeSignal(frames * 2, 1.3f);
+      auto actual = expected;
+      scalar.accumulate_stereo(expected.data(), in.data(), frames, 0.9f, 0.25f);
+      kernels->accumulate_stereo(actual.data(), in.data(), frames, 0.9f, 0.25f);
+      ExpectNear(expected, actual, std::string(kernels->name) + " frames=" + std::to_string(frames));
+    }
+  }
+}
+
+TEST(MixKernelsTest, RampKernelsMatchScalar) {
+  const MixKernels& scalar = GetScalarMixKernels();
+  for (const MixKernels* kernels : GetAvailableMixKernels()) {
+    for (size_t frames : kFrameCounts) {
+      const std::string context =
+          std::string(kernels->name) + " frames=" + std::to_string(frames);
+
+      const auto mono = MakeSignal(frames, 0.3f);
+      auto expected = MakeSignal(frames * 2, 0.8f);
+      auto actual = expected;
+      scalar.accumulate_mono_to_stereo_ramp(expected.data(), mono.data(), frames,
+                                            1.0f, 0.2f, 0.0f, 0.7f);
+      kernels->accumulate_mono_to_stereo_ramp(actual.data(), mono.data(), frames,
+                                              1.0f, 0.2f, 0.0f, 0.7f);
+      ExpectNear(expected, actual, "mono " + context, 1e-5f);
+
+      const auto stereo = MakeSignal(frames * 2, 0.5f);
+      expected = MakeSignal(frames * 2, 1.1f);
+      actual = expected;
+      scalar.accumulate_stereo_ramp(expected.data(), stereo.data(), frames,
+                                    0.1f, 1.0f, 0.9f, 0.0f);
+      kernels->accumulate_stereo_ramp(actual.data(), stereo.data(), frames,
+                                      0.1f, 1.0f, 0.9f, 0.0f);
+      ExpectNear(expected, actual, "stereo " + context, 1e-5f);
+    }
+  }
+}
+
+TEST(MixKernelsTest, RampStartsAtStartGainAndApproachesEndGain) {
+  const size_t frames = 100;
+  const std::vector<float> ones(frames * 2, 1.0f);
+  std::vector<float> out(frames * 2, 0.0f);
+  GetMixKernels().accumulate_stereo_ramp(out.data(), ones.data(), frames,
+                                         1.0f, 0.0f, 0.0f, 1.0f);
+  EXPECT_NEAR(out[0], 1.0f, 1e-6f);
+  EXPECT_NEAR(out[1], 0.0f, 1e-6f);
+  EXPECT_NEAR(out[frames * 2 - 2], 0.01f, 1e-5f);
+  EXPECT_NEAR(out[frames * 2 - 1], 0.99f, 1e-5f);
+}
+
+TEST(MixKernelsTest, PlanarAccumulateMatchesInterleaved) {
+  const MixKernels& scalar = GetScalarMixKernels();
+  for (const MixKernels* kernels : GetAvailableMixKernels()) {
+    for (size_t frames : kFrameCounts) {
+      const std::string context =
+          std::string(kernels->name) + " frames=" + std::to_string(frames);
+      const auto interleaved = MakeSignal(frames * 2, 0.15f);
+      std::vector<float> left(frames);
+      std::vector<float> right(frames);
+      kernels->deinterleave_stereo(left.data(), right.data(), interleaved.data(), frames);
+
+      auto expected = MakeSignal(frames * 2, 0.45f);
+      auto actual = expected;
+      scalar.accumulate_stereo(expected.data(), interleaved.data(), frames, 0.7f, 0.4f);
+      kernels->accumulate_planar_stereo(actual.data(), left.data(), right.data(), frames,
+                                        0.7f, 0.4f);
+      ExpectNear(expected, actual, "planar " + context);
+
+      expected = MakeSignal(frames * 2, 0.65f);
+      actual = expected;
+      scalar.accumulate_stereo_ramp(expected.data(), interleaved.data(), frames,
+                                    0.2f, 1.0f, 0.8f, 0.1f);
+      kernels->accumulate_planar_stereo_ramp(actual.data(), left.data(), right.data(), frames,
+                                             0.2f, 1.0f, 0.8f, 0.1f);
+      ExpectNear(expected, actual, "planar ramp " + context, 1e-5f);
+    }
+  }
+}
+
+TEST(MixKernelsTest, InterleaveRoundTrips) {
+  for (const MixKernels* kernels : GetAvailableMixKernels()) {
+    for (size_t frames : kFrameCounts) {
+      const auto in = MakeSignal(frames * 2, 0.35f);
+      std::vector<float> left(frames);
+      std::vector<float> right(frames);
+      kernels->deinterleave_stereo(left.data(), right.data(), in.data(), frames);
+      for (size_t i = 0; i < frames; ++i) {
+        ASSERT_EQ(left[i], in[i * 2]) << kernels->name;
+        ASSERT_EQ(right[i], in[i * 2 + 1]) << kernels->name;
+      }
+      std::vector<float> out(frames * 2, 0.0f);
+      kernels->interleave_stereo(out.data(), left.data(), right.data(), frames);
+      EXPECT_EQ(in, out) << kernels->name << " frames=" << frames;
+    }
+  }
+}
+
+TEST(MixKernelsTest, ScaleStereoMatchesScalar) {
+  const MixKernels& scalar = GetScalarMixKernels();
+  for (const MixKernels* kernels : GetAvailableMixKernels()) {
+    for (size_t frames : kFrameCounts) {
+      auto expected = MakeSignal(frames * 2, 0.4f);
+      auto actual = expected;
+      scalar.scale_stereo(expected.data(), frames, 0.5f, 1.5f);
+      kernels->scale_stereo(actual.data(), frames, 0.5f, 1.5f);
+      ExpectNear(expected, actual, std::string(kernels->name) + " frames=" + std::to_string(frames));
+    }
+  }
+}
+
+TEST(MixKernelsTest, ApplyGainAndClipMatchesScalarAndClips) {
+  const MixKernels& scalar = GetScalarMixKernels();
+  for (const MixKernels* kernels : GetAvailableMixKernels()) {
+    for (size_t frames : kFrameCounts) {
+      auto expected = MakeSignal(frames * 2, 0.9f);
+      auto actual = expected;
+      scalar.apply_gain_and_clip(expected.data(), expected.size(), 1.2f);
+      kernels->apply_gain_and_clip(actual.data(), actual.size(), 1.2f);
+      ExpectNear(expected, actual, std::string(kernels->name) + " frames=" + std::to_string(frames));
+      for (float sample : actual) {
+        EXPECT_LE(std::abs(sample), 1.0f);
+      }
+    }
+  }
+}
+
+TEST(MixKernelsTest, ConvertS16ToF32MatchesScalar) {
+  const MixKernels& scalar = GetScalarMixKernels();
+  for (const MixKernels* kernels : GetAvailableMixKernels()) {
+    for (size_t frames : kFrameCounts) {
+      std::vector<int16_t> pcm(frames * 2);
+      for (size_t i = 0; i < pcm.size(); ++i) {
+        pcm[i] = static_cast<int16_t>((static_cast<int32_t>(i) * 7919) % 65536 - 32768);
+      }
+      std::vector<float> expected(pcm.size(), 0.0f);
+      std::vector<float> actual(pcm.size(), 0.0f);
+      scalar.convert_s16_to_f32(expected.data(), pcm.data(), pcm.size());
+      kernels->convert_s16_to_f32(actual.data(), pcm.data(), pcm.size());
+      ExpectNear(expected, actual, std::string(kernels->name) + " frames=" + std::to_string(frames));
+      for (float sample : actual) {
+        EXPECT_GE(sample, -1.0f);
+        EXPECT_LT(sample, 1.0f);
+      }
+    }
+  }
+}
+
+TEST(MixKernelsTest, DotProductMatchesScalar) {
+  const MixKernels& scalar = GetScalarMixKernels();
+  for (const MixKernels* kernels : GetAvailableMixKernels()) {
+    for (size_t count : kFrameCounts) {
+      const auto a = MakeSignal(count, 0.6f);
+      const auto b = MakeSignal(count, 2.1f);
+      const float expected = scalar.dot_product(a.data(), b.data(), count);
+      const float actual = kernels->dot_product(a.data(), b.data(), count);
+      EXPECT_NEAR(expected, actual, 1e-5f * (1.0f + static_cast<float>(count)))
+          << kernels->name << " count=" << count;
+    }
+  }
+}
+
+}  // namespace dsp
+}  // namespace sezo
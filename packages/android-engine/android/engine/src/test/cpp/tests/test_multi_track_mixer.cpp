@@ -1,8 +1,10 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cmath>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -170,5 +172,666 @@ TEST(MultiTrackMixerTest, MonoTrackUpmixesToStereo) {
   EXPECT_LT(StereoDiffRms(output), 1e-3f);
 }
 
+TEST(MultiTrackMixerTest, VolumeChangeRampsAcrossOneCallback) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  auto track = std::make_shared<Track>("ramp", path);
+  ASSERT_TRUE(track->Load());
+
+  MultiTrackMixer mixer;
+  mixer.AddTrack(track);
+
+  const size_t frames = 512;
+  auto steady = MixWithRetry(mixer, frames, 0);
+  const float steady_peak = test::MaxAbs(steady.data(), steady.size());
+  ASSERT_GT(steady_peak, 0.01f);
+
+  track->SetVolume(0.0f);
+  std::vector<float> ramped(frames * 2, 0.0f);
+  mixer.Mix(ramped.data(), frames, frames);
+  const size_t edge_samples = 64 * 2;
+  const float head = SegmentMaxAbs(ramped, 0, edge_samples);
+  const float tail = SegmentMaxAbs(ramped, ramped.size() - edge_samples, edge_samples);
+  EXPECT_GT(head, steady_peak * 0.5f);
+  EXPECT_LT(tail, steady_peak * 0.2f);
+
+  std::vector<float> silent(frames * 2, 1.0f);
+  mixer.Mix(silent.data(), frames, frames * 2);
+  EXPECT_LT(test::MaxAbs(silent.data(), silent.size()), 1e-6f);
+}
+
+TEST(MultiTrackMixerTest, PlanarTrackMixesLikeInterleaved) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  auto interleaved = std::make_shared<Track>("interleaved", path);
+  auto planar = std::make_shared<Track>("planar", path);
+  planar->SetPlanar(true);
+  ASSERT_TRUE(interleaved->Load());
+  ASSERT_TRUE(planar->Load());
+  for (auto& track : {interleaved, planar}) {
+    track->SetPan(-0.4f);
+    track->SetVolume(0.8f);
+  }
+
+  MultiTrackMixer interleaved_mixer;
+  MultiTrackMixer planar_mixer;
+  interleaved_mixer.AddTrack(interleaved);
+  planar_mixer.AddTrack(planar);
+
+  const size_t frames = 512;
+  std::vector<float> expected(frames * 2, 0.0f);
+  std::vector<float> actual(frames * 2, 0.0f);
+  for (int block = 0; block < 120; ++block) {
+    if (block == 20) {
+      // Ramped gains across the block
+      interleaved->SetVolume(0.3f);
+      planar->SetVolume(0.3f);
+    } else if (block == 40) {
+      interleaved->SetStretchFactor(0.8f);
+      planar->SetStretchFactor(0.8f);
+    }
+    for (int i = 0; i < 200 && !(interleaved->IsPrimed(frames) && planar->IsPrimed(frames)); ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    const int64_t timeline = static_cast<int64_t>(block) * static_cast<int64_t>(frames);
+    interleaved_mixer.Mix(expected.data(), frames, timeline);
+    planar_mixer.Mix(actual.data(), frames, timeline);
+    for (size_t i = 0; i < expected.size(); ++i) {
+      ASSERT_NEAR(actual[i], expected[i], 1e-6f) << "block " << block << " sample " << i;
+    }
+  }
+}
+
+TEST(MultiTrackMixerTest, ParallelRenderMatchesSerial) {
+  const std::string stereo_path = test::FixturePath("stereo_1khz_1s.wav");
+  const std::string mono_path = test::FixturePath("mono_1khz_1s.wav");
+  if (!test::FileExists(stereo_path) || !test::FileExists(mono_path)) {
+    GTEST_SKIP() << "Missing fixture";
+  }
+
+  MultiTrackMixer serial_mixer;
+  MultiTrackMixer parallel_mixer;
+  parallel_mixer.SetParallelRender(true, 48000, 3);
+  std::vector<std::shared_ptr<Track>> serial_tracks;
+  std::vector<std::shared_ptr<Track>> parallel_tracks;
+  for (int i = 0; i < 6; ++i) {
+    const std::string& path = i % 3 == 2 ? mono_path : stereo_path;
+    for (auto* tracks : {&serial_tracks, &parallel_tracks}) {
+      auto track = std::make_shared<Track>("track_" + std::to_string(i), path);
+      ASSERT_TRUE(track->Load());
+      track->SetPan(i % 2 == 0 ? -0.3f : 0.3f);
+      track->SetVolume(0.2f + 0.1f * static_cast<float>(i));
+      track->SetStartTimeSamples(static_cast<int64_t>(i) * 300);
+      if (i == 1) {
+        track->SetStretchFactor(0.8f);
+      }
+      tracks->push_back(track);
+    }
+  }
+  for (size_t i = 0; i < serial_tracks.size(); ++i) {
+    serial_mixer.AddTrack(serial_tracks[i]);
+    parallel_mixer.AddTrack(parallel_tracks[i]);
+  }
+
+  const size_t frames = 480;
+  std::vector<float> expected(frames * 2, 0.0f);
+  std::vector<float> actual(frames * 2, 0.0f);
+  for (int block = 0; block < 60; ++block) {
+    for (int i = 0; i < 200; ++i) {
+      bool primed = true;
+      for (size_t t = 0; t < serial_tracks.size(); ++t) {
+        primed = primed && serial_tracks[t]->IsPrimed(frames) &&
+                 parallel_tracks[t]->IsPrimed(frames);
+      }
+      if (primed) {
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    const int64_t timeline = static_cast<int64_t>(block) * static_cast<int64_t>(frames);
+    serial_mixer.Mix(expected.data(), frames, timeline);
+    parallel_mixer.Mix(actual.data(), frames, timeline);
+    for (size_t i = 0; i < expected.size(); ++i) {
+      ASSERT_NEAR(actual[i], expected[i], 1e-5f) << "block " << block << " sample " << i;
+    }
+  }
+
+  const auto stats = parallel_mixer.GetParallelRenderStats();
+  EXPECT_EQ(stats.workers, 3u);
+  EXPECT_EQ(stats.pool.batches + stats.fallback_blocks, 60u);
+}
+
+TEST(MultiTrackMixerTest, NeutralMasterStretchLeavesMixUntouched) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  auto plain = std::make_shared<Track>("plain", path);
+  auto routed = std::make_shared<Track>("routed", path);
+  ASSERT_TRUE(plain->Load());
+  ASSERT_TRUE(routed->Load());
+  routed->SetStretchOnMasterBus(true);
+
+  MultiTrackMixer plain_mixer;
+  MultiTrackMixer bus_mixer;
+  bus_mixer.ConfigureMasterStretch(routed->GetOutputSampleRate());
+  bus_mixer.SetMasterStretch(0.0f, 1.0f);
+  EXPECT_FALSE(bus_mixer.IsMasterStretchActive());
+  plain_mixer.AddTrack(plain);
+  bus_mixer.AddTrack(routed);
+
+  const size_t frames = 512;
+  std::vector<float> expected(frames * 2, 0.0f);
+  std::vector<float> actual(frames * 2, 0.0f);
+  for (int block = 0; block < 10; ++block) {
+    for (int i = 0; i < 200 && !(plain->IsPrimed(frames) && routed->IsPrimed(frames)); ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    const int64_t timeline = static_cast<int64_t>(block) * static_cast<int64_t>(frames);
+    plain_mixer.Mix(expected.data(), frames, timeline);
+    bus_mixer.Mix(actual.data(), frames, timeline);
+    ASSERT_EQ(actual, expected) << "block " << block;
+  }
+}
+
+TEST(MultiTrackMixerTest, MasterBusStretchProcessesRoutedTracks) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  std::vector<std::shared_ptr<Track>> tracks;
+  MultiTrackMixer mixer;
+  for (int i = 0; i < 3; ++i) {
+    auto track = std::make_shared<Track>("bus_" + std::to_string(i), path);
+    ASSERT_TRUE(track->Load());
+    track->SetPitchSemitones(4.0f);
+    track->SetStretchFactor(1.5f);
+    track->SetStretchOnMasterBus(true);
+    mixer.AddTrack(track);
+    tracks.push_back(track);
+  }
+  mixer.ConfigureMasterStretch(tracks[0]->GetOutputSampleRate());
+  mixer.SetMasterStretch(4.0f, 1.5f);
+  EXPECT_TRUE(mixer.IsMasterStretchActive());
+
+  // Tracks hand over raw samples; only the bus is stretched
+  core::CircularBuffer::ReadSpan span;
+  for (int i = 0; i < 200 && !tracks[0]->IsPrimed(512); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  ASSERT_TRUE(tracks[0]->AcquireRaw(0, &span));
+  tracks[0]->ReleaseRaw(span);
+
+  const size_t frames = 512;
+  std::vector<float> output(frames * 2, 0.0f);
+  float peak = 0.0f;
+  for (int block = 0; block < 40; ++block) {
+    for (const auto& track : tracks) {
+      for (int i = 0; i < 200 && !track->IsPrimed(frames * 2); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      }
+    }
+    if (block == 20) {
+      mixer.ResetMasterStretch();
+    }
+    mixer.Mix(output.data(), frames, static_cast<int64_t>(block) * static_cast<int64_t>(frames));
+    ASSERT_TRUE(test::AllFinite(output.data(), output.size()));
+    peak = std::max(peak, test::MaxAbs(output.data(), output.size()));
+  }
+  EXPECT_GT(peak, 0.01f);
+}
+
+TEST(MultiTrackMixerTest, RemovedTrackIsReleasedByReclaimThread) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  MultiTrackMixer mixer;
+  std::weak_ptr<Track> weak_track;
+  {
+    auto track = std::make_shared<Track>("reclaim", path);
+    ASSERT_TRUE(track->Load());
+    weak_track = track;
+    mixer.AddTrack(track);
+  }
+
+  MixWithRetry(mixer, 256, 0);
+  ASSERT_TRUE(mixer.RemoveTrack("reclaim"));
+  EXPECT_EQ(mixer.GetTrack("reclaim"), nullptr);
+
+  for (int i = 0; i < 200 && !weak_track.expired(); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  EXPECT_TRUE(weak_track.expired());
+}
+
+TEST(MultiTrackMixerTest, TrackListUpdatesDuringMix) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  auto first = std::make_shared<Track>("first", path);
+  auto second = std::make_shared<Track>("second", path);
+  ASSERT_TRUE(first->Load());
+  ASSERT_TRUE(second->Load());
+
+  MultiTrackMixer mixer;
+  mixer.AddTrack(first);
+
+  std::atomic<bool> running{true};
+  std::thread writer([&]() {
+    while (running.load(std::memory_order_acquire)) {
+      mixer.AddTrack(second);
+      mixer.RemoveTrack("second");
+    }
+  });
+
+  std::vector<float> output(256 * 2, 0.0f);
+  for (int i = 0; i < 500; ++i) {
+    mixer.Mix(output.data(), 256, 0);
+    ASSERT_TRUE(test::AllFinite(output.data(), output.size()));
+  }
+
+  running.store(false, std::memory_order_release);
+  writer.join();
+  EXPECT_EQ(mixer.GetTracks().size(), 1u);
+  EXPECT_EQ(mixer.GetTrack("first"), first);
+}
+
+TEST(MultiTrackMixerTest, ControlChangesReachNextBlock) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  auto left = std::make_shared<Track>("left", path);
+  auto right = std::make_shared<Track>("right", path);
+  ASSERT_TRUE(left->Load());
+  ASSERT_TRUE(right->Load());
+
+  MultiTrackMixer mixer;
+  mixer.AddTrack(left);
+  mixer.AddTrack(right);
+  left->SetPan(-1.0f);
+  right->SetPan(1.0f);
+
+  const size_t frames = 512;
+  auto output = MixWithRetry(mixer, frames, 0);
+  EXPECT_GT(ChannelRms(output, 0, 2), 0.01f);
+  EXPECT_GT(ChannelRms(output, 1, 2), 0.01f);
+
+  // The first block after a change may still ramp the gains
+  int64_t timeline = 0;
+  auto mix_twice = [&]() {
+    for (int i = 0; i < 2; ++i) {
+      mixer.Mix(output.data(), frames, timeline);
+      timeline += static_cast<int64_t>(frames);
+    }
+  };
+
+  left->SetSolo(true);
+  mix_twice();
+  EXPECT_GT(ChannelRms(output, 0, 2), 0.01f);
+  EXPECT_LT(ChannelRms(output, 1, 2), 1e-3f);
+
+  left->SetMuted(true);
+  mix_twice();
+  EXPECT_LT(test::Rms(output.data(), output.size()), 1e-3f);
+
+  // The right track was parked while soloed out and resumes first
+  left->SetSolo(false);
+  for (int i = 0; i < 100 && right->IsResuming(); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    mix_twice();
+  }
+  mix_twice();
+  EXPECT_LT(ChannelRms(output, 0, 2), 1e-3f);
+  EXPECT_GT(ChannelRms(output, 1, 2), 0.01f);
+
+  right->SetStartTimeSamples(timeline + static_cast<int64_t>(frames) * 2);
+  mix_twice();
+  EXPECT_LT(test::Rms(output.data(), output.size()), 1e-3f);
+}
+
+TEST(MultiTrackMixerTest, InaudibleTracksAreParked) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  auto first = std::make_shared<Track>("first", path);
+  auto second = std::make_shared<Track>("second", path);
+  ASSERT_TRUE(first->Load());
+  ASSERT_TRUE(second->Load());
+
+  MultiTrackMixer mixer;
+  mixer.AddTrack(first);
+  mixer.AddTrack(second);
+  EXPECT_FALSE(first->IsParked());
+  EXPECT_FALSE(second->IsParked());
+
+  second->SetSolo(true);
+  EXPECT_TRUE(first->IsParked());
+  EXPECT_FALSE(second->IsParked());
+
+  first->SetMuted(true);
+  second->SetSolo(false);
+  EXPECT_TRUE(first->IsParked());
+
+  first->SetMuted(false);
+  EXPECT_FALSE(first->IsParked());
+  EXPECT_TRUE(first->IsResuming());
+}
+
+TEST(MultiTrackMixerTest, UnmutedTrackResumesInSync) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  auto track = std::make_shared<Track>("resumed", path);
+  auto reference = std::make_shared<Track>("reference", path);
+  ASSERT_TRUE(track->Load());
+  ASSERT_TRUE(reference->Load());
+
+  MultiTrackMixer mixer;
+  MultiTrackMixer reference_mixer;
+  mixer.AddTrack(track);
+  reference_mixer.AddTrack(reference);
+
+  const size_t frames = 256;
+  std::vector<float> output(frames * 2, 0.0f);
+  std::vector<float> expected(frames * 2, 0.0f);
+  int64_t timeline = 0;
+  auto wait_primed = [frames](const std::shared_ptr<Track>& t) {
+    for (int i = 0; i < 200 && !t->IsPrimed(frames); ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  };
+  auto mix_block = [&]() {
+    wait_primed(reference);
+    if (!track->IsParked() && !track->IsResuming()) {
+      wait_primed(track);
+    }
+    mixer.Mix(output.data(), frames, timeline);
+    reference_mixer.Mix(expected.data(), frames, timeline);
+    timeline += static_cast<int64_t>(frames);
+  };
+
+  for (int i = 0; i < 4; ++i) {
+    mix_block();
+  }
+  track->SetMuted(true);
+  ASSERT_TRUE(track->IsParked());
+  for (int i = 0; i < 40; ++i) {
+    mix_block();
+    EXPECT_LT(test::Rms(output.data(), output.size()), 1e-6f);
+  }
+
+  track->SetMuted(false);
+  int silent_blocks = 0;
+  while (track->IsResuming() && silent_blocks < 100) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    mix_block();
+    ++silent_blocks;
+  }
+  ASSERT_FALSE(track->IsResuming());
+  EXPECT_GT(test::Rms(output.data(), output.size()), 0.01f);  // fading in
+
+  // Back on the timeline: sample-identical to the track that never paused
+  for (int i = 0; i < 4; ++i) {
+    mix_block();
+    for (size_t j = 0; j < output.size(); ++j) {
+      ASSERT_NEAR(output[j], expected[j], 1e-6f) << "block " << i << " sample " << j;
+    }
+  }
+}
+
+TEST(MultiTrackMixerTest, TrackOutlivesMixer) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  auto track = std::make_shared<Track>("kept", path);
+  ASSERT_TRUE(track->Load());
+  {
+    MultiTrackMixer mixer;
+    mixer.AddTrack(track);
+    MixWithRetry(mixer, 256, 0);
+  }
+
+  // The destroyed mixer must no longer be notified
+  track->SetVolume(0.5f);
+  track->SetMuted(true);
+  EXPECT_FLOAT_EQ(track->GetVolume(), 0.5f);
+}
+
+TEST(MultiTrackMixerTest, PrimingGateHoldsOutputUntilTracksPrimed) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  auto first = std::make_shared<Track>("first", path);
+  auto second = std::make_shared<Track>("second", path);
+  ASSERT_TRUE(first->Load());
+  ASSERT_TRUE(second->Load());
+
+  MultiTrackMixer mixer;
+  mixer.AddTrack(first);
+  mixer.AddTrack(second);
+
+  const size_t frames = 512;
+  const size_t prime_frames = 4800;
+  std::vector<float> output(frames * 2, 1.0f);
+  mixer.ArmPrimingGate(prime_frames);
+  EXPECT_EQ(mixer.GetLastPrimingLatencyNs(), -1);
+
+  // Held while seeks are in flight, regardless of buffer state
+  EXPECT_FALSE(mixer.Mix(output.data(), frames, 0));
+  EXPECT_LT(test::MaxAbs(output.data(), output.size()), 1e-6f);
+
+  ASSERT_TRUE(first->Seek(0));
+  ASSERT_TRUE(second->Seek(0));
+  mixer.ReleasePrimingHold();
+
+  bool opened = false;
+  for (int i = 0; i < 200 && !opened; ++i) {
+    opened = mixer.Mix(output.data(), frames, 0);
+    if (!opened) {
+      EXPECT_LT(test::MaxAbs(output.data(), output.size()), 1e-6f);
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+  }
+  ASSERT_TRUE(opened);
+  EXPECT_TRUE(first->IsPrimed(prime_frames));
+  EXPECT_TRUE(second->IsPrimed(prime_frames));
+  // The first block after the gate opens is fully buffered audio
+  EXPECT_GT(test::Rms(output.data(), output.size()), 0.01f);
+  EXPECT_GE(mixer.GetLastPrimingLatencyNs(), 0);
+  EXPECT_EQ(mixer.GetPrimingTimeoutCount(), 0u);
+}
+
+TEST(MultiTrackMixerTest, PrimingGateCanBePolledWithoutMixing) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  auto track = std::make_shared<Track>("polled", path);
+  ASSERT_TRUE(track->Load());
+  MultiTrackMixer mixer;
+  mixer.AddTrack(track);
+
+  mixer.ArmPrimingGate(4800);
+  EXPECT_FALSE(mixer.PollPrimingGate(0));
+  ASSERT_TRUE(track->Seek(0));
+  mixer.ReleasePrimingHold();
+
+  bool ready = false;
+  for (int i = 0; i < 200 && !ready; ++i) {
+    ready = mixer.PollPrimingGate(0);
+    if (!ready) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+  }
+  EXPECT_TRUE(ready);
+  EXPECT_GE(mixer.GetLastPrimingLatencyNs(), 0);
+}
+
+TEST(MultiTrackMixerTest, MasterBusStaysAlignedAcrossToggle) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  // The same file mixed directly and through the master bus
+  auto direct_track = std::make_shared<Track>("direct", path);
+  auto bus_track = std::make_shared<Track>("bus", path);
+  ASSERT_TRUE(direct_track->Load());
+  ASSERT_TRUE(bus_track->Load());
+  bus_track->SetStretchOnMasterBus(true);
+  MultiTrackMixer direct;
+  MultiTrackMixer bus;
+  direct.AddTrack(direct_track);
+  bus.AddTrack(bus_track);
+  bus.ConfigureMasterStretch(bus_track->GetOutputSampleRate());
+  bus.SetMasterStretch(4.0f, 1.0f);
+  const int64_t latency = bus.GetMasterLatencyFrames();
+  EXPECT_GT(latency, 0);
+
+  const size_t frames = 256;
+  std::vector<float> direct_out(frames * 2);
+  std::vector<float> bus_out(frames * 2);
+  int64_t timeline = 0;
+  auto mix_block = [&]() {
+    for (int i = 0; i < 200; ++i) {
+      if (direct_track->IsPrimed(frames) &&
+          bus_track->IsPrimed(frames + static_cast<size_t>(latency))) {
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    direct.Mix(direct_out.data(), frames, timeline);
+    bus.Mix(bus_out.data(), frames, timeline);
+    timeline += static_cast<int64_t>(frames);
+  };
+
+  for (int block = 0; block < 4; ++block) {
+    mix_block();
+    ASSERT_TRUE(test::AllFinite(bus_out.data(), bus_out.size()));
+  }
+
+  // Off: the bus tail drains while the bus track holds, then both line up
+  bus.SetMasterStretch(0.0f, 1.0f);
+  EXPECT_EQ(bus.GetMasterLatencyFrames(), 0);
+  const int drain_blocks = static_cast<int>(static_cast<size_t>(latency) / frames) + 1;
+  for (int block = 0; block < drain_blocks; ++block) {
+    mix_block();
+  }
+  mix_block();
+  for (size_t i = 0; i < direct_out.size(); ++i) {
+    ASSERT_FLOAT_EQ(bus_out[i], direct_out[i]) << "sample " << i;
+  }
+}
+
+TEST(MultiTrackMixerTest, MasterBusVarispeedMatchesTrackVarispeed) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  // Resampling the bus once equals resampling each track, since both are
+  // linear; switching off plays out the look-ahead on both paths alike
+  auto direct_track = std::make_shared<Track>("direct", path);
+  auto bus_track = std::make_shared<Track>("bus", path);
+  ASSERT_TRUE(direct_track->Load());
+  ASSERT_TRUE(bus_track->Load());
+  direct_track->SetVarispeed(true);
+  direct_track->SetStretchFactor(0.75f);
+  bus_track->SetStretchOnMasterBus(true);
+  MultiTrackMixer direct;
+  MultiTrackMixer bus;
+  direct.AddTrack(direct_track);
+  bus.AddTrack(bus_track);
+  bus.ConfigureMasterStretch(bus_track->GetOutputSampleRate());
+  bus.SetMasterVarispeed(true);
+  bus.SetMasterStretch(3.0f, 0.75f);
+  EXPECT_TRUE(bus.IsMasterStretchActive());
+  EXPECT_EQ(bus.GetMasterLatencyFrames(), 0);
+
+  const size_t frames = 256;
+  std::vector<float> direct_out(frames * 2);
+  std::vector<float> bus_out(frames * 2);
+  int64_t timeline = 0;
+  auto mix_block = [&]() {
+    for (int i = 0; i < 200; ++i) {
+      if (direct_track->IsPrimed(frames * 2) && bus_track->IsPrimed(frames * 2)) {
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    direct.Mix(direct_out.data(), frames, timeline);
+    bus.Mix(bus_out.data(), frames, timeline);
+    timeline += static_cast<int64_t>(frames);
+    for (size_t i = 0; i < direct_out.size(); ++i) {
+      ASSERT_NEAR(bus_out[i], direct_out[i], 1e-5f) << "sample " << i;
+    }
+  };
+
+  for (int block = 0; block < 4; ++block) {
+    mix_block();
+  }
+  EXPECT_GT(test::Rms(bus_out.data(), bus_out.size()), 0.01f);
+
+  direct_track->SetStretchFactor(1.0f);
+  bus.SetMasterStretch(3.0f, 1.0f);
+  EXPECT_FALSE(bus.IsMasterStretchActive());
+  for (int block = 0; block < 3; ++block) {
+    mix_block();
+  }
+}
+
+TEST(MultiTrackMixerTest, MasterBusPlacesMidBlockStartAtTimelineFrame) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  // The bus reads input frames, so at 0.75x the start 128 output frames in
+  // falls 96 frames into the bus buffer and is heard from output frame 128
+  auto track = std::make_shared<Track>("late", path);
+  ASSERT_TRUE(track->Load());
+  track->SetStretchOnMasterBus(true);
+  track->SetStartTimeSamples(128);
+  MultiTrackMixer mixer;
+  mixer.AddTrack(track);
+  mixer.ConfigureMasterStretch(track->GetOutputSampleRate());
+  mixer.SetMasterVarispeed(true);
+  mixer.SetMasterStretch(0.0f, 0.75f);
+
+  const size_t frames = 512;
+  for (int i = 0; i < 200 && !track->IsPrimed(frames); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  std::vector<float> output(frames * 2, 0.0f);
+  mixer.Mix(output.data(), frames, 0);
+
+  const size_t slack = 16;
+  EXPECT_LT(SegmentMaxAbs(output, 0, (128 - slack) * 2), 1e-4f);
+  EXPECT_GT(test::Rms(output.data() + (128 + slack) * 2, 32 * 2), 0.01f);
+}
+
 }  // namespace playback
 }  // namespace sezo
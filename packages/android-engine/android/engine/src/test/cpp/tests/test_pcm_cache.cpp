@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "audio/MP3Decoder.h"
+#include "audio/PcmCache.h"
+#include "audio/WAVDecoder.h"
+#include "playback/Track.h"
+#include "test_helpers.h"
+
+namespace sezo {
+namespace audio {
+
+namespace {
+
+// Copies a fixture so each test gets sources with distinct cache keys.
+std::string CopyFixture(const std::string& fixture, const std::string& dir, const std::string& name) {
+  const std::string destination = (std::filesystem::path(dir) / name).string();
+  std::filesystem::copy_file(fixture, destination,
+                             std::filesystem::copy_options::overwrite_existing);
+  return destination;
+}
+
+PcmCache::Config MakeConfig(const std::string& dir, int64_t max_bytes) {
+  PcmCache::Config config;
+  config.directory = dir;
+  config.max_bytes = max_bytes;
+  return config;
+}
+
+}  // namespace
+
+TEST(PcmCacheTest, CachedPcmMatchesSourceDecode) {
+  const std::string path = test::FixturePath("short.mp3");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  test::ScopedTempDir dir(test::MakeTempPath("sezo_pcm_cache_", ""));
+  PcmCache cache(MakeConfig(dir.path(), 64LL * 1024 * 1024));
+  EXPECT_EQ(cache.OpenCached(path), nullptr);
+  ASSERT_TRUE(cache.DecodeNow(path));
+  EXPECT_TRUE(cache.Contains(path));
+  EXPECT_EQ(cache.GetEntryCount(), 1u);
+
+  auto cached = cache.OpenCached(path);
+  ASSERT_NE(cached, nullptr);
+  EXPECT_TRUE(static_cast<WAVDecoder*>(cached.get())->IsMemoryMapped());
+
+  MP3Decoder source;
+  ASSERT_TRUE(source.Open(path));
+  ASSERT_EQ(cached->GetFormat().sample_rate, source.GetFormat().sample_rate);
+  ASSERT_EQ(cached->GetFormat().channels, source.GetFormat().channels);
+
+  const size_t channels = static_cast<size_t>(source.GetFormat().channels);
+  std::vector<float> expected(4096 * channels);
+  std::vector<float> actual(4096 * channels);
+  const size_t expected_frames = source.Read(expected.data(), 4096);
+  const size_t actual_frames = cached->Read(actual.data(), 4096);
+  ASSERT_EQ(expected_frames, actual_frames);
+  for (size_t i = 0; i < expected_frames * channels; ++i) {
+    ASSERT_NEAR(expected[i], actual[i], 1.0f / 16384.0f) << "sample " << i;
+  }
+}
+
+TEST(PcmCacheTest, PrefetchDecodesInBackground) {
+  const std::string path = test::FixturePath("short.mp3");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  test::ScopedTempDir dir(test::MakeTempPath("sezo_pcm_cache_", ""));
+  PcmCache cache(MakeConfig(dir.path(), 64LL * 1024 * 1024));
+  cache.Prefetch(path);
+  cache.Prefetch(path);
+  for (int i = 0; i < 500 && !cache.Contains(path); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_TRUE(cache.Contains(path));
+  EXPECT_EQ(cache.GetEntryCount(), 1u);
+}
+
+TEST(PcmCacheTest, EvictsLeastRecentlyUsedOverBudget) {
+  const std::string fixture = test::FixturePath("short.mp3");
+  if (!test::FileExists(fixture)) {
+    GTEST_SKIP() << "Missing fixture: " << fixture;
+  }
+
+  test::ScopedTempDir sources(test::MakeTempPath("sezo_pcm_sources_", ""));
+  test::ScopedTempDir dir(test::MakeTempPath("sezo_pcm_cache_", ""));
+  const std::string a = CopyFixture(fixture, sources.path(), "a.mp3");
+  const std::string b = CopyFixture(fixture, sources.path(), "b.mp3");
+  const std::string c = CopyFixture(fixture, sources.path(), "c.mp3");
+
+  // Measure one entry, then size the budget for two of them
+  int64_t entry_bytes = 0;
+  {
+    test::ScopedTempDir probe_dir(test::MakeTempPath("sezo_pcm_probe_", ""));
+    PcmCache probe(MakeConfig(probe_dir.path(), 64LL * 1024 * 1024));
+    ASSERT_TRUE(probe.DecodeNow(a));
+    entry_bytes = probe.GetTotalBytes();
+  }
+  ASSERT_GT(entry_bytes, 0);
+
+  PcmCache cache(MakeConfig(dir.path(), entry_bytes * 2 + entry_bytes / 2));
+  ASSERT_TRUE(cache.DecodeNow(a));
+  ASSERT_TRUE(cache.DecodeNow(b));
+  ASSERT_NE(cache.OpenCached(a), nullptr);  // a becomes most recently used
+  ASSERT_TRUE(cache.DecodeNow(c));
+
+  EXPECT_EQ(cache.GetEntryCount(), 2u);
+  EXPECT_LE(cache.GetTotalBytes(), cache.GetConfig().max_bytes);
+  EXPECT_TRUE(cache.Contains(a));
+  EXPECT_FALSE(cache.Contains(b));
+  EXPECT_TRUE(cache.Contains(c));
+}
+
+TEST(PcmCacheTest, ReopenRestoresEntries) {
+  const std::string path = test::FixturePath("short.mp3");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  test::ScopedTempDir dir(test::MakeTempPath("sezo_pcm_cache_", ""));
+  {
+    PcmCache cache(MakeConfig(dir.path(), 64LL * 1024 * 1024));
+    ASSERT_TRUE(cache.DecodeNow(path));
+  }
+  PcmCache reopened(MakeConfig(dir.path(), 64LL * 1024 * 1024));
+  EXPECT_TRUE(reopened.Contains(path));
+  EXPECT_NE(reopened.OpenCached(path), nullptr);
+}
+
+TEST(PcmCacheTest, TrackLoadsFromCacheAndSwitchesOnSeek) {
+  const std::string path = test::FixturePath("short.mp3");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  test::ScopedTempDir dir(test::MakeTempPath("sezo_pcm_cache_", ""));
+  auto cache = std::make_shared<PcmCache>(MakeConfig(dir.path(), 64LL * 1024 * 1024));
+
+  playback::Track uncached("uncached", path);
+  uncached.SetPcmCache(cache);
+  ASSERT_TRUE(uncached.Load());
+  EXPECT_FALSE(uncached.IsCacheBacked());
+  for (int i = 0; i < 500 && !cache->Contains(path); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_TRUE(cache->Contains(path));
+  ASSERT_TRUE(uncached.Seek(0));
+  EXPECT_TRUE(uncached.IsCacheBacked());
+
+  playback::Track cached("cached", path);
+  cached.SetPcmCache(cache);
+  ASSERT_TRUE(cached.Load());
+  EXPECT_TRUE(cached.IsCacheBacked());
+  EXPECT_EQ(cached.GetChannels(), uncached.GetChannels());
+  EXPECT_EQ(cached.GetSampleRate(), uncached.GetSampleRate());
+}
+
+}  // namespace audio
+}  // namespace sezo
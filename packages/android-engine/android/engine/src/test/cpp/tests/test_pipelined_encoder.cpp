@@ -0,0 +1,251 @@
+#include <gtest/gtest.h>
+
+#include "audio/WAVEncoder.h"
+#include "extraction/PipelinedEncoder.h"
+#include "test_helpers.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+namespace sezo {
+namespace extraction {
+namespace {
+
+constexpr int32_t kChannels = 2;
+constexpr size_t kBlockFrames = 256;
+
+// Records the first sample of every block; can hold writes or fail one of
+// them.
+class FakeEncoder : public audio::AudioEncoder {
+ public:
+  bool Open(const std::string&, const audio::EncoderConfig&) override { return true; }
+
+  bool Write(const float* samples, size_t frame_count) override {
+    writes_started.fetch_add(1, std::memory_order_acq_rel);
+    while (hold.load(std::memory_order_acquire)) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (static_cast<int32_t>(first_samples.size()) == fail_at) {
+      return false;
+    }
+    first_samples.push_back(samples[0]);
+    frames_written += static_cast<int64_t>(frame_count);
+    return true;
+  }
+
+  bool Close() override { return true; }
+  bool IsOpen() const override { return true; }
+  int64_t GetFramesWritten() const override { return frames_written; }
+  int64_t GetFileSize() const override { return 0; }
+
+  std::atomic<bool> hold{false};
+  std::atomic<size_t> writes_started{0};
+  int32_t fail_at = -1;
+  std::vector<float> first_samples;
+  int64_t frames_written = 0;
+};
+
+void FillBlock(float* block, size_t index) {
+  for (size_t i = 0; i < kBlockFrames * kChannels; ++i) {
+    block[i] = static_cast<float>(index) * 0.01f;
+  }
+}
+
+// Polls until the condition holds. The deadline only keeps a broken build
+// from hanging; nothing is asserted about how long it took.
+template <typename Condition>
+bool WaitFor(Condition condition) {
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (!condition()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+std::vector<char> ReadBytes(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+}  // namespace
+
+TEST(PipelinedEncoderTest, WritesBlocksInOrder) {
+  FakeEncoder encoder;
+  PipelinedEncoder pipeline(&encoder, kChannels, kBlockFrames, 3);
+
+  for (size_t i = 0; i < 20; ++i) {
+    float* block = pipeline.AcquireBlock();
+    ASSERT_NE(block, nullptr);
+    FillBlock(block, i);
+    ASSERT_TRUE(pipeline.SubmitBlock(i == 19 ? kBlockFrames / 2 : kBlockFrames));
+  }
+  ASSERT_TRUE(pipeline.Finish());
+
+  ASSERT_EQ(encoder.first_samples.size(), 20u);
+  for (size_t i = 0; i < 20; ++i) {
+    EXPECT_FLOAT_EQ(encoder.first_samples[i], static_cast<float>(i) * 0.01f);
+  }
+  EXPECT_EQ(encoder.frames_written, static_cast<int64_t>(19 * kBlockFrames + kBlockFrames / 2));
+  EXPECT_EQ(pipeline.GetStats().blocks, 20u);
+}
+
+TEST(PipelinedEncoderTest, WavOutputMatchesInlineEncoding) {
+  audio::EncoderConfig config;
+  config.format = audio::EncoderFormat::kWAV;
+  config.sample_rate = 48000;
+  config.channels = kChannels;
+  config.bits_per_sample = 16;
+
+  auto encode = [&config](size_t depth, const std::string& path) {
+    audio::WAVEncoder encoder;
+    if (!encoder.Open(path, config)) {
+      return false;
+    }
+    PipelinedEncoder pipeline(&encoder, kChannels, kBlockFrames, depth);
+    for (size_t i = 0; i < 50; ++i) {
+      float* block = pipeline.AcquireBlock();
+      if (!block) {
+        return false;
+      }
+      FillBlock(block, i);
+      block[1] = -0.5f;
+      if (!pipeline.SubmitBlock(kBlockFrames)) {
+        return false;
+      }
+    }
+    const bool finished = pipeline.Finish();
+    return encoder.Close() && finished;
+  };
+
+  test::ScopedTempFile inline_file(test::MakeTempPath("sezo_pipe_inline_", ".wav"));
+  test::ScopedTempFile pipelined_file(test::MakeTempPath("sezo_pipe_queued_", ".wav"));
+  ASSERT_TRUE(encode(0, inline_file.path()));
+  ASSERT_TRUE(encode(4, pipelined_file.path()));
+
+  const auto inline_bytes = ReadBytes(inline_file.path());
+  EXPECT_FALSE(inline_bytes.empty());
+  EXPECT_EQ(inline_bytes, ReadBytes(pipelined_file.path()));
+}
+
+TEST(PipelinedEncoderTest, FullPoolHoldsBackRenderer) {
+  FakeEncoder encoder;
+  encoder.hold.store(true);
+  PipelinedEncoder pipeline(&encoder, kChannels, kBlockFrames, 3);
+
+  std::atomic<size_t> submitted{0};
+  std::thread renderer([&] {
+    for (size_t i = 0; i < 10; ++i) {
+      float* block = pipeline.AcquireBlock();
+      if (!block) {
+        return;
+      }
+      FillBlock(block, i);
+      pipeline.SubmitBlock(kBlockFrames);
+      submitted.fetch_add(1);
+    }
+  });
+
+  // The held encoder keeps every block queued, so the renderer stops at the
+  // pool size
+  ASSERT_TRUE(WaitFor([&] { return pipeline.GetStats().render_waits > 0; }));
+  EXPECT_EQ(submitted.load(), 3u);
+  EXPECT_EQ(pipeline.GetStats().blocks, 0u);
+
+  encoder.hold.store(false);
+  renderer.join();
+  ASSERT_TRUE(pipeline.Finish());
+  EXPECT_EQ(encoder.first_samples.size(), 10u);
+  EXPECT_GE(pipeline.GetStats().render_waits, 1u);
+}
+
+TEST(PipelinedEncoderTest, CancelReleasesBothSides) {
+  FakeEncoder encoder;
+  encoder.hold.store(true);
+  std::atomic<bool> cancel{false};
+  PipelinedEncoder pipeline(&encoder, kChannels, kBlockFrames, 2, &cancel);
+
+  std::atomic<bool> renderer_stopped{false};
+  std::thread renderer([&] {
+    while (float* block = pipeline.AcquireBlock()) {
+      FillBlock(block, 0);
+      pipeline.SubmitBlock(kBlockFrames);
+    }
+    renderer_stopped.store(true);
+  });
+
+  ASSERT_TRUE(WaitFor([&] { return pipeline.GetStats().render_waits > 0; }));
+  EXPECT_FALSE(renderer_stopped.load());
+  cancel.store(true);
+  renderer.join();
+  EXPECT_TRUE(renderer_stopped.load());
+
+  encoder.hold.store(false);
+  EXPECT_FALSE(pipeline.Finish());
+  EXPECT_LE(encoder.first_samples.size(), 1u);
+  EXPECT_FALSE(pipeline.HasFailed());
+}
+
+TEST(PipelinedEncoderTest, FailedWriteStopsRenderer) {
+  FakeEncoder encoder;
+  encoder.fail_at = 3;
+  PipelinedEncoder pipeline(&encoder, kChannels, kBlockFrames, 2);
+
+  size_t submitted = 0;
+  for (size_t i = 0; i < 100; ++i) {
+    float* block = pipeline.AcquireBlock();
+    if (!block) {
+      break;
+    }
+    FillBlock(block, i);
+    if (!pipeline.SubmitBlock(kBlockFrames)) {
+      break;
+    }
+    ++submitted;
+  }
+
+  EXPECT_LT(submitted, 100u);
+  EXPECT_FALSE(pipeline.Finish());
+  EXPECT_TRUE(pipeline.HasFailed());
+  EXPECT_EQ(encoder.first_samples.size(), 3u);
+}
+
+TEST(PipelinedEncoderTest, OverlapsRenderingWithSlowEncoder) {
+  FakeEncoder encoder;
+  encoder.hold.store(true);
+  PipelinedEncoder pipeline(&encoder, kChannels, kBlockFrames, 4);
+  ASSERT_TRUE(WaitFor([&] { return pipeline.GetStats().encode_waits > 0; }));
+
+  // While the encoder is stuck in its first write, the rest of the pool can
+  // still be rendered and queued without waiting
+  float* block = pipeline.AcquireBlock();
+  ASSERT_NE(block, nullptr);
+  FillBlock(block, 0);
+  ASSERT_TRUE(pipeline.SubmitBlock(kBlockFrames));
+  ASSERT_TRUE(WaitFor([&] { return encoder.writes_started.load() == 1; }));
+  for (size_t i = 1; i < 4; ++i) {
+    block = pipeline.AcquireBlock();
+    ASSERT_NE(block, nullptr);
+    FillBlock(block, i);
+    ASSERT_TRUE(pipeline.SubmitBlock(kBlockFrames));
+  }
+  EXPECT_EQ(pipeline.GetStats().render_waits, 0u);
+  EXPECT_EQ(pipeline.GetStats().blocks, 0u);
+  EXPECT_EQ(encoder.writes_started.load(), 1u);
+
+  encoder.hold.store(false);
+  ASSERT_TRUE(pipeline.Finish());
+  ASSERT_EQ(encoder.first_samples.size(), 4u);
+  for (size_t i = 0; i < 4; ++i) {
+    EXPECT_FLOAT_EQ(encoder.first_samples[i], static_cast<float>(i) * 0.01f);
+  }
+}
+
+}  // namespace extraction
+}  // namespace sezo
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include "core/QualityGovernor.h"
+
+namespace sezo {
+namespace core {
+
+namespace {
+
+QualityGovernor::Window LoadWindow(double p90_load_percent) {
+  QualityGovernor::Window window;
+  window.callbacks = 50;
+  window.mean_load_percent = p90_load_percent * 0.8;
+  window.p90_load_percent = p90_load_percent;
+  return window;
+}
+
+QualityGovernor::Config TestConfig() {
+  QualityGovernor::Config config;
+  config.step_down_load_percent = 80.0;
+  config.step_up_load_percent = 40.0;
+  config.calm_windows_to_step_up = 3;
+  config.hold_windows = 1;
+  config.max_level = 2;
+  return config;
+}
+
+}  // namespace
+
+TEST(QualityGovernorTest, HighLoadStepsDownAndHolds) {
+  QualityGovernor governor(TestConfig());
+  QualityGovernor::Step step;
+  ASSERT_TRUE(governor.Evaluate(LoadWindow(90.0), &step));
+  EXPECT_EQ(step.level, 1);
+  EXPECT_EQ(step.previous_level, 0);
+  EXPECT_EQ(step.reason, QualityGovernor::Reason::kLoad);
+
+  // The window after a step is ignored
+  EXPECT_FALSE(governor.Evaluate(LoadWindow(90.0), &step));
+  ASSERT_TRUE(governor.Evaluate(LoadWindow(90.0), &step));
+  EXPECT_EQ(step.level, 2);
+
+  // Never past max_level
+  governor.Evaluate(LoadWindow(90.0), &step);
+  EXPECT_FALSE(governor.Evaluate(LoadWindow(90.0), &step));
+  EXPECT_EQ(governor.GetLevel(), 2);
+}
+
+TEST(QualityGovernorTest, XrunsAndDeadlineMissesStepDownAtLowLoad) {
+  QualityGovernor governor(TestConfig());
+  QualityGovernor::Step step;
+  QualityGovernor::Window window = LoadWindow(20.0);
+  window.xruns = 1;
+  ASSERT_TRUE(governor.Evaluate(window, &step));
+  EXPECT_EQ(step.reason, QualityGovernor::Reason::kXRun);
+
+  governor.Reset();
+  window = LoadWindow(20.0);
+  window.deadline_misses = 2;
+  ASSERT_TRUE(governor.Evaluate(window, &step));
+  EXPECT_EQ(step.reason, QualityGovernor::Reason::kDeadlineMiss);
+}
+
+TEST(QualityGovernorTest, CalmWindowsStepBackUp) {
+  QualityGovernor governor(TestConfig());
+  governor.SetLevel(2);
+  QualityGovernor::Step step;
+  EXPECT_FALSE(governor.Evaluate(LoadWindow(10.0), &step));  // hold
+
+  EXPECT_FALSE(governor.Evaluate(LoadWindow(10.0), &step));
+  EXPECT_FALSE(governor.Evaluate(LoadWindow(10.0), &step));
+  ASSERT_TRUE(governor.Evaluate(LoadWindow(10.0), &step));
+  EXPECT_EQ(step.level, 1);
+  EXPECT_EQ(step.reason, QualityGovernor::Reason::kRecovered);
+}
+
+TEST(QualityGovernorTest, MidLoadBreaksCalmRun) {
+  QualityGovernor governor(TestConfig());
+  governor.SetLevel(1);
+  QualityGovernor::Step step;
+  governor.Evaluate(LoadWindow(10.0), &step);  // hold
+  governor.Evaluate(LoadWindow(10.0), &step);
+  governor.Evaluate(LoadWindow(10.0), &step);
+  EXPECT_FALSE(governor.Evaluate(LoadWindow(60.0), &step));
+  EXPECT_FALSE(governor.Evaluate(LoadWindow(10.0), &step));
+  EXPECT_EQ(governor.GetLevel(), 1);
+}
+
+TEST(QualityGovernorTest, EmptyWindowsAreSkipped) {
+  QualityGovernor governor(TestConfig());
+  QualityGovernor::Step step;
+  QualityGovernor::Window window;
+  window.xruns = 3;
+  EXPECT_FALSE(governor.Evaluate(window, &step));
+  EXPECT_EQ(governor.GetLevel(), 0);
+}
+
+TEST(QualityGovernorTest, MakeWindowDiffsSnapshots) {
+  CallbackStats stats;
+  constexpr int32_t kSampleRate = 48000;
+  constexpr int32_t kFrames = 480;  // 10 ms period
+  int64_t start_us = 1000;
+  for (int i = 0; i < 100; ++i) {
+    stats.Record(start_us * 1000, (start_us + 1000) * 1000, kFrames, kSampleRate);
+    start_us += 10000;
+  }
+  const CallbackStats::Snapshot previous = stats.GetSnapshot();
+  for (int i = 0; i < 100; ++i) {
+    stats.Record(start_us * 1000, (start_us + 9000) * 1000, kFrames, kSampleRate);
+    start_us += 10000;
+  }
+  const CallbackStats::Snapshot current = stats.GetSnapshot();
+
+  const QualityGovernor::Window window = QualityGovernor::MakeWindow(previous, current, 2, 5);
+  EXPECT_EQ(window.callbacks, 100u);
+  EXPECT_EQ(window.xruns, 3);
+  // Only the slow half counts: 9 ms of a 10 ms period
+  EXPECT_NEAR(window.mean_load_percent, 90.0, 1.0);
+  EXPECT_GE(window.p90_load_percent, 90.0);
+  EXPECT_LT(window.p90_load_percent, 110.0);
+
+  // A reset in between counts from zero
+  const QualityGovernor::Window restarted = QualityGovernor::MakeWindow(current, previous, -1, -1);
+  EXPECT_EQ(restarted.callbacks, previous.callbacks);
+  EXPECT_EQ(restarted.xruns, 0);
+}
+
+}  // namespace core
+}  // namespace sezo
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "playback/RenderPool.h"
+
+namespace sezo {
+namespace playback {
+
+namespace {
+
+struct CountingContext {
+  std::vector<std::atomic<int>> runs;
+  explicit CountingContext(size_t count) : runs(count) {}
+};
+
+void CountTask(void* context, size_t task) {
+  static_cast<CountingContext*>(context)->runs[task].fetch_add(1, std::memory_order_relaxed);
+}
+
+void SlowTask(void* context [[maybe_unused]], size_t task [[maybe_unused]]) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+}
+
+int64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+TEST(RenderPoolTest, RunsEveryTaskOncePerBatch) {
+  RenderPool pool(3);
+  EXPECT_EQ(pool.GetWorkerCount(), 3u);
+
+  constexpr size_t kTasks = 17;
+  constexpr int kBatches = 500;
+  CountingContext context(kTasks);
+  for (int batch = 0; batch < kBatches; ++batch) {
+    EXPECT_TRUE(pool.Run(&CountTask, &context, kTasks, 0));
+    for (size_t task = 0; task < kTasks; ++task) {
+      ASSERT_EQ(context.runs[task].load(), batch + 1) << "task " << task;
+    }
+  }
+
+  const RenderPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(stats.batches, static_cast<uint64_t>(kBatches));
+  EXPECT_EQ(stats.tasks_on_workers + stats.tasks_on_caller,
+            static_cast<uint64_t>(kTasks) * kBatches);
+  EXPECT_EQ(stats.late_batches, 0u);
+}
+
+TEST(RenderPoolTest, HandlesSmallAndEmptyBatches) {
+  RenderPool pool(1);
+  CountingContext context(4);
+  EXPECT_TRUE(pool.Run(&CountTask, &context, 4, 0));
+  EXPECT_TRUE(pool.Run(&CountTask, &context, 0, 0));
+  for (auto& runs : context.runs) {
+    EXPECT_EQ(runs.load(), 1);
+  }
+}
+
+TEST(RenderPoolTest, ReportsMissedDeadline) {
+  RenderPool pool(2);
+  const int64_t deadline = NowNs() + 1000 * 1000;  // 1 ms for 4 x 2 ms of work
+  EXPECT_FALSE(pool.Run(&SlowTask, nullptr, 4, deadline));
+  EXPECT_EQ(pool.GetStats().late_batches, 1u);
+}
+
+}  // namespace playback
+}  // namespace sezo
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "dsp/Resampler.h"
+
+namespace sezo {
+namespace dsp {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+std::vector<float> MakeSine(double frequency, int32_t sample_rate, size_t frames, int32_t channels) {
+  std::vector<float> samples(frames * static_cast<size_t>(channels));
+  for (size_t i = 0; i < frames; ++i) {
+    const float value = static_cast<float>(
+        0.5 * std::sin(2.0 * kPi * frequency * static_cast<double>(i) / sample_rate));
+    for (int32_t c = 0; c < channels; ++c) {
+      samples[i * channels + c] = value;
+    }
+  }
+  return samples;
+}
+
+// Runs the resampler in fixed output blocks, feeding input as requested.
+std::vector<float> ResampleInBlocks(Resampler& resampler,
+                                    const std::vector<float>& input,
+                                    size_t output_frames,
+                                    size_t block_frames) {
+  const size_t channels = static_cast<size_t>(resampler.GetChannels());
+  const size_t input_frames = input.size() / channels;
+  std::vector<float> output(output_frames * channels, 0.0f);
+  size_t consumed = 0;
+  for (size_t produced = 0; produced < output_frames;) {
+    const size_t frames = std::min(block_frames, output_frames - produced);
+    const size_t needed = resampler.GetInputFramesNeeded(frames);
+    const size_t available = consumed < input_frames ? input_frames - consumed : 0;
+    resampler.Process(input.data() + std::min(consumed, input_frames) * channels,
+                      std::min(needed, available),
+                      output.data() + produced * channels,
+                      frames);
+    consumed += needed;
+    produced += frames;
+  }
+  return output;
+}
+
+// Max error against an ideal sine at the output rate, skipping the edges.
+double MaxSineError(const std::vector<float>& output,
+                    double frequency,
+                    int32_t sample_rate,
+                    int32_t channels,
+                    size_t skip_frames) {
+  const size_t frames = output.size() / static_cast<size_t>(channels);
+  double max_error = 0.0;
+  for (size_t i = skip_frames; i + skip_frames < frames; ++i) {
+    const double expected = 0.5 * std::sin(2.0 * kPi * frequency * static_cast<double>(i) / sample_rate);
+    for (int32_t c = 0; c < channels; ++c) {
+      max_error = std::max(max_error, std::abs(output[i * channels + c] - expected));
+    }
+  }
+  return max_error;
+}
+
+}  // namespace
+
+TEST(ResamplerTest, DownsamplesSineAccurately) {
+  const auto input = MakeSine(1000.0, 48000, 48000, 2);
+  Resampler resampler(48000, 44100, 2);
+  const auto output = ResampleInBlocks(resampler, input, 44100, 512);
+  EXPECT_LT(MaxSineError(output, 1000.0, 44100, 2, 64), 1e-3);
+}
+
+TEST(ResamplerTest, UpsamplesSineAccurately) {
+  const auto input = MakeSine(1000.0, 44100, 44100, 1);
+  Resampler resampler(44100, 48000, 1);
+  const auto output = ResampleInBlocks(resampler, input, 48000, 480);
+  EXPECT_LT(MaxSineError(output, 1000.0, 48000, 1, 64), 1e-3);
+}
+
+TEST(ResamplerTest, IrrationalRatioUsesApproximatePhases) {
+  const auto input = MakeSine(440.0, 44101, 44101, 1);
+  Resampler resampler(44101, 48000, 1);
+  const auto output = ResampleInBlocks(resampler, input, 48000, 256);
+  EXPECT_LT(MaxSineError(output, 440.0, 48000, 1, 64), 2e-3);
+}
+
+TEST(ResamplerTest, BlockSizeDoesNotChangeOutput) {
+  const auto input = MakeSine(1000.0, 48000, 24000, 2);
+  Resampler one_shot(48000, 44100, 2);
+  Resampler chunked(48000, 44100, 2);
+  const auto expected = ResampleInBlocks(one_shot, input, 22000, 22000);
+  const auto actual = ResampleInBlocks(chunked, input, 22000, 113);
+  ASSERT_EQ(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_NEAR(expected[i], actual[i], 1e-6f) << "sample " << i;
+  }
+}
+
+TEST(ResamplerTest, ConsumesInputAtRateRatio) {
+  Resampler resampler(48000, 44100, 2);
+  std::vector<float> input(48000 * 2, 0.0f);
+  std::vector<float> output(441 * 2, 0.0f);
+  size_t consumed = 0;
+  for (int block = 0; block < 100; ++block) {
+    const size_t needed = resampler.GetInputFramesNeeded(441);
+    resampler.Process(input.data(), needed, output.data(), 441);
+    consumed += needed;
+  }
+  // 44100 output frames consume 48000 input frames plus the initial look-ahead.
+  EXPECT_EQ(consumed, 48000u + Resampler::kTapsPerPhase / 2 + 1);
+}
+
+TEST(ResamplerTest, ResetRestartsFromSilence) {
+  const auto input = MakeSine(1000.0, 48000, 4800, 1);
+  Resampler resampler(48000, 44100, 1);
+  const auto first = ResampleInBlocks(resampler, input, 4000, 256);
+  resampler.Reset();
+  const auto second = ResampleInBlocks(resampler, input, 4000, 256);
+  for (size_t i = 0; i < first.size(); ++i) {
+    ASSERT_NEAR(first[i], second[i], 1e-6f) << "sample " << i;
+  }
+}
+
+}  // namespace dsp
+}  // namespace sezo
@@ -27,6 +27,48 @@ TEST(TimeStretchTest, PassThroughWhenInactive) {
   }
 }
 
+TEST(TimeStretchTest, PlanarMatchesInterleaved) {
+  TimeStretch interleaved(48000, 2);
+  TimeStretch planar(48000, 2);
+  interleaved.SetPitchSemitones(4.0f);
+  planar.SetPitchSemitones(4.0f);
+
+  const size_t input_frames = 600;
+  const size_t output_frames = 512;
+  const size_t available = 550;  // short read: the tail is silence
+  std::vector<float> input(input_frames * 2, 0.0f);
+  std::vector<float> left(available);
+  std::vector<float> right(available);
+  for (size_t i = 0; i < available; ++i) {
+    left[i] = std::sin(static_cast<float>(i) * 0.05f);
+    right[i] = std::cos(static_cast<float>(i) * 0.03f) * 0.5f;
+    input[i * 2] = left[i];
+    input[i * 2 + 1] = right[i];
+  }
+
+  std::vector<float> expected(output_frames * 2, 0.0f);
+  interleaved.Process(input.data(), input_frames, expected.data(), output_frames);
+
+  // Planes split in two segments, as when reading across a ring buffer wrap
+  const size_t split = 200;
+  TimeStretch::PlanarInput planes;
+  planes.first[0] = left.data();
+  planes.first[1] = right.data();
+  planes.first_frames = split;
+  planes.second[0] = left.data() + split;
+  planes.second[1] = right.data() + split;
+  planes.available_frames = available;
+  std::vector<float> out_left(output_frames, 1.0f);
+  std::vector<float> out_right(output_frames, 1.0f);
+  float* outputs[2] = {out_left.data(), out_right.data()};
+  planar.ProcessPlanar(planes, input_frames, outputs, output_frames);
+
+  for (size_t i = 0; i < output_frames; ++i) {
+    ASSERT_EQ(out_left[i], expected[i * 2]) << i;
+    ASSERT_EQ(out_right[i], expected[i * 2 + 1]) << i;
+  }
+}
+
 TEST(TimeStretchTest, PitchDoesNotChangeDuration) {
   TimeStretch stretch(48000, 2);
   stretch.SetPitchSemitones(5.0f);
@@ -104,5 +146,78 @@ TEST(TimeStretchTest, SilenceProducesSilenceWithoutNaNs) {
   EXPECT_LT(test::MaxAbs(output.data(), output.size()), 1e-4f);
 }
 
+TEST(TimeStretchTest, PrerollCoversLatencyAtCurrentSpeed) {
+  TimeStretch stretch(48000, 2);
+  const size_t latency = static_cast<size_t>(stretch.GetLatencyFrames());
+  EXPECT_GT(latency, 0u);
+  EXPECT_EQ(stretch.GetPrerollInputFrames(), latency);
+  stretch.SetStretchFactor(1.5f);
+  EXPECT_EQ(stretch.GetPrerollInputFrames(),
+            static_cast<size_t>(std::ceil(static_cast<float>(latency) * 1.5f)));
+}
+
+TEST(TimeStretchTest, PrerollAndDrainStayFinite) {
+  TimeStretch stretch(48000, 2);
+  stretch.SetPitchSemitones(4.0f);
+
+  const size_t preroll = stretch.GetPrerollInputFrames();
+  std::vector<float> input(preroll * 2);
+  for (size_t i = 0; i < preroll; ++i) {
+    const float value = std::sin(static_cast<float>(i) * 0.05f) * 0.5f;
+    input[i * 2] = value;
+    input[i * 2 + 1] = value;
+  }
+  stretch.Preroll(input.data(), preroll);
+
+  // The tail can be drained even with the effect switched off
+  stretch.SetPitchSemitones(0.0f);
+  const size_t latency = static_cast<size_t>(stretch.GetLatencyFrames());
+  std::vector<float> tail(latency * 2, 0.0f);
+  stretch.Drain(tail.data(), latency);
+  EXPECT_TRUE(test::AllFinite(tail.data(), tail.size()));
+}
+
+TEST(TimeStretchTest, QualitySwitchCrossfadesAndKeepsLatency) {
+  TimeStretch stretch(48000, 2);
+  stretch.SetPitchSemitones(4.0f);
+  const int32_t latency = stretch.GetLatencyFrames();
+
+  stretch.SetQuality(TimeStretch::Quality::kLow, 256);
+  EXPECT_EQ(stretch.GetQuality(), TimeStretch::Quality::kLow);
+  EXPECT_EQ(stretch.GetActiveQuality(), TimeStretch::Quality::kHigh);
+  EXPECT_EQ(stretch.GetLatencyFrames(), latency);
+
+  const size_t frames = 512;
+  std::vector<float> input(frames * 2);
+  std::vector<float> output(frames * 2);
+  size_t position = 0;
+  for (int block = 0; block < 64; ++block) {
+    for (size_t i = 0; i < frames; ++i, ++position) {
+      const float value = std::sin(static_cast<float>(position) * 0.05f) * 0.5f;
+      input[i * 2] = value;
+      input[i * 2 + 1] = value;
+    }
+    stretch.Process(input.data(), frames, output.data(), frames);
+    ASSERT_TRUE(test::AllFinite(output.data(), output.size()));
+    EXPECT_LT(test::MaxAbs(output.data(), output.size()), 2.0f);
+  }
+  EXPECT_EQ(stretch.GetActiveQuality(), TimeStretch::Quality::kLow);
+  EXPECT_EQ(stretch.GetLatencyFrames(), latency);
+}
+
+TEST(TimeStretchTest, ResetAdoptsRequestedQuality) {
+  TimeStretch stretch(48000, 2);
+  stretch.SetQuality(TimeStretch::Quality::kMedium, 256);
+  stretch.Reset();
+  EXPECT_EQ(stretch.GetActiveQuality(), TimeStretch::Quality::kMedium);
+
+  stretch.SetPitchSemitones(-3.0f);
+  const size_t frames = 512;
+  std::vector<float> input(frames * 2, 0.25f);
+  std::vector<float> output(frames * 2);
+  stretch.Process(input.data(), frames, output.data(), frames);
+  EXPECT_TRUE(test::AllFinite(output.data(), output.size()));
+}
+
 }  // namespace playback
 }  // namespace sezo
@@ -127,5 +127,364 @@ TEST(TrackTest, VolumeAndPanApplied) {
   EXPECT_LT(hard_left_right, 1e-3f);
 }
 
+TEST(TrackTest, ReadRawIgnoresVolumeAndPan) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  Track track("track_raw", path);
+  ASSERT_TRUE(track.Load());
+  ASSERT_EQ(track.GetChannels(), 2);
+  track.SetVolume(0.0f);
+  track.SetPan(-1.0f);
+
+  const size_t frames = 1024;
+  std::vector<float> output(frames * 2, 0.0f);
+  for (int i = 0; i < 50 && test::Rms(output.data(), output.size()) <= 1e-4f; ++i) {
+    track.ReadRaw(output.data(), frames);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  EXPECT_GT(ChannelRms(output, 0, 2), 0.01f);
+  EXPECT_GT(ChannelRms(output, 1, 2), 0.01f);
+}
+
+TEST(TrackTest, OutputSampleRateResamplesDurationAndAudio) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  Track track("track_resampled", path);
+  track.SetOutputSampleRate(44100);
+  ASSERT_TRUE(track.Load());
+  EXPECT_EQ(track.GetSampleRate(), 48000);
+  EXPECT_EQ(track.GetOutputSampleRate(), 44100);
+  EXPECT_EQ(track.GetDuration(), 44100);
+
+  const size_t frames = 1024;
+  auto output = ReadSamplesWithRetry(track, frames, 2);
+  EXPECT_TRUE(test::AllFinite(output.data(), output.size()));
+  EXPECT_GT(test::Rms(output.data(), output.size()), 0.01f);
+}
+
+TEST(TrackTest, AcquireRawMatchesReadRawUntilTimeStretched) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  Track copied("copied", path);
+  Track borrowed("borrowed", path);
+  ASSERT_TRUE(copied.Load());
+  ASSERT_TRUE(borrowed.Load());
+
+  const size_t frames = 512;
+  for (int i = 0; i < 200 && !(copied.IsPrimed(frames) && borrowed.IsPrimed(frames)); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  ASSERT_TRUE(copied.IsPrimed(frames));
+  ASSERT_TRUE(borrowed.IsPrimed(frames));
+
+  std::vector<float> expected(frames * 2, 0.0f);
+  ASSERT_EQ(copied.ReadRaw(expected.data(), frames), frames);
+
+  core::CircularBuffer::ReadSpan span;
+  ASSERT_TRUE(borrowed.AcquireRaw(frames, &span));
+  ASSERT_EQ(span.size(), frames * 2);
+  std::vector<float> actual(span.first, span.first + span.first_count);
+  actual.insert(actual.end(), span.second, span.second + span.second_count);
+  borrowed.ReleaseRaw(span);
+  EXPECT_EQ(actual, expected);
+
+  // The next read continues after the released span
+  ASSERT_EQ(copied.ReadRaw(expected.data(), frames), frames);
+  ASSERT_EQ(borrowed.ReadRaw(actual.data(), frames), frames);
+  EXPECT_EQ(actual, expected);
+
+  borrowed.SetPitchSemitones(3.0f);
+  EXPECT_FALSE(borrowed.AcquireRaw(frames, &span));
+}
+
+TEST(TrackTest, MasterBusRoutingBypassesOwnStretcher) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  Track track("bus", path);
+  ASSERT_TRUE(track.Load());
+  const size_t frames = 256;
+  for (int i = 0; i < 200 && !track.IsPrimed(frames); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+
+  track.SetPitchSemitones(5.0f);
+  core::CircularBuffer::ReadSpan span;
+  EXPECT_FALSE(track.AcquireRaw(frames, &span));
+
+  // On the master bus the track plays unstretched but keeps its settings
+  track.SetStretchOnMasterBus(true);
+  EXPECT_TRUE(track.IsStretchOnMasterBus());
+  EXPECT_FLOAT_EQ(track.GetPitchSemitones(), 5.0f);
+  ASSERT_TRUE(track.AcquireRaw(frames, &span));
+  EXPECT_EQ(span.size(), frames * 2);
+  track.ReleaseRaw(span);
+
+  track.SetStretchOnMasterBus(false);
+  EXPECT_FALSE(track.AcquireRaw(frames, &span));
+}
+
+TEST(TrackTest, PlanarPathMatchesInterleaved) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  Track interleaved("interleaved", path);
+  Track planar("planar", path);
+  planar.SetPlanar(true);
+  ASSERT_TRUE(interleaved.Load());
+  ASSERT_TRUE(planar.Load());
+  EXPECT_FALSE(interleaved.IsPlanar());
+  EXPECT_TRUE(planar.IsPlanar());
+
+  const size_t frames = 480;
+  auto wait_primed = [&]() {
+    for (int i = 0; i < 200 && !(interleaved.IsPrimed(frames) && planar.IsPrimed(frames)); ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    ASSERT_TRUE(interleaved.IsPrimed(frames));
+    ASSERT_TRUE(planar.IsPrimed(frames));
+  };
+  wait_primed();
+
+  std::vector<float> expected(frames * 2, 0.0f);
+  std::vector<float> actual(frames * 2, 0.0f);
+  ASSERT_EQ(interleaved.ReadRaw(expected.data(), frames), frames);
+  ASSERT_EQ(planar.ReadRaw(actual.data(), frames), frames);
+  EXPECT_EQ(actual, expected);
+
+  // Borrowed planes continue where the copy left off
+  core::CircularBuffer::ReadSpan span;
+  EXPECT_FALSE(planar.AcquireRaw(frames, &span));
+  Track::PlanarBlock block;
+  EXPECT_FALSE(interleaved.AcquirePlanar(frames, &block));
+  ASSERT_TRUE(planar.AcquirePlanar(frames, &block));
+  ASSERT_EQ(block.size(), frames);
+  ASSERT_EQ(interleaved.ReadRaw(expected.data(), frames), frames);
+  for (size_t i = 0; i < frames; ++i) {
+    const int segment = i < block.frames[0] ? 0 : 1;
+    const size_t index = segment == 0 ? i : i - block.frames[0];
+    ASSERT_EQ(block.left[segment][index], expected[i * 2]) << i;
+    ASSERT_EQ(block.right[segment][index], expected[i * 2 + 1]) << i;
+  }
+  planar.ReleasePlanar(block);
+
+  // Time-stretched output is identical too, for many blocks across the ring
+  // wrap point
+  interleaved.SetStretchFactor(1.25f);
+  planar.SetStretchFactor(1.25f);
+  for (int block_index = 0; block_index < 150; ++block_index) {
+    wait_primed();
+    ASSERT_EQ(interleaved.ReadRaw(expected.data(), frames), frames);
+    ASSERT_EQ(planar.ReadRaw(actual.data(), frames), frames);
+    ASSERT_EQ(actual, expected) << "block " << block_index;
+  }
+}
+
+TEST(TrackTest, StretchAheadLeavesCallbackCopyOnly) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  const size_t max_ahead = 4800;
+  Track track("ahead", path);
+  track.SetStretchAhead(true, max_ahead);
+  ASSERT_TRUE(track.Load());
+  EXPECT_TRUE(track.IsStretchAhead());
+  EXPECT_EQ(track.GetEffectLatencyFrames(), 0);
+
+  // Turning the effect on re-renders whatever was buffered unstretched
+  track.SetPitchSemitones(5.0f);
+  const size_t frames = 256;
+  for (int i = 0; i < 200 && !(track.GetStretchFlushCount() > 0 && track.IsPrimed(frames)); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  EXPECT_GE(track.GetStretchFlushCount(), 1u);
+  ASSERT_TRUE(track.IsPrimed(frames));
+
+  // The lead stays bounded: the limit plus at most one stretched chunk
+  const int64_t latency = track.GetEffectLatencyFrames();
+  EXPECT_GT(latency, 0);
+  EXPECT_LE(latency, static_cast<int64_t>(max_ahead + max_ahead / 2));
+
+  // Already stretched, so the mixer can borrow the ring in place
+  core::CircularBuffer::ReadSpan span;
+  ASSERT_TRUE(track.AcquireRaw(frames, &span));
+  EXPECT_EQ(span.size(), frames * 2);
+  track.ReleaseRaw(span);
+
+  const auto output = ReadSamplesWithRetry(track, frames, 2);
+  EXPECT_TRUE(test::AllFinite(output.data(), output.size()));
+  EXPECT_GT(test::Rms(output.data(), output.size()), 1e-4f);
+}
+
+TEST(TrackTest, StretchAheadFlushesOnlyOnLargeChanges) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  Track track("ahead", path);
+  track.SetStretchAhead(true, 4800);
+  ASSERT_TRUE(track.Load());
+  track.SetPitchSemitones(3.0f);
+
+  const size_t frames = 256;
+  std::vector<float> output(frames * 2, 0.0f);
+  auto play = [&](int blocks) {
+    for (int i = 0; i < blocks; ++i) {
+      track.ReadSamples(output.data(), frames);
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+  };
+  for (int i = 0; i < 200 && track.GetStretchFlushCount() == 0; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  const uint64_t flushes = track.GetStretchFlushCount();
+  ASSERT_GE(flushes, 1u);
+
+  // A small nudge applies to the audio rendered next
+  track.SetPitchSemitones(3.2f);
+  play(20);
+  EXPECT_EQ(track.GetStretchFlushCount(), flushes);
+
+  // A large jump discards the lead and re-renders
+  track.SetPitchSemitones(-4.0f);
+  for (int i = 0; i < 200 && track.GetStretchFlushCount() == flushes; ++i) {
+    play(1);
+  }
+  EXPECT_EQ(track.GetStretchFlushCount(), flushes + 1);
+  EXPECT_TRUE(test::AllFinite(output.data(), output.size()));
+}
+
+TEST(TrackTest, StretchLatencyIsCompensatedAcrossEffectToggle) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  Track plain("plain", path);
+  Track pitched("pitched", path);
+  ASSERT_TRUE(plain.Load());
+  ASSERT_TRUE(pitched.Load());
+  EXPECT_EQ(pitched.GetProcessingLatencyFrames(), 0);
+
+  const size_t frames = 256;
+  std::vector<float> plain_out(frames * 2);
+  std::vector<float> pitched_out(frames * 2);
+  auto read_block = [&]() {
+    for (int i = 0; i < 200 && !(plain.IsPrimed(frames) && pitched.IsPrimed(frames)); ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    ASSERT_EQ(plain.ReadRaw(plain_out.data(), frames), frames);
+    ASSERT_EQ(pitched.ReadRaw(pitched_out.data(), frames), frames);
+  };
+
+  // Switching on pre-rolls the stretcher's latency from the buffer
+  pitched.SetPitchSemitones(4.0f);
+  const int64_t latency = pitched.GetProcessingLatencyFrames();
+  EXPECT_GT(latency, 0);
+  for (int block = 0; block < 4; ++block) {
+    read_block();
+    ASSERT_TRUE(test::AllFinite(pitched_out.data(), pitched_out.size()));
+  }
+
+  // Switching off plays the tail out for as long, after which both tracks
+  // read the same position again
+  pitched.SetPitchSemitones(0.0f);
+  EXPECT_EQ(pitched.GetProcessingLatencyFrames(), 0);
+  const int drain_blocks = static_cast<int>(static_cast<size_t>(latency) / frames) + 1;
+  for (int block = 0; block < drain_blocks; ++block) {
+    read_block();
+  }
+  read_block();
+  for (size_t i = 0; i < plain_out.size(); ++i) {
+    ASSERT_FLOAT_EQ(pitched_out[i], plain_out[i]) << "sample " << i;
+  }
+}
+
+TEST(TrackTest, VarispeedMatchesOfflineResamplingAcrossModeSwitch) {
+  const std::string path = test::FixturePath("stereo_1khz_1s.wav");
+  if (!test::FileExists(path)) {
+    GTEST_SKIP() << "Missing fixture: " << path;
+  }
+
+  // The plain track feeds a standalone resampler run in the same blocks
+  Track plain("plain", path);
+  Track varispeed("varispeed", path);
+  Track planar("planar", path);
+  planar.SetPlanar(true);
+  ASSERT_TRUE(plain.Load());
+  ASSERT_TRUE(varispeed.Load());
+  ASSERT_TRUE(planar.Load());
+  for (Track* track : {&varispeed, &planar}) {
+    track->SetVarispeed(true);
+    track->SetStretchFactor(1.5f);
+    EXPECT_EQ(track->GetProcessingLatencyFrames(), 0);
+  }
+  dsp::Varispeed reference(2);
+  reference.SetRate(1.5);
+
+  const size_t frames = 256;
+  std::vector<float> input;
+  std::vector<float> expected(frames * 2);
+  std::vector<float> actual(frames * 2);
+  auto wait_primed = [&](size_t plain_frames) {
+    for (int i = 0; i < 200 && !(plain.IsPrimed(plain_frames) && varispeed.IsPrimed(plain_frames) &&
+                                 planar.IsPrimed(plain_frames));
+         ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+  };
+  auto compare = [&]() {
+    for (Track* track : {&varispeed, &planar}) {
+      ASSERT_EQ(track->ReadRaw(actual.data(), frames), frames);
+      for (size_t i = 0; i < actual.size(); ++i) {
+        ASSERT_FLOAT_EQ(actual[i], expected[i]) << track->GetId() << " sample " << i;
+      }
+    }
+  };
+
+  for (int block = 0; block < 6; ++block) {
+    if (block == 3) {
+      // Quality tiers can change mid-stream
+      reference.SetQuality(dsp::Varispeed::Quality::kCubic);
+      varispeed.SetVarispeedQuality(dsp::Varispeed::Quality::kCubic);
+      planar.SetVarispeedQuality(dsp::Varispeed::Quality::kCubic);
+    }
+    const size_t needed = reference.GetInputFramesNeeded(frames);
+    input.resize(needed * 2);
+    wait_primed(needed);
+    ASSERT_EQ(plain.ReadRaw(input.data(), needed), needed);
+    reference.Process(input.data(), needed, expected.data(), frames);
+    compare();
+  }
+
+  // Back at unit speed the look-ahead plays out, then the ring continues
+  // from where the resampler stopped reading
+  varispeed.SetStretchFactor(1.0f);
+  planar.SetStretchFactor(1.0f);
+  const size_t drained = reference.Drain(expected.data(), frames);
+  EXPECT_GT(drained, 0u);
+  wait_primed(frames);
+  plain.ReadRaw(expected.data() + drained * 2, frames - drained);
+  compare();
+  plain.ReadRaw(expected.data(), frames);
+  compare();
+}
+
 }  // namespace playback
 }  // namespace sezo
@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "dsp/Varispeed.h"
+
+namespace sezo {
+namespace dsp {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+std::vector<float> MakeSine(double frequency, int32_t sample_rate, size_t frames, int32_t channels) {
+  std::vector<float> samples(frames * static_cast<size_t>(channels));
+  for (size_t i = 0; i < frames; ++i) {
+    const float value = static_cast<float>(
+        0.5 * std::sin(2.0 * kPi * frequency * static_cast<double>(i) / sample_rate));
+    for (int32_t c = 0; c < channels; ++c) {
+      samples[i * channels + c] = value;
+    }
+  }
+  return samples;
+}
+
+// Runs the resampler in fixed output blocks, feeding input as requested.
+// Returns the number of input frames consumed through consumed_frames.
+std::vector<float> ProcessInBlocks(Varispeed& varispeed,
+                                   const std::vector<float>& input,
+                                   size_t output_frames,
+                                   size_t block_frames,
+                                   size_t* consumed_frames = nullptr) {
+  const size_t channels = static_cast<size_t>(varispeed.GetChannels());
+  const size_t input_frames = input.size() / channels;
+  std::vector<float> output(output_frames * channels, 0.0f);
+  size_t consumed = 0;
+  for (size_t produced = 0; produced < output_frames;) {
+    const size_t frames = std::min(block_frames, output_frames - produced);
+    const size_t needed = varispeed.GetInputFramesNeeded(frames);
+    const size_t available = consumed < input_frames ? input_frames - consumed : 0;
+    varispeed.Process(input.data() + std::min(consumed, input_frames) * channels,
+                      std::min(needed, available),
+                      output.data() + produced * channels,
+                      frames);
+    consumed += needed;
+    produced += frames;
+  }
+  if (consumed_frames) {
+    *consumed_frames = consumed;
+  }
+  return output;
+}
+
+// Max error against a sine at the given output frequency, skipping the edges.
+double MaxSineError(const std::vector<float>& output,
+                    double frequency,
+                    int32_t sample_rate,
+                    int32_t channels,
+                    size_t skip_frames) {
+  const size_t frames = output.size() / static_cast<size_t>(channels);
+  double max_error = 0.0;
+  for (size_t i = skip_frames; i + skip_frames < frames; ++i) {
+    const double expected = 0.5 * std::sin(2.0 * kPi * frequency * static_cast<double>(i) / sample_rate);
+    for (int32_t c = 0; c < channels; ++c) {
+      max_error = std::max(max_error, std::abs(output[i * channels + c] - expected));
+    }
+  }
+  return max_error;
+}
+
+}  // namespace
+
+TEST(VarispeedTest, CubicAtUnitRatePassesInputThrough) {
+  const auto input = MakeSine(1000.0, 48000, 4800, 2);
+  Varispeed varispeed(2);
+  varispeed.SetQuality(Varispeed::Quality::kCubic);
+  const auto output = ProcessInBlocks(varispeed, input, 4000, 256);
+  for (size_t i = 0; i < output.size(); ++i) {
+    ASSERT_FLOAT_EQ(output[i], input[i]) << "sample " << i;
+  }
+}
+
+TEST(VarispeedTest, SpeedScalesFrequency) {
+  // Half speed plays a 1 kHz tone at 500 Hz, double speed at 2 kHz
+  const auto input = MakeSine(1000.0, 48000, 96000, 1);
+  for (auto quality : {Varispeed::Quality::kCubic, Varispeed::Quality::kSinc}) {
+    Varispeed slow(1);
+    slow.SetQuality(quality);
+    slow.SetRate(0.5);
+    EXPECT_LT(MaxSineError(ProcessInBlocks(slow, input, 24000, 480), 500.0, 48000, 1, 64), 2e-3);
+
+    Varispeed fast(1);
+    fast.SetQuality(quality);
+    fast.SetRate(2.0);
+    EXPECT_LT(MaxSineError(ProcessInBlocks(fast, input, 24000, 480), 2000.0, 48000, 1, 64), 2e-3);
+  }
+}
+
+TEST(VarispeedTest, SincRejectsToneAboveScaledNyquist) {
+  // At double speed an 18 kHz tone would land above Nyquist; the sinc tier
+  // filters it instead of folding it back into the audible band
+  const auto input = MakeSine(18000.0, 48000, 48000, 1);
+  Varispeed sinc(1);
+  sinc.SetQuality(Varispeed::Quality::kSinc);
+  sinc.SetRate(2.0);
+  const auto filtered = ProcessInBlocks(sinc, input, 12000, 512);
+
+  Varispeed cubic(1);
+  cubic.SetQuality(Varispeed::Quality::kCubic);
+  cubic.SetRate(2.0);
+  const auto aliased = ProcessInBlocks(cubic, input, 12000, 512);
+
+  auto rms = [](const std::vector<float>& samples) {
+    double sum = 0.0;
+    for (size_t i = 256; i < samples.size(); ++i) {
+      sum += static_cast<double>(samples[i]) * samples[i];
+    }
+    return std::sqrt(sum / static_cast<double>(samples.size() - 256));
+  };
+  EXPECT_LT(rms(filtered), 0.02);
+  EXPECT_GT(rms(aliased), 0.1);
+}
+
+TEST(VarispeedTest, ConsumesRateTimesOutputPlusLookahead) {
+  const auto input = MakeSine(440.0, 48000, 48000, 2);
+  Varispeed varispeed(2);
+  varispeed.SetRate(1.37);
+  size_t consumed = 0;
+  ProcessInBlocks(varispeed, input, 10000, 333, &consumed);
+  const double expected = 1.37 * 10000.0 + static_cast<double>(varispeed.GetLeadFrames());
+  EXPECT_NEAR(static_cast<double>(consumed), expected, 2.0);
+}
+
+TEST(VarispeedTest, DrainEndsAtLastConsumedFrame) {
+  // A ramp makes each sample its own input position
+  std::vector<float> input(8192);
+  for (size_t i = 0; i < input.size(); ++i) {
+    input[i] = static_cast<float>(i);
+  }
+  Varispeed varispeed(1);
+  varispeed.SetRate(0.8);
+  size_t consumed = 0;
+  ProcessInBlocks(varispeed, input, 1000, 128, &consumed);
+
+  const size_t lead = varispeed.GetLeadFrames();
+  ASSERT_GT(lead, 0u);
+  std::vector<float> tail(lead + 8, -1.0f);
+  size_t drained = varispeed.Drain(tail.data(), 5);
+  drained += varispeed.Drain(tail.data() + drained, tail.size() - drained);
+  ASSERT_EQ(drained, lead);
+  EXPECT_EQ(varispeed.GetLeadFrames(), 0u);
+  for (size_t i = 0; i < lead; ++i) {
+    EXPECT_FLOAT_EQ(tail[i], static_cast<float>(consumed - lead + i));
+  }
+}
+
+TEST(VarispeedTest, RateAndQualityChangesAreContinuous) {
+  const auto input = MakeSine(200.0, 48000, 48000, 1);
+  Varispeed varispeed(1);
+  std::vector<float> output;
+  size_t consumed = 0;
+  const double rates[] = {1.0, 1.5, 0.7, 2.0, 1.0};
+  for (int block = 0; block < 20; ++block) {
+    varispeed.SetRate(rates[block % 5]);
+    varispeed.SetQuality(block % 2 == 0 ? Varispeed::Quality::kSinc : Varispeed::Quality::kCubic);
+    const size_t needed = varispeed.GetInputFramesNeeded(256);
+    std::vector<float> block_out(256);
+    varispeed.Process(input.data() + consumed, needed, block_out.data(), 256);
+    consumed += needed;
+    output.insert(output.end(), block_out.begin(), block_out.end());
+  }
+  // A 200 Hz tone at up to double speed moves at most ~0.053 per sample
+  for (size_t i = 1; i < output.size(); ++i) {
+    ASSERT_LT(std::abs(output[i] - output[i - 1]), 0.06f) << "frame " << i;
+  }
+}
+
+}  // namespace dsp
+}  // namespace sezo